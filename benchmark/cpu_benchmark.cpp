@@ -0,0 +1,301 @@
+// CPU microbenchmarks of the loader, the data packing, the pruning, the spatial reordering and the CPU sorter.
+// Needs no Vulkan device. Scenes are synthetic unless a ply file is provided.
+//
+// usage: cpu_benchmark [-counts 100000,1000000] [-threads 1,4,0] [-repeats 5]
+//                      [-ply file.ply] [-gsMode 0|1] [-out cpu_benchmark.json]
+// a thread count of 0 stands for one thread per hardware thread.
+// The JSON report lists one entry per (benchmark, splat count, thread count).
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ply_async_loader.h"
+#include "splat_generator.h"
+#include "splat_packing.h"
+#include "splat_prune.h"
+#include "splat_reorder.h"
+#include "splat_sorter_async.h"
+#include "utilities.h"
+
+struct CpuBenchmarkSettings
+{
+  std::vector<uint32_t> splatCounts  = {100000, 1000000, 4000000};
+  std::vector<uint32_t> threadCounts = {1, 0};
+  uint32_t              repeats      = 5;
+  uint32_t              gsMode       = GSMode_3DGS;
+  std::string           plyFilename;
+  std::string           reportFilename = "cpu_benchmark.json";
+};
+
+struct CpuBenchmarkResult
+{
+  std::string name;
+  size_t      splatCount  = 0;
+  uint32_t    threadCount = 0;
+  // in milliseconds over the repeats
+  double minTime    = 0.0;
+  double medianTime = 0.0;
+  double meanTime   = 0.0;
+};
+
+static bool parseList(const std::string& str, std::vector<uint32_t>& values)
+{
+  std::vector<uint32_t> parsed;
+  std::stringstream     stream(str);
+  std::string           item;
+  while(std::getline(stream, item, ','))
+  {
+    try
+    {
+      parsed.push_back((uint32_t)std::stoul(item));
+    }
+    catch(const std::exception&)
+    {
+      return false;
+    }
+  }
+  if(parsed.empty())
+    return false;
+  values = parsed;
+  return true;
+}
+
+static bool parseArguments(int argc, char** argv, CpuBenchmarkSettings& settings)
+{
+  for(int i = 1; i < argc; ++i)
+  {
+    const std::string arg   = argv[i];
+    const bool        value = i + 1 < argc;
+    if(arg == "-counts" && value && parseList(argv[++i], settings.splatCounts))
+      continue;
+    if(arg == "-threads" && value && parseList(argv[++i], settings.threadCounts))
+      continue;
+    if(arg == "-repeats" && value)
+    {
+      settings.repeats = std::max(1, std::atoi(argv[++i]));
+      continue;
+    }
+    if(arg == "-gsMode" && value)
+    {
+      settings.gsMode = std::atoi(argv[++i]) == 0 ? GSMode_3DGS : GSMode_SPACETIME_LITE;
+      continue;
+    }
+    if(arg == "-ply" && value)
+    {
+      settings.plyFilename = argv[++i];
+      continue;
+    }
+    if(arg == "-out" && value)
+    {
+      settings.reportFilename = argv[++i];
+      continue;
+    }
+    std::cerr << "Error: invalid argument " << arg << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// runs func repeats times and returns the statistics in milliseconds
+static CpuBenchmarkResult measure(const std::string& name, size_t splatCount, uint32_t repeats, const std::function<void()>& func)
+{
+  std::vector<double> times;
+  for(uint32_t i = 0; i < repeats; ++i)
+  {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    func();
+    auto endTime = std::chrono::high_resolution_clock::now();
+    times.push_back(0.001 * std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count());
+  }
+  std::sort(times.begin(), times.end());
+
+  CpuBenchmarkResult result;
+  result.name        = name;
+  result.splatCount  = splatCount;
+  result.threadCount = getParallelThreadCount();
+  result.minTime     = times.front();
+  result.medianTime  = times[times.size() / 2];
+  for(double t : times)
+    result.meanTime += t / times.size();
+
+  std::cout << name << " splats=" << splatCount << " threads=" << result.threadCount << " min=" << result.minTime
+            << "ms median=" << result.medianTime << "ms" << std::endl;
+  return result;
+}
+
+// benchmarks of one scene for all the thread counts
+static void runScene(const CpuBenchmarkSettings& settings, const std::string& filename, std::vector<CpuBenchmarkResult>& results)
+{
+  const GSMode gsMode = (GSMode)settings.gsMode;
+
+  // the loader is single threaded, measured once
+  SplatSet splatSet;
+  {
+    PlyAsyncLoader loader;
+    loader.m_gsMode = gsMode;
+    bool loaded     = true;
+    results.push_back(measure(gsMode == GSMode_3DGS ? "load_3dgs" : "load_spacetime_lite", 0, settings.repeats, [&]() {
+      splatSet = {};
+      loaded   = loader.loadSceneSync(filename, splatSet);
+    }));
+    if(!loaded)
+    {
+      std::cerr << "Error: failed to load " << filename << std::endl;
+      results.pop_back();
+      return;
+    }
+    results.back().splatCount = splatSet.size();
+  }
+  const size_t splatCount = splatSet.size();
+
+  for(uint32_t threadCount : settings.threadCounts)
+  {
+    parallelThreadCountOverride() = threadCount;
+
+    if(gsMode == GSMode_3DGS)
+    {
+      std::vector<float> centers(splatCount * 4);
+      results.push_back(measure("pack_centers", splatCount, settings.repeats, [&]() { packCenters(splatSet, centers.data(), 4); }));
+
+      std::vector<float> covariances(splatCount * 6);
+      results.push_back(measure("pack_covariances", splatCount, settings.repeats,
+                                [&]() { packCovariances_3DGS(splatSet, covariances.data()); }));
+
+      std::vector<float> colors(splatCount * 4);
+      results.push_back(measure("pack_colors", splatCount, settings.repeats, [&]() { packColors_3DGS(splatSet, colors.data()); }));
+
+      const uint32_t       shStride = getShComponentCount(getShDegree_3DGS(splatSet));
+      std::vector<uint8_t> sh(splatCount * shStride * sizeof(float));
+      const char*          shNames[] = {"pack_sh_fp32", "pack_sh_fp16", "pack_sh_uint8"};
+      for(uint32_t format : {FORMAT_FLOAT32, FORMAT_FLOAT16, FORMAT_UINT8})
+      {
+        results.push_back(measure(shNames[format], splatCount, settings.repeats,
+                                  [&]() { packSphericalHarmonics_3DGS(splatSet, format, sh.data(), shStride); }));
+      }
+
+      // adaptive SH storage, degree analysis, layout and packing as done at upload
+      std::vector<uint8_t>  shDegrees;
+      std::vector<uint32_t> shHeaders;
+      results.push_back(measure("pack_sh_adaptive_fp16", splatCount, settings.repeats, [&]() {
+        computeShDegrees_3DGS(splatSet, 1.0f / 255.0f, 3, shDegrees);
+        if(computeAdaptiveShLayout(shDegrees, FORMAT_FLOAT16, shHeaders) > 0)
+          packAdaptiveSphericalHarmonics_3DGS(splatSet, FORMAT_FLOAT16, shHeaders, sh.data());
+      }));
+    }
+
+    // load time pruning with every test enabled, the budget keeps half of the splats
+    {
+      SplatPruneSettings pruneSettings;
+      pruneSettings.enabled          = true;
+      pruneSettings.maxDistanceRatio = 20.0f;
+      pruneSettings.maxSplatCount    = splatCount / 2;
+      SplatSet        pruned;
+      SplatPruneStats pruneStats;
+      results.push_back(measure("prune", splatCount, settings.repeats, [&]() {
+        pruned = splatSet;
+        pruneSplatSet(pruned, pruneSettings, pruneStats);
+      }));
+    }
+
+    // load time spatial reordering, applied to a copy at each repeat
+    for(SplatOrder order : {SPLAT_ORDER_MORTON, SPLAT_ORDER_HILBERT})
+    {
+      SplatSet reordered;
+      results.push_back(measure(order == SPLAT_ORDER_MORTON ? "reorder_morton" : "reorder_hilbert", splatCount,
+                                settings.repeats, [&]() {
+                                  reordered = splatSet;
+                                  reorderSplatSet(reordered, order);
+                                }));
+    }
+
+    // the sorter is never started, sorts run in this thread
+    SplatSorterAsync      sorter;
+    std::vector<uint32_t> indices;
+    double                distTime = 0.0, sortTime = 0.0;
+    double                distSum = 0.0, sortSum = 0.0;
+    uint32_t              view    = 0;
+    results.push_back(measure("cpu_sort", splatCount, settings.repeats, [&]() {
+      // a different viewpoint at each repeat so that the input is never already sorted
+      const float     angle = 0.7f * float(view++);
+      const glm::vec3 cop(10.0f * std::cos(angle), 2.0f, 10.0f * std::sin(angle));
+      sorter.sortSync(glm::normalize(-cop), cop, splatSet.positions, indices, distTime, sortTime);
+      distSum += distTime;
+      sortSum += sortTime;
+    }));
+    // split of the sort in its two stages, averaged
+    CpuBenchmarkResult dist = results.back(), sort = results.back();
+    dist.name = "cpu_sort_distances";
+    sort.name = "cpu_sort_sorting";
+    dist.minTime = dist.medianTime = dist.meanTime = distSum / settings.repeats;
+    sort.minTime = sort.medianTime = sort.meanTime = sortSum / settings.repeats;
+    results.push_back(dist);
+    results.push_back(sort);
+  }
+  parallelThreadCountOverride() = 0;
+}
+
+static bool writeReport(const std::string& filename, const std::vector<CpuBenchmarkResult>& results)
+{
+  std::ofstream file(filename);
+  if(!file.is_open())
+  {
+    std::cerr << "Error: cannot write report " << filename << std::endl;
+    return false;
+  }
+  file << "{\n  \"hardwareThreads\": " << std::thread::hardware_concurrency() << ",\n  \"results\": [\n";
+  for(size_t i = 0; i < results.size(); ++i)
+  {
+    const auto& r = results[i];
+    file << "    {\"name\": \"" << r.name << "\", \"splatCount\": " << r.splatCount << ", \"threads\": " << r.threadCount
+         << ", \"minMs\": " << r.minTime << ", \"medianMs\": " << r.medianTime << ", \"meanMs\": " << r.meanTime << "}"
+         << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  file << "  ]\n}\n";
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  CpuBenchmarkSettings settings;
+  if(!parseArguments(argc, argv, settings))
+    return 1;
+
+  std::vector<CpuBenchmarkResult> results;
+
+  if(!settings.plyFilename.empty())
+  {
+    runScene(settings, settings.plyFilename, results);
+  }
+  else
+  {
+    // synthetic scenes go through a temporary ply file so that the loader is measured too
+    for(uint32_t splatCount : settings.splatCounts)
+    {
+      SplatGeneratorSettings generator;
+      generator.splatCount = splatCount;
+
+      const std::string filename =
+          (std::filesystem::temp_directory_path() / ("cpu_benchmark_" + std::to_string(splatCount) + ".ply")).string();
+      {
+        SplatSet splatSet;
+        if(!generateSplatSet(generator, (GSMode)settings.gsMode, splatSet)
+           || !writeSplatSetPly(filename, splatSet, (GSMode)settings.gsMode))
+          return 1;
+      }
+      runScene(settings, filename, results);
+      std::filesystem::remove(filename);
+    }
+  }
+
+  if(!writeReport(settings.reportFilename, results))
+    return 1;
+  std::cout << "Report written to " << settings.reportFilename << std::endl;
+  return 0;
+}
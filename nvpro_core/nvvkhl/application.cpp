@@ -386,7 +386,7 @@ void nvvkhl::Application::runXR(std::function<void(nvvkhl::Application* app)> fu
   while(!glfwWindowShouldClose(m_windowHandle))
   {
     glfwPollEvents();
-    if(glfwGetWindowAttrib(m_windowHandle, GLFW_ICONIFIED) == GLFW_TRUE)
+    if(isMinimized() && !m_renderWhenMinimized)
     {
       ImGui_ImplGlfw_Sleep(10);  // Do nothing when minimized
       continue;
@@ -452,10 +452,11 @@ void nvvkhl::Application::runXR(std::function<void(nvvkhl::Application* app)> fu
     }
 
     // XR rendering
+    m_offscreenFrame = false;
     func(this);
 
-    // Update and Render additional Platform Windows (floating windows)
-    if((ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable) != 0)
+    // Update and Render additional Platform Windows (floating windows), they are presented with the main window
+    if((ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable) != 0 && !m_offscreenFrame)
     {
       ImGui::UpdatePlatformWindows();
       ImGui::RenderPlatformWindowsDefault();
@@ -654,6 +655,91 @@ void nvvkhl::Application::presentFrame()
 }
 
 
+bool nvvkhl::Application::isMinimized() const
+{
+  return glfwGetWindowAttrib(m_windowHandle, GLFW_ICONIFIED) == GLFW_TRUE;
+}
+
+//-----------------------------------------------------------------------
+// Offscreen frames use the same ring of frame resources as beginFrame/endFrame,
+// so the elements can keep indexing their per-frame data with getFrameCycleIndex(),
+// but no swapchain image is acquired: the frame never waits for the display.
+//
+VkCommandBuffer nvvkhl::Application::beginOffscreenFrame()
+{
+  FrameData& frame = m_frameData[m_frameRingCurrent];
+
+  // Wait until GPU has finished processing the frame that was using these resources previously
+  const uint64_t            waitValue = frame.frameNumber;
+  const VkSemaphoreWaitInfo waitInfo  = {
+       .sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+       .semaphoreCount = 1,
+       .pSemaphores    = &m_frameTimelineSemaphore,
+       .pValues        = &waitValue,
+  };
+  vkWaitSemaphores(m_device, &waitInfo, std::numeric_limits<uint64_t>::max());
+
+  NVVK_CHECK(vkResetCommandPool(m_device, frame.cmdPool, 0));
+  VkCommandBuffer cmd = frame.cmdBuffer;
+
+  const VkCommandBufferBeginInfo beginInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                                           .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+  NVVK_CHECK(vkBeginCommandBuffer(cmd, &beginInfo));
+
+  m_offscreenFrame = true;
+  return cmd;
+}
+
+void nvvkhl::Application::drawOffscreenFrame(VkCommandBuffer cmd)
+{
+  m_waitSemaphores.clear();
+  m_signalSemaphores.clear();
+  m_commandBuffers.clear();
+
+  // The UI is still processed so that its state follows the frames, it is only drawn when presented
+  for(std::shared_ptr<IAppElement>& e : m_elements)
+  {
+    e->onUIRender();
+  }
+  ImGui::Render();
+
+  for(std::shared_ptr<IAppElement>& e : m_elements)
+  {
+    e->onRender(cmd);
+  }
+}
+
+void nvvkhl::Application::endOffscreenFrame(VkCommandBuffer cmd)
+{
+  NVVK_CHECK(vkEndCommandBuffer(cmd));
+
+  FrameData&     frame            = m_frameData[m_frameRingCurrent];
+  const uint64_t signalFrameValue = frame.frameNumber + m_swapchain.getMaxFramesInFlight();
+  frame.frameNumber               = signalFrameValue;
+
+  m_signalSemaphores.push_back({
+      .sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+      .semaphore = m_frameTimelineSemaphore,
+      .value     = signalFrameValue,
+      .stageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+  });
+  m_commandBuffers.push_back({.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO, .commandBuffer = cmd});
+
+  const VkSubmitInfo2 submitInfo{
+      .sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+      .waitSemaphoreInfoCount   = uint32_t(m_waitSemaphores.size()),
+      .pWaitSemaphoreInfos      = m_waitSemaphores.data(),
+      .commandBufferInfoCount   = uint32_t(m_commandBuffers.size()),
+      .pCommandBufferInfos      = m_commandBuffers.data(),
+      .signalSemaphoreInfoCount = uint32_t(m_signalSemaphores.size()),
+      .pSignalSemaphoreInfos    = m_signalSemaphores.data(),
+  };
+  NVVK_CHECK(vkQueueSubmit2(m_queues[0].queue, 1, &submitInfo, nullptr));
+
+  // Move to the next frame
+  m_frameRingCurrent = (m_frameRingCurrent + 1) % m_swapchain.getMaxFramesInFlight();
+}
+
 //-----------------------------------------------------------------------
 // We are using dynamic rendering, which is a more flexible way to render to the swapchain image.
 //
@@ -240,6 +240,17 @@ public:
   void            endFrame(VkCommandBuffer cmd);
   void            presentFrame();
 
+  // Frame of the ring submitted without acquiring nor presenting a swapchain image.
+  // The elements are rendered and the UI is processed but not drawn to the window,
+  // used by the XR frames that are not mirrored on the desktop.
+  VkCommandBuffer beginOffscreenFrame();
+  void            drawOffscreenFrame(VkCommandBuffer cmd);
+  void            endOffscreenFrame(VkCommandBuffer cmd);
+
+  // runXR keeps calling its function when the window is minimized
+  void setRenderWhenMinimized(bool v) { m_renderWhenMinimized = v; }
+  bool isMinimized() const;
+
 private:
   void            init(ApplicationCreateInfo& info);
   void            initGlfw(ApplicationCreateInfo& info);
@@ -317,6 +328,8 @@ private:
   glm::ivec2              m_winSize{};
   // Mode
   bool m_switchMode = false;
+  bool m_renderWhenMinimized = false;
+  bool m_offscreenFrame      = false;  // the current frame is not presented to the window
 };
 
 
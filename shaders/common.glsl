@@ -41,6 +41,10 @@ layout(set = 0, binding = BINDING_COVARIANCES_BUFFER) buffer _covariancesBuffer
 };
 layout(set = 0, binding = BINDING_SH_BUFFER) buffer _sphericalHarmonicsBuffer
 {
+#if GSMODE != GSMODE_3DGS
+  // spacetime features (motion, scale, rotation, omega, trbf) are always uploaded as fp32
+  float sphericalHarmonicsBuffer[];
+#else
 #if SH_FORMAT == FORMAT_FLOAT32
   float sphericalHarmonicsBuffer[];
 #else
@@ -54,6 +58,27 @@ layout(set = 0, binding = BINDING_SH_BUFFER) buffer _sphericalHarmonicsBuffer
 #endif
 #endif
 #endif
+#endif
+};
+#if SH_ADAPTIVE
+// per splat headers of the adaptive SH storage, (offset << 2) | degree, at the
+// beginning of the SH buffer, see packAdaptiveSphericalHarmonics_3DGS
+layout(set = 0, binding = BINDING_SH_BUFFER) buffer _shHeadersBuffer
+{
+  uint shHeadersBuffer[];
+};
+#endif
+#endif
+
+#if SCENE_INSTANCING
+// composed scenes, the splats of the instances are ranges of the concatenated data
+layout(set = 0, binding = BINDING_INSTANCE_INDICES_BUFFER, scalar) readonly buffer _instanceIndicesBuffer
+{
+  uint32_t instanceIndices[];
+};
+layout(set = 0, binding = BINDING_INSTANCES_BUFFER, scalar) readonly buffer _instancesBuffer
+{
+  SplatInstance instances[];
 };
 #endif
 
@@ -82,11 +107,62 @@ ivec2 getDataPosF(in uint splatIndex, in float stride, in uint offset, in ivec2
   return ivec2(fullOffset % dimensions.x, fullOffset / dimensions.x);
 }
 
+#if GSMODE != GSMODE_3DGS
+// builds the covariance of a spacetime gaussian from its scale, rotation
+// quaternion and rotation velocity (omega) at time deltaT
+mat3 spacetimeCovariance(in vec3 s, in vec4 q, in vec4 omega, in float deltaT)
+{
+  q = q + deltaT * omega;
+  q = q / length(q);
+
+  float xx  = q.x * q.x;
+  float yy  = q.y * q.y;
+  float zz  = q.z * q.z;
+  float xy  = q.x * q.y;
+  float xz  = q.x * q.z;
+  float yz  = q.y * q.z;
+  float wx  = q.w * q.x;
+  float wy  = q.w * q.y;
+  float wz  = q.w * q.z;
+  mat3  rot = mat3(1.0 - 2.0 * (yy + zz), 2.0 * (xy + wz), 2.0 * (xz - wy), 2.0 * (xy - wz), 1.0 - 2.0 * (xx + zz),
+                   2.0 * (yz + wx), 2.0 * (xz + wy), 2.0 * (yz - wx), 1.0 - 2.0 * (xx + yy));
+  mat3  ss  = mat3(s.x * s.x, 0.0, 0.0, 0.0, s.y * s.y, 0.0, 0.0, 0.0, s.z * s.z);
+  return rot * ss * transpose(rot);
+}
+#endif
+
 #if DATA_STORAGE == STORAGE_TEXTURES
+#if GSMODE != GSMODE_3DGS
+// spacetime features are stored in the SH texture map using the same
+// component order as the data buffer, padded to SPACETIME_TEXELS_PER_SPLAT texels:
+// 0: motion 0..3, 1: motion 4..7, 2: motion 8 + scale, 3: rotation, 4: omega, 5: trbf center, trbf scale
+vec4 fetchSpacetimeTexel(in uint splatIndex, in uint texel)
+{
+  return texelFetch(sphericalHarmonicsTexture,
+                    getDataPos(splatIndex, SPACETIME_TEXELS_PER_SPLAT, texel, textureSize(sphericalHarmonicsTexture, 0)), 0);
+}
+#endif
+
 // fetch center value from texture map
-vec3 fetchCenter(in uint splatIndex)
+vec3 fetchCenter(
+    in uint splatIndex
+#if GSMODE != GSMODE_3DGS
+    , in float deltaT
+#endif
+)
 {
-  return vec3(texelFetch(centersTexture, getDataPos(splatIndex, 1, 0, textureSize(centersTexture, 0)), 0));
+  const vec3 a0 = vec3(texelFetch(centersTexture, getDataPos(splatIndex, 1, 0, textureSize(centersTexture, 0)), 0));
+#if GSMODE == GSMODE_3DGS
+  return a0;
+#else  // spacetime gaussian
+  const vec4 motion0123 = fetchSpacetimeTexel(splatIndex, 0);
+  const vec4 motion4567 = fetchSpacetimeTexel(splatIndex, 1);
+  const vec4 motion8    = fetchSpacetimeTexel(splatIndex, 2);
+  const vec3 a1         = motion0123.xyz;
+  const vec3 a2         = vec3(motion0123.w, motion4567.xy);
+  const vec3 a3         = vec3(motion4567.zw, motion8.x);
+  return (a0 + a1 * deltaT) + (a2 + a3 * deltaT) * (deltaT * deltaT);
+#endif
 }
 #else
 
@@ -115,9 +191,18 @@ vec3 fetchCenter(
 
 #if DATA_STORAGE == STORAGE_TEXTURES
 // fetchColor replaces fetchSH0 since non view dependent color is precomputed on CPU
-vec4 fetchColor(in uint splatIndex)
+vec4 fetchColor(
+    in uint splatIndex
+#if GSMODE != GSMODE_3DGS
+    , in float deltaT
+#endif
+)
 {
-  return texelFetch(colorsTexture, getDataPos(splatIndex, 1, 0, textureSize(colorsTexture, 0)), 0);
+  vec4 color = texelFetch(colorsTexture, getDataPos(splatIndex, 1, 0, textureSize(colorsTexture, 0)), 0);
+#if GSMODE != GSMODE_3DGS  // spacetime gaussian
+  color.a = color.a * exp(-fetchSpacetimeTexel(splatIndex, 5).y * deltaT * deltaT);
+#endif
+  return color;
 }
 #else
 // fetch center value from data buffer
@@ -140,6 +225,7 @@ vec4 fetchColor(
 #if DATA_STORAGE == STORAGE_TEXTURES
 // fetch from data textures
 void fetchSh(in uint  splatIndex,
+             in int   shDegree,
              out vec3 shd1[3]
 #if MAX_SH_DEGREE >= 2
              , out vec3 shd2[5]
@@ -177,81 +263,108 @@ void fetchSh(in uint  splatIndex,
 
   // fetching degree 2
 #if MAX_SH_DEGREE >= 2
-  const vec4 sampledSH12131415 =
-      texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 3, textureSize(sphericalHarmonicsTexture, 0)), 0);
-  const vec4 sampledSH16171819 =
-      texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 4, textureSize(sphericalHarmonicsTexture, 0)), 0);
-  const vec4 sampledSH20212223 =
-      texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 5, textureSize(sphericalHarmonicsTexture, 0)), 0);
-
-  const vec3 sh4 = sampledSH891011.gba;
-  const vec3 sh5 = sampledSH12131415.rgb;
-  const vec3 sh6 = vec3(sampledSH12131415.a, sampledSH16171819.rg);
-  const vec3 sh7 = vec3(sampledSH16171819.ba, sampledSH20212223.r);
-  const vec3 sh8 = sampledSH20212223.gba;
+  if(shDegree >= 2)
+  {
+    const vec4 sampledSH12131415 =
+        texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 3, textureSize(sphericalHarmonicsTexture, 0)), 0);
+    const vec4 sampledSH16171819 =
+        texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 4, textureSize(sphericalHarmonicsTexture, 0)), 0);
+    const vec4 sampledSH20212223 =
+        texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 5, textureSize(sphericalHarmonicsTexture, 0)), 0);
+
+    const vec3 sh4 = sampledSH891011.gba;
+    const vec3 sh5 = sampledSH12131415.rgb;
+    const vec3 sh6 = vec3(sampledSH12131415.a, sampledSH16171819.rg);
+    const vec3 sh7 = vec3(sampledSH16171819.ba, sampledSH20212223.r);
+    const vec3 sh8 = sampledSH20212223.gba;
 
 #if SH_FORMAT != FORMAT_UINT8
-  shd2[0] = sh4;
-  shd2[1] = sh5;
-  shd2[2] = sh6;
-  shd2[3] = sh7;
-  shd2[4] = sh8;
+    shd2[0] = sh4;
+    shd2[1] = sh5;
+    shd2[2] = sh6;
+    shd2[3] = sh7;
+    shd2[4] = sh8;
 #else
-  shd2[0] = sh4 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
-  shd2[1] = sh5 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
-  shd2[2] = sh6 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
-  shd2[3] = sh7 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
-  shd2[4] = sh8 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
+    shd2[0] = sh4 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
+    shd2[1] = sh5 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
+    shd2[2] = sh6 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
+    shd2[3] = sh7 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
+    shd2[4] = sh8 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
 #endif
+  }
 #endif
 
   // Fetching degree 3
 #if MAX_SH_DEGREE >= 3
-  const vec4 sampledSH24252627 =
-      texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 6, textureSize(sphericalHarmonicsTexture, 0)), 0);
-  const vec4 sampledSH28293031 =
-      texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 7, textureSize(sphericalHarmonicsTexture, 0)), 0);
-  const vec4 sampledSH32333435 =
-      texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 8, textureSize(sphericalHarmonicsTexture, 0)), 0);
-  const vec4 sampledSH36373839 =
-      texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 9, textureSize(sphericalHarmonicsTexture, 0)), 0);
-  const vec4 sampledSH404142 =
-      texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 10, textureSize(sphericalHarmonicsTexture, 0)), 0);
-  const vec4 sampledSH434445 =
-      texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 11, textureSize(sphericalHarmonicsTexture, 0)), 0);
-
-  const vec3 sh9  = sampledSH24252627.rgb;
-  const vec3 sh10 = vec3(sampledSH24252627.a, sampledSH28293031.rg);
-  const vec3 sh11 = vec3(sampledSH28293031.ba, sampledSH32333435.r );
-  const vec3 sh12 = sampledSH32333435.gba;
-  const vec3 sh13 = sampledSH36373839.rgb;
-  const vec3 sh14 = vec3(sampledSH36373839.a, sampledSH404142.rg);
-  const vec3 sh15 = vec3(sampledSH404142.ba, sampledSH434445.r);
+  if(shDegree >= 3)
+  {
+    const vec4 sampledSH24252627 =
+        texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 6, textureSize(sphericalHarmonicsTexture, 0)), 0);
+    const vec4 sampledSH28293031 =
+        texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 7, textureSize(sphericalHarmonicsTexture, 0)), 0);
+    const vec4 sampledSH32333435 =
+        texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 8, textureSize(sphericalHarmonicsTexture, 0)), 0);
+    const vec4 sampledSH36373839 =
+        texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 9, textureSize(sphericalHarmonicsTexture, 0)), 0);
+    const vec4 sampledSH404142 =
+        texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 10, textureSize(sphericalHarmonicsTexture, 0)), 0);
+    const vec4 sampledSH434445 =
+        texelFetch(sphericalHarmonicsTexture, getDataPos(splatIndex, stride, 11, textureSize(sphericalHarmonicsTexture, 0)), 0);
+
+    const vec3 sh9  = sampledSH24252627.rgb;
+    const vec3 sh10 = vec3(sampledSH24252627.a, sampledSH28293031.rg);
+    const vec3 sh11 = vec3(sampledSH28293031.ba, sampledSH32333435.r );
+    const vec3 sh12 = sampledSH32333435.gba;
+    const vec3 sh13 = sampledSH36373839.rgb;
+    const vec3 sh14 = vec3(sampledSH36373839.a, sampledSH404142.rg);
+    const vec3 sh15 = vec3(sampledSH404142.ba, sampledSH434445.r);
 
 #if SH_FORMAT != FORMAT_UINT8
-  shd3[0] = sh9;
-  shd3[1] = sh10;
-  shd3[2] = sh11;
-  shd3[3] = sh12;
-  shd3[4] = sh13;
-  shd3[5] = sh14;
-  shd3[6] = sh15;
+    shd3[0] = sh9;
+    shd3[1] = sh10;
+    shd3[2] = sh11;
+    shd3[3] = sh12;
+    shd3[4] = sh13;
+    shd3[5] = sh14;
+    shd3[6] = sh15;
 #else
-  shd3[0] = sh9 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
-  shd3[1] = sh10 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
-  shd3[2] = sh11 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
-  shd3[3] = sh12 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
-  shd3[4] = sh13 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
-  shd3[5] = sh14 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
-  shd3[6] = sh15 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
+    shd3[0] = sh9 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
+    shd3[1] = sh10 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
+    shd3[2] = sh11 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
+    shd3[3] = sh12 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
+    shd3[4] = sh13 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
+    shd3[5] = sh14 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
+    shd3[6] = sh15 * SphericalHarmonics8BitCompressionRange - vec8BitSHShift;
 #endif
+  }
 #endif
 
 }
 #else// fetch from data buffers
 #if GSMODE == GSMODE_3DGS
+// 8 bit SH coefficients are mapped from [0, 255] to [-1, 1]
+const float SphericalHarmonics8BitCompressionRange     = 2.0;
+const float SphericalHarmonics8BitCompressionHalfRange = SphericalHarmonics8BitCompressionRange / 2.0;
+const vec3  vec8BitSHShift                             = vec3(SphericalHarmonics8BitCompressionHalfRange);
+const float SphericalHarmonics8BitScale                = SphericalHarmonics8BitCompressionRange / 255.0f;
+
+#if SH_ADAPTIVE
+// coefficient coef of a splat whose coefficients start at base
+vec3 fetchShCoefficient(in uint base, in uint coef)
+{
+  const vec3 sh = vec3(sphericalHarmonicsBuffer[base + 3 * coef + 0], sphericalHarmonicsBuffer[base + 3 * coef + 1],
+                       sphericalHarmonicsBuffer[base + 3 * coef + 2]);
+#if SH_FORMAT != FORMAT_UINT8
+  return sh;
+#else
+  return sh * SphericalHarmonics8BitScale - vec8BitSHShift;
+#endif
+}
+
+// each splat stores the bands up to its own degree, the higher bands are zero.
+// the bands above shDegree are not fetched
 void fetchSh(
-  in uint splatIndex ,out vec3 shd1[3] 
+  in uint splatIndex, in int shDegree, out vec3 shd1[3]
 #if MAX_SH_DEGREE >= 2
   ,out vec3 shd2[5]
 #endif
@@ -260,12 +373,48 @@ void fetchSh(
 #endif
 )
 {
-  const uint splatStride = 45;
-
-  const float SphericalHarmonics8BitCompressionRange     = 2.0;
-  const float SphericalHarmonics8BitCompressionHalfRange = SphericalHarmonics8BitCompressionRange / 2.0;
-  const vec3  vec8BitSHShift                             = vec3(SphericalHarmonics8BitCompressionHalfRange);
-  const float SphericalHarmonics8BitScale                = SphericalHarmonics8BitCompressionRange / 255.0f;
+  const uint header = shHeadersBuffer[splatIndex];
+  const uint degree = min(header & 3u, uint(shDegree));
+  const uint base   = header >> 2;
+
+  for(uint i = 0; i < 3; ++i)
+    shd1[i] = vec3(0.0);
+  if(degree >= 1)
+  {
+    for(uint i = 0; i < 3; ++i)
+      shd1[i] = fetchShCoefficient(base, i);
+  }
+#if MAX_SH_DEGREE >= 2
+  for(uint i = 0; i < 5; ++i)
+    shd2[i] = vec3(0.0);
+  if(degree >= 2)
+  {
+    for(uint i = 0; i < 5; ++i)
+      shd2[i] = fetchShCoefficient(base, 3 + i);
+  }
+#endif
+#if MAX_SH_DEGREE >= 3
+  for(uint i = 0; i < 7; ++i)
+    shd3[i] = vec3(0.0);
+  if(degree >= 3)
+  {
+    for(uint i = 0; i < 7; ++i)
+      shd3[i] = fetchShCoefficient(base, 8 + i);
+  }
+#endif
+}
+#else
+void fetchSh(
+  in uint splatIndex, in int shDegree, out vec3 shd1[3] 
+#if MAX_SH_DEGREE >= 2
+  ,out vec3 shd2[5]
+#endif
+#if MAX_SH_DEGREE >= 3
+  ,out vec3 shd3[7]
+#endif
+)
+{
+  const uint splatStride = SH_BUFFER_STRIDE;  // SH components per splat in the buffer, see initShaders
 
   // fetching degree 1
   const vec3 sh1 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 0 + 0],
@@ -292,90 +441,97 @@ void fetchSh(
 
   // fetching degree 2
 #if MAX_SH_DEGREE >= 2
-  const vec3 sh4 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 3 + 0],
-                        sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 3 + 1],
-                        sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 3 + 2]);
+  if(shDegree >= 2)
+  {
+    const vec3 sh4 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 3 + 0],
+                          sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 3 + 1],
+                          sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 3 + 2]);
 
-  const vec3 sh5 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 4 + 0],
-                        sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 4 + 1],
-                        sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 4 + 2]);
+    const vec3 sh5 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 4 + 0],
+                          sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 4 + 1],
+                          sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 4 + 2]);
 
-  const vec3 sh6 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 5 + 0],
-                        sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 5 + 1],
-                        sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 5 + 2]);
+    const vec3 sh6 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 5 + 0],
+                          sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 5 + 1],
+                          sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 5 + 2]);
 
-  const vec3 sh7 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 6 + 0],
-                        sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 6 + 1],
-                        sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 6 + 2]);
+    const vec3 sh7 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 6 + 0],
+                          sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 6 + 1],
+                          sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 6 + 2]);
 
-  const vec3 sh8 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 7 + 0],
-                        sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 7 + 1],
-                        sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 7 + 2]);
+    const vec3 sh8 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 7 + 0],
+                          sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 7 + 1],
+                          sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 7 + 2]);
 
 #if SH_FORMAT != FORMAT_UINT8
-  shd2[0] = sh4;
-  shd2[1] = sh5;
-  shd2[2] = sh6;
-  shd2[3] = sh7;
-  shd2[4] = sh8;
+    shd2[0] = sh4;
+    shd2[1] = sh5;
+    shd2[2] = sh6;
+    shd2[3] = sh7;
+    shd2[4] = sh8;
 #else
-  shd2[0] = sh4 * SphericalHarmonics8BitScale - vec8BitSHShift;
-  shd2[1] = sh5 * SphericalHarmonics8BitScale - vec8BitSHShift;
-  shd2[2] = sh6 * SphericalHarmonics8BitScale - vec8BitSHShift;
-  shd2[3] = sh7 * SphericalHarmonics8BitScale - vec8BitSHShift;
-  shd2[4] = sh8 * SphericalHarmonics8BitScale - vec8BitSHShift;
+    shd2[0] = sh4 * SphericalHarmonics8BitScale - vec8BitSHShift;
+    shd2[1] = sh5 * SphericalHarmonics8BitScale - vec8BitSHShift;
+    shd2[2] = sh6 * SphericalHarmonics8BitScale - vec8BitSHShift;
+    shd2[3] = sh7 * SphericalHarmonics8BitScale - vec8BitSHShift;
+    shd2[4] = sh8 * SphericalHarmonics8BitScale - vec8BitSHShift;
 #endif
+  }
 #endif
 
   // fetching degree 3
 #if MAX_SH_DEGREE >= 3
-  const vec3 sh9 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 8 + 0],
-                        sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 8 + 1],
-                        sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 8 + 2]);
+  if(shDegree >= 3)
+  {
+    const vec3 sh9 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 8 + 0],
+                          sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 8 + 1],
+                          sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 8 + 2]);
 
-  const vec3 sh10 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 9 + 0],
-                         sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 9 + 1],
-                         sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 9 + 2]);
+    const vec3 sh10 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 9 + 0],
+                           sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 9 + 1],
+                           sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 9 + 2]);
 
-  const vec3 sh11 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 10 + 0],
-                         sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 10 + 1],
-                         sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 10 + 2]);
+    const vec3 sh11 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 10 + 0],
+                           sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 10 + 1],
+                           sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 10 + 2]);
 
-  const vec3 sh12 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 11 + 0],
-                         sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 11 + 1],
-                         sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 11 + 2]);
+    const vec3 sh12 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 11 + 0],
+                           sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 11 + 1],
+                           sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 11 + 2]);
 
-  const vec3 sh13 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 12 + 0],
-                         sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 12 + 1],
-                         sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 12 + 2]);
+    const vec3 sh13 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 12 + 0],
+                           sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 12 + 1],
+                           sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 12 + 2]);
 
-  const vec3 sh14 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 13 + 0],
-                         sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 13 + 1],
-                         sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 13 + 2]);
+    const vec3 sh14 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 13 + 0],
+                           sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 13 + 1],
+                           sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 13 + 2]);
 
-  const vec3 sh15 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 14 + 0],
-                         sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 14 + 1],
-                         sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 14 + 2]);
+    const vec3 sh15 = vec3(sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 14 + 0],
+                           sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 14 + 1],
+                           sphericalHarmonicsBuffer[splatStride * splatIndex + 3 * 14 + 2]);
 
 #if SH_FORMAT != FORMAT_UINT8
-  shd3[0] = sh9;
-  shd3[1] = sh10;
-  shd3[2] = sh11;
-  shd3[3] = sh12;
-  shd3[4] = sh13;
-  shd3[5] = sh14;
-  shd3[6] = sh15;
+    shd3[0] = sh9;
+    shd3[1] = sh10;
+    shd3[2] = sh11;
+    shd3[3] = sh12;
+    shd3[4] = sh13;
+    shd3[5] = sh14;
+    shd3[6] = sh15;
 #else
-  shd3[0] = sh9 * SphericalHarmonics8BitScale - vec8BitSHShift;
-  shd3[1] = sh10 * SphericalHarmonics8BitScale - vec8BitSHShift;
-  shd3[2] = sh11 * SphericalHarmonics8BitScale - vec8BitSHShift;
-  shd3[3] = sh12 * SphericalHarmonics8BitScale - vec8BitSHShift;
-  shd3[4] = sh13 * SphericalHarmonics8BitScale - vec8BitSHShift;
-  shd3[5] = sh14 * SphericalHarmonics8BitScale - vec8BitSHShift;
-  shd3[6] = sh15 * SphericalHarmonics8BitScale - vec8BitSHShift;
+    shd3[0] = sh9 * SphericalHarmonics8BitScale - vec8BitSHShift;
+    shd3[1] = sh10 * SphericalHarmonics8BitScale - vec8BitSHShift;
+    shd3[2] = sh11 * SphericalHarmonics8BitScale - vec8BitSHShift;
+    shd3[3] = sh12 * SphericalHarmonics8BitScale - vec8BitSHShift;
+    shd3[4] = sh13 * SphericalHarmonics8BitScale - vec8BitSHShift;
+    shd3[5] = sh14 * SphericalHarmonics8BitScale - vec8BitSHShift;
+    shd3[6] = sh15 * SphericalHarmonics8BitScale - vec8BitSHShift;
 #endif
+  }
 #endif
 }
+#endif //SH_ADAPTIVE
 #endif //GSMODE == GSMODE_3DGS
 #if GSMODE == GSMODE_SPACETIME_LITE
 
@@ -383,8 +539,19 @@ void fetchSh(
 #endif
 
 #if DATA_STORAGE == STORAGE_TEXTURES
-mat3 fetchCovariance(in uint splatIndex)
+mat3 fetchCovariance(
+    in uint splatIndex
+#if GSMODE != GSMODE_3DGS
+    , in float deltaT
+#endif
+)
 {
+#if GSMODE != GSMODE_3DGS
+  const vec3 s = fetchSpacetimeTexel(splatIndex, 2).yzw;
+  const vec4 q = fetchSpacetimeTexel(splatIndex, 3);
+  const vec4 omega = fetchSpacetimeTexel(splatIndex, 4);
+  return spacetimeCovariance(s, q, omega, deltaT);
+#else
   // Use RGBA texture map to store sets of 3 elements requires some offset shifting depending on splatIndex
 
   const uint  oddOffset        = uint(splatIndex) & uint(0x00000001);
@@ -408,6 +575,7 @@ mat3 fetchCovariance(in uint splatIndex)
 
   return mat3(cov3D_M11_M12_M13.x, cov3D_M11_M12_M13.y, cov3D_M11_M12_M13.z, cov3D_M11_M12_M13.y, cov3D_M22_M23_M33.x,
               cov3D_M22_M23_M33.y, cov3D_M11_M12_M13.z, cov3D_M22_M23_M33.y, cov3D_M22_M23_M33.z);
+#endif
 }
 #else
 
@@ -434,22 +602,7 @@ mat3 fetchCovariance(
                     sphericalHarmonicsBuffer[splatIndex * 22 + 14], sphericalHarmonicsBuffer[splatIndex * 22 + 15]);
   vec4 omega = vec4(sphericalHarmonicsBuffer[splatIndex * 22 + 16], sphericalHarmonicsBuffer[splatIndex * 22 + 17],
                     sphericalHarmonicsBuffer[splatIndex * 22 + 18], sphericalHarmonicsBuffer[splatIndex * 22 + 19]);
-  q          = q + deltaT * omega;
-  q          = q / length(q);
-
-  float xx  = q.x * q.x;
-  float yy  = q.y * q.y;
-  float zz  = q.z * q.z;
-  float xy  = q.x * q.y;
-  float xz  = q.x * q.z;
-  float yz  = q.y * q.z;
-  float wx  = q.w * q.x;
-  float wy  = q.w * q.y;
-  float wz  = q.w * q.z;
-  mat3  rot = mat3(1.0 - 2.0 * (yy + zz), 2.0 * (xy + wz), 2.0 * (xz - wy), 2.0 * (xy - wz), 1.0 - 2.0 * (xx + zz),
-                        2.0 * (yz + wx), 2.0 * (xz + wy), 2.0 * (yz - wx), 1.0 - 2.0 * (xx + yy) );
-  mat3  ss  = mat3(s.x * s.x, 0.0, 0.0, 0.0, s.y * s.y, 0.0, 0.0, 0.0, s.z * s.z);
-  return rot * ss * transpose(rot);
+  return spacetimeCovariance(s, q, omega, deltaT);
 #endif
 }
 #endif
@@ -457,6 +610,10 @@ mat3 fetchCovariance(
 #if GSMODE != GSMODE_3DGS
 float fetchDeltaT(in uint splatIndex, in float T)
 {
+#if DATA_STORAGE == STORAGE_TEXTURES
+  return T - fetchSpacetimeTexel(splatIndex, 5).x;
+#else
   return T - sphericalHarmonicsBuffer[splatIndex * 22 + 20];
+#endif
 }
 #endif
\ No newline at end of file
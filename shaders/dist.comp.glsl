@@ -20,6 +20,10 @@
 #version 460
 
 #extension GL_GOOGLE_include_directive : enable
+#if DIST_SUBGROUP_COMPACTION
+#extension GL_KHR_shader_subgroup_basic : require
+#extension GL_KHR_shader_subgroup_ballot : require
+#endif
 #include "shaderio.h"
 #include "common.glsl"
 
@@ -55,24 +59,42 @@ uint encodeMinMaxFp32(float val)
 void main()
 {
   const uint id = gl_GlobalInvocationID.x;
+#if DIST_SUBGROUP_COMPACTION
+  // the invocations must stay alive up to the ballot, so we do not early return
+  // for out of range splats, they are simply flagged as not visible
+  bool visible = id < frameInfo.splatCount;
+  float depth  = 0.0f;
+  if(visible)
+  {
+#else
   // each workgroup (but the last one if splat count is not a multiple)
   // processes DISTANCE_COMPUTE_WORKGROUP_SIZE points
   if(id >= frameInfo.splatCount)
     return;
+#endif
 
 #if GSMODE != GSMODE_3DGS
   const float deltaT = fetchDeltaT(id, frameInfo.timestamp);
 #endif
 
-  vec4 pos = frameInfo.sceneScale * vec4(fetchCenter(id
+  vec3 center = fetchCenter(id
 #if GSMODE != GSMODE_3DGS
       , deltaT
 #endif
-  ), 1.0);
-  pos.w             = 1.0f;
-  pos               = frameInfo.projectionMatrix * frameInfo.viewMatrix * pos;
-  pos               = pos / pos.w;
+  );
+#if SCENE_INSTANCING
+  const SplatInstance splatInstance = instances[instanceIndices[id]];
+  center                            = (splatInstance.transform * vec4(center, 1.0)).xyz;
+#endif
+  vec4 pos = frameInfo.sceneScale * vec4(center, 1.0);
+  pos.w = 1.0f;
+  pos   = frameInfo.projectionMatrix * frameInfo.viewMatrix * pos;
+  pos   = pos / pos.w;
+#if DIST_SUBGROUP_COMPACTION
+  depth = pos.z;
+#else
   const float depth = pos.z;
+#endif
 
   // valid only when center is inside NDC clip space.
   // Note: when culling between x=[-1,1] y=[-1,1], which is NDC extent,
@@ -80,19 +102,64 @@ void main()
   // the center of each splat instead of its extent.
 #if FRUSTUM_CULLING_MODE == FRUSTUM_CULLING_AT_DIST
   const float clip = 1.0f + frameInfo.frustumDilation;
+#if DIST_SUBGROUP_COMPACTION
+  visible = !(abs(pos.x) > clip || abs(pos.y) > clip || pos.z < 0.f - frameInfo.frustumDilation || pos.z > 1.0);
+#else
   if(abs(pos.x) > clip || abs(pos.y) > clip || pos.z < 0.f - frameInfo.frustumDilation || pos.z > 1.0)
     return;
 #endif
+#endif
 
+#if SCENE_INSTANCING
+  // the splats of the hidden instances are not sorted nor drawn
+#if DIST_SUBGROUP_COMPACTION
+  visible = visible && splatInstance.visible != 0;
+#else
+  if(splatInstance.visible == 0)
+    return;
+#endif
+#endif
+
+#if DIST_SUBGROUP_COMPACTION
+  }
+
+  // compact the visible splats of the subgroup, a single atomic per subgroup
+  // reserves the output range instead of one atomic per visible splat
+  const uvec4 ballot       = subgroupBallot(visible);
+  const uint  visibleCount = subgroupBallotBitCount(ballot);
+  if(visibleCount == 0)
+    return;
+
+  uint baseIndex = 0;
+  if(subgroupElect())
+  {
+    baseIndex = atomicAdd(indirect.instanceCount, visibleCount);
+    // set the workgroup count for the mesh shading pipeline, i.e. the number of
+    // multiples of RASTER_MESH_WORKGROUP_SIZE crossed by [baseIndex, baseIndex + visibleCount)
+    const uint groupCount = (baseIndex + visibleCount + RASTER_MESH_WORKGROUP_SIZE - 1) / RASTER_MESH_WORKGROUP_SIZE
+                            - (baseIndex + RASTER_MESH_WORKGROUP_SIZE - 1) / RASTER_MESH_WORKGROUP_SIZE;
+    if(groupCount > 0)
+      atomicAdd(indirect.groupCountX, groupCount);
+  }
+  baseIndex = subgroupBroadcastFirst(baseIndex);
+
+  if(!visible)
+    return;
+
+  const uint instance_index = baseIndex + subgroupBallotExclusiveBitCount(ballot);
+#else
   // increments the visible splat counter in the indirect buffer 
   const uint instance_index = atomicAdd(indirect.instanceCount, 1);
+#endif
   // stores the distance
   distances[instance_index] = encodeMinMaxFp32(-depth);
   // stores the base index
   indices[instance_index] = id;
+#if !DIST_SUBGROUP_COMPACTION
   // set the workgroup count for the mesh shading pipeline
   if(instance_index % RASTER_MESH_WORKGROUP_SIZE == 0)
   {
     atomicAdd(indirect.groupCountX, 1);
   }
+#endif
 }
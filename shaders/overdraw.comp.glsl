@@ -0,0 +1,76 @@
+#version 460
+
+#extension GL_GOOGLE_include_directive : enable
+#include "shaderio.h"
+
+// Overdraw render mode, the number of fragments of each pixel counted by the
+// fragment shader is summarized into OverdrawStats and displayed as a heatmap.
+
+layout(local_size_x = OVERDRAW_COMPUTE_WORKGROUP_SIZE, local_size_y = OVERDRAW_COMPUTE_WORKGROUP_SIZE) in;
+
+layout(set = 0, binding = BINDING_OVERDRAW_IMAGE, r32ui) uniform readonly uimage2D overdrawImage;
+layout(set = 0, binding = BINDING_OVERDRAW_OUTPUT_IMAGE, rgba8) uniform writeonly image2D outputImage;
+layout(set = 0, binding = BINDING_OVERDRAW_STATS_BUFFER, scalar) buffer _overdrawStats
+{
+  OverdrawStats stats;
+};
+
+// the workgroup accumulates locally so that only a few global atomics are issued per workgroup
+shared uint sHistogram[OVERDRAW_HISTOGRAM_BINS];
+shared uint sMaxCount;
+shared uint sCoveredPixels;
+shared uint sFragments;
+
+uint histogramBin(uint count)
+{
+  return count == 0 ? 0 : min(uint(findMSB(count)) + 1, OVERDRAW_HISTOGRAM_BINS - 1);
+}
+
+// dark blue for one fragment up to dark red for the last histogram bin
+vec3 heatmap(float t)
+{
+  return clamp(vec3(1.5) - abs(4.0 * t - vec3(3.0, 2.0, 1.0)), 0.0, 1.0);
+}
+
+void main()
+{
+  const uint localId = gl_LocalInvocationIndex;
+  if(localId < OVERDRAW_HISTOGRAM_BINS)
+    sHistogram[localId] = 0;
+  if(localId == 0)
+  {
+    sMaxCount      = 0;
+    sCoveredPixels = 0;
+    sFragments     = 0;
+  }
+  barrier();
+
+  const ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+  if(all(lessThan(coord, imageSize(overdrawImage))))
+  {
+    const uint count = imageLoad(overdrawImage, coord).r;
+    atomicAdd(sHistogram[histogramBin(count)], 1);
+    vec3 color = vec3(0.0);
+    if(count > 0)
+    {
+      atomicMax(sMaxCount, count);
+      atomicAdd(sCoveredPixels, 1);
+      atomicAdd(sFragments, count);
+      color = heatmap(clamp(log2(float(count)) / float(OVERDRAW_HISTOGRAM_BINS - 2), 0.0, 1.0));
+    }
+    imageStore(outputImage, coord, vec4(color, 1.0));
+  }
+  barrier();
+
+  if(localId < OVERDRAW_HISTOGRAM_BINS && sHistogram[localId] > 0)
+    atomicAdd(stats.histogram[localId], sHistogram[localId]);
+  if(localId == 0)
+  {
+    atomicMax(stats.maxCount, sMaxCount);
+    atomicAdd(stats.coveredPixels, sCoveredPixels);
+    // 64-bit total without requiring 64-bit atomics
+    const uint previous = atomicAdd(stats.fragmentsLow, sFragments);
+    if(previous + sFragments < previous)
+      atomicAdd(stats.fragmentsHigh, 1);
+  }
+}
@@ -67,6 +67,20 @@ layout(set = 0, binding = BINDING_FRAME_INFO_UBO, scalar) uniform FrameInfo_
   FrameInfo frameInfo;
 };
 
+#if OVERDRAW_MODE
+// fragments per pixel, summarized by overdraw.comp.glsl
+layout(set = 0, binding = BINDING_OVERDRAW_IMAGE, r32ui) uniform uimage2D overdrawImage;
+#endif
+
+#if XR_DEPTH_MODE
+// per pixel depth of the nearest fragment crossing XR_DEPTH_OPACITY, as float bits,
+// the depths are positive so the integer order is the float order
+layout(set = 0, binding = BINDING_XR_DEPTH_BUFFER, scalar) buffer XrDepth_
+{
+  uint32_t xrDepth[];
+};
+#endif
+
 vec3 sRGBToLinear(vec3 srgb)
 {
   return mix(srgb / 12.92,                            // Բ
@@ -93,6 +107,10 @@ void main()
   if(A > 8.0)
     discard;
 
+#if OVERDRAW_MODE
+  imageAtomicAdd(overdrawImage, ivec2(gl_FragCoord.xy), 1u);
+#endif
+
 #ifdef DISABLE_OPACITY_GAUSSIAN
   const float opacity = 1.0;
 #else
@@ -102,6 +120,14 @@ void main()
   const float opacity = exp(-0.5 * A) * inSplatCol.a;
 #endif
 
+#if XR_DEPTH_MODE
+  if(opacity >= XR_DEPTH_OPACITY)
+  {
+    const uint width = uint(round(1.0 / frameInfo.basisViewport.x));
+    atomicMin(xrDepth[uint(gl_FragCoord.y) * width + uint(gl_FragCoord.x)], floatBitsToUint(gl_FragCoord.z));
+  }
+#endif
+
 #if GAMMA_CORRECTION
   outColor = vec4(sRGBToLinear(inSplatCol.rgb), opacity);
 #else
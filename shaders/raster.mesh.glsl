@@ -85,7 +85,6 @@ layout(set = 0, binding = BINDING_INDIRECT_BUFFER, scalar) buffer _indirect
 
 void main()
 {
-#if GSMODE == GSMODE_3DGS
   const uint32_t baseIndex  = gl_GlobalInvocationID.x;
 #if FRUSTUM_CULLING_MODE == FRUSTUM_CULLING_AT_DIST
   // if culling is already performed we use the subset of splats
@@ -110,8 +109,38 @@ void main()
     gl_PrimitiveTriangleIndicesEXT[gl_LocalInvocationIndex * 2 + 0] = uvec3(0, 2, 1) + gl_LocalInvocationIndex * 4;
     gl_PrimitiveTriangleIndicesEXT[gl_LocalInvocationIndex * 2 + 1] = uvec3(2, 0, 3) + gl_LocalInvocationIndex * 4;
 
+#if GSMODE != GSMODE_3DGS
+    // each invocation evaluates its own splat at the current timestamp
+    const float deltaT = fetchDeltaT(splatIndex, frameInfo.timestamp);
+#endif
+
+#if SCENE_INSTANCING
+    // instance of the splat in the composed scene, the splats of the hidden instances are culled
+    // (already culled by the distance shader when sorting on the GPU)
+    const SplatInstance splatInstance = instances[instanceIndices[splatIndex]];
+    if(splatInstance.visible == 0)
+    {
+      // Early return to discard splat
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 0].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 1].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 2].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 3].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      return;
+    }
+#endif
+
     // work on splat position
-    const vec3 splatCenter = fetchCenter(splatIndex);
+    const vec3 localCenter = fetchCenter(
+        splatIndex
+#if GSMODE != GSMODE_3DGS
+        , deltaT
+#endif
+    );
+#if SCENE_INSTANCING
+    const vec3 splatCenter = frameInfo.sceneScale * (splatInstance.transform * vec4(localCenter, 1.0)).xyz;
+#else
+    const vec3 splatCenter = frameInfo.sceneScale * localCenter;
+#endif
 
     const mat4 transformModelViewMatrix = frameInfo.viewMatrix;
     const vec4 viewCenter               = transformModelViewMatrix * vec4(splatCenter, 1.0);
@@ -132,6 +161,12 @@ void main()
     }
 #endif
 
+    // fixed foveated LOD, 0 in the fovea up to 1 beyond the outer radius
+    const float periphery = frameInfo.foveaOuterRadius > 0.0 ?
+                                smoothstep(frameInfo.foveaInnerRadius, frameInfo.foveaOuterRadius,
+                                           length(clipCenter.xy / clipCenter.w - frameInfo.foveaCenter)) :
+                                0.0;
+
     // the vertices of the quad
     const vec2 positions[4] = {{-1.0, -1.0}, {1.0, -1.0}, {1.0, 1.0}, {-1.0, 1.0}};
 
@@ -145,7 +180,12 @@ void main()
 #endif
 
     // work on color
-    vec4 splatColor = fetchColor(splatIndex);
+    vec4 splatColor = fetchColor(
+        splatIndex
+#if GSMODE != GSMODE_3DGS
+        , deltaT
+#endif
+    );
 
 #if SHOW_SH_ONLY == 1
     splatColor.r = 0.5;
@@ -153,59 +193,77 @@ void main()
     splatColor.b = 0.5;
 #endif
 
+#if GSMODE == GSMODE_3DGS
 #if MAX_SH_DEGREE >= 1
-    // SH coefficients for degree 1 (1,2,3)
-    vec3 shd1[3];
+    // the periphery and the frame governor lower the SH degree, degree 0 skips the fetch of the SH coefficients
+    const int shDegree = min(periphery >= 1.0 ? frameInfo.foveaShDegree : MAX_SH_DEGREE, frameInfo.shDegreeCap);
+    if(shDegree >= 1)
+    {
+      // SH coefficients for degree 1 (1,2,3)
+      vec3 shd1[3];
 #if MAX_SH_DEGREE >= 2
-    // SH coefficients for degree 2 (4 5 6 7 8)
-    vec3 shd2[5];
+      // SH coefficients for degree 2 (4 5 6 7 8)
+      vec3 shd2[5];
 #endif
 #if MAX_SH_DEGREE >= 3
-    // SH coefficients for degree 3 (9,10,11,12,13,14,15)
-    vec3 shd3[7];
+      // SH coefficients for degree 3 (9,10,11,12,13,14,15)
+      vec3 shd3[7];
 #endif
-    // fetch the data (only what is needed according to degree)
-    fetchSh(splatIndex, shd1
+      // fetch the data (only what is needed according to degree)
+      fetchSh(splatIndex, shDegree, shd1
 #if MAX_SH_DEGREE >= 2
-            ,
-            shd2
+              ,
+              shd2
 #endif
 #if MAX_SH_DEGREE >= 3
-            ,
-            shd3
+              ,
+              shd3
 #endif
-    );
+      );
 
-    const vec3  worldViewDir = normalize(splatCenter - frameInfo.cameraPosition);
-    const float x            = worldViewDir.x;
-    const float y            = worldViewDir.y;
-    const float z            = worldViewDir.z;
-    splatColor.rgb += SH_C1 * (-shd1[0] * y + shd1[1] * z - shd1[2] * x);
+#if SCENE_INSTANCING
+      // the SH are expressed in the frame of the splat set
+      const vec3 worldViewDir = normalize(transpose(mat3(splatInstance.transform)) * (splatCenter - frameInfo.cameraPosition));
+#else
+      const vec3  worldViewDir = normalize(splatCenter - frameInfo.cameraPosition);
+#endif
+      const float x            = worldViewDir.x;
+      const float y            = worldViewDir.y;
+      const float z            = worldViewDir.z;
+      splatColor.rgb += SH_C1 * (-shd1[0] * y + shd1[1] * z - shd1[2] * x);
 
 #if MAX_SH_DEGREE >= 2
-    const float xx = x * x;
-    const float yy = y * y;
-    const float zz = z * z;
-    const float xy = x * y;
-    const float yz = y * z;
-    const float xz = x * z;
-
-    splatColor.rgb += (SH_C2[0] * xy) * shd2[0] + (SH_C2[1] * yz) * shd2[1] + (SH_C2[2] * (2.0 * zz - xx - yy)) * shd2[2]
-                      + (SH_C2[3] * xz) * shd2[3] + (SH_C2[4] * (xx - yy)) * shd2[4];
-#endif
+      if(shDegree >= 2)
+      {
+        const float xx = x * x;
+        const float yy = y * y;
+        const float zz = z * z;
+        const float xy = x * y;
+        const float yz = y * z;
+        const float xz = x * z;
+
+        splatColor.rgb += (SH_C2[0] * xy) * shd2[0] + (SH_C2[1] * yz) * shd2[1] + (SH_C2[2] * (2.0 * zz - xx - yy)) * shd2[2]
+                          + (SH_C2[3] * xz) * shd2[3] + (SH_C2[4] * (xx - yy)) * shd2[4];
 #if MAX_SH_DEGREE >= 3
-    // Degree 3 SH basis function terms
-    const float xyy = x * yy;
-    const float yzz = y * zz;
-    const float zxx = z * xx;
-    const float xyz = x * y * z;
-
-    // Degree 3 contributions
-    splatColor.rgb += SH_C3[0] * shd3[0] * (3.0 * x * x - y * y) * y + SH_C3[1] * shd3[1] * x * y * z
-                      + SH_C3[2] * shd3[2] * (4.0 * z * z - x * x - y * y) * y
-                      + SH_C3[3] * shd3[3] * z * (2.0 * z * z - 3.0 * x * x - 3.0 * y * y)
-                      + SH_C3[4] * shd3[4] * x * (4.0 * z * z - x * x - y * y)
-                      + SH_C3[5] * shd3[5] * (x * x - y * y) * z + SH_C3[6] * shd3[6] * x * (x * x - 3.0 * y * y);
+        if(shDegree >= 3)
+        {
+          // Degree 3 SH basis function terms
+          const float xyy = x * yy;
+          const float yzz = y * zz;
+          const float zxx = z * xx;
+          const float xyz = x * y * z;
+
+          // Degree 3 contributions
+          splatColor.rgb += SH_C3[0] * shd3[0] * (3.0 * x * x - y * y) * y + SH_C3[1] * shd3[1] * x * y * z
+                            + SH_C3[2] * shd3[2] * (4.0 * z * z - x * x - y * y) * y
+                            + SH_C3[3] * shd3[3] * z * (2.0 * z * z - 3.0 * x * x - 3.0 * y * y)
+                            + SH_C3[4] * shd3[4] * x * (4.0 * z * z - x * x - y * y)
+                            + SH_C3[5] * shd3[5] * (x * x - y * y) * z + SH_C3[6] * shd3[6] * x * (x * x - 3.0 * y * y);
+        }
+#endif
+      }
+#endif
+    }
 #endif
 #endif
 
@@ -225,7 +283,28 @@ void main()
     outSplatCol[gl_LocalInvocationIndex * 2 + 1] = splatColor;
 
     // Fetch and construct the 3D covariance matrix
-    const mat3 Vrk = fetchCovariance(splatIndex);
+    mat3 Vrk = fetchCovariance(
+        splatIndex
+#if GSMODE != GSMODE_3DGS
+        , deltaT
+#endif
+    );
+
+    // splat budget of the frame governor, culls the least important splats (see computeImportanceThresholds)
+    if(splatColor.a * (Vrk[0][0] + Vrk[1][1] + Vrk[2][2]) < frameInfo.minSplatImportance)
+    {
+      // Early return to discard splat
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 0].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 1].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 2].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 3].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+      return;
+    }
+
+#if SCENE_INSTANCING
+    // to the scene space, the covariance of the splat set is rotated and scaled
+    Vrk = mat3(splatInstance.transform) * Vrk * transpose(mat3(splatInstance.transform));
+#endif
 
 #if ORTHOGRAPHIC_MODE == 1
     // Since the projection is linear, we don't need an approximation
@@ -235,8 +314,9 @@ void main()
     // 3D covariance matrix instead of using the actual projection matrix because that transformation would
     // require a non-linear component (perspective division) which would yield a non-gaussian result.
     const float s = 1.0 / (viewCenter.z * viewCenter.z);
-    const mat3  J = mat3(frameInfo.focal.x / viewCenter.z, 0., -(frameInfo.focal.x * viewCenter.x) * s, 0.,
-                         frameInfo.focal.y / viewCenter.z, -(frameInfo.focal.y * viewCenter.y) * s, 0., 0., 0.);
+    const mat3  J = frameInfo.sceneScale
+                   * mat3(frameInfo.focal.x / viewCenter.z, 0., -(frameInfo.focal.x * viewCenter.x) * s, 0.,
+                          frameInfo.focal.y / viewCenter.z, -(frameInfo.focal.y * viewCenter.y) * s, 0., 0., 0.);
 #endif
 
     // Concatenate the projection approximation with the model-view transformation
@@ -280,7 +360,11 @@ void main()
     float       eigenValue2 = traceOver2 - term2;
 
     // from original code
-    if(eigenValue2 <= 0.0)
+    // also culls the splats whose opacity x area at one standard deviation is under a few pixels (frame governor),
+    // the periphery culls more of them and the small ones (foveated LOD)
+    if(eigenValue2 <= 0.0
+       || splatColor.a * 3.14159265 * sqrt(max(D, 0.0)) < frameInfo.minSplatContribution + periphery * frameInfo.foveaMinContribution
+       || eigenValue1 < periphery * frameInfo.foveaMinRadius * frameInfo.foveaMinRadius)
     {
       // Early return to discard splat
       gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + 0].gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
@@ -317,5 +401,4 @@ void main()
       gl_MeshVerticesEXT[gl_LocalInvocationIndex * 4 + i].gl_Position = quadPos;
     }
   }
-#endif
 }
@@ -73,13 +73,30 @@ void main()
   const float deltaT = fetchDeltaT(splatIndex, frameInfo.timestamp);
 #endif
 
+#if SCENE_INSTANCING
+  // instance of the splat in the composed scene, the splats of the hidden instances are culled
+  // (already culled by the distance shader when sorting on the GPU)
+  const SplatInstance splatInstance = instances[instanceIndices[splatIndex]];
+  if(splatInstance.visible == 0)
+  {
+    // emit same vertex to get degenerate triangle
+    gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+    return;
+  }
+#endif
+
   // Work on splat position
-  const vec3 splatCenter = frameInfo.sceneScale * fetchCenter(
+  const vec3 localCenter = fetchCenter(
       splatIndex
 #if GSMODE != GSMODE_3DGS
       , deltaT
 #endif
   );
+#if SCENE_INSTANCING
+  const vec3 splatCenter = frameInfo.sceneScale * (splatInstance.transform * vec4(localCenter, 1.0)).xyz;
+#else
+  const vec3 splatCenter = frameInfo.sceneScale * localCenter;
+#endif
 
   const mat4 transformModelViewMatrix = frameInfo.viewMatrix;
   const vec4 viewCenter               = transformModelViewMatrix * vec4(splatCenter, 1.0);
@@ -98,6 +115,12 @@ void main()
   }
 #endif
 
+  // fixed foveated LOD, 0 in the fovea up to 1 beyond the outer radius
+  const float periphery = frameInfo.foveaOuterRadius > 0.0 ?
+                              smoothstep(frameInfo.foveaInnerRadius, frameInfo.foveaOuterRadius,
+                                         length(clipCenter.xy / clipCenter.w - frameInfo.foveaCenter)) :
+                              0.0;
+
   const vec2 fragPos = inPosition.xy;
 #if !USE_BARYCENTRIC
   // emit as early as possible
@@ -120,33 +143,46 @@ void main()
 
 #if GSMODE == GSMODE_3DGS
 #if MAX_SH_DEGREE >= 1
-  // SH coefficients for degree 1 (1,2,3)
-  vec3 shd1[3];
+  // the periphery and the frame governor lower the SH degree, degree 0 skips the fetch of the SH coefficients
+  const int shDegree = min(periphery >= 1.0 ? frameInfo.foveaShDegree : MAX_SH_DEGREE, frameInfo.shDegreeCap);
+  if(shDegree >= 1)
+  {
+    // SH coefficients for degree 1 (1,2,3)
+    vec3 shd1[3];
 #if MAX_SH_DEGREE >= 2
-  // SH coefficients for degree 2 (4 5 6 7 8)
-  vec3 shd2[5];
+    // SH coefficients for degree 2 (4 5 6 7 8)
+    vec3 shd2[5];
 #endif
 #if MAX_SH_DEGREE >= 3
-  // SH coefficients for degree 3 (9,10,11,12,13,14,15)
-  vec3 shd3[7];
+    // SH coefficients for degree 3 (9,10,11,12,13,14,15)
+    vec3 shd3[7];
 #endif
-  // fetch the data (only what is needed according to degree)
-  fetchSh(splatIndex, shd1
+    // fetch the data (only what is needed according to degree)
+    fetchSh(splatIndex, shDegree, shd1
 #if MAX_SH_DEGREE >= 2
-    , shd2
+            ,
+            shd2
 #endif
 #if MAX_SH_DEGREE >= 3
-    , shd3
+            ,
+            shd3
 #endif
-  );
+    );
 
+#if SCENE_INSTANCING
+    // the SH are expressed in the frame of the splat set
+    const vec3 worldViewDir = normalize(transpose(mat3(splatInstance.transform)) * (splatCenter - frameInfo.cameraPosition));
+#else
     const vec3  worldViewDir = normalize(splatCenter - frameInfo.cameraPosition);
+#endif
     const float x            = worldViewDir.x;
     const float y            = worldViewDir.y;
     const float z            = worldViewDir.z;
     splatColor.rgb += SH_C1 * (-shd1[0] * y + shd1[1] * z - shd1[2] * x);
 
 #if MAX_SH_DEGREE >= 2
+    if(shDegree >= 2)
+    {
       const float xx = x * x;
       const float yy = y * y;
       const float zz = z * z;
@@ -156,21 +192,26 @@ void main()
 
       splatColor.rgb += (SH_C2[0] * xy) * shd2[0] + (SH_C2[1] * yz) * shd2[1] + (SH_C2[2] * (2.0 * zz - xx - yy)) * shd2[2]
                         + (SH_C2[3] * xz) * shd2[3] + (SH_C2[4] * (xx - yy)) * shd2[4];
-#endif
 #if MAX_SH_DEGREE >= 3
-      // Degree 3 SH basis function terms
-      const float xyy = x * yy;
-      const float yzz = y * zz;
-      const float zxx = z * xx;
-      const float xyz = x * y * z;
-
-      // Degree 3 contributions
-      splatColor.rgb += SH_C3[0] * shd3[0] * (3.0 * x * x - y * y) * y + SH_C3[1] * shd3[1] * x * y * z
-                        + SH_C3[2] * shd3[2] * (4.0 * z * z - x * x - y * y) * y
-                        + SH_C3[3] * shd3[3] * z * (2.0 * z * z - 3.0 * x * x - 3.0 * y * y)
-                        + SH_C3[4] * shd3[4] * x * (4.0 * z * z - x * x - y * y)
-                        + SH_C3[5] * shd3[5] * (x * x - y * y) * z + SH_C3[6] * shd3[6] * x * (x * x - 3.0 * y * y);
+      if(shDegree >= 3)
+      {
+        // Degree 3 SH basis function terms
+        const float xyy = x * yy;
+        const float yzz = y * zz;
+        const float zxx = z * xx;
+        const float xyz = x * y * z;
+
+        // Degree 3 contributions
+        splatColor.rgb += SH_C3[0] * shd3[0] * (3.0 * x * x - y * y) * y + SH_C3[1] * shd3[1] * x * y * z
+                          + SH_C3[2] * shd3[2] * (4.0 * z * z - x * x - y * y) * y
+                          + SH_C3[3] * shd3[3] * z * (2.0 * z * z - 3.0 * x * x - 3.0 * y * y)
+                          + SH_C3[4] * shd3[4] * x * (4.0 * z * z - x * x - y * y)
+                          + SH_C3[5] * shd3[5] * (x * x - y * y) * z + SH_C3[6] * shd3[6] * x * (x * x - 3.0 * y * y);
+      }
+#endif
+    }
 #endif
+  }
 #endif
 #endif
 
@@ -186,13 +227,26 @@ void main()
   outFragCol = splatColor;
 
   // Fetch and construct the 3D covariance matrix
-  const mat3 Vrk = fetchCovariance(
+  mat3 Vrk = fetchCovariance(
       splatIndex
 #if GSMODE != GSMODE_3DGS
       , deltaT
 #endif
   );
 
+  // splat budget of the frame governor, culls the least important splats (see computeImportanceThresholds)
+  if(splatColor.a * (Vrk[0][0] + Vrk[1][1] + Vrk[2][2]) < frameInfo.minSplatImportance)
+  {
+    // emit same vertex to get degenerate triangle
+    gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+    return;
+  }
+
+#if SCENE_INSTANCING
+  // to the scene space, the covariance of the splat set is rotated and scaled
+  Vrk = mat3(splatInstance.transform) * Vrk * transpose(mat3(splatInstance.transform));
+#endif
+
 #if ORTHOGRAPHIC_MODE == 1
   // Since the projection is linear, we don't need an approximation
   const mat3 J = transpose(mat3(frameInfo.orthoZoom, 0.0, 0.0, 0.0, frameInfo.orthoZoom, 0.0, 0.0, 0.0, 0.0));
@@ -246,7 +300,11 @@ void main()
   float       eigenValue1 = traceOver2 + term2;
   float       eigenValue2 = traceOver2 - term2;
 
-  if(eigenValue2 <= 0.0)
+  // also culls the splats whose opacity x area at one standard deviation is under a few pixels (frame governor),
+  // the periphery culls more of them and the small ones (foveated LOD)
+  if(eigenValue2 <= 0.0
+     || splatColor.a * 3.14159265 * sqrt(max(D, 0.0)) < frameInfo.minSplatContribution + periphery * frameInfo.foveaMinContribution
+     || eigenValue1 < periphery * frameInfo.foveaMinRadius * frameInfo.foveaMinRadius)
   {
     // emit same vertex to get degenerate triangle
     gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
@@ -57,6 +57,18 @@
 #define BINDING_COLORS_BUFFER 9
 #define BINDING_COVARIANCES_BUFFER 10
 #define BINDING_SH_BUFFER 11
+// overdraw render mode only
+#define BINDING_OVERDRAW_IMAGE 12
+#define BINDING_OVERDRAW_STATS_BUFFER 13
+#define BINDING_OVERDRAW_OUTPUT_IMAGE 14
+// XR depth layer only
+#define BINDING_XR_DEPTH_BUFFER 15
+// reduced resolution rendering only
+#define BINDING_UPSCALE_INPUT_IMAGE 16
+#define BINDING_UPSCALE_OUTPUT_IMAGE 17
+// composed scenes, instance of each splat and instance table
+#define BINDING_INSTANCE_INDICES_BUFFER 18
+#define BINDING_INSTANCES_BUFFER 19
 
 // location for vertex attributes
 // (only for vertex shader mode)
@@ -70,9 +82,30 @@
 // This configuration is optimized for NVIDIA hardware
 #define RASTER_MESH_WORKGROUP_SIZE 32
 
+// Overdraw shader workgroup size (in x and y)
+#define OVERDRAW_COMPUTE_WORKGROUP_SIZE 16
+// bin 0 counts the pixels without fragments, bin i>0 the pixels
+// with [2^(i-1), 2^i) fragments, the last bin is open ended
+#define OVERDRAW_HISTOGRAM_BINS 16
+
+// Upscale shader workgroup size (in x and y)
+#define UPSCALE_COMPUTE_WORKGROUP_SIZE 16
+
+// size of the instance table of the composed scenes
+#define MAX_SCENE_INSTANCES 64
+
+// XR depth layer, a pixel takes the depth of the nearest fragment
+// reaching this opacity, far plane if none
+#define XR_DEPTH_OPACITY 0.5
+
 #define GSMODE_3DGS 0
 #define GSMODE_SPACETIME_LITE 1
 
+// number of RGBA texels used per splat to store the spacetime
+// features (motion, scale, rotation, omega, trbf) in texture storage mode
+#define SPACETIME_FEATURES_PER_SPLAT 22
+#define SPACETIME_TEXELS_PER_SPLAT 6
+
 #ifdef __cplusplus
 #include <glm/glm.hpp>
 // used to assign fields defaults
@@ -112,6 +145,25 @@ struct FrameInfo
   float frustumDilation    DEFAULT(0.2f);           // for frustum culling, 2% scale
   float alphaCullThreshold DEFAULT(1.0f / 255.0f);  // for alpha culling
   float timestamp          DEFAULT(0.0f);
+
+  // frame governor culls, 0 disables them
+  float minSplatContribution DEFAULT(0.0f);  // opacity x area at one standard deviation, in pixels
+  float minSplatImportance   DEFAULT(0.0f);  // opacity x trace of the 3D covariance
+  int shDegreeCap            DEFAULT(3);     // caps MAX_SH_DEGREE without a shader rebuild
+
+  // reduced resolution rendering, the splats are rasterized in the top left renderExtent
+  // pixels of the upscale input then upscaled to the outputExtent pixels of the view
+  ivec2 renderExtent DEFAULT(ivec2(0));
+  ivec2 outputExtent DEFAULT(ivec2(0));
+
+  // fixed foveated LOD, the splats get cheaper from foveaInnerRadius to foveaOuterRadius
+  // away from foveaCenter, in NDC. A zero outer radius disables it
+  vec2 foveaCenter           DEFAULT(vec2(0.0f));  // projection of the view direction
+  float foveaInnerRadius     DEFAULT(0.0f);
+  float foveaOuterRadius     DEFAULT(0.0f);
+  float foveaMinContribution DEFAULT(0.0f);  // added to minSplatContribution at the outer radius, in pixels
+  float foveaMinRadius       DEFAULT(0.0f);  // minimum radius at one standard deviation at the outer radius, in pixels
+  int foveaShDegree          DEFAULT(3);     // SH degree beyond the outer radius
 };
 
 // TODO will be used for model transformation
@@ -120,6 +172,17 @@ struct PushConstant
   mat4 transfo;
 };
 
+// instance of a splat set in a composed scene, all the instances are drawn and sorted
+// at once so the transforms are in a table indexed per splat rather than push constants
+struct SplatInstance
+{
+  mat4 transform;              // splat set to scene, rigid with a uniform scale
+  uint32_t visible DEFAULT(1);  // the splats of the hidden instances are culled
+  uint32_t pad0    DEFAULT(0);
+  uint32_t pad1    DEFAULT(0);
+  uint32_t pad2    DEFAULT(0);
+};
+
 // indirect parameters for
 // - vkCmdDrawIndexedIndirect (first 6 attr)
 // - vkCmdDrawMeshTasksIndirectEXT (last 3 attr)
@@ -138,6 +201,16 @@ struct IndirectParams
   uint32_t groupCountZ DEFAULT(1);  // Allways one workgroup on Z
 };
 
+// overdraw summary, accumulated by the overdraw compute shader
+struct OverdrawStats
+{
+  uint32_t histogram[OVERDRAW_HISTOGRAM_BINS] DEFAULT({});
+  uint32_t maxCount      DEFAULT(0);  // max number of fragments of a pixel
+  uint32_t coveredPixels DEFAULT(0);  // pixels with at least one fragment
+  uint32_t fragmentsLow  DEFAULT(0);  // total number of fragments, low 32 bits
+  uint32_t fragmentsHigh DEFAULT(0);  // total number of fragments, high 32 bits
+};
+
 #ifdef __cplusplus
 }  // namespace shaderio
 #endif
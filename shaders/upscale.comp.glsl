@@ -0,0 +1,61 @@
+#version 460
+
+#extension GL_GOOGLE_include_directive : enable
+#include "shaderio.h"
+
+// Reduced resolution rendering, the splats rasterized in the top left frameInfo.renderExtent
+// texels of the input image are upscaled to the frameInfo.outputExtent pixels of the output.
+// The filter is a Catmull-Rom bicubic, sharper than the bilinear, clamped to the range of the
+// 2x2 nearest texels so that it does not ring along the edges of the splats.
+
+layout(local_size_x = UPSCALE_COMPUTE_WORKGROUP_SIZE, local_size_y = UPSCALE_COMPUTE_WORKGROUP_SIZE) in;
+
+layout(set = 0, binding = BINDING_FRAME_INFO_UBO, scalar) uniform _frameInfo
+{
+  FrameInfo frameInfo;
+};
+layout(set = 0, binding = BINDING_UPSCALE_INPUT_IMAGE) uniform sampler2D inputImage;
+layout(set = 0, binding = BINDING_UPSCALE_OUTPUT_IMAGE, rgba8) uniform writeonly image2D outputImage;
+
+// the texels outside of the rendered area are not written this frame
+vec4 fetch(ivec2 coord)
+{
+  return texelFetch(inputImage, clamp(coord, ivec2(0), frameInfo.renderExtent - 1), 0);
+}
+
+void main()
+{
+  const ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+  if(any(greaterThanEqual(coord, frameInfo.outputExtent)))
+    return;
+
+  // center of the pixel in the input, relative to the texel centers
+  const vec2  pos  = (vec2(coord) + 0.5) * vec2(frameInfo.renderExtent) / vec2(frameInfo.outputExtent) - 0.5;
+  const ivec2 base = ivec2(floor(pos));
+  const vec2  f    = pos - vec2(base);
+
+  // Catmull-Rom weights of the texels at -1, 0, 1 and 2 from base, per axis
+  vec2 w[4];
+  w[0] = f * (-0.5 + f * (1.0 - 0.5 * f));
+  w[1] = 1.0 + f * f * (-2.5 + 1.5 * f);
+  w[2] = f * (0.5 + f * (2.0 - 1.5 * f));
+  w[3] = f * f * (-0.5 + 0.5 * f);
+
+  vec4 color = vec4(0.0);
+  for(int j = 0; j < 4; ++j)
+  {
+    for(int i = 0; i < 4; ++i)
+    {
+      color += fetch(base + ivec2(i - 1, j - 1)) * (w[i].x * w[j].y);
+    }
+  }
+
+  // deringing, the negative lobes must not overshoot the nearest texels
+  const vec4 c00 = fetch(base);
+  const vec4 c10 = fetch(base + ivec2(1, 0));
+  const vec4 c01 = fetch(base + ivec2(0, 1));
+  const vec4 c11 = fetch(base + ivec2(1, 1));
+  color          = clamp(color, min(min(c00, c10), min(c01, c11)), max(max(c00, c10), max(c01, c11)));
+
+  imageStore(outputImage, coord, color);
+}
@@ -20,6 +20,17 @@
         }                                                                                          \
     }
 
+// same as VULKAN_CHECK, but fails the XR context creation
+#define VULKAN_INIT_CHECK(x, y)                                                                    \
+    {                                                                                              \
+        VkResult result = (x);                                                                     \
+        if (result != VK_SUCCESS) {                                                                \
+            std::cout << "ERROR: VULKAN: " << std::hex << "0x" << result << std::dec << std::endl; \
+            std::cout << "ERROR: VULKAN: " << y << std::endl;                                      \
+            return XR_ERROR_GRAPHICS_DEVICE_INVALID;                                               \
+        }                                                                                          \
+    }
+
 #if defined(__ANDROID__) && !defined(VK_API_MAKE_VERSION)
 #define VK_MAKE_API_VERSION(variant, major, minor, patch) VK_MAKE_VERSION(major, minor, patch)
 #endif
@@ -40,6 +51,21 @@ static bool MemoryTypeFromProperties(VkPhysicalDeviceMemoryProperties memoryProp
     return false;
 };
 
+// appends the extension to the enabled ones if it is in the available ones, returns whether it is enabled
+static bool AddSupportedExtension(std::vector<const char *> &activeExtensions, const std::vector<VkExtensionProperties> &availableExtensions, const char *extension) {
+    for (const char *activeExtension : activeExtensions) {
+        if (!strcmp(activeExtension, extension))
+            return true;
+    }
+    for (const VkExtensionProperties &extensionProperty : availableExtensions) {
+        if (!strcmp(extension, extensionProperty.extensionName)) {
+            activeExtensions.push_back(extension);
+            return true;
+        }
+    }
+    return false;
+}
+
 static VkFormat ToVkFormat(GraphicsAPI::VertexType type) {
     switch (type) {
     case GraphicsAPI::VertexType::FLOAT:
@@ -90,19 +116,23 @@ VkDescriptorType ToVkDescrtiptorType(const GraphicsAPI::DescriptorInfo &descInfo
     return vkType;
 }
 
-void GraphicsAPI_Vulkan::init() {
+void GraphicsAPI_Vulkan::init(bool headless) {
     // Vulkan creation context information (see nvvk::Context)
     static VkPhysicalDeviceFragmentShaderBarycentricFeaturesKHR baryFeaturesKHR = {
         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADER_BARYCENTRIC_FEATURES_KHR};
     static VkPhysicalDeviceMeshShaderFeaturesEXT meshFeaturesEXT = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT};
     nvvk::ContextCreateInfo vkSetup;
     vkSetup.setVersion(1, 3);
-    vkSetup.addDeviceExtension(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    // headless rendering has no window, so it can run on devices without presentation support
+    if(!headless)
+        vkSetup.addDeviceExtension(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
     vkSetup.addDeviceExtension(VK_EXT_MESH_SHADER_EXTENSION_NAME, false, &meshFeaturesEXT);
     vkSetup.addDeviceExtension(VK_KHR_FRAGMENT_SHADER_BARYCENTRIC_EXTENSION_NAME, false, &baryFeaturesKHR);
     vkSetup.addDeviceExtension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);  // for ImGui
+    vkSetup.addDeviceExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, true);  // for memory telemetry
     vkSetup.addInstanceExtension(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
-    nvvkhl::addSurfaceExtensions(vkSetup.instanceExtensions);
+    if(!headless)
+        nvvkhl::addSurfaceExtensions(vkSetup.instanceExtensions);
 
     // from meshlettest.cpp sample
     vkSetup.fnDisableFeatures = [](VkStructureType sType, void* pFeatureStruct) {
@@ -125,6 +155,8 @@ void GraphicsAPI_Vulkan::init() {
     queueFamilyIndex = vkContext->m_queueGCT.familyIndex;
     queueIndex       = vkContext->m_queueGCT.queueIndex;
     queue            = vkContext->m_queueGCT.queue;
+
+    memoryBudgetEnabled = vkContext->hasDeviceExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
 }
 
 XrResult GraphicsAPI_Vulkan::init(XrInstance m_xrInstance, XrSystemId systemId)
@@ -135,6 +167,11 @@ XrResult GraphicsAPI_Vulkan::init(XrInstance m_xrInstance, XrSystemId systemId)
     XrGraphicsRequirementsVulkanKHR graphicsRequirements{XR_TYPE_GRAPHICS_REQUIREMENTS_VULKAN_KHR};
     OPENXR_LOG(xrGetVulkanGraphicsRequirementsKHR(m_xrInstance, systemId, &graphicsRequirements), "Failed to get Graphics Requirements for Vulkan.");
 
+    // the renderer relies on Vulkan 1.3 like the desktop context, unless the runtime asks for more
+    uint32_t apiVersion = VK_API_VERSION_1_3;
+    if (XR_MAKE_VERSION(1, 3, 0) < graphicsRequirements.minApiVersionSupported)
+        apiVersion = VK_MAKE_API_VERSION(0, XR_VERSION_MAJOR(graphicsRequirements.minApiVersionSupported), XR_VERSION_MINOR(graphicsRequirements.minApiVersionSupported), 0);
+
     VkApplicationInfo ai;
     ai.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
     ai.pNext = nullptr;
@@ -142,29 +179,29 @@ XrResult GraphicsAPI_Vulkan::init(XrInstance m_xrInstance, XrSystemId systemId)
     ai.applicationVersion = 1;
     ai.pEngineName = "OpenXR Tutorial - Vulkan Engine";
     ai.engineVersion = 1;
-    ai.apiVersion = VK_MAKE_API_VERSION(0, XR_VERSION_MAJOR(graphicsRequirements.minApiVersionSupported), XR_VERSION_MINOR(graphicsRequirements.minApiVersionSupported), 0);
+    ai.apiVersion = apiVersion;
 
     uint32_t instanceExtensionCount = 0;
-    VULKAN_CHECK(vkEnumerateInstanceExtensionProperties(nullptr, &instanceExtensionCount, nullptr), "Failed to enumerate InstanceExtensionProperties.");
+    VULKAN_INIT_CHECK(vkEnumerateInstanceExtensionProperties(nullptr, &instanceExtensionCount, nullptr), "Failed to enumerate InstanceExtensionProperties.");
 
     std::vector<VkExtensionProperties> instanceExtensionProperties;
     instanceExtensionProperties.resize(instanceExtensionCount);
-    VULKAN_CHECK(vkEnumerateInstanceExtensionProperties(nullptr, &instanceExtensionCount, instanceExtensionProperties.data()), "Failed to enumerate InstanceExtensionProperties.");
+    VULKAN_INIT_CHECK(vkEnumerateInstanceExtensionProperties(nullptr, &instanceExtensionCount, instanceExtensionProperties.data()), "Failed to enumerate InstanceExtensionProperties.");
+
+    // the extensions the runtime asks for and the surface extensions of the desktop window are required,
+    // the other ones are only enabled when available
+    std::vector<const char *> requiredInstanceExtensions;
     const std::vector<std::string> &openXrInstanceExtensionNames = GetInstanceExtensionsForOpenXR(m_xrInstance, systemId);
-    for (const std::string &requestExtension : openXrInstanceExtensionNames) {
-        for (const VkExtensionProperties &extensionProperty : instanceExtensionProperties) {
-            if (strcmp(requestExtension.c_str(), extensionProperty.extensionName))
-                continue;
-            else
-                activeInstanceExtensions.push_back(requestExtension.c_str());
-            break;
+    for (const std::string &requestExtension : openXrInstanceExtensionNames)
+        requiredInstanceExtensions.push_back(requestExtension.c_str());
+    nvvkhl::addSurfaceExtensions(requiredInstanceExtensions);
+    for (const char *requestExtension : requiredInstanceExtensions) {
+        if (!AddSupportedExtension(activeInstanceExtensions, instanceExtensionProperties, requestExtension)) {
+            std::cout << "ERROR: Vulkan: Instance extension " << requestExtension << " is not supported." << std::endl;
+            return XR_ERROR_VALIDATION_FAILURE;
         }
     }
-
-    activeInstanceExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
-    activeInstanceExtensions.push_back("VK_KHR_surface");
-    activeInstanceExtensions.push_back("VK_KHR_win32_surface");
-    activeInstanceExtensions.push_back("VK_KHR_get_surface_capabilities2");
+    AddSupportedExtension(activeInstanceExtensions, instanceExtensionProperties, VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 
     VkInstanceCreateInfo instanceCI;
     instanceCI.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -175,25 +212,31 @@ XrResult GraphicsAPI_Vulkan::init(XrInstance m_xrInstance, XrSystemId systemId)
     instanceCI.ppEnabledLayerNames = activeInstanceLayers.data();
     instanceCI.enabledExtensionCount = static_cast<uint32_t>(activeInstanceExtensions.size());
     instanceCI.ppEnabledExtensionNames = activeInstanceExtensions.data();
-    VULKAN_CHECK(vkCreateInstance(&instanceCI, nullptr, &instance), "Failed to create Vulkan Instance.");
+    VULKAN_INIT_CHECK(vkCreateInstance(&instanceCI, nullptr, &instance), "Failed to create Vulkan Instance.");
 
     // Physical Device
     uint32_t physicalDeviceCount = 0;
     std::vector<VkPhysicalDevice> physicalDevices;
-    VULKAN_CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, nullptr), "Failed to enumerate PhysicalDevices.");
+    VULKAN_INIT_CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, nullptr), "Failed to enumerate PhysicalDevices.");
     physicalDevices.resize(physicalDeviceCount);
-    VULKAN_CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, physicalDevices.data()), "Failed to enumerate PhysicalDevices.");
+    VULKAN_INIT_CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, physicalDevices.data()), "Failed to enumerate PhysicalDevices.");
 
+    // the runtime can only present from the device it returns
     VkPhysicalDevice physicalDeviceFromXR;
     OPENXR_LOG(xrGetVulkanGraphicsDeviceKHR(m_xrInstance, systemId, instance, &physicalDeviceFromXR),
                "Failed to get Graphics Device for Vulkan.");
     auto physicalDeviceFromXR_it = std::find(physicalDevices.begin(), physicalDevices.end(), physicalDeviceFromXR);
-    if (physicalDeviceFromXR_it != physicalDevices.end()) {
-        physicalDevice = *physicalDeviceFromXR_it;
-    } else {
+    if (physicalDeviceFromXR_it == physicalDevices.end()) {
         std::cout << "ERROR: Vulkan: Failed to find PhysicalDevice for OpenXR." << std::endl;
-        // Select the first available device.
-        physicalDevice = physicalDevices[0];
+        return XR_ERROR_GRAPHICS_DEVICE_INVALID;
+    }
+    physicalDevice = *physicalDeviceFromXR_it;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    if (properties.apiVersion < VK_API_VERSION_1_3) {
+        std::cout << "ERROR: Vulkan: The PhysicalDevice for OpenXR does not support Vulkan 1.3." << std::endl;
+        return XR_ERROR_GRAPHICS_DEVICE_INVALID;
     }
 
     // Device
@@ -225,39 +268,57 @@ XrResult GraphicsAPI_Vulkan::init(XrInstance m_xrInstance, XrSystemId systemId)
     }
 
     uint32_t deviceExtensionCount = 0;
-    VULKAN_CHECK(vkEnumerateDeviceExtensionProperties(physicalDevice, 0, &deviceExtensionCount, 0), "Failed to enumerate DeviceExtensionProperties.");
+    VULKAN_INIT_CHECK(vkEnumerateDeviceExtensionProperties(physicalDevice, 0, &deviceExtensionCount, 0), "Failed to enumerate DeviceExtensionProperties.");
     std::vector<VkExtensionProperties> deviceExtensionProperties;
     deviceExtensionProperties.resize(deviceExtensionCount);
 
-    VULKAN_CHECK(vkEnumerateDeviceExtensionProperties(physicalDevice, 0, &deviceExtensionCount, deviceExtensionProperties.data()), "Failed to enumerate DeviceExtensionProperties.");
+    VULKAN_INIT_CHECK(vkEnumerateDeviceExtensionProperties(physicalDevice, 0, &deviceExtensionCount, deviceExtensionProperties.data()), "Failed to enumerate DeviceExtensionProperties.");
+    std::vector<const char *> requiredDeviceExtensions;
     const std::vector<std::string> &openXrDeviceExtensionNames = GetDeviceExtensionsForOpenXR(m_xrInstance, systemId);
-    for (const std::string &requestExtension : openXrDeviceExtensionNames) {
-        for (const VkExtensionProperties &extensionProperty : deviceExtensionProperties) {
-            if (strcmp(requestExtension.c_str(), extensionProperty.extensionName))
-                continue;
-            else
-                activeDeviceExtensions.push_back(requestExtension.c_str());
-            break;
+    for (const std::string &requestExtension : openXrDeviceExtensionNames)
+        requiredDeviceExtensions.push_back(requestExtension.c_str());
+    requiredDeviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    requiredDeviceExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);  // for ImGui
+    for (const char *requestExtension : requiredDeviceExtensions) {
+        if (!AddSupportedExtension(activeDeviceExtensions, deviceExtensionProperties, requestExtension)) {
+            std::cout << "ERROR: Vulkan: Device extension " << requestExtension << " is not supported." << std::endl;
+            return XR_ERROR_GRAPHICS_DEVICE_INVALID;
         }
     }
-    activeDeviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
-    activeDeviceExtensions.push_back(VK_EXT_MESH_SHADER_EXTENSION_NAME);
-    activeDeviceExtensions.push_back(VK_KHR_FRAGMENT_SHADER_BARYCENTRIC_EXTENSION_NAME);
-    activeDeviceExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
 
+    // all the supported core features are enabled, as nvvk::Context does for the desktop
+    VkPhysicalDeviceFeatures2 features2 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+    VkPhysicalDeviceVulkan11Features features11 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES};
+    VkPhysicalDeviceVulkan12Features features12 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+    VkPhysicalDeviceVulkan13Features features13 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES};
+    features2.pNext  = &features11;
+    features11.pNext = &features12;
+    features12.pNext = &features13;
+
+    // optional extensions, the renderer checks the features before using them
     VkPhysicalDeviceFragmentShaderBarycentricFeaturesKHR baryFeaturesKHR = {
         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADER_BARYCENTRIC_FEATURES_KHR};
-    baryFeaturesKHR.fragmentShaderBarycentric = true;
     VkPhysicalDeviceMeshShaderFeaturesEXT meshFeaturesEXT = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT};
-    meshFeaturesEXT.meshShader = true;
-    baryFeaturesKHR.pNext      = &meshFeaturesEXT;
+    void **lastFeatures = &features13.pNext;
+    if (AddSupportedExtension(activeDeviceExtensions, deviceExtensionProperties, VK_EXT_MESH_SHADER_EXTENSION_NAME)) {
+        *lastFeatures = &meshFeaturesEXT;
+        lastFeatures  = &meshFeaturesEXT.pNext;
+    }
+    if (AddSupportedExtension(activeDeviceExtensions, deviceExtensionProperties, VK_KHR_FRAGMENT_SHADER_BARYCENTRIC_EXTENSION_NAME)) {
+        *lastFeatures = &baryFeaturesKHR;
+        lastFeatures  = &baryFeaturesKHR.pNext;
+    }
+    // for memory telemetry
+    memoryBudgetEnabled = AddSupportedExtension(activeDeviceExtensions, deviceExtensionProperties, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
 
-    VkPhysicalDeviceFeatures features;
-    vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+    // same as the desktop context, enabling and not using them may cost a tiny bit of performance on NV hardware
+    meshFeaturesEXT.meshShaderQueries = VK_FALSE;
+    meshFeaturesEXT.primitiveFragmentShadingRateMeshShader = VK_FALSE;
 
     VkDeviceCreateInfo deviceCI;
     deviceCI.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    deviceCI.pNext                   = &baryFeaturesKHR;
+    deviceCI.pNext = &features2;
     deviceCI.flags = 0;
     deviceCI.queueCreateInfoCount = static_cast<uint32_t>(deviceQueueCIs.size());
     deviceCI.pQueueCreateInfos = deviceQueueCIs.data();
@@ -265,13 +326,14 @@ XrResult GraphicsAPI_Vulkan::init(XrInstance m_xrInstance, XrSystemId systemId)
     deviceCI.ppEnabledLayerNames = nullptr;
     deviceCI.enabledExtensionCount = static_cast<uint32_t>(activeDeviceExtensions.size());
     deviceCI.ppEnabledExtensionNames = activeDeviceExtensions.data();
-    deviceCI.pEnabledFeatures = &features;
-    VULKAN_CHECK(vkCreateDevice(physicalDevice, &deviceCI, nullptr, &device), "Failed to create Device.");
+    deviceCI.pEnabledFeatures = nullptr;
+    VULKAN_INIT_CHECK(vkCreateDevice(physicalDevice, &deviceCI, nullptr, &device), "Failed to create Device.");
 
     vkGetDeviceQueue(device, queueFamilyIndex, queueIndex, &queue);
 
     nvvk::DebugUtil debugUtil(device);
     debugUtil.setObjectName(queue, "queueGTC");
+    return XR_SUCCESS;
 }
 
 GraphicsAPI_Vulkan::~GraphicsAPI_Vulkan() {
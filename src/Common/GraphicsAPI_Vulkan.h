@@ -15,7 +15,7 @@ public:
     ~GraphicsAPI_Vulkan();
 
     XrResult init(XrInstance m_xrInstance, XrSystemId systemId);
-    void init();
+    void init(bool headless = false);
 
     virtual int64_t GetDepthFormat() override { return (int64_t)VK_FORMAT_D32_SFLOAT; }
 
@@ -57,6 +57,8 @@ public:
     uint32_t queueFamilyIndex = 0xFFFFFFFF;
     uint32_t queueIndex = 0xFFFFFFFF;
     VkQueue queue{};
+    // VK_EXT_memory_budget is enabled, the allocator can then report the actual heap budgets
+    bool memoryBudgetEnabled = false;
 
  private:
     // or using Context to create the above Vulkan objects
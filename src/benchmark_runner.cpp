@@ -0,0 +1,263 @@
+#include "benchmark_runner.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <glm/gtc/quaternion.hpp>
+#include <nvh/parametertools.hpp>
+
+// parses a comma separated list of unsigned values in [0, maxValue] such as "0,1,2",
+// name is the argument reported in the error messages
+static bool parseList(const std::string& str, const char* name, uint32_t maxValue, std::vector<uint32_t>& values)
+{
+  if(str.empty())
+    return true;  // keep defaults
+
+  std::vector<uint32_t> parsed;
+  std::stringstream     stream(str);
+  std::string           item;
+  while(std::getline(stream, item, ','))
+  {
+    try
+    {
+      parsed.push_back((uint32_t)std::stoul(item));
+    }
+    catch(const std::exception&)
+    {
+      std::cerr << "Error: invalid benchmark list value \"" << item << "\" in \"" << str << "\"" << std::endl;
+      return false;
+    }
+    if(parsed.back() > maxValue)
+    {
+      std::cerr << "Error: value " << parsed.back() << " of -" << name << " is out of range [0," << maxValue << "]" << std::endl;
+      return false;
+    }
+  }
+  if(parsed.empty())
+  {
+    std::cerr << "Error: empty benchmark list for -" << name << std::endl;
+    return false;
+  }
+  values = parsed;
+  return true;
+}
+
+bool parseBenchmarkArguments(int argc, char** argv, BenchmarkSettings& settings)
+{
+  std::string pipelines, sortings, storages, shFormats, maxShDegrees;
+
+  nvh::ParameterList parameters;
+  parameters.add("bench|runs the headless benchmark on the given ply file", &settings.sceneFilename);
+  parameters.add("benchSynthetic|1=runs the headless benchmark on the scene described by the -generate options",
+                 &settings.synthetic);
+  parameters.add("benchCamera|camera path file replayed for each configuration", &settings.cameraPathFilename);
+  parameters.add("benchReport|JSON report output file", &settings.reportFilename);
+  parameters.add("benchGsMode|0=3dgs 1=spacetime-lite", &settings.gsMode, nullptr, 1, GSMODE_3DGS, GSMODE_SPACETIME_LITE);
+  parameters.add("benchFrames|number of measured frames per configuration", &settings.framesPerConfig);
+  parameters.add("benchSize|rendering resolution (width and height)", settings.resolution, nullptr, 2);
+  parameters.add("benchPipelines|comma separated list, 0=mesh 1=vert", &pipelines);
+  parameters.add("benchSortings|comma separated list, 0=gpu radix 2=cpu async multi", &sortings);
+  parameters.add("benchStorages|comma separated list, 0=buffers 1=textures", &storages);
+  parameters.add("benchShFormats|comma separated list, 0=fp32 1=fp16 2=uint8", &shFormats);
+  parameters.add("benchShDegrees|comma separated list of max SH degrees in [0,3]", &maxShDegrees);
+  parameters.add("benchOverdraw|1=renders in overdraw mode and reports the overdraw summary", &settings.overdraw);
+  parameters.add("benchSplatOrder|0=file 1=morton 2=hilbert", &settings.splatOrder, nullptr, 1, SPLAT_ORDER_NONE, SPLAT_ORDER_HILBERT);
+  parameters.add("benchShAdaptive|1=per splat SH degree with the data buffers", &settings.shAdaptive);
+  parameters.add("benchShAdaptiveTolerance|color error tolerated by the adaptive SH degree", &settings.shAdaptiveTolerance);
+  parameters.add("benchPrune|1=prunes the negligible splats at load time", &settings.prune.enabled);
+  parameters.add("benchPruneMinOpacity|min opacity of the kept splats", &settings.prune.minOpacity);
+  parameters.add("benchPruneMinSize|min size of the kept splats relative to the scene radius", &settings.prune.minSizeRatio);
+  parameters.add("benchPruneMaxDistance|max distance of the kept splats relative to the scene radius, 0=off",
+                 &settings.prune.maxDistanceRatio);
+  parameters.add("benchPruneBudget|max number of kept splats, 0=off", &settings.prune.maxSplatCount);
+
+  // skip executable name
+  parameters.applyTokens((uint32_t)argc - 1, (const char**)argv + 1, "-", ".");
+
+  settings.enabled = !settings.sceneFilename.empty() || settings.synthetic;
+  if(!settings.enabled)
+    return true;
+
+  // the ray tracing pipeline is not implemented
+  if(!parseList(pipelines, "benchPipelines", PIPELINE_VERT, settings.pipelines)
+     || !parseList(sortings, "benchSortings", SORTING_CPU_ASYNC_MULTI, settings.sortings)
+     || !parseList(storages, "benchStorages", STORAGE_TEXTURES, settings.storages)
+     || !parseList(shFormats, "benchShFormats", FORMAT_UINT8, settings.shFormats)
+     || !parseList(maxShDegrees, "benchShDegrees", 3, settings.maxShDegrees))
+    return false;
+
+  settings.framesPerConfig = std::max(1u, settings.framesPerConfig);
+  settings.resolution[0]   = std::max(1u, settings.resolution[0]);
+  settings.resolution[1]   = std::max(1u, settings.resolution[1]);
+
+  return true;
+}
+
+BenchmarkConfig getBenchmarkConfig(const BenchmarkSettings& settings, uint32_t configId)
+{
+  BenchmarkConfig config;
+  config.maxShDegree = settings.maxShDegrees[configId % settings.maxShDegrees.size()];
+  configId /= (uint32_t)settings.maxShDegrees.size();
+  config.shFormat = settings.shFormats[configId % settings.shFormats.size()];
+  configId /= (uint32_t)settings.shFormats.size();
+  config.storage = settings.storages[configId % settings.storages.size()];
+  configId /= (uint32_t)settings.storages.size();
+  config.sorting = settings.sortings[configId % settings.sortings.size()];
+  configId /= (uint32_t)settings.sortings.size();
+  config.pipeline = settings.pipelines[configId % settings.pipelines.size()];
+  return config;
+}
+
+bool loadCameraPath(const std::string& filename, std::vector<CameraKey>& path)
+{
+  std::ifstream file(filename);
+  if(!file.is_open())
+  {
+    std::cerr << "Error: cannot open camera path file " << filename << std::endl;
+    return false;
+  }
+
+  path.clear();
+  std::string line;
+  uint32_t    lineNumber = 0;
+  while(std::getline(file, line))
+  {
+    lineNumber++;
+    std::stringstream stream(line);
+    std::string       type;
+    if(!(stream >> type) || type[0] == '#')
+      continue;
+
+    CameraKey key;
+    if(type == "lookat")
+    {
+      stream >> key.eye.x >> key.eye.y >> key.eye.z >> key.center.x >> key.center.y >> key.center.z >> key.up.x
+          >> key.up.y >> key.up.z;
+    }
+    else if(type == "pose")
+    {
+      glm::vec3 position;
+      glm::quat orientation;
+      stream >> position.x >> position.y >> position.z >> orientation.x >> orientation.y >> orientation.z >> orientation.w;
+      orientation = glm::normalize(orientation);
+      // OpenXR convention, the head looks toward -Z with +Y up
+      key.eye    = position;
+      key.center = position + orientation * glm::vec3(0.0f, 0.0f, -1.0f);
+      key.up     = orientation * glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+    else
+    {
+      std::cerr << "Error: unknown camera key type \"" << type << "\" at line " << lineNumber << " of " << filename << std::endl;
+      return false;
+    }
+
+    if(stream.fail())
+    {
+      std::cerr << "Error: invalid camera key at line " << lineNumber << " of " << filename << std::endl;
+      return false;
+    }
+    path.push_back(key);
+  }
+
+  return !path.empty();
+}
+
+CameraKey sampleCameraPath(const std::vector<CameraKey>& path, float t)
+{
+  if(path.empty())
+    return {};
+  if(path.size() == 1)
+    return path.front();
+
+  const float    position = glm::clamp(t, 0.0f, 1.0f) * float(path.size() - 1);
+  const uint32_t index    = std::min((uint32_t)position, (uint32_t)path.size() - 2);
+  const float    alpha    = position - float(index);
+
+  const CameraKey& a = path[index];
+  const CameraKey& b = path[index + 1];
+
+  CameraKey key;
+  key.eye    = glm::mix(a.eye, b.eye, alpha);
+  key.center = glm::mix(a.center, b.center, alpha);
+  key.up     = glm::normalize(glm::mix(a.up, b.up, alpha));
+  return key;
+}
+
+bool writeBenchmarkReport(const std::string&                  filename,
+                          const BenchmarkSettings&            settings,
+                          const std::string&                  deviceName,
+                          uint32_t                            splatCount,
+                          const std::vector<BenchmarkResult>& results)
+{
+  std::ofstream file(filename);
+  if(!file.is_open())
+  {
+    std::cerr << "Error: cannot write benchmark report " << filename << std::endl;
+    return false;
+  }
+
+  // minimal escaping, sufficient for file paths and device names
+  auto quote = [](const std::string& str) {
+    std::string out = "\"";
+    for(char c : str)
+    {
+      if(c == '"' || c == '\\')
+        out += '\\';
+      out += c;
+    }
+    return out + "\"";
+  };
+
+  file << "{\n";
+  file << "  \"device\": " << quote(deviceName) << ",\n";
+  file << "  \"scene\": "
+       << quote(settings.synthetic ? getSyntheticSceneName(settings.generator) : settings.sceneFilename) << ",\n";
+  file << "  \"cameraPath\": " << quote(settings.cameraPathFilename) << ",\n";
+  file << "  \"gsMode\": " << settings.gsMode << ",\n";
+  file << "  \"splatCount\": " << splatCount << ",\n";
+  file << "  \"resolution\": [" << settings.resolution[0] << ", " << settings.resolution[1] << "],\n";
+  file << "  \"framesPerConfig\": " << settings.framesPerConfig << ",\n";
+  file << "  \"overdrawMode\": " << (settings.overdraw ? "true" : "false") << ",\n";
+  file << "  \"splatOrder\": " << settings.splatOrder << ",\n";
+  file << "  \"shAdaptive\": " << (settings.shAdaptive ? "true" : "false")
+       << ", \"shAdaptiveTolerance\": " << settings.shAdaptiveTolerance << ",\n";
+  file << "  \"pruning\": {\"enabled\": " << (settings.prune.enabled ? "true" : "false")
+       << ", \"minOpacity\": " << settings.prune.minOpacity << ", \"minSizeRatio\": " << settings.prune.minSizeRatio
+       << ", \"maxDistanceRatio\": " << settings.prune.maxDistanceRatio
+       << ", \"maxSplatCount\": " << settings.prune.maxSplatCount << "},\n";
+  file << "  \"results\": [\n";
+  for(size_t i = 0; i < results.size(); ++i)
+  {
+    const BenchmarkResult& r = results[i];
+    file << "    {\n";
+    file << "      \"pipeline\": " << r.config.pipeline << ", \"sorting\": " << r.config.sorting
+         << ", \"storage\": " << r.config.storage << ", \"shFormat\": " << r.config.shFormat
+         << ", \"maxShDegree\": " << r.config.maxShDegree << ",\n";
+    file << "      \"supported\": " << (r.supported ? "true" : "false") << ",\n";
+    file << "      \"timingsMs\": {\"cpuFrame\": " << r.cpuFrame << ", \"gpuDist\": " << r.gpuDist
+         << ", \"gpuSort\": " << r.gpuSort << ", \"gpuRendering\": " << r.gpuRendering << ", \"cpuDist\": " << r.cpuDist
+         << ", \"cpuSort\": " << r.cpuSort << "},\n";
+    file << "      \"visibleSplats\": " << r.visibleSplats << ",\n";
+    file << "      \"pipelineStatistics\": {\"vertexInvocations\": " << r.vertexInvocations
+         << ", \"clippingInvocations\": " << r.clippingInvocations << ", \"clippingPrimitives\": " << r.clippingPrimitives
+         << ", \"fragmentInvocations\": " << r.fragmentInvocations << "},\n";
+    if(settings.overdraw)
+    {
+      file << "      \"overdraw\": {\"max\": " << r.overdrawMax << ", \"mean\": " << r.overdrawMean
+           << ", \"coverage\": " << r.overdrawCoverage << ", \"histogram\": [";
+      for(size_t b = 0; b < r.overdrawHistogram.size(); ++b)
+        file << (b ? ", " : "") << r.overdrawHistogram[b];
+      file << "]},\n";
+    }
+    file << "      \"memoryBytes\": {\"modelHostUsed\": " << r.modelHostUsed << ", \"modelDeviceUsed\": " << r.modelDeviceUsed
+         << ", \"modelDeviceAlloc\": " << r.modelDeviceAlloc << ", \"renderHostUsed\": " << r.renderHostUsed
+         << ", \"renderDeviceUsed\": " << r.renderDeviceUsed << ", \"renderDeviceAlloc\": " << r.renderDeviceAlloc << "}\n";
+    file << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  file << "  ]\n";
+  file << "}\n";
+
+  return true;
+}
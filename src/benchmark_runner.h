@@ -0,0 +1,124 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "shaders/shaderio.h"
+#include "splat_generator.h"
+#include "splat_prune.h"
+#include "splat_reorder.h"
+
+// Settings of the headless benchmark mode, parsed from the command line.
+// The scene is rendered for each combination of the sweep lists
+// (pipeline x sorting x storage x shFormat x maxShDegree), replaying
+// the camera path over framesPerConfig frames for each combination.
+struct BenchmarkSettings
+{
+  bool        enabled = false;
+  std::string sceneFilename;
+  // benchmarks a synthetic scene instead of sceneFilename
+  uint32_t               synthetic = 0;
+  SplatGeneratorSettings generator;
+  std::string cameraPathFilename;
+  std::string reportFilename  = "benchmark.json";
+  uint32_t    gsMode          = GSMODE_3DGS;
+  uint32_t    framesPerConfig = 64;
+  uint32_t    resolution[2]   = {1280, 720};
+  // renders in overdraw mode to report the overdraw summary, this changes the timings
+  uint32_t overdraw = 0;
+  // spatial reordering of the splats at load time (SplatOrder)
+  uint32_t splatOrder = SPLAT_ORDER_NONE;
+  // per splat SH degree with the data buffers, and the color error it tolerates
+  uint32_t shAdaptive          = 0;
+  float    shAdaptiveTolerance = 1.0f / 255.0f;
+  // load time pruning, splatCount of the report is the count after pruning
+  SplatPruneSettings prune;
+
+  std::vector<uint32_t> pipelines    = {PIPELINE_MESH, PIPELINE_VERT};
+  std::vector<uint32_t> sortings     = {SORTING_GPU_SYNC_RADIX, SORTING_CPU_ASYNC_MULTI};
+  std::vector<uint32_t> storages     = {STORAGE_BUFFERS, STORAGE_TEXTURES};
+  std::vector<uint32_t> shFormats    = {FORMAT_FLOAT32, FORMAT_FLOAT16, FORMAT_UINT8};
+  std::vector<uint32_t> maxShDegrees = {0, 1, 2, 3};
+
+  // number of combinations in the sweep
+  uint32_t configCount() const
+  {
+    return (uint32_t)(pipelines.size() * sortings.size() * storages.size() * shFormats.size() * maxShDegrees.size());
+  }
+};
+
+// One parameter combination of the sweep
+struct BenchmarkConfig
+{
+  uint32_t pipeline    = PIPELINE_VERT;
+  uint32_t sorting     = SORTING_GPU_SYNC_RADIX;
+  uint32_t storage     = STORAGE_BUFFERS;
+  uint32_t shFormat    = FORMAT_FLOAT32;
+  uint32_t maxShDegree = 3;
+};
+
+// returns the combination of index configId, maxShDegree varies the fastest
+// so that data storage is rebuilt as few times as possible
+BenchmarkConfig getBenchmarkConfig(const BenchmarkSettings& settings, uint32_t configId);
+
+// Measures collected at the end of each combination
+struct BenchmarkResult
+{
+  BenchmarkConfig config;
+  bool            supported = true;  // false if the combination could not be run on this device
+  // averaged timings in milliseconds
+  double cpuFrame     = 0.0;
+  double gpuDist      = 0.0;
+  double gpuSort      = 0.0;
+  double gpuRendering = 0.0;
+  double cpuDist      = 0.0;  // CPU sorting only
+  double cpuSort      = 0.0;  // CPU sorting only
+  // rendered splats after culling (GPU sorting only, equals splatCount otherwise)
+  uint32_t visibleSplats = 0;
+  // pipeline statistics of the splat draw of the last measured frame, zero if not supported
+  uint64_t vertexInvocations   = 0;
+  uint64_t clippingInvocations = 0;
+  uint64_t clippingPrimitives  = 0;
+  uint64_t fragmentInvocations = 0;
+  // overdraw summary of the last measured frame, overdraw mode only
+  uint32_t              overdrawMax      = 0;
+  double                overdrawMean     = 0.0;  // fragments per covered pixel
+  double                overdrawCoverage = 0.0;  // ratio of covered pixels
+  std::vector<uint32_t> overdrawHistogram;       // see OVERDRAW_HISTOGRAM_BINS
+  // memory in bytes
+  uint64_t modelHostUsed     = 0;
+  uint64_t modelDeviceUsed   = 0;
+  uint64_t modelDeviceAlloc  = 0;
+  uint64_t renderHostUsed    = 0;
+  uint64_t renderDeviceUsed  = 0;
+  uint64_t renderDeviceAlloc = 0;
+};
+
+// A key of the camera path, XR head poses are converted to this representation
+struct CameraKey
+{
+  glm::vec3 eye{0.0f, 0.0f, -2.0f};
+  glm::vec3 center{0.0f};
+  glm::vec3 up{0.0f, 1.0f, 0.0f};
+};
+
+// parses the -bench* command line arguments, returns false on error.
+// settings.enabled is set if a benchmark was requested.
+bool parseBenchmarkArguments(int argc, char** argv, BenchmarkSettings& settings);
+
+// Loads a camera path file, one key per line, empty lines and lines starting with # are skipped
+//   lookat eyeX eyeY eyeZ centerX centerY centerZ upX upY upZ
+//   pose   posX posY posZ quatX quatY quatZ quatW   (XR head pose)
+bool loadCameraPath(const std::string& filename, std::vector<CameraKey>& path);
+
+// linear interpolation of the path keys, t in [0,1]
+CameraKey sampleCameraPath(const std::vector<CameraKey>& path, float t);
+
+// writes the report in JSON format, returns false on error
+bool writeBenchmarkReport(const std::string&                  filename,
+                          const BenchmarkSettings&            settings,
+                          const std::string&                  deviceName,
+                          uint32_t                            splatCount,
+                          const std::vector<BenchmarkResult>& results);
@@ -0,0 +1,171 @@
+#include "frame_governor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "utilities.h"
+
+const std::array<float, 6> FrameGovernor::BUDGET_FRACTIONS = {1.0f, 0.8f, 0.65f, 0.5f, 0.35f, 0.25f};
+
+namespace {
+// KNOB_CONTRIBUTION_CULL, minimum opacity x projected area at one sigma, in pixels
+const std::array<float, 6> CONTRIBUTION_THRESHOLDS = {0.0f, 0.25f, 0.5f, 1.0f, 2.0f, 4.0f};
+// KNOB_RENDER_SCALE, factor of the resolution in each dimension
+const std::array<float, 5> RENDER_SCALE_FACTORS = {1.0f, 0.85f, 0.7f, 0.6f, 0.5f};
+// KNOB_SH_DEGREE, caps the SH degree set by the user
+const std::array<int, 4> SH_DEGREE_CAPS = {3, 2, 1, 0};
+}  // namespace
+
+void FrameGovernor::reset()
+{
+  m_levels.fill(0);
+  m_overSince     = -1.0;
+  m_underSince    = -1.0;
+  m_lastFrameTime = 0.0f;
+  m_lastBudget    = 0.0f;
+  m_decisions.clear();
+}
+
+int FrameGovernor::getLevelCount(GovernorKnob knob)
+{
+  switch(knob)
+  {
+    case KNOB_CONTRIBUTION_CULL:
+      return (int)CONTRIBUTION_THRESHOLDS.size();
+    case KNOB_SPLAT_BUDGET:
+      return (int)BUDGET_FRACTIONS.size();
+    case KNOB_RENDER_SCALE:
+      return (int)RENDER_SCALE_FACTORS.size();
+    case KNOB_SH_DEGREE:
+      return (int)SH_DEGREE_CAPS.size();
+    default:
+      return 1;
+  }
+}
+
+const char* FrameGovernor::getKnobName(GovernorKnob knob)
+{
+  switch(knob)
+  {
+    case KNOB_CONTRIBUTION_CULL:
+      return "Contribution cull";
+    case KNOB_SPLAT_BUDGET:
+      return "Splat budget";
+    case KNOB_RENDER_SCALE:
+      return "Render scale";
+    case KNOB_SH_DEGREE:
+      return "SH degree";
+    default:
+      return "";
+  }
+}
+
+float FrameGovernor::getContributionThreshold() const
+{
+  return CONTRIBUTION_THRESHOLDS[m_levels[KNOB_CONTRIBUTION_CULL]];
+}
+
+float FrameGovernor::getBudgetFraction() const
+{
+  return BUDGET_FRACTIONS[m_levels[KNOB_SPLAT_BUDGET]];
+}
+
+float FrameGovernor::getRenderScaleFactor() const
+{
+  return RENDER_SCALE_FACTORS[m_levels[KNOB_RENDER_SCALE]];
+}
+
+int FrameGovernor::getShDegreeCap() const
+{
+  return SH_DEGREE_CAPS[m_levels[KNOB_SH_DEGREE]];
+}
+
+void FrameGovernor::setLevel(double time, GovernorKnob knob, int level, float frameTime, float budget)
+{
+  m_decisions.push_back({time, knob, m_levels[knob], level, frameTime, budget});
+  if(m_decisions.size() > MAX_DECISIONS)
+    m_decisions.erase(m_decisions.begin());
+  m_levels[knob] = level;
+}
+
+bool FrameGovernor::update(double time, float gpuFrameTime, float frameBudget)
+{
+  if(!settings.enabled)
+  {
+    // back to the full quality
+    const bool changed = std::any_of(m_levels.begin(), m_levels.end(), [](int level) { return level > 0; });
+    m_levels.fill(0);
+    m_overSince = m_underSince = -1.0;
+    return changed;
+  }
+  if(gpuFrameTime <= 0.0f || frameBudget <= 0.0f)
+  {
+    m_overSince = m_underSince = -1.0;
+    return false;
+  }
+  m_lastFrameTime = gpuFrameTime;
+  m_lastBudget    = frameBudget;
+
+  const bool over  = gpuFrameTime > settings.targetRatio * frameBudget;
+  const bool under = gpuFrameTime < settings.raiseRatio * frameBudget;
+  m_overSince      = over ? (m_overSince < 0.0 ? time : m_overSince) : -1.0;
+  m_underSince     = under ? (m_underSince < 0.0 ? time : m_underSince) : -1.0;
+
+  if(over && time - m_overSince >= settings.lowerDelay)
+  {
+    // cheapest degradation first
+    for(uint32_t k = 0; k < KNOB_COUNT; ++k)
+    {
+      const GovernorKnob knob = (GovernorKnob)k;
+      if(m_levels[knob] + 1 < getLevelCount(knob))
+      {
+        setLevel(time, knob, m_levels[knob] + 1, gpuFrameTime, frameBudget);
+        m_overSince = -1.0;
+        return true;
+      }
+    }
+  }
+  else if(under && time - m_underSince >= settings.raiseDelay)
+  {
+    // the most visible degradation is removed first
+    for(int k = KNOB_COUNT - 1; k >= 0; --k)
+    {
+      const GovernorKnob knob = (GovernorKnob)k;
+      if(m_levels[knob] > 0)
+      {
+        setLevel(time, knob, m_levels[knob] - 1, gpuFrameTime, frameBudget);
+        m_underSince = -1.0;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void computeImportanceThresholds(const SplatSet& splatSet, const float* keepFractions, size_t count, std::vector<float>& thresholds)
+{
+  thresholds.clear();
+  const size_t splatCount = splatSet.size();
+  if(splatCount == 0 || splatSet.opacity.size() < splatCount || splatSet.scale.size() < splatCount * 3)
+    return;
+
+  std::vector<float> importance(splatCount);
+  START_PAR_LOOP(splatCount, splatIdx)
+  {
+    const float* s       = &splatSet.scale[splatIdx * 3];
+    const float  opacity = 1.0f / (1.0f + std::exp(-splatSet.opacity[splatIdx]));
+    importance[splatIdx] = opacity * (std::exp(2.0f * s[0]) + std::exp(2.0f * s[1]) + std::exp(2.0f * s[2]));
+  }
+  END_PAR_LOOP()
+
+  // the threshold is the importance of the first kept splat in increasing order
+  thresholds.resize(count, 0.0f);
+  for(size_t i = 0; i < count; ++i)
+  {
+    const size_t culled = std::min((size_t)((1.0 - std::clamp(keepFractions[i], 0.0f, 1.0f)) * splatCount), splatCount - 1);
+    if(culled == 0)
+      continue;
+    std::nth_element(importance.begin(), importance.begin() + culled, importance.end());
+    thresholds[i] = importance[culled];
+  }
+}
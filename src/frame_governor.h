@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "splat_set.h"
+
+// Quality knobs driven by the governor, ranked from the least to the most visible degradation.
+// Level 0 of a knob is the full quality, higher levels are cheaper.
+enum GovernorKnob : uint32_t
+{
+  KNOB_CONTRIBUTION_CULL,  // culls the splats whose opacity x projected area is below a few pixels
+  KNOB_SPLAT_BUDGET,       // keeps the most important splats only, by opacity x size
+  KNOB_RENDER_SCALE,       // renders at a reduced resolution then upscales, builds the targets on first use
+  KNOB_SH_DEGREE,          // lowers the SH degree evaluated by the shaders, a frame parameter
+  KNOB_COUNT
+};
+
+struct FrameGovernorSettings
+{
+  bool enabled = false;
+  // the GPU frame time is kept under this ratio of the frame budget,
+  // the headroom absorbs the variations and the compositor work
+  float targetRatio = 0.9f;
+  // the quality is raised back when the frame time is under this ratio of the budget
+  float raiseRatio = 0.7f;
+  // seconds over the target before lowering the quality, and under
+  // the raise ratio before raising it back (slower, avoids oscillations)
+  float lowerDelay = 0.25f;
+  float raiseDelay = 2.0f;
+  // frame budget in PC mode in Hz, the display period is used in XR mode
+  float pcTargetRate = 60.0f;
+};
+
+// Closed loop control of the rendering quality to keep the GPU frame time under a budget.
+// When the frame time stays over the target, the first knob of the ranking not at its
+// cheapest level is lowered by one level. When it stays well under the target, the last
+// lowered knob is raised by one level. Each change restarts the measurement, the decision
+// needs a full delay of new samples, so the effect of a change is seen before the next one.
+class FrameGovernor
+{
+public:
+  struct Decision
+  {
+    double       time      = 0.0;  // seconds
+    GovernorKnob knob      = KNOB_COUNT;
+    int          fromLevel = 0;
+    int          toLevel   = 0;
+    float        frameTime = 0.0f;  // ms, GPU frame time that triggered the decision
+    float        budget    = 0.0f;  // ms
+  };
+
+  FrameGovernorSettings settings;
+
+  // back to the full quality
+  void reset();
+
+  // to be called once per frame with the averaged GPU frame time and the frame budget in ms, a
+  // frame time <= 0 means no valid measure. Returns true if a knob changed, the measures must then
+  // be restarted (the averages still contain frames rendered with the previous levels).
+  // When the governor is disabled, the knobs go back to their full quality level.
+  bool update(double time, float gpuFrameTime, float frameBudget);
+
+  int        getLevel(GovernorKnob knob) const { return m_levels[knob]; }
+  static int getLevelCount(GovernorKnob knob);
+  static const char* getKnobName(GovernorKnob knob);
+
+  // values of the knobs for their current level
+  float getContributionThreshold() const;  // in pixels, 0 disables the cull
+  float getBudgetFraction() const;         // fraction of the splats kept, by importance
+  float getRenderScaleFactor() const;      // multiplies the render scale set by the user
+  int   getShDegreeCap() const;            // in [0,3]
+
+  // last decisions, the most recent last
+  const std::vector<Decision>& getDecisions() const { return m_decisions; }
+  // state of the loop for display
+  float getLastFrameTime() const { return m_lastFrameTime; }
+  float getLastBudget() const { return m_lastBudget; }
+
+  // budget levels of KNOB_SPLAT_BUDGET, fraction of the splats kept
+  static const std::array<float, 6> BUDGET_FRACTIONS;
+
+private:
+  static const size_t MAX_DECISIONS = 8;
+
+  void setLevel(double time, GovernorKnob knob, int level, float frameTime, float budget);
+
+  std::array<int, KNOB_COUNT> m_levels{};
+  double                      m_overSince     = -1.0;  // time the frame time went over the target, -1 if under
+  double                      m_underSince    = -1.0;  // time the frame time went under the raise ratio, -1 if over
+  float                       m_lastFrameTime = 0.0f;
+  float                       m_lastBudget    = 0.0f;
+  std::vector<Decision>       m_decisions;
+};
+
+// importance of the splats for the splat budget knob, opacity (after the sigmoid) times the trace
+// of the covariance (sum of the squared scales), computed the same way by the raster shaders.
+// thresholds[i] is the importance under which the splats are culled to keep keepFractions[i] of
+// them, 0 to keep all of them. The thresholds are empty if the set has no attributes.
+void computeImportanceThresholds(const SplatSet& splatSet, const float* keepFractions, size_t count, std::vector<float>& thresholds);
@@ -22,9 +22,11 @@
 
 #include "gaussian_splatting.h"
 #include "utilities.h"
+#include "splat_packing.h"
+
+#include <limits>
 
 #include <nvh/misc.hpp>
-#include <glm/gtc/packing.hpp>  // Required for half-float operations
 #include "openxr_env.h"
 #include "GraphicsAPI_Vulkan.h"
 
@@ -52,6 +54,30 @@ GaussianSplatting::GaussianSplatting(std::shared_ptr<nvvkhl::ElementProfiler>
   benchmark->addPostBenchmarkAdvanceCallback([&]() { benchmarkAdvance(); });
 };
 
+void GaussianSplatting::parseCommandLine(int argc, char** argv)
+{
+  nvh::ParameterList parameters;
+  parameters.add("gpuSortPolicy|0=always 1=lazy 2=every N frames 3=on threshold", &m_gpuSortPolicy);
+  parameters.add("memoryBudget|device memory budget of the model in MB, 0=available heap budget", &m_memoryBudgetMB);
+  parameters.add("splatOrder|0=file 1=morton 2=hilbert", &m_plyLoader.m_splatOrder);
+  parameters.add("prune|1=prunes the negligible splats at load time", &m_plyLoader.m_pruneSettings.enabled);
+  parameters.add("pruneMinOpacity|min opacity of the kept splats", &m_plyLoader.m_pruneSettings.minOpacity);
+  parameters.add("pruneMinSize|min size of the kept splats relative to the scene radius",
+                 &m_plyLoader.m_pruneSettings.minSizeRatio);
+  parameters.add("pruneMaxDistance|max distance of the kept splats relative to the scene radius, 0=off",
+                 &m_plyLoader.m_pruneSettings.maxDistanceRatio);
+  parameters.add("pruneBudget|max number of kept splats, 0=off", &m_plyLoader.m_pruneSettings.maxSplatCount);
+  parameters.add("shAdaptive|1=per splat SH degree (data buffers only)", &m_shAdaptiveDefault);
+  parameters.add("shAdaptiveTolerance|color error tolerated by the adaptive SH degree", &m_shAdaptiveTolerance);
+  parameters.add("releaseHostData|1=frees the host copy of the splat attributes once uploaded",
+                 &m_releaseHostData);
+  parameters.add("stagingRingSize|host memory used to upload the model in MB", &m_stagingRingSizeMB);
+
+  // skip executable name
+  parameters.applyTokens((uint32_t)argc - 1, (const char**)argv + 1, "-", ".");
+  m_defines.shAdaptive = m_shAdaptiveDefault;
+}
+
 GaussianSplatting::~GaussianSplatting()
 {
   // all threads must be stopped,
@@ -64,6 +90,8 @@ void GaussianSplatting::onAttach(nvvkhl::Application* app)
 {
   initGui();
 
+  TraceRecorder::instance().setThreadName("Render");
+
   // starts the asynchronous services
   m_plyLoader.initialize();
   m_cpuSorter.initialize();
@@ -73,16 +101,37 @@ void GaussianSplatting::onAttach(nvvkhl::Application* app)
   m_device = m_app->getDevice();
 
   m_depthFormat = nvvk::findDepthFormat(app->getPhysicalDevice());
+  // subgroup ballot is needed in compute for the compaction in the distance shader
+  VkPhysicalDeviceSubgroupProperties subgroupProperties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES};
+  VkPhysicalDeviceProperties2        properties2{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2};
+  properties2.pNext = &subgroupProperties;
+  vkGetPhysicalDeviceProperties2(app->getPhysicalDevice(), &properties2);
+  m_supportSubgroupBallot = (subgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT)
+                            && (subgroupProperties.supportedOperations & VK_SUBGROUP_FEATURE_BALLOT_BIT);
+  // mesh shaders and fragment barycentrics are optional device extensions (e.g. not exposed by software devices)
+  VkPhysicalDeviceMeshShaderFeaturesEXT meshFeatures{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT};
+  VkPhysicalDeviceFragmentShaderBarycentricFeaturesKHR baryFeatures{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADER_BARYCENTRIC_FEATURES_KHR};
+  VkPhysicalDeviceFeatures2 features2{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+  meshFeatures.pNext = &baryFeatures;
+  features2.pNext    = &meshFeatures;
+  vkGetPhysicalDeviceFeatures2(app->getPhysicalDevice(), &features2);
+  m_supportMeshShader  = meshFeatures.meshShader == VK_TRUE;
+  m_supportBarycentric = baryFeatures.fragmentShaderBarycentric == VK_TRUE;
   // Debug utility
   m_dutil = std::make_unique<nvvk::DebugUtil>(m_device);
   //
   m_dset = std::make_unique<nvvk::DescriptorSetContainer>(m_device);
-  // Memory allocator
+  // Memory allocator, reports the actual heap budgets if VK_EXT_memory_budget
+  // is enabled (Vulkan 1.3 context), an estimate from the heap sizes otherwise
+  VmaAllocatorCreateFlags allocatorFlags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+  if(m_supportMemoryBudget)
+    allocatorFlags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
   m_alloc = std::make_unique<nvvkhl::AllocVma>(VmaAllocatorCreateInfo{
-      .flags          = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT,
-      .physicalDevice = app->getPhysicalDevice(),
-      .device         = app->getDevice(),
-      .instance       = app->getInstance(),
+      .flags            = allocatorFlags,
+      .physicalDevice   = app->getPhysicalDevice(),
+      .device           = app->getDevice(),
+      .instance         = app->getInstance(),
+      .vulkanApiVersion = m_supportMemoryBudget ? VK_API_VERSION_1_3 : VK_API_VERSION_1_0,
   });
 
   // Where to find shader' source code
@@ -94,6 +143,9 @@ void GaussianSplatting::onAttach(nvvkhl::Application* app)
   shaderSearchPaths.push_back(NVPSystem::exePath() + std::string(PROJECT_RELDIRECTORY) + "shaders");
   shaderSearchPaths.push_back(NVPSystem::exePath() + std::string(PROJECT_RELDIRECTORY) + "nvpro_core");
 
+  m_gpuTrace.init(app);
+  m_pipelineStats.init(app);
+
   m_shaderManager.init(m_device, 1, 2);
   m_shaderManager.m_filetype        = nvh::ShaderFileManager::FILETYPE_GLSL;
   m_shaderManager.m_keepModuleSPIRV = true;
@@ -109,7 +161,10 @@ void GaussianSplatting::onDetach()
   m_plyLoader.shutdown();
   m_cpuSorter.shutdown();
   // release resources
+  m_gpuTrace.deinit();
+  m_pipelineStats.deinit();
   deinitAll();
+  m_stagingRing.deinit();
   m_dset->deinit();
   deinitGbuffers();
 }
@@ -117,6 +172,20 @@ void GaussianSplatting::onDetach()
 void GaussianSplatting::onResize(VkCommandBuffer cmd, const VkExtent2D& size)
 {
   initGbuffers({size.width, size.height});
+  // the overdraw image follows the G-Buffer size, the queue is idle at this point
+  if(m_overdrawImage.image != VK_NULL_HANDLE)
+  {
+    deinitOverdrawResources();
+    initOverdrawResources();
+    updateOverdrawDescriptors();
+  }
+  // so do the upscale targets in PC mode
+  if(m_upscaleInput.image != VK_NULL_HANDLE && m_mode == Mode::PC)
+  {
+    deinitUpscaleResources();
+    initUpscaleResources();
+    updateUpscaleDescriptors();
+  }
 }
 
 void GaussianSplatting::initGbuffers(const glm::vec2& size)
@@ -135,15 +204,16 @@ void GaussianSplatting::renderPC(VkCommandBuffer cmd) {
   if(!m_gBuffers)
     return;
 
+  TRACE_SCOPE("renderPC");
   const nvvk::DebugUtil::ScopedCmdLabel sdbg = m_dutil->DBG_SCOPE(cmd);
 
   // collect readback results from previous frame if any
   collectReadBackValuesIfNeeded();
 
   // 0 if not ready so the rendering does not
-  // touch the splat set while loading
+  // touch the splat set while loading, an instance is loaded in its own set
   uint32_t splatCount = 0;
-  if(m_plyLoader.getStatus() == PlyAsyncLoader::State::E_READY)
+  if(m_plyLoader.getStatus() == PlyAsyncLoader::State::E_READY || m_loadingInstance)
   {
     splatCount = (uint32_t)m_splatSet.size();
   }
@@ -151,6 +221,7 @@ void GaussianSplatting::renderPC(VkCommandBuffer cmd) {
   // Handle device-host data update and sorting if a scene exist
   if(splatCount)
   {
+    uploadInstancesIfNeeded(cmd);
     updateAndUploadFrameInfoUBO(cmd, splatCount);
 
     if(m_frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX)
@@ -165,29 +236,55 @@ void GaussianSplatting::renderPC(VkCommandBuffer cmd) {
       tryConsumeAndUploadCpuSortingResult(cmd, splatCount);
     }
   }
-  // Drawing the primitives in the G-Buffer if any
+  // Drawing the primitives in the G-Buffer if any, in the upscale input in reduced resolution
+  const VkExtent2D outputExtent = m_gBuffers->getSize();
+  const VkExtent2D renderExtent = getRenderExtent(0, outputExtent);
+  const bool upscale = renderExtent.width != outputExtent.width || renderExtent.height != outputExtent.height;
   {
     auto timerSection = m_profiler->timeRecurring("Rendering", cmd);
+    auto traceSection = m_gpuTrace.section("Rendering", cmd);
 
-    nvvk::createRenderingInfo r_info({{0, 0}, m_gBuffers->getSize()}, {m_gBuffers->getColorImageView()},
+    const VkImage colorImage = upscale ? m_upscaleInput.image : m_gBuffers->getColorImage();
+    nvvk::createRenderingInfo r_info({{0, 0}, renderExtent},
+                                     {upscale ? m_upscaleInput.descriptor.imageView : m_gBuffers->getColorImageView()},
                                      m_gBuffers->getDepthImageView(), VK_ATTACHMENT_LOAD_OP_CLEAR,
                                      VK_ATTACHMENT_LOAD_OP_CLEAR, m_clearColor);
     r_info.pStencilAttachment = nullptr;
 
-    nvvk::cmdBarrierImageLayout(cmd, m_gBuffers->getColorImage(), VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    if(isOverdrawModeActive())
+      clearOverdraw(cmd);
+
+    nvvk::cmdBarrierImageLayout(cmd, colorImage, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 
     vkCmdBeginRendering(cmd, &r_info);
-    m_app->setViewport(cmd);
+    if(upscale)
+    {
+      VkViewport viewport{0.0F, 0.0F, static_cast<float>(renderExtent.width), static_cast<float>(renderExtent.height), 0.0F, 1.0F};
+      vkCmdSetViewport(cmd, 0, 1, &viewport);
+      VkRect2D scissor{{0, 0}, renderExtent};
+      vkCmdSetScissor(cmd, 0, 1, &scissor);
+    }
+    else
+    {
+      m_app->setViewport(cmd);
+    }
     if(splatCount)
     {
+      auto statsScope = m_pipelineStats.scope(cmd);
       // let's throw some pixels !!
       drawSplatPrimitives(cmd, splatCount);
     }
 
     vkCmdEndRendering(cmd);
-    nvvk::cmdBarrierImageLayout(cmd, m_gBuffers->getColorImage(), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL);
+    nvvk::cmdBarrierImageLayout(cmd, colorImage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL);
   }
 
+  if(upscale)
+    processUpscale(cmd, outputExtent);
+
+  if(isOverdrawModeActive())
+    processOverdraw(cmd);
+
   readBackIndirectParametersIfNeeded(cmd);
 
   updateRenderingMemoryStatistics(cmd, splatCount);
@@ -197,19 +294,23 @@ void GaussianSplatting::renderXR(VkCommandBuffer cmd) {
     // nothing to do here
 }
 
-void GaussianSplatting::renderView(VkCommandBuffer cmd, void* view, void* camera, void* image) {
+void GaussianSplatting::renderView(VkCommandBuffer cmd, void* view, void* camera, void* image, bool mirror, void* depthImage) {
   if(!m_gBuffers)
     return;
 
+  // index of the view in the frame, incremented by the upload of its frame info
+  const uint32_t viewIndex = m_frameViewIndex;
+
+  TRACE_SCOPE("renderView");
   //const nvvk::DebugUtil::ScopedCmdLabel sdbg = m_dutil->DBG_SCOPE(cmd);
 
   // collect readback results from previous frame if any
   collectReadBackValuesIfNeeded();
 
   // 0 if not ready so the rendering does not
-  // touch the splat set while loading
+  // touch the splat set while loading, an instance is loaded in its own set
   uint32_t splatCount = 0;
-  if(m_plyLoader.getStatus() == PlyAsyncLoader::State::E_READY)
+  if(m_plyLoader.getStatus() == PlyAsyncLoader::State::E_READY || m_loadingInstance)
   {
     splatCount = (uint32_t)m_splatSet.size();
   }
@@ -217,6 +318,7 @@ void GaussianSplatting::renderView(VkCommandBuffer cmd, void* view, void* camera
   // Handle device-host data update and sorting if a scene exist
   if(splatCount)
   {
+    uploadInstancesIfNeeded(cmd);
     updateAndUploadFrameInfoUBO(cmd, splatCount, camera);
 
     if(m_frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX)
@@ -232,16 +334,28 @@ void GaussianSplatting::renderView(VkCommandBuffer cmd, void* view, void* camera
     }
   }
   // Drawing the primitives in the G-Buffer if any
-  CameraConstants* cameraXR = (CameraConstants*)camera;
-  VkExtent2D       extent   = {(uint32_t)cameraXR->viewport.width, (uint32_t)cameraXR->viewport.height};
+  CameraConstants* cameraXR   = (CameraConstants*)camera;
+  const VkExtent2D viewExtent = {(uint32_t)cameraXR->viewport.width, (uint32_t)cameraXR->viewport.height};
+  const VkExtent2D extent     = getRenderExtent(viewIndex, viewExtent);
+  const bool       upscale    = extent.width != viewExtent.width || extent.height != viewExtent.height;
+  const bool       xrDepth    = depthImage && m_xrDepthBuffer.buffer != VK_NULL_HANDLE
+                       && extent.width <= m_xrDepthExtent.width && extent.height <= m_xrDepthExtent.height;
+  if(xrDepth)
+  {
+    clearXrDepth(cmd);
+  }
   {
     auto timerSection = m_profiler->timeRecurring("Rendering", cmd);
+    auto traceSection = m_gpuTrace.section("Rendering", cmd);
     
-    nvvk::createRenderingInfo r_info({{0, 0}, extent}, {(VkImageView)view}, nullptr, VK_ATTACHMENT_LOAD_OP_CLEAR,
-                                     VK_ATTACHMENT_LOAD_OP_CLEAR, m_clearColor);
+    nvvk::createRenderingInfo r_info({{0, 0}, extent}, {upscale ? m_upscaleInput.descriptor.imageView : (VkImageView)view},
+                                     nullptr, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_LOAD_OP_CLEAR, m_clearColor);
     r_info.pStencilAttachment = nullptr;
     r_info.pDepthAttachment   = nullptr;
 
+    if(upscale)
+      nvvk::cmdBarrierImageLayout(cmd, m_upscaleInput.image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
     vkCmdBeginRendering(cmd, &r_info);
     VkViewport viewport{0.0F, 0.0F, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0F, 1.0F};
     vkCmdSetViewport(cmd, 0, 1, &viewport);
@@ -250,21 +364,33 @@ void GaussianSplatting::renderView(VkCommandBuffer cmd, void* view, void* camera
     vkCmdSetScissor(cmd, 0, 1, &scissor);
     if(splatCount)
     {
+      auto statsScope = m_pipelineStats.scope(cmd);
       // let's throw some pixels !!
       drawSplatPrimitives(cmd, splatCount);
     }
 
     vkCmdEndRendering(cmd);
+    if(upscale)
+      nvvk::cmdBarrierImageLayout(cmd, m_upscaleInput.image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL);
   }
-  if(image) // let's blit image
+  if(xrDepth)
+  {
+    copyXrDepth(cmd, (VkImage)depthImage, extent);
+  }
+  if(upscale)
+  {
+    processUpscale(cmd, viewExtent);
+    copyUpscaleOutput(cmd, (VkImage)image, viewExtent);
+  }
+  if(mirror && image)  // let's blit image, downsampled to the mirror resolution
   {
     nvvk::cmdBarrierImageLayout(cmd, m_gBuffers->getColorImage(), VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
     nvvk::cmdBarrierImageLayout(cmd, (VkImage)image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
     
-    const glm::vec2   sourceResolution  = {static_cast<float>(extent.width), static_cast<float>(extent.height)};
+    const glm::vec2   sourceResolution  = {static_cast<float>(viewExtent.width), static_cast<float>(viewExtent.height)};
     const float      sourceAspectRatio = sourceResolution.x / sourceResolution.y;
     const VkExtent2D gResolution          = m_gBuffers->getSize();
-    const glm::vec2 destinationResolution = {static_cast<float>(gResolution.width), static_cast<float>(gResolution.height)};
+    const glm::vec2  destinationResolution = glm::max(glm::vec2(gResolution.width, gResolution.height) * m_mirrorScale, glm::vec2(1.0f));
     const float     destinationAspectRatio = destinationResolution.x / destinationResolution.y;
     glm::vec2       cropResolution = sourceResolution, cropOffset = {0.0f, 0.0f};
 
@@ -296,8 +422,17 @@ void GaussianSplatting::renderView(VkCommandBuffer cmd, void* view, void* camera
     imageBlit.dstSubresource.baseArrayLayer = 0u;
     imageBlit.dstSubresource.layerCount     = 1u;
 
+    // the viewport only presents the blitted region, the rest is cleared so no stale
+    // desktop frame remains when the mirror scale changes
+    const VkImageSubresourceRange range{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    vkCmdClearColorImage(cmd, m_gBuffers->getColorImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &m_clearColor, 1, &range);
+    const VkMemoryBarrier clearBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER, nullptr, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT};
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
     vkCmdBlitImage(cmd, (VkImage)image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_gBuffers->getColorImage(),
-                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1u, &imageBlit, VK_FILTER_NEAREST);
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1u, &imageBlit, VK_FILTER_LINEAR);
+    m_mirrorUvMax = {static_cast<float>(imageBlit.dstOffsets[1].x) / static_cast<float>(gResolution.width),
+                     static_cast<float>(imageBlit.dstOffsets[1].y) / static_cast<float>(gResolution.height)};
 
     nvvk::cmdBarrierImageLayout(cmd, m_gBuffers->getColorImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL);
     nvvk::cmdBarrierImageLayout(cmd, (VkImage)image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
@@ -308,20 +443,51 @@ void GaussianSplatting::renderView(VkCommandBuffer cmd, void* view, void* camera
   updateRenderingMemoryStatistics(cmd, splatCount);
 }
 
+void GaussianSplatting::setMode(Mode mode)
+{
+  if(mode == m_mode)
+    return;
+  m_mode = mode;
+  // the head poses of a previous session must not be extrapolated
+  m_xrHeadPoses.reset();
+
+  if(m_mode == Mode::XR)
+  {
+    const int shFormat = m_defines.shFormat;
+    m_defines.adjust4xr();
+    // the SH are stored in the data format
+    if(m_defines.shFormat != shFormat)
+      m_updateData = true;
+  }
+  // gamma correction depends on the mode and on the headset swapchain format
+  m_updateShaders = true;
+}
+
 void GaussianSplatting::onRender(VkCommandBuffer cmd)
 {
-  switch(m_mode)
+  if(!m_benchSettings.enabled || benchmarkStep())
   {
-    case PC:
-      renderPC(cmd);
-      break;
-    case XR:
-      renderXR(cmd);
-      break;
-    default:
-      break;
+    switch(m_mode)
+    {
+      case PC:
+        renderPC(cmd);
+        break;
+      case XR:
+        renderXR(cmd);
+        break;
+      default:
+        break;
+    }
   }
-  
+
+  // called once per frame in both modes, XR views are recorded before in the same command buffer
+  m_frameViewIndex = 0;
+  m_frameIndex++;
+  m_gpuTrace.endFrame(cmd);
+  m_pipelineStats.endFrame(cmd);
+  // in XR the frame ends after xrEndFrame, see AppCtrl::runXR
+  if(m_mode != Mode::XR)
+    TraceRecorder::instance().endFrame();
 }
 
 void GaussianSplatting::updateAndUploadFrameInfoUBO(VkCommandBuffer cmd, const uint32_t splatCount, const void* data)
@@ -337,23 +503,27 @@ void GaussianSplatting::updateAndUploadFrameInfoUBO(VkCommandBuffer cmd, const u
   {
     m_frameInfo.timestamp = 0.0f;
   }
+  // culls of the frame governor, the importance thresholds are per splat budget level
+  m_frameInfo.minSplatContribution = m_governor.getContributionThreshold();
+  m_frameInfo.shDegreeCap          = m_governor.getShDegreeCap();
+  m_frameInfo.minSplatImportance =
+      m_importanceThresholds.empty() ? 0.0f : m_importanceThresholds[m_governor.getLevel(KNOB_SPLAT_BUDGET)];
   // auto timerSection = m_profiler->timeRecurring("UBO update", cmd);
-  CameraConstants* cameraXR    = (CameraConstants*)data;
-  auto             screen_size = data ? glm::vec2((float)cameraXR->viewport.width, (float)cameraXR->viewport.height) :
-                                        glm::vec2(m_viewSize.x, m_viewSize.y);
-  const float      aspectRatio = screen_size.x / screen_size.y;
+  m_frameInfo.splatCount       = splatCount;
+  m_frameInfo.orthoZoom        = 1.0f;
+  m_frameInfo.orthographicMode = 0;  // disabled (uses perspective) TODO: activate support for orthographic
+  const uint32_t view          = m_frameViewIndex++;
   if(data)
   {
-    memcpy(&m_frameInfo, data, 16 * 4 * 2 + 4 * 3);  // proj view pos
-    m_loadedSceneParamsViewMat = cameraXR->head;
-    m_frameInfo.viewMatrix     = m_frameInfo.viewMatrix * m_loadedSceneParamsViewMat;
-    //m_frameInfo.projectionMatrix[1][1] *= -1;
-    //glm::mat4 matrix        = glm::mat4(1.0f);
-    //glm::mat4 rotatedMatrix = glm::rotate(matrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-    //m_frameInfo.viewMatrix  = rotatedMatrix * m_frameInfo.viewMatrix;
+    setFrameInfoCamera(m_frameInfo, data, view);
   }
   else
   {
+    // the splats are projected on the rendered area, smaller than the view in reduced resolution rendering
+    const VkExtent2D outputExtent = {(uint32_t)m_viewSize.x, (uint32_t)m_viewSize.y};
+    const VkExtent2D renderExtent = getRenderExtent(0, outputExtent);
+    const glm::vec2  screen_size  = glm::vec2(renderExtent.width, renderExtent.height);
+    const float      aspectRatio  = m_viewSize.x / m_viewSize.y;
     CameraManip.getLookat(m_eye, m_center, m_up);
     // Update frame parameters uniform buffer
     // some attributes of frameInfo were set by the user interface
@@ -363,36 +533,93 @@ void GaussianSplatting::updateAndUploadFrameInfoUBO(VkCommandBuffer cmd, const u
     // OpenGL (0,0) is bottom left, Vulkan (0,0) is top left, and glm::perspectiveRH_ZO is for OpenGL so we mirror on y
     m_frameInfo.projectionMatrix[1][1] *= -1;
     m_frameInfo.cameraPosition = m_eye;
+
+    const float focalLengthX           = m_frameInfo.projectionMatrix[0][0] * 0.5f * screen_size.x;
+    const float focalLengthY           = m_frameInfo.projectionMatrix[1][1] * 0.5f * screen_size.y;
+    m_frameInfo.basisViewport          = glm::vec2(1.0f / screen_size.x, 1.0f / screen_size.y);
+    m_frameInfo.focal                  = glm::vec2(focalLengthX, focalLengthY);
+    m_frameInfo.inverseFocalAdjustment = 1.0f;
+    m_frameInfo.renderExtent           = glm::ivec2(renderExtent.width, renderExtent.height);
+    m_frameInfo.outputExtent           = glm::ivec2(outputExtent.width, outputExtent.height);
+    setFrameInfoFovea(m_frameInfo);
   }
 
-  float       devicePixelRatio       = 1.0;
-  const float focalLengthX           = m_frameInfo.projectionMatrix[0][0] * 0.5f * devicePixelRatio * screen_size.x;
-  const float focalLengthY           = m_frameInfo.projectionMatrix[1][1] * 0.5f * devicePixelRatio * screen_size.y;
-  const bool  isOrthographicCamera   = false;
-  const float focalMultiplier        = isOrthographicCamera ? (1.0f / devicePixelRatio) : 1.0f;
-  const float focalAdjustment        = focalMultiplier;  //  this.focalAdjustment* focalMultiplier;
-  m_frameInfo.splatCount             = splatCount;
-  m_frameInfo.orthoZoom              = 1.0f;
-  m_frameInfo.orthographicMode       = 0;  // disabled (uses perspective) TODO: activate support for orthographic
-  m_frameInfo.basisViewport          = glm::vec2(1.0f / screen_size.x, 1.0f / screen_size.y);
-  m_frameInfo.focal                  = glm::vec2(focalLengthX, focalLengthY);
-  m_frameInfo.inverseFocalAdjustment = 1.0f / focalAdjustment;
+  // each view of the frame has its own slot, the slots of the frame are not in use by the device
+  // since the application waited for the completion of the previous use of the frame resources.
+  // Host coherent writes done before the submission are visible to the device, no barrier needed.
+  memcpy(getFrameInfoSlot(view), &m_frameInfo, sizeof(shaderio::FrameInfo));
+  m_frameInfoOffset = uint32_t((uint8_t*)getFrameInfoSlot(view) - m_frameInfoMapped);
+}
 
-  vkCmdUpdateBuffer(cmd, m_frameInfoBuffer.buffer, 0, sizeof(shaderio::FrameInfo), &m_frameInfo);
+void GaussianSplatting::setFrameInfoCamera(shaderio::FrameInfo& frameInfo, const void* camera, uint32_t view)
+{
+  const CameraConstants* cameraXR     = (const CameraConstants*)camera;
+  const VkExtent2D       outputExtent = {(uint32_t)cameraXR->viewport.width, (uint32_t)cameraXR->viewport.height};
+  const VkExtent2D       renderExtent = getRenderExtent(view, outputExtent);
+  const glm::vec2        screen_size  = glm::vec2(renderExtent.width, renderExtent.height);
+
+  memcpy(&frameInfo, camera, 16 * 4 * 2 + 4 * 3);  // proj view pos
+  m_loadedSceneParamsViewMat = cameraXR->head;
+  frameInfo.viewMatrix       = frameInfo.viewMatrix * m_loadedSceneParamsViewMat;
+
+  const float focalLengthX         = frameInfo.projectionMatrix[0][0] * 0.5f * screen_size.x;
+  const float focalLengthY         = frameInfo.projectionMatrix[1][1] * 0.5f * screen_size.y;
+  frameInfo.basisViewport          = glm::vec2(1.0f / screen_size.x, 1.0f / screen_size.y);
+  frameInfo.focal                  = glm::vec2(focalLengthX, focalLengthY);
+  frameInfo.inverseFocalAdjustment = 1.0f;
+  frameInfo.renderExtent           = glm::ivec2(renderExtent.width, renderExtent.height);
+  frameInfo.outputExtent           = glm::ivec2(outputExtent.width, outputExtent.height);
+  setFrameInfoFovea(frameInfo);
+}
 
-  // sync with end of copy to device
-  VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
-  barrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
-  barrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT;
+void GaussianSplatting::setFrameInfoFovea(shaderio::FrameInfo& frameInfo) const
+{
+  if(!m_defines.foveation)
+  {
+    frameInfo.foveaOuterRadius = 0.0f;
+    frameInfo.foveaShDegree    = 3;
+    return;
+  }
+  // the XR projections are asymmetric, the view direction is not at the center of the image
+  const glm::vec4 center         = frameInfo.projectionMatrix * glm::vec4(0.0f, 0.0f, -1.0f, 1.0f);
+  frameInfo.foveaCenter          = glm::vec2(center) / center.w;
+  frameInfo.foveaInnerRadius     = m_defines.foveaInnerRadius;
+  frameInfo.foveaOuterRadius     = std::max(m_defines.foveaOuterRadius, m_defines.foveaInnerRadius + 0.01f);
+  frameInfo.foveaMinContribution = m_defines.foveaMinContribution;
+  frameInfo.foveaMinRadius       = m_defines.foveaMinRadius;
+  frameInfo.foveaShDegree        = m_defines.foveaShDegree;
+}
 
-  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
-                           | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT,
-                       0, 1, &barrier, 0, NULL, 0, NULL);
+VkExtent2D GaussianSplatting::getRenderExtent(uint32_t view, const VkExtent2D& extent) const
+{
+  // the upscale targets are built with the pipelines, full resolution until then
+  const VkExtent2D targetExtent = m_mode == Mode::XR ? m_xrViewExtent : (m_gBuffers ? m_gBuffers->getSize() : VkExtent2D{0, 0});
+  if(m_upscalePipeline == VK_NULL_HANDLE || extent.width > targetExtent.width || extent.height > targetExtent.height)
+    return extent;
+
+  const float userScale = m_defines.upscaling ? m_defines.renderScale[std::min(view, 1u)] : 1.0f;
+  const float scale     = std::clamp(userScale * m_governor.getRenderScaleFactor(), MIN_RENDER_SCALE, 1.0f);
+  return {std::max(1u, (uint32_t)(extent.width * scale + 0.5f)), std::max(1u, (uint32_t)(extent.height * scale + 0.5f))};
+}
+
+void GaussianSplatting::latchViewCamera(uint32_t view, const void* camera)
+{
+  if(m_frameInfoMapped == nullptr || view >= FRAME_INFO_MAX_VIEWS)
+    return;
+  // the device reads the slot at execution, m_frameInfo keeps the camera the sort was computed with.
+  // the slot is patched from a host copy, the mapped memory may be write combined
+  shaderio::FrameInfo frameInfo = m_frameInfo;
+  setFrameInfoCamera(frameInfo, camera, view);
+  memcpy(getFrameInfoSlot(view), &frameInfo, sizeof(shaderio::FrameInfo));
 }
 
 void GaussianSplatting::tryConsumeAndUploadCpuSortingResult(VkCommandBuffer cmd, const uint32_t splatCount)
 {
+  TRACE_SCOPE("tryConsumeAndUploadCpuSortingResult");
+
+  // the CPU sorter overwrites the indices, GPU sorting must restart from scratch
+  m_gpuLastSort.valid = false;
+
   // upload CPU sorted indices to the GPU if needed
   bool newIndexAvailable = false;
 
@@ -400,19 +627,34 @@ void GaussianSplatting::tryConsumeAndUploadCpuSortingResult(VkCommandBuffer cmd,
   {
     // 1. Splatting/blending is on, we check for a newly sorted index table
     auto status = m_cpuSorter.getStatus();
-    if(status != SplatSorterAsync::E_SORTING)
+    if(!m_cpuSorter.isSorting())
     {
       // sorter is sleeping, we can work on shared data
       // we take into account the result of the sort
       if(status == SplatSorterAsync::E_SORTED)
       {
         m_cpuSorter.consume(m_splatIndices, m_distTime, m_sortTime);
-        newIndexAvailable = true;
+        // a sort started before an instance was added does not cover the whole set
+        newIndexAvailable = m_splatIndices.size() == splatCount;
+        // the latency drives the horizon of the pose prediction of the next sorts
+        m_cpuSortLatency = glm::mix(m_cpuSortLatency, float(m_frameIndex - m_cpuSortStartFrame), 0.2f);
+        TraceRecorder::instance().addInstant("Sort result consumed");
       }
 
       // let's wakeup the sorting thread to run a new sort if needed
       // will start work only if camera direction or position has changed
-      m_cpuSorter.sortAsync(glm::normalize(m_center - m_eye), m_eye, m_splatSet.positions, m_cpuLazySort);
+      glm::vec3 camDir, camCop;
+      getCpuSortViewpoint(camDir, camCop);
+      // the instances moved or changed, the sort must restart even if the viewpoint did not
+      const bool lazy = m_cpuLazySort && !m_sortPositionsDirty;
+      if(m_sortPositionsDirty)
+      {
+        updateSortPositions();
+        m_sortPositionsDirty = false;
+      }
+      std::vector<float>& positions = m_sceneInstancing ? m_sortPositions : m_splatSet.positions;
+      if(m_cpuSorter.sortAsync(camDir, camCop, positions, lazy))
+        m_cpuSortStartFrame = m_frameIndex;
     }
   }
   else
@@ -437,6 +679,7 @@ void GaussianSplatting::tryConsumeAndUploadCpuSortingResult(VkCommandBuffer cmd,
   // 2. upload to GPU is needed
   {
     auto timerSection = m_profiler->timeRecurring("Copy indices to GPU", cmd);
+    auto traceSection = m_gpuTrace.section("Copy indices to GPU", cmd);
 
     if(newIndexAvailable)
     {
@@ -453,15 +696,100 @@ void GaussianSplatting::tryConsumeAndUploadCpuSortingResult(VkCommandBuffer cmd,
       barrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT;
 
       vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                           VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT,
+                           VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | meshShaderStage(),
                            0, 1, &barrier, 0, NULL, 0, NULL);
     }
   }
 }
 
+void GaussianSplatting::setXrHeadPose(double displayTime, double displayPeriod, const PosePredictor::Pose& pose)
+{
+  m_xrHeadPoses.addSample(displayTime, pose);
+  m_xrDisplayTime   = displayTime;
+  m_xrDisplayPeriod = displayPeriod;
+}
+
+void GaussianSplatting::getCpuSortViewpoint(glm::vec3& camDir, glm::vec3& camCop) const
+{
+  if(m_mode != Mode::XR || !m_xrHeadPoses.isValid())
+  {
+    camDir = glm::normalize(m_center - m_eye);
+    camCop = m_eye;
+    return;
+  }
+  // the result is displayed from the frame expected to consume it
+  const double displayTime = m_xrDisplayTime + (m_cpuSortPrediction ? m_cpuSortLatency * m_xrDisplayPeriod : 0.0);
+  const PosePredictor::Pose pose = m_xrHeadPoses.predict(displayTime, MAX_PREDICTION_HORIZON);
+  // from the local space to the scene, the inverse of the locomotion matrix of the views,
+  // the shaders scale the splat positions by the scene scale
+  const glm::mat4 localToScene = glm::inverse(m_loadedSceneParamsViewMat);
+  camCop = glm::vec3(localToScene * glm::vec4(pose.position, 1.0f)) / m_frameInfo.sceneScale;
+  camDir = glm::normalize(glm::mat3(localToScene) * (pose.orientation * glm::vec3(0.0f, 0.0f, -1.0f)));
+}
+
+bool GaussianSplatting::isGpuSortNeeded(const uint32_t splatCount)
+{
+  m_gpuSortFrame++;
+
+  const auto& last = m_gpuLastSort;
+  // view of the frame info just uploaded. The views share the indices and the frustum cull of the
+  // distance pass, so a sort made for another view (the other eye in XR) cannot be reused
+  const uint32_t view = m_frameViewIndex > 0 ? m_frameViewIndex - 1 : 0;
+
+  bool needed = !last.valid || m_gpuSortPolicy == GPU_SORT_ALWAYS || last.view != view || last.splatCount != splatCount
+                || last.sceneScale != m_frameInfo.sceneScale || last.frustumDilation != m_frameInfo.frustumDilation;
+
+  if(!needed)
+  {
+    switch(m_gpuSortPolicy)
+    {
+      case GPU_SORT_LAZY:
+        needed = last.viewMatrix != m_frameInfo.viewMatrix || last.projectionMatrix != m_frameInfo.projectionMatrix
+                 || (m_gsMode != GSMode_3DGS && last.timestamp != m_frameInfo.timestamp);
+        break;
+      case GPU_SORT_EVERY_N:
+        needed = m_gpuSortFrame - last.frame >= std::max(1u, m_gpuSortInterval);
+        break;
+      case GPU_SORT_ON_THRESHOLD: {
+        // compare camera position and viewing direction in world space
+        const glm::mat4 lastCamera    = glm::inverse(last.viewMatrix);
+        const glm::mat4 currentCamera = glm::inverse(m_frameInfo.viewMatrix);
+        const float     distance      = glm::distance(glm::vec3(lastCamera[3]), glm::vec3(currentCamera[3]));
+        const float     cosAngle      = glm::dot(glm::normalize(glm::vec3(lastCamera[2])), glm::normalize(glm::vec3(currentCamera[2])));
+        const float     angle         = glm::degrees(std::acos(glm::clamp(cosAngle, -1.0f, 1.0f)));
+        needed = last.projectionMatrix != m_frameInfo.projectionMatrix || distance > m_gpuSortDistanceThreshold
+                 || angle > m_gpuSortAngleThreshold;
+      }
+      break;
+      default:
+        needed = true;
+        break;
+    }
+  }
+
+  if(needed)
+  {
+    m_gpuLastSort = {.valid            = true,
+                     .frame            = m_gpuSortFrame,
+                     .view             = view,
+                     .splatCount       = splatCount,
+                     .viewMatrix       = m_frameInfo.viewMatrix,
+                     .projectionMatrix = m_frameInfo.projectionMatrix,
+                     .sceneScale       = m_frameInfo.sceneScale,
+                     .frustumDilation  = m_frameInfo.frustumDilation,
+                     .timestamp        = m_frameInfo.timestamp};
+  }
+
+  return needed;
+}
+
 void GaussianSplatting::processSortingOnGPU(VkCommandBuffer cmd, const uint32_t splatCount)
 {
-  // when GPU sorting, we sort at each frame, all buffer in device memory, no copy from RAM
+  // when GPU sorting, all buffer in device memory, no copy from RAM.
+  // depending on the sorting policy, we may reuse the results of the previous sort
+  m_gpuSortSkipped = !isGpuSortNeeded(splatCount);
+  if(m_gpuSortSkipped)
+    return;
 
   // 1. reset the draw indirect parameters and counters, will be updated by compute shader
   {
@@ -473,7 +801,7 @@ void GaussianSplatting::processSortingOnGPU(VkCommandBuffer cmd, const uint32_t
     barrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT;
 
     vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | meshShaderStage() | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
                          0, 1, &barrier, 0, NULL, 0, NULL);
   }
 
@@ -484,38 +812,41 @@ void GaussianSplatting::processSortingOnGPU(VkCommandBuffer cmd, const uint32_t
   // 2. invoke the distance compute shader
   {
     auto timerSection = m_profiler->timeRecurring("GPU Dist", cmd);
+    auto traceSection = m_gpuTrace.section("GPU Dist", cmd);
 
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
-    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_dset->getPipeLayout(), 0, 1, m_dset->getSets(), 0, nullptr);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_dset->getPipeLayout(), 0, 1, m_dset->getSets(), 1, &m_frameInfoOffset);
 
     vkCmdDispatch(cmd, (splatCount + DISTANCE_COMPUTE_WORKGROUP_SIZE - 1) / DISTANCE_COMPUTE_WORKGROUP_SIZE, 1, 1);
 
     vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | meshShaderStage() | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
                          0, 1, &barrier, 0, NULL, 0, NULL);
   }
 
   // 3. invoke the radix sort from vrdx lib
   {
     auto timerSection = m_profiler->timeRecurring("GPU Sort", cmd);
+    auto traceSection = m_gpuTrace.section("GPU Sort", cmd);
 
     vrdxCmdSortKeyValueIndirect(cmd, m_gpuSorter, splatCount, m_indirect.buffer,
                                 offsetof(shaderio::IndirectParams, instanceCount), m_splatDistancesDevice.buffer, 0,
                                 m_splatIndicesDevice.buffer, 0, m_vrdxStorageDevice.buffer, 0, 0, 0);
 
     vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                         VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                         VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | meshShaderStage() | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
                          0, 1, &barrier, 0, NULL, 0, NULL);
   }
 }
 
 void GaussianSplatting::drawSplatPrimitives(VkCommandBuffer cmd, const uint32_t splatCount)
 {
-  if(m_selectedPipeline == PIPELINE_VERT)
+  // falls back to the vertex shader pipeline if mesh shaders are not supported by the device
+  if(m_selectedPipeline == PIPELINE_VERT || !m_supportMeshShader)
   {  // Pipeline using vertex shader
 
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
-    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_dset->getPipeLayout(), 0, 1, m_dset->getSets(), 0, nullptr);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_dset->getPipeLayout(), 0, 1, m_dset->getSets(), 1, &m_frameInfoOffset);
     // overrides the pipeline setup for depth test/write
     vkCmdSetDepthTestEnable(cmd, (VkBool32)m_defines.opacityGaussianDisabled);
 
@@ -538,7 +869,7 @@ void GaussianSplatting::drawSplatPrimitives(VkCommandBuffer cmd, const uint32_t
   {  // Pipeline using mesh shader
 
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineMesh);
-    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_dset->getPipeLayout(), 0, 1, m_dset->getSets(), 0, nullptr);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_dset->getPipeLayout(), 0, 1, m_dset->getSets(), 1, &m_frameInfoOffset);
     // overrides the pipeline setup for depth test/write
     vkCmdSetDepthTestEnable(cmd, (VkBool32)m_defines.opacityGaussianDisabled);
     if(m_frameInfo.sortingMethod != SORTING_GPU_SYNC_RADIX)
@@ -570,6 +901,7 @@ void GaussianSplatting::readBackIndirectParametersIfNeeded(VkCommandBuffer cmd)
   if(m_indirectReadbackHost.buffer != VK_NULL_HANDLE && m_frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX)
   {
     auto timerSection = m_profiler->timeRecurring("Indirect readback", cmd);
+    auto traceSection = m_gpuTrace.section("Indirect readback", cmd);
 
     // ensures m_indirect buffer modified by GPU sort is available for transfer
     VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
@@ -617,18 +949,331 @@ void GaussianSplatting::updateRenderingMemoryStatistics(VkCommandBuffer cmd, con
       m_renderMemoryStats.usedIndirect = sizeof(shaderio::IndirectParams);
     }
   }
-  m_renderMemoryStats.usedUboFrameInfo = sizeof(shaderio::FrameInfo);
+  m_renderMemoryStats.usedUboFrameInfo = m_frameInfoSlotStride * FRAME_INFO_MAX_VIEWS * m_app->getFrameCycleSize();
 
-  m_renderMemoryStats.hostTotal =
-      m_renderMemoryStats.hostAllocIndices + m_renderMemoryStats.hostAllocDistances + m_renderMemoryStats.usedUboFrameInfo;
+  m_renderMemoryStats.hostTotal = m_renderMemoryStats.hostAllocIndices + m_renderMemoryStats.hostAllocDistances
+                                  + m_renderMemoryStats.usedUboFrameInfo + m_renderMemoryStats.hostAllocOverdraw;
 
-  uint32_t vrdxSize = m_frameInfo.sortingMethod != SORTING_GPU_SYNC_RADIX ? 0 : m_renderMemoryStats.allocVdrxInternal;
+  uint64_t vrdxSize = m_frameInfo.sortingMethod != SORTING_GPU_SYNC_RADIX ? 0 : m_renderMemoryStats.allocVdrxInternal;
 
   m_renderMemoryStats.deviceUsedTotal = m_renderMemoryStats.usedIndices + m_renderMemoryStats.usedDistances + vrdxSize
-                                        + m_renderMemoryStats.usedIndirect + m_renderMemoryStats.usedUboFrameInfo;
+                                        + m_renderMemoryStats.usedIndirect + m_renderMemoryStats.usedUboFrameInfo
+                                        + m_renderMemoryStats.allocOverdraw + m_renderMemoryStats.allocUpscale;
 
   m_renderMemoryStats.deviceAllocTotal = m_renderMemoryStats.allocIndices + m_renderMemoryStats.allocDistances + vrdxSize
-                                         + m_renderMemoryStats.usedIndirect + m_renderMemoryStats.usedUboFrameInfo;
+                                         + m_renderMemoryStats.usedIndirect + m_renderMemoryStats.usedUboFrameInfo
+                                         + m_renderMemoryStats.allocOverdraw + m_renderMemoryStats.allocUpscale;
+
+  updateHeapBudgets();
+}
+
+void GaussianSplatting::initOverdrawResources()
+{
+  if(!m_gBuffers)
+    return;
+
+  const VkExtent2D size = m_gBuffers->getSize();
+
+  VkImageCreateInfo imageInfo =
+      nvvk::makeImage2DCreateInfo(size, VK_FORMAT_R32_UINT, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+  nvvk::Image image = m_alloc->createImage(imageInfo);
+  m_dutil->setObjectName(image.image, "OverdrawImage");
+  VkImageViewCreateInfo viewInfo = nvvk::makeImage2DViewCreateInfo(image.image, VK_FORMAT_R32_UINT);
+  m_overdrawImage                = m_alloc->createTexture(image, viewInfo);
+  m_overdrawImage.descriptor.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+  // the image stays in general layout, used by the fragment and compute shaders
+  VkCommandBuffer cmd = m_app->createTempCmdBuffer();
+  nvvk::cmdBarrierImageLayout(cmd, m_overdrawImage.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+  m_app->submitAndWaitTempCmdBuffer(cmd);
+
+  m_overdrawStatsDevice = m_alloc->createBuffer(sizeof(shaderio::OverdrawStats),
+                                                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+                                                    | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+
+  // one more slot than frames in flight, so a slot is always completed when read
+  m_overdrawSlotPending.assign(m_app->getFrameCycleSize() + 1, false);
+  m_overdrawSlot       = 0;
+  m_overdrawStatsValid = false;
+  m_overdrawStatsHost  = m_alloc->createBuffer(m_overdrawSlotPending.size() * sizeof(shaderio::OverdrawStats),
+                                               VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+  m_dutil->DBG_NAME(m_overdrawStatsDevice.buffer);
+  m_dutil->DBG_NAME(m_overdrawStatsHost.buffer);
+
+  m_renderMemoryStats.allocOverdraw     = (uint64_t)size.width * size.height * sizeof(uint32_t) + sizeof(shaderio::OverdrawStats);
+  m_renderMemoryStats.hostAllocOverdraw = m_overdrawSlotPending.size() * sizeof(shaderio::OverdrawStats);
+}
+
+void GaussianSplatting::deinitOverdrawResources()
+{
+  m_alloc->destroy(m_overdrawImage);
+  m_alloc->destroy(const_cast<nvvk::Buffer&>(m_overdrawStatsDevice));
+  m_alloc->destroy(const_cast<nvvk::Buffer&>(m_overdrawStatsHost));
+  m_overdrawSlotPending.clear();
+  m_overdrawStatsValid                  = false;
+  m_renderMemoryStats.allocOverdraw     = 0;
+  m_renderMemoryStats.hostAllocOverdraw = 0;
+}
+
+void GaussianSplatting::updateOverdrawDescriptors()
+{
+  if(m_overdrawImage.image == VK_NULL_HANDLE)
+    return;
+
+  std::vector<VkWriteDescriptorSet> writes;
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_OVERDRAW_IMAGE, &m_overdrawImage.descriptor));
+  const VkDescriptorBufferInfo stats_desc{m_overdrawStatsDevice.buffer, 0, VK_WHOLE_SIZE};
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_OVERDRAW_STATS_BUFFER, &stats_desc));
+  const VkDescriptorImageInfo output_desc = m_gBuffers->getDescriptorImageInfo();
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_OVERDRAW_OUTPUT_IMAGE, &output_desc));
+  vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+void GaussianSplatting::clearOverdraw(VkCommandBuffer cmd)
+{
+  if(m_overdrawImage.image == VK_NULL_HANDLE)
+    return;
+
+  const VkClearColorValue       zero{};
+  const VkImageSubresourceRange range{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+  vkCmdClearColorImage(cmd, m_overdrawImage.image, VK_IMAGE_LAYOUT_GENERAL, &zero, 1, &range);
+  vkCmdFillBuffer(cmd, m_overdrawStatsDevice.buffer, 0, sizeof(shaderio::OverdrawStats), 0);
+
+  VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+  barrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0,
+                       NULL, 0, NULL);
+}
+
+void GaussianSplatting::processOverdraw(VkCommandBuffer cmd)
+{
+  if(m_overdrawImage.image == VK_NULL_HANDLE || m_overdrawPipeline == VK_NULL_HANDLE)
+    return;
+
+  auto timerSection = m_profiler->timeRecurring("Overdraw", cmd);
+  auto traceSection = m_gpuTrace.section("Overdraw", cmd);
+
+  // fragment counts and splat colors are written before the compute pass reads them and overwrites the colors
+  {
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, NULL, 0, NULL);
+  }
+
+  const VkExtent2D size = m_gBuffers->getSize();
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_overdrawPipeline);
+  vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_dset->getPipeLayout(), 0, 1, m_dset->getSets(), 1, &m_frameInfoOffset);
+  vkCmdDispatch(cmd, (size.width + OVERDRAW_COMPUTE_WORKGROUP_SIZE - 1) / OVERDRAW_COMPUTE_WORKGROUP_SIZE,
+                (size.height + OVERDRAW_COMPUTE_WORKGROUP_SIZE - 1) / OVERDRAW_COMPUTE_WORKGROUP_SIZE, 1);
+
+  // the heatmap is then displayed by the UI and the summary copied for readback
+  {
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, NULL,
+                         0, NULL);
+  }
+
+  // the slot was written one frame cycle ago, its command buffer is completed
+  const VkDeviceSize slotOffset = m_overdrawSlot * sizeof(shaderio::OverdrawStats);
+  if(m_overdrawSlotPending[m_overdrawSlot])
+  {
+    const auto* hostBuffer = static_cast<const uint8_t*>(m_alloc->map(m_overdrawStatsHost));
+    std::memcpy((void*)&m_overdrawStats, hostBuffer + slotOffset, sizeof(shaderio::OverdrawStats));
+    m_alloc->unmap(m_overdrawStatsHost);
+    m_overdrawStatsValid = true;
+  }
+
+  VkBufferCopy bc{.srcOffset = 0, .dstOffset = slotOffset, .size = sizeof(shaderio::OverdrawStats)};
+  vkCmdCopyBuffer(cmd, m_overdrawStatsDevice.buffer, m_overdrawStatsHost.buffer, 1, &bc);
+
+  m_overdrawSlotPending[m_overdrawSlot] = true;
+  m_overdrawSlot                        = (m_overdrawSlot + 1) % (uint32_t)m_overdrawSlotPending.size();
+}
+
+void GaussianSplatting::initXrDepthResources()
+{
+  const VkDeviceSize size = (VkDeviceSize)m_xrDepthExtent.width * m_xrDepthExtent.height * sizeof(float);
+  m_xrDepthBuffer         = m_alloc->createBuffer(size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+                                                            | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+  m_dutil->DBG_NAME(m_xrDepthBuffer.buffer);
+
+  const VkDescriptorBufferInfo depth_desc{m_xrDepthBuffer.buffer, 0, VK_WHOLE_SIZE};
+  VkWriteDescriptorSet         write = m_dset->makeWrite(0, BINDING_XR_DEPTH_BUFFER, &depth_desc);
+  vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+}
+
+void GaussianSplatting::deinitXrDepthResources()
+{
+  m_alloc->destroy(const_cast<nvvk::Buffer&>(m_xrDepthBuffer));
+}
+
+void GaussianSplatting::clearXrDepth(VkCommandBuffer cmd)
+{
+  // the buffer is shared by the views, the copy of the previous view must be completed
+  VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, NULL, 0, NULL);
+
+  const float farDepth = 1.0f;
+  vkCmdFillBuffer(cmd, m_xrDepthBuffer.buffer, 0, VK_WHOLE_SIZE, *reinterpret_cast<const uint32_t*>(&farDepth));
+
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &barrier, 0,
+                       NULL, 0, NULL);
+}
+
+void GaussianSplatting::copyXrDepth(VkCommandBuffer cmd, VkImage depthImage, const VkExtent2D& extent)
+{
+  auto traceSection = m_gpuTrace.section("XR depth", cmd);
+
+  VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+  barrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.dstAccessMask   = VK_ACCESS_TRANSFER_READ_BIT;
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0,
+                       NULL, 0, NULL);
+  // the previous content of the swapchain image is not needed
+  nvvk::cmdBarrierImageLayout(cmd, depthImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              VK_IMAGE_ASPECT_DEPTH_BIT);
+
+  // the buffer rows have the width of the view
+  VkBufferImageCopy region{};
+  region.bufferRowLength             = extent.width;
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+  region.imageSubresource.layerCount = 1;
+  region.imageExtent                 = {extent.width, extent.height, 1};
+  vkCmdCopyBufferToImage(cmd, m_xrDepthBuffer.buffer, depthImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+  // the runtime expects the image of a depth swapchain in this layout at release
+  nvvk::cmdBarrierImageLayout(cmd, depthImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_ASPECT_DEPTH_BIT);
+}
+
+void GaussianSplatting::initUpscaleResources()
+{
+  const VkExtent2D size = m_mode == Mode::XR ? m_xrViewExtent : (m_gBuffers ? m_gBuffers->getSize() : VkExtent2D{0, 0});
+  if(size.width == 0 || size.height == 0)
+    return;
+
+  // the input is read with texelFetch, the sampler is not used
+  VkSamplerCreateInfo samplerInfo{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+  samplerInfo.magFilter = VK_FILTER_NEAREST;
+  samplerInfo.minFilter = VK_FILTER_NEAREST;
+
+  VkImageCreateInfo imageInfo =
+      nvvk::makeImage2DCreateInfo(size, m_colorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+  nvvk::Image image = m_alloc->createImage(imageInfo);
+  m_dutil->setObjectName(image.image, "UpscaleInput");
+  m_upscaleInput = m_alloc->createTexture(image, nvvk::makeImage2DViewCreateInfo(image.image, m_colorFormat), samplerInfo);
+  m_upscaleInput.descriptor.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+  uint64_t allocSize                    = (uint64_t)size.width * size.height * 4;
+
+  // in PC mode the compute pass writes the G-Buffer
+  if(m_mode == Mode::XR)
+  {
+    imageInfo = nvvk::makeImage2DCreateInfo(size, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_STORAGE_BIT);
+    image     = m_alloc->createImage(imageInfo);
+    m_dutil->setObjectName(image.image, "UpscaleOutput");
+    m_upscaleOutput = m_alloc->createTexture(image, nvvk::makeImage2DViewCreateInfo(image.image, VK_FORMAT_R8G8B8A8_UNORM));
+    m_upscaleOutput.descriptor.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    allocSize += (uint64_t)size.width * size.height * 4;
+  }
+
+  // the images stay in general layout, out of the rendering of the splats
+  VkCommandBuffer cmd = m_app->createTempCmdBuffer();
+  nvvk::cmdBarrierImageLayout(cmd, m_upscaleInput.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+  if(m_upscaleOutput.image != VK_NULL_HANDLE)
+    nvvk::cmdBarrierImageLayout(cmd, m_upscaleOutput.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+  m_app->submitAndWaitTempCmdBuffer(cmd);
+
+  m_renderMemoryStats.allocUpscale = allocSize;
+}
+
+void GaussianSplatting::deinitUpscaleResources()
+{
+  m_alloc->destroy(m_upscaleInput);
+  m_alloc->destroy(m_upscaleOutput);
+  m_renderMemoryStats.allocUpscale = 0;
+}
+
+void GaussianSplatting::updateUpscaleDescriptors()
+{
+  if(m_upscaleInput.image == VK_NULL_HANDLE)
+    return;
+
+  std::vector<VkWriteDescriptorSet> writes;
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_UPSCALE_INPUT_IMAGE, &m_upscaleInput.descriptor));
+  const VkDescriptorImageInfo output_desc =
+      m_mode == Mode::XR ? m_upscaleOutput.descriptor : m_gBuffers->getDescriptorImageInfo();
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_UPSCALE_OUTPUT_IMAGE, &output_desc));
+  vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+void GaussianSplatting::processUpscale(VkCommandBuffer cmd, const VkExtent2D& outputExtent)
+{
+  if(m_upscaleInput.image == VK_NULL_HANDLE || m_upscalePipeline == VK_NULL_HANDLE)
+    return;
+
+  auto timerSection = m_profiler->timeRecurring("Upscale", cmd);
+  auto traceSection = m_gpuTrace.section("Upscale", cmd);
+
+  // the splat colors are written before the compute pass reads them, and the
+  // output of the previous view is copied to its swapchain image before being overwritten
+  {
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask   = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, NULL, 0, NULL);
+  }
+
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_upscalePipeline);
+  vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_dset->getPipeLayout(), 0, 1, m_dset->getSets(), 1, &m_frameInfoOffset);
+  vkCmdDispatch(cmd, (outputExtent.width + UPSCALE_COMPUTE_WORKGROUP_SIZE - 1) / UPSCALE_COMPUTE_WORKGROUP_SIZE,
+                (outputExtent.height + UPSCALE_COMPUTE_WORKGROUP_SIZE - 1) / UPSCALE_COMPUTE_WORKGROUP_SIZE, 1);
+
+  // the upscaled view is then displayed by the UI (PC) or copied to the swapchain image (XR),
+  // and the input is written again by the rendering of the next view
+  {
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, NULL,
+                         0, NULL);
+  }
+}
+
+void GaussianSplatting::copyUpscaleOutput(VkCommandBuffer cmd, VkImage image, const VkExtent2D& extent)
+{
+  if(m_upscaleOutput.image == VK_NULL_HANDLE)
+    return;
+
+  // a blit and not a copy, it converts to the format of the swapchain (component order, sRGB encoding)
+  nvvk::cmdBarrierImageLayout(cmd, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+  VkImageBlit blit{};
+  blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+  blit.srcOffsets[1]  = {static_cast<int32_t>(extent.width), static_cast<int32_t>(extent.height), 1};
+  blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+  blit.dstOffsets[1]  = blit.srcOffsets[1];
+  vkCmdBlitImage(cmd, m_upscaleOutput.image, VK_IMAGE_LAYOUT_GENERAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
+                 &blit, VK_FILTER_NEAREST);
+
+  nvvk::cmdBarrierImageLayout(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 }
 
 void GaussianSplatting::deinitAll()
@@ -671,6 +1316,15 @@ void GaussianSplatting::initAll()
     resetRenderSettings();
   }
   // init a new setup
+  TRACE_SCOPE("initAll");
+  // a single instance covering the model until instances are added
+  SceneInstance instance;
+  instance.name       = std::filesystem::path(m_loadedSceneFilename).filename().string();
+  instance.splatCount = (uint32_t)m_splatSet.size();
+  m_instances         = {instance};
+  m_governor.reset();
+  m_dataStorageError.clear();
+  applyMemoryAdmissionPolicy();
   initShaders();
   initRendererBuffers();
   if(m_defines.dataStorage == STORAGE_TEXTURES)
@@ -678,12 +1332,26 @@ void GaussianSplatting::initAll()
   else
     initDataBuffers();
   initPipelines();
+  updateImportanceThresholds();
+  releaseHostSplatData();
 }
 
 void GaussianSplatting::reinitDataStorage()
 {
   vkDeviceWaitIdle(m_device);
 
+  // the current data are kept if the attributes cannot be reloaded, and so are
+  // the settings describing them since the shaders must keep matching the data
+  if(!restoreHostSplatData())
+  {
+    m_defines.dataStorage = m_dataDefines.dataStorage;
+    m_defines.shFormat    = m_dataDefines.shFormat;
+    m_defines.shAdaptive  = m_dataDefines.shAdaptive;
+    m_dataStorageError    = "cannot reload the splat attributes from " + m_hostDataSource.filename;
+    return;
+  }
+  m_dataStorageError.clear();
+
   if(m_centersMap.image != VK_NULL_HANDLE)
   {
     deinitDataTextures();
@@ -695,6 +1363,7 @@ void GaussianSplatting::reinitDataStorage()
   deinitPipelines();
   deinitShaders();
 
+  applyMemoryAdmissionPolicy();
   if(m_defines.dataStorage == STORAGE_TEXTURES)
   {
     initDataTextures();
@@ -705,6 +1374,8 @@ void GaussianSplatting::reinitDataStorage()
   }
   initShaders();
   initPipelines();
+  updateImportanceThresholds();
+  releaseHostSplatData();
 }
 
 void GaussianSplatting::reinitShaders()
@@ -722,47 +1393,507 @@ void GaussianSplatting::deinitScene()
 {
   m_splatSet            = {};
   m_loadedSceneFilename = "";
+  m_hostDataReleased    = false;
+  m_sceneEdited         = false;
+  m_instances.clear();
+  m_compactScene  = false;
+  m_splatCapacity = 0;
+  m_sortPositions.clear();
+  m_sortPositionsDirty = true;
 }
 
-bool GaussianSplatting::initShaders(void)
+bool GaussianSplatting::isSceneComposed() const
 {
-  bool gammaCorrection = m_mode == Mode::PC ? false : (true && !m_headsetSupportUnorm);
-  auto startTime = std::chrono::high_resolution_clock::now();
-
-  // blank page
-  deinitShaders();
-
-  // prepare definitions prepend
-  std::string prepends;
-  if(m_defines.opacityGaussianDisabled)
-    prepends += "#define DISABLE_OPACITY_GAUSSIAN\n";
-  prepends += nvh::stringFormat("#define FRUSTUM_CULLING_MODE %d\n", m_defines.frustumCulling);
-  prepends += "#define ORTHOGRAPHIC_MODE 0\n";  // Disabled, TODO do we enable ortho cam in the UI/camera controller
-  prepends += nvh::stringFormat("#define SHOW_SH_ONLY %d\n", m_defines.showShOnly);
-  prepends += nvh::stringFormat("#define MAX_SH_DEGREE %d\n", m_defines.maxShDegree);
-  prepends += nvh::stringFormat("#define DATA_STORAGE %d\n", m_defines.dataStorage);
-  prepends += nvh::stringFormat("#define SH_FORMAT %d\n", m_defines.shFormat);
-  prepends += nvh::stringFormat("#define POINT_CLOUD_MODE %d\n", m_defines.pointCloudModeEnabled);
-  prepends += nvh::stringFormat("#define USE_BARYCENTRIC %d\n", m_defines.fragmentBarycentric);
-  prepends += nvh::stringFormat("#define GAMMA_CORRECTION %d\n", gammaCorrection);
-  prepends += nvh::stringFormat("#define GSMODE %d\n", (int)m_gsMode);
+  if(m_instances.size() > 1)
+    return true;
+  return !m_instances.empty() && (!m_instances[0].isIdentity() || !m_instances[0].visible);
+}
 
-  // generate the shader modules
-  m_shaders.distShader   = m_shaderManager.createShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, "dist.comp.glsl", prepends);
-  m_shaders.vertexShader = m_shaderManager.createShaderModule(VK_SHADER_STAGE_VERTEX_BIT, "raster.vert.glsl", prepends);
-  m_shaders.meshShader = m_shaderManager.createShaderModule(VK_SHADER_STAGE_MESH_BIT_EXT, "raster.mesh.glsl", prepends);
-  m_shaders.fragmentShader = m_shaderManager.createShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, "raster.frag.glsl", prepends);
+size_t GaussianSplatting::getLiveInstanceCount() const
+{
+  size_t liveCount = 0;
+  for(const auto& instance : m_instances)
+    liveCount += instance.removed ? 0 : 1;
+  return liveCount;
+}
 
-  if(!m_shaderManager.areShaderModulesValid())
+void GaussianSplatting::addLoadedInstance()
+{
+  SplatSet splatSet = std::move(m_instanceSplatSet);
+  m_instanceSplatSet = {};
+  const std::string name  = std::filesystem::path(m_plyLoader.getFilename()).filename().string();
+  const auto        count = (uint32_t)splatSet.size();
+  if(count == 0 || getLiveInstanceCount() >= MAX_SCENE_INSTANCES)
   {
-    m_shaderManager.deleteShaderModules();
-    return false;
+    std::cerr << "Error: cannot add " << name << " to the scene, empty set or " << MAX_SCENE_INSTANCES
+              << " instances reached" << std::endl;
+    return;
   }
-  auto      endTime   = std::chrono::high_resolution_clock::now();
-  long long buildTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
-  std::cout << "Shaders updated in " << buildTime << "ms" << std::endl;
+  // the attributes are needed to append the instance and to rebuild the storage
+  if(!restoreHostSplatData())
+    return;
 
-  return true;
+  TRACE_SCOPE("addLoadedInstance");
+  const auto first         = (uint32_t)m_splatSet.size();
+  bool       layoutChanged = false;
+  if(!appendSplatSet(m_splatSet, splatSet, layoutChanged))
+  {
+    std::cerr << "Error: the attributes of " << name << " do not match the ones of the scene" << std::endl;
+    return;
+  }
+  SceneInstance instance;
+  instance.name        = name;
+  instance.splatOffset = first;
+  instance.splatCount  = count;
+  m_instances.push_back(instance);
+  m_sceneEdited        = true;
+  m_instancesDirty     = true;
+  m_sortPositionsDirty = true;
+  std::cout << "Instance " << name << " added, " << count << " splats" << std::endl;
+
+  // the range of the instance is uploaded in place when the storage allows it, the
+  // textures, the spacetime features and the adaptive SH have a global layout. The rebuild
+  // also frees the slots of the removed instances when the instance table is full
+  const bool rangeUpload = !layoutChanged && m_gsMode == GSMODE_3DGS && m_defines.dataStorage == STORAGE_BUFFERS
+                           && !useAdaptiveSh() && first + count <= m_splatCapacity
+                           && m_instances.size() <= MAX_SCENE_INSTANCES;
+  if(!rangeUpload)
+  {
+    rebuildSceneStorage();
+    return;
+  }
+
+  // the frames in flight draw the first splats only, the range is not in use by the device
+  updateStagingRing();
+  m_stagingRing.uploadBuffer(m_centersDevice.buffer, (VkDeviceSize)first * 3 * sizeof(float), count, 3 * sizeof(float),
+                             [&](void* dst, uint64_t offset, uint64_t chunkCount) {
+                               packCenters(m_splatSet, static_cast<float*>(dst), 3, first + (uint32_t)offset, (uint32_t)chunkCount);
+                             });
+  m_stagingRing.uploadBuffer(m_covariancesDevice.buffer, (VkDeviceSize)first * 6 * sizeof(float), count, 6 * sizeof(float),
+                             [&](void* dst, uint64_t offset, uint64_t chunkCount) {
+                               packCovariances_3DGS(m_splatSet, static_cast<float*>(dst), first + (uint32_t)offset,
+                                                    (uint32_t)chunkCount);
+                             });
+  m_stagingRing.uploadBuffer(m_colorsDevice.buffer, (VkDeviceSize)first * 4 * sizeof(float), count, 4 * sizeof(float),
+                             [&](void* dst, uint64_t offset, uint64_t chunkCount) {
+                               packColors_3DGS(m_splatSet, static_cast<float*>(dst), first + (uint32_t)offset, (uint32_t)chunkCount);
+                             });
+  const uint32_t     splatStride = getShComponentCount(m_shDegreeUploaded);
+  const VkDeviceSize shSize      = splatStride * formatSize(m_defines.shFormat);
+  if(splatStride > 0)
+  {
+    m_stagingRing.uploadBuffer(m_sphericalHarmonicsDevice.buffer, first * shSize, count, shSize,
+                               [&](void* dst, uint64_t offset, uint64_t chunkCount) {
+                                 packSphericalHarmonics_3DGS(m_splatSet, m_defines.shFormat, dst, splatStride, m_shDegreeUploaded,
+                                                             first + (uint32_t)offset, (uint32_t)chunkCount);
+                               });
+  }
+  // drawn in their order until a sort covers them
+  m_stagingRing.uploadBuffer(m_splatIndicesDevice.buffer, (VkDeviceSize)first * sizeof(uint32_t), count, sizeof(uint32_t),
+                             [&](void* dst, uint64_t offset, uint64_t chunkCount) {
+                               uint32_t* indices = static_cast<uint32_t*>(dst);
+                               for(uint64_t i = 0; i < chunkCount; ++i)
+                                 indices[i] = first + (uint32_t)(offset + i);
+                             });
+  uploadInstanceIndices(first, count);
+  m_stagingRing.flush();
+
+  m_gpuLastSort.valid = false;
+  updateImportanceThresholds();
+}
+
+void GaussianSplatting::removeInstance(size_t instanceId)
+{
+  if(instanceId >= m_instances.size())
+    return;
+  // a table upload is enough, the splats are culled by the shaders
+  m_instances[instanceId].removed = true;
+  m_instances[instanceId].visible = false;
+  m_sceneEdited                   = true;
+  m_instancesDirty                = true;
+
+  // the removed splats still cost the sort and the culling
+  size_t removedCount = 0;
+  for(const auto& instance : m_instances)
+    removedCount += instance.removed ? instance.splatCount : 0;
+  if(removedCount * 2 >= m_splatSet.size())
+    m_compactScene = true;
+}
+
+void GaussianSplatting::rebuildSceneStorage()
+{
+  vkDeviceWaitIdle(m_device);
+
+  // drops the splats of the removed instances, the next instances move down
+  uint32_t offset = 0;
+  for(auto it = m_instances.begin(); it != m_instances.end();)
+  {
+    if(it->removed)
+    {
+      eraseSplatRange(m_splatSet, offset, it->splatCount);
+      it = m_instances.erase(it);
+      continue;
+    }
+    it->splatOffset = offset;
+    offset += it->splatCount;
+    ++it;
+  }
+  // room for the next instances, a rebuild is then only needed when the scene doubles
+  m_splatCapacity = isSceneComposed() ? (uint32_t)m_splatSet.size() * 3 / 2 : 0;
+
+  if(m_centersMap.image != VK_NULL_HANDLE)
+  {
+    deinitDataTextures();
+  }
+  else
+  {
+    deinitDataBuffers();
+  }
+  deinitPipelines();
+  deinitShaders();
+  deinitRendererBuffers();
+
+  applyMemoryAdmissionPolicy();
+  initShaders();
+  initRendererBuffers();
+  if(m_defines.dataStorage == STORAGE_TEXTURES)
+  {
+    initDataTextures();
+  }
+  else
+  {
+    initDataBuffers();
+  }
+  initPipelines();
+  updateImportanceThresholds();
+
+  // the indices of the previous sorts refer to the former layout
+  m_splatIndices.clear();
+  m_sortPositionsDirty = true;
+}
+
+void GaussianSplatting::uploadInstanceIndices(uint32_t first, uint32_t count)
+{
+  if(m_instances.empty() || count == 0)
+    return;
+  m_stagingRing.uploadBuffer(m_instanceIndicesDevice.buffer, (VkDeviceSize)first * sizeof(uint32_t), count, sizeof(uint32_t),
+                             [&](void* dst, uint64_t offset, uint64_t chunkCount) {
+                               uint32_t* indices  = static_cast<uint32_t*>(dst);
+                               uint32_t  splatIdx = first + (uint32_t)offset;
+                               // the instances are in the order of their splats
+                               uint32_t instanceId = 0;
+                               for(uint64_t i = 0; i < chunkCount; ++i, ++splatIdx)
+                               {
+                                 while(instanceId + 1 < m_instances.size()
+                                       && splatIdx >= m_instances[instanceId].splatOffset + m_instances[instanceId].splatCount)
+                                   instanceId++;
+                                 indices[i] = instanceId;
+                               }
+                             });
+}
+
+void GaussianSplatting::uploadInstancesIfNeeded(VkCommandBuffer cmd)
+{
+  if(!m_instancesDirty || m_instancesDevice.buffer == VK_NULL_HANDLE)
+    return;
+
+  std::vector<shaderio::SplatInstance> instances(m_instances.size());
+  for(size_t i = 0; i < m_instances.size(); ++i)
+  {
+    instances[i].transform = m_instances[i].getTransform();
+    instances[i].visible   = m_instances[i].visible && !m_instances[i].removed;
+  }
+
+  // the table may still be read by the previous frame
+  VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+  barrier.srcAccessMask   = VK_ACCESS_SHADER_READ_BIT;
+  barrier.dstAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+  const VkPipelineStageFlags shaderStages =
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | meshShaderStage();
+  vkCmdPipelineBarrier(cmd, shaderStages, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, NULL, 0, NULL);
+  vkCmdUpdateBuffer(cmd, m_instancesDevice.buffer, 0, instances.size() * sizeof(shaderio::SplatInstance), instances.data());
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, shaderStages, 0, 1, &barrier, 0, NULL, 0, NULL);
+
+  m_instancesDirty = false;
+  // the splats moved, the results of the last GPU sort cannot be reused
+  m_gpuLastSort.valid = false;
+}
+
+void GaussianSplatting::updateSortPositions()
+{
+  if(!m_sceneInstancing)
+  {
+    std::vector<float>().swap(m_sortPositions);
+    return;
+  }
+  m_sortPositions.resize(m_splatSet.positions.size());
+  for(const auto& instance : m_instances)
+  {
+    const glm::mat4 transform = instance.getTransform();
+    START_PAR_LOOP(instance.splatCount, i)
+    {
+      const size_t    splatIdx = instance.splatOffset + (size_t)i;
+      const glm::vec4 center   = glm::vec4(glm::make_vec3(&m_splatSet.positions[splatIdx * 3]), 1.0f);
+      const glm::vec3 position = glm::vec3(transform * center);
+      m_sortPositions[splatIdx * 3 + 0] = position.x;
+      m_sortPositions[splatIdx * 3 + 1] = position.y;
+      m_sortPositions[splatIdx * 3 + 2] = position.z;
+    }
+    END_PAR_LOOP()
+  }
+}
+
+void GaussianSplatting::updateImportanceThresholds()
+{
+  m_importanceThresholds.clear();
+  // the importance uses the static covariance of the 3DGS splats
+  if(m_gsMode != GSMode_3DGS)
+    return;
+  computeImportanceThresholds(m_splatSet, FrameGovernor::BUDGET_FRACTIONS.data(), FrameGovernor::BUDGET_FRACTIONS.size(),
+                              m_importanceThresholds);
+}
+
+void GaussianSplatting::updateFrameGovernor()
+{
+  // GPU time of the passes affected by the knobs, accumulated over the views in XR
+  double cpuTime = 0.0, gpuTime = 0.0, gpuFrameTime = 0.0;
+  for(const char* section : {"GPU Dist", "GPU Sort", "Copy indices to GPU", "Rendering", "Upscale"})
+  {
+    if(m_profiler->getAveragedValues(section, cpuTime, gpuTime))
+      gpuFrameTime += gpuTime / 1000.0;
+  }
+  const float budget = m_mode == Mode::XR ? m_frameBudget : 1000.0f / m_governor.settings.pcTargetRate;
+
+  const bool upscale = isUpscaleActive();
+  if(m_governor.update(ImGui::GetTime(), (float)gpuFrameTime, budget))
+  {
+    // the averages must only contain frames rendered with the new levels
+    m_profiler->reset(nvh::Profiler::CONFIG_DELAY);
+    // the upscale targets are built when the render scale is first lowered
+    if(isUpscaleActive() != upscale)
+      m_updateShaders = true;
+  }
+}
+
+void GaussianSplatting::releaseHostSplatData()
+{
+  if(!m_releaseHostData || m_hostDataReleased || m_splatSet.size() == 0 || m_sceneEdited)
+    return;
+
+  // source of the splat set currently uploaded, kept by the loader until the next load
+  m_hostDataSource = m_plyLoader.getLastLoadSettings();
+
+  // the positions are still read by the CPU sorter, swap to actually free the memory
+  const size_t releasedBytes = (m_splatSet.f_dc.size() + m_splatSet.f_rest.size() + m_splatSet.opacity.size()
+                               + m_splatSet.scale.size() + m_splatSet.rotation.size())
+                              * sizeof(float);
+  std::vector<float>().swap(m_splatSet.f_dc);
+  std::vector<float>().swap(m_splatSet.f_rest);
+  std::vector<float>().swap(m_splatSet.opacity);
+  std::vector<float>().swap(m_splatSet.scale);
+  std::vector<float>().swap(m_splatSet.rotation);
+  m_hostDataReleased = true;
+
+  std::cout << "Host splat attributes released, " << releasedBytes / (1024 * 1024) << " MB freed" << std::endl;
+}
+
+bool GaussianSplatting::restoreHostSplatData()
+{
+  if(!m_hostDataReleased)
+    return true;
+
+  TRACE_SCOPE("Restore host splat data");
+  // the loader is deterministic, same settings give the same pruned and reordered set
+  PlyAsyncLoader loader;
+  SplatSet       splatSet;
+  if(!loader.loadSync(m_hostDataSource, splatSet) || splatSet.size() != m_splatSet.size())
+  {
+    std::cerr << "Error: failed to reload the splat attributes from " << m_hostDataSource.filename << std::endl;
+    return false;
+  }
+
+  // the positions are kept as is, they may be in use by the CPU sorter
+  m_splatSet.f_dc     = std::move(splatSet.f_dc);
+  m_splatSet.f_rest   = std::move(splatSet.f_rest);
+  m_splatSet.opacity  = std::move(splatSet.opacity);
+  m_splatSet.scale    = std::move(splatSet.scale);
+  m_splatSet.rotation = std::move(splatSet.rotation);
+  m_hostDataReleased  = false;
+  return true;
+}
+
+void GaussianSplatting::updateHeapBudgets()
+{
+  const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+  vmaGetMemoryProperties(m_alloc->vma(), &memoryProperties);
+  m_heapBudgets.resize(memoryProperties->memoryHeapCount);
+  vmaGetHeapBudgets(m_alloc->vma(), m_heapBudgets.data());
+}
+
+uint64_t GaussianSplatting::getModelMemoryBudget()
+{
+  updateHeapBudgets();
+
+  // the model is stored in the largest device local heap
+  const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+  vmaGetMemoryProperties(m_alloc->vma(), &memoryProperties);
+  int deviceHeap = -1;
+  for(uint32_t i = 0; i < memoryProperties->memoryHeapCount; ++i)
+  {
+    const VkMemoryHeap& heap = memoryProperties->memoryHeaps[i];
+    if((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) && (deviceHeap < 0 || heap.size > memoryProperties->memoryHeaps[deviceHeap].size))
+      deviceHeap = i;
+  }
+
+  uint64_t budget = std::numeric_limits<uint64_t>::max();
+  if(deviceHeap >= 0)
+  {
+    const VmaBudget& heapBudget = m_heapBudgets[deviceHeap];
+    budget = heapBudget.budget > heapBudget.usage ? heapBudget.budget - heapBudget.usage : 0;
+  }
+  if(m_memoryBudgetMB > 0)
+    budget = std::min(budget, (uint64_t)m_memoryBudgetMB * 1024 * 1024);
+  return budget;
+}
+
+uint64_t GaussianSplatting::estimateModelDeviceMemory(int dataStorage, int shFormat, uint32_t shDegree)
+{
+  const auto     splatCount = (uint32_t)m_splatSet.size();
+  const uint32_t shStride   = getShComponentCount(shDegree);
+
+  if(dataStorage == STORAGE_BUFFERS)
+  {
+    // centers, covariances, colors and SH, see initDataBuffers_3DGS
+    // the adaptive SH storage is bounded by the fixed stride plus the per splat headers
+    const uint64_t shHeader = m_defines.shAdaptive && shDegree > 0 ? sizeof(uint32_t) : 0;
+    return (uint64_t)splatCount * ((3 + 6 + 4) * sizeof(float) + shStride * formatSize(shFormat) + shHeader);
+  }
+
+  // same layouts as initDataTextures_3DGS, including the padding of the maps
+  const uint32_t paddedShStride = (shStride + 3) / 4 * 4;
+  const auto     mapBytes       = [&](int elementsPerTexel, int elementsPerSplat, uint64_t texelSize) {
+    const glm::ivec2 mapSize = computeDataTextureSize(elementsPerTexel, elementsPerSplat, splatCount);
+    return (uint64_t)mapSize.x * mapSize.y * texelSize;
+  };
+  return mapBytes(3, 3, 4 * sizeof(float)) + mapBytes(4, 6, 4 * sizeof(float)) + mapBytes(4, 4, 4 * sizeof(uint8_t))
+         + mapBytes(4, paddedShStride, 4 * formatSize(shFormat));
+}
+
+void GaussianSplatting::applyMemoryAdmissionPolicy()
+{
+  m_shDegreeUploaded = m_gsMode == GSMODE_3DGS ? getShDegree_3DGS(m_splatSet) : 0;
+
+  // the spacetime features have a fixed layout, nothing to trade
+  if(m_splatSet.size() == 0 || m_gsMode != GSMODE_3DGS)
+    return;
+
+  static const char* formatNames[] = {"float32", "float16", "uint8"};
+
+  const uint64_t budget          = getModelMemoryBudget();
+  const int      requestedFormat = m_defines.shFormat;
+  const uint32_t fileShDegree    = m_shDegreeUploaded;
+  const uint64_t requested       = estimateModelDeviceMemory(m_defines.dataStorage, m_defines.shFormat, m_shDegreeUploaded);
+  uint64_t       estimate        = requested;
+
+  // precision of the SH coefficients is traded first, then the highest SH bands.
+  // data textures store all the degrees of the file (fixed 12 texels layout in the shaders).
+  while(estimate > budget)
+  {
+    if(m_defines.shFormat == FORMAT_FLOAT32)
+      m_defines.shFormat = FORMAT_FLOAT16;
+    else if(m_defines.shFormat == FORMAT_FLOAT16)
+      m_defines.shFormat = FORMAT_UINT8;
+    else if(m_defines.dataStorage == STORAGE_BUFFERS && m_shDegreeUploaded > 0)
+      m_shDegreeUploaded--;
+    else
+      break;
+    estimate = estimateModelDeviceMemory(m_defines.dataStorage, m_defines.shFormat, m_shDegreeUploaded);
+  }
+
+  const uint64_t MB = 1024 * 1024;
+  std::cout << "Memory admission: model needs " << requested / MB << " MB, budget ";
+  if(budget == std::numeric_limits<uint64_t>::max())
+    std::cout << "unknown";
+  else
+    std::cout << budget / MB << " MB";
+  if(estimate == requested)
+  {
+    std::cout << ", kept SH " << formatNames[requestedFormat] << " degree " << fileShDegree << std::endl;
+    return;
+  }
+  std::cout << ", downgraded SH " << formatNames[requestedFormat] << " degree " << fileShDegree << " to "
+            << formatNames[m_defines.shFormat] << " degree " << m_shDegreeUploaded << " (" << estimate / MB << " MB)";
+  if(estimate > budget)
+    std::cout << ", still over budget";
+  std::cout << std::endl;
+}
+
+bool GaussianSplatting::useAdaptiveSh() const
+{
+  if(!m_defines.shAdaptive || m_defines.dataStorage != STORAGE_BUFFERS || m_gsMode != GSMODE_3DGS || m_shDegreeUploaded == 0)
+    return false;
+  // the offsets of the worst case layout must fit in the headers, see computeAdaptiveShLayout
+  const uint64_t splatCount = m_splatSet.size();
+  return splatCount * (sizeof(uint32_t) / formatSize(m_defines.shFormat) + getShComponentCount(m_shDegreeUploaded))
+         < SH_ADAPTIVE_MAX_OFFSET;
+}
+
+bool GaussianSplatting::initShaders(void)
+{
+  bool gammaCorrection = m_mode == Mode::PC ? false : (true && !m_headsetSupportUnorm);
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  // blank page
+  deinitShaders();
+
+  // prepare definitions prepend
+  std::string prepends;
+  if(m_defines.opacityGaussianDisabled)
+    prepends += "#define DISABLE_OPACITY_GAUSSIAN\n";
+  prepends += nvh::stringFormat("#define FRUSTUM_CULLING_MODE %d\n", m_defines.frustumCulling);
+  prepends += "#define ORTHOGRAPHIC_MODE 0\n";  // Disabled, TODO do we enable ortho cam in the UI/camera controller
+  prepends += nvh::stringFormat("#define SHOW_SH_ONLY %d\n", m_defines.showShOnly);
+  // data buffers may store less SH degrees than the file, see applyMemoryAdmissionPolicy
+  int maxShDegree = m_defines.dataStorage == STORAGE_BUFFERS ? std::min(m_defines.maxShDegree, (int)m_shDegreeUploaded)
+                                                             : m_defines.maxShDegree;
+  prepends += nvh::stringFormat("#define MAX_SH_DEGREE %d\n", maxShDegree);
+  prepends += nvh::stringFormat("#define SH_BUFFER_STRIDE %d\n", getShComponentCount(m_shDegreeUploaded));
+  prepends += nvh::stringFormat("#define SH_ADAPTIVE %d\n", useAdaptiveSh());
+  prepends += nvh::stringFormat("#define DATA_STORAGE %d\n", m_defines.dataStorage);
+  prepends += nvh::stringFormat("#define SH_FORMAT %d\n", m_defines.shFormat);
+  prepends += nvh::stringFormat("#define POINT_CLOUD_MODE %d\n", m_defines.pointCloudModeEnabled);
+  prepends += nvh::stringFormat("#define USE_BARYCENTRIC %d\n", m_defines.fragmentBarycentric && m_supportBarycentric);
+  prepends += nvh::stringFormat("#define GAMMA_CORRECTION %d\n", gammaCorrection);
+  prepends += nvh::stringFormat("#define GSMODE %d\n", (int)m_gsMode);
+  prepends += nvh::stringFormat("#define DIST_SUBGROUP_COMPACTION %d\n",
+                                m_defines.distSubgroupCompaction && m_supportSubgroupBallot);
+  prepends += nvh::stringFormat("#define OVERDRAW_MODE %d\n", isOverdrawModeActive());
+  prepends += nvh::stringFormat("#define XR_DEPTH_MODE %d\n", isXrDepthActive());
+  m_sceneInstancing = isSceneComposed();
+  prepends += nvh::stringFormat("#define SCENE_INSTANCING %d\n", m_sceneInstancing);
+
+  // generate the shader modules
+  m_shaders.distShader   = m_shaderManager.createShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, "dist.comp.glsl", prepends);
+  m_shaders.vertexShader = m_shaderManager.createShaderModule(VK_SHADER_STAGE_VERTEX_BIT, "raster.vert.glsl", prepends);
+  m_shaders.meshShader = m_shaderManager.createShaderModule(VK_SHADER_STAGE_MESH_BIT_EXT, "raster.mesh.glsl", prepends);
+  m_shaders.fragmentShader = m_shaderManager.createShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, "raster.frag.glsl", prepends);
+  if(isOverdrawModeActive())
+    m_shaders.overdrawShader = m_shaderManager.createShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, "overdraw.comp.glsl", prepends);
+  if(isUpscaleActive())
+    m_shaders.upscaleShader = m_shaderManager.createShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, "upscale.comp.glsl", prepends);
+
+  if(!m_shaderManager.areShaderModulesValid())
+  {
+    m_shaderManager.deleteShaderModules();
+    return false;
+  }
+  auto      endTime   = std::chrono::high_resolution_clock::now();
+  long long buildTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+  std::cout << "Shaders updated in " << buildTime << "ms" << std::endl;
+
+  return true;
 }
 
 void GaussianSplatting::deinitShaders(void)
@@ -775,14 +1906,19 @@ void GaussianSplatting::deinitShaders(void)
 
 void GaussianSplatting::initPipelines()
 {
+  // defines, data or buffers may have changed, forces a new GPU sort
+  m_gpuLastSort.valid = false;
+
   // reset descriptor bindings
   std::vector<VkDescriptorSetLayoutBinding> empty;
   m_dset->setBindings(empty);
 
-  m_dset->addBinding(BINDING_FRAME_INFO_UBO, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  m_dset->addBinding(BINDING_FRAME_INFO_UBO, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_ALL);
   m_dset->addBinding(BINDING_DISTANCES_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
   m_dset->addBinding(BINDING_INDICES_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
   m_dset->addBinding(BINDING_INDIRECT_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  m_dset->addBinding(BINDING_INSTANCE_INDICES_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  m_dset->addBinding(BINDING_INSTANCES_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
   if(m_defines.dataStorage == STORAGE_TEXTURES)
   {
     m_dset->addBinding(BINDING_SH_TEXTURE, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_ALL);
@@ -797,6 +1933,21 @@ void GaussianSplatting::initPipelines()
     m_dset->addBinding(BINDING_COVARIANCES_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
     m_dset->addBinding(BINDING_SH_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
   }
+  if(isOverdrawModeActive())
+  {
+    m_dset->addBinding(BINDING_OVERDRAW_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_ALL);
+    m_dset->addBinding(BINDING_OVERDRAW_STATS_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+    m_dset->addBinding(BINDING_OVERDRAW_OUTPUT_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_ALL);
+  }
+  if(isXrDepthActive())
+  {
+    m_dset->addBinding(BINDING_XR_DEPTH_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL);
+  }
+  if(isUpscaleActive())
+  {
+    m_dset->addBinding(BINDING_UPSCALE_INPUT_IMAGE, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_ALL);
+    m_dset->addBinding(BINDING_UPSCALE_OUTPUT_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_ALL);
+  }
 
   m_dset->initLayout();
   m_dset->initPool(1);
@@ -809,7 +1960,7 @@ void GaussianSplatting::initPipelines()
   std::vector<VkWriteDescriptorSet> writes;
 
   // add common buffers
-  const VkDescriptorBufferInfo dbi_frameInfo{m_frameInfoBuffer.buffer, 0, VK_WHOLE_SIZE};
+  const VkDescriptorBufferInfo dbi_frameInfo{m_frameInfoBuffer.buffer, 0, sizeof(shaderio::FrameInfo)};
   writes.emplace_back(m_dset->makeWrite(0, BINDING_FRAME_INFO_UBO, &dbi_frameInfo));
   const VkDescriptorBufferInfo keys_desc{m_splatDistancesDevice.buffer, 0, VK_WHOLE_SIZE};
   writes.emplace_back(m_dset->makeWrite(0, BINDING_DISTANCES_BUFFER, &keys_desc));
@@ -817,6 +1968,10 @@ void GaussianSplatting::initPipelines()
   writes.emplace_back(m_dset->makeWrite(0, BINDING_INDICES_BUFFER, &cpuKeys_desc));
   const VkDescriptorBufferInfo indirect_desc{m_indirect.buffer, 0, VK_WHOLE_SIZE};
   writes.emplace_back(m_dset->makeWrite(0, BINDING_INDIRECT_BUFFER, &indirect_desc));
+  const VkDescriptorBufferInfo instanceIndices_desc{m_instanceIndicesDevice.buffer, 0, VK_WHOLE_SIZE};
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_INSTANCE_INDICES_BUFFER, &instanceIndices_desc));
+  const VkDescriptorBufferInfo instances_desc{m_instancesDevice.buffer, 0, VK_WHOLE_SIZE};
+  writes.emplace_back(m_dset->makeWrite(0, BINDING_INSTANCES_BUFFER, &instances_desc));
 
   if(m_defines.dataStorage == STORAGE_TEXTURES)
   {
@@ -842,6 +1997,21 @@ void GaussianSplatting::initPipelines()
   // write
   vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
 
+  if(isOverdrawModeActive())
+  {
+    initOverdrawResources();
+    updateOverdrawDescriptors();
+  }
+  if(isXrDepthActive())
+  {
+    initXrDepthResources();
+  }
+  if(isUpscaleActive())
+  {
+    initUpscaleResources();
+    updateUpscaleDescriptors();
+  }
+
   // Create the pipeline to run the compute shader for distance & culling
   {
     auto pipelineLayout = m_dset->getPipeLayout();
@@ -859,6 +2029,38 @@ void GaussianSplatting::initPipelines()
     };
     vkCreateComputePipelines(m_device, {}, 1, &pipelineInfo, nullptr, &m_computePipeline);
   }
+  // Create the pipeline of the overdraw render mode
+  if(isOverdrawModeActive())
+  {
+    VkComputePipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage =
+            {
+                .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage  = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = m_shaderManager.get(m_shaders.overdrawShader),
+                .pName  = "main",
+            },
+        .layout = m_dset->getPipeLayout(),
+    };
+    vkCreateComputePipelines(m_device, {}, 1, &pipelineInfo, nullptr, &m_overdrawPipeline);
+  }
+  // Create the pipeline of the reduced resolution rendering, not without targets (XR view size unknown)
+  if(isUpscaleActive() && m_upscaleInput.image != VK_NULL_HANDLE)
+  {
+    VkComputePipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage =
+            {
+                .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage  = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = m_shaderManager.get(m_shaders.upscaleShader),
+                .pName  = "main",
+            },
+        .layout = m_dset->getPipeLayout(),
+    };
+    vkCreateComputePipelines(m_device, {}, 1, &pipelineInfo, nullptr, &m_upscalePipeline);
+  }
   // Create the two rasterization pipelines
   {
 
@@ -890,6 +2092,7 @@ void GaussianSplatting::initPipelines()
     pstate.addDynamicStateEnable(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE);
 
     // create the pipeline that uses mesh shaders
+    if(m_supportMeshShader)
     {
       nvvk::GraphicsPipelineGenerator pgen(m_device, m_dset->getPipeLayout(), prend_info, pstate);
       pgen.addShader(m_shaderManager.get(m_shaders.meshShader), VK_SHADER_STAGE_MESH_BIT_EXT);
@@ -938,11 +2141,25 @@ void GaussianSplatting::deinitPipelines()
     vkDestroyPipeline(m_device, m_computePipeline, nullptr);
     m_computePipeline = nullptr;
   }
+  if(m_overdrawPipeline)
+  {
+    vkDestroyPipeline(m_device, m_overdrawPipeline, nullptr);
+    m_overdrawPipeline = nullptr;
+  }
+  if(m_upscalePipeline)
+  {
+    vkDestroyPipeline(m_device, m_upscalePipeline, nullptr);
+    m_upscalePipeline = nullptr;
+  }
+  deinitOverdrawResources();
+  deinitXrDepthResources();
+  deinitUpscaleResources();
 }
 
 void GaussianSplatting::initRendererBuffers()
 {
-  const auto splatCount = (uint32_t)m_splatSet.size();
+  // room for the instances added later to a composed scene
+  const auto splatCount = getSplatCapacity();
 
   // All this block for the sorting
   {
@@ -972,7 +2189,7 @@ void GaussianSplatting::initRendererBuffers()
       VrdxSorterStorageRequirements requirements;
       vrdxGetSorterKeyValueStorageRequirements(m_gpuSorter, splatCount, &requirements);
       m_vrdxStorageDevice = m_alloc->createBuffer(requirements.size, requirements.usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-      m_renderMemoryStats.allocVdrxInternal = (uint32_t)requirements.size;  // for stats reporting only
+      m_renderMemoryStats.allocVdrxInternal = requirements.size;  // for stats reporting only
 
       // generate debug information for buffers
       m_dutil->DBG_NAME(m_splatIndicesHost.buffer);
@@ -995,6 +2212,20 @@ void GaussianSplatting::initRendererBuffers()
   m_dutil->DBG_NAME(m_indirect.buffer);
   m_dutil->DBG_NAME(m_indirectReadbackHost.buffer);
 
+  // scene composition, the instance table is uploaded before the next sort
+  m_instanceIndicesDevice = m_alloc->createBuffer(std::max(splatCount, 1u) * sizeof(uint32_t),
+                                                  VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  m_instancesDevice       = m_alloc->createBuffer(MAX_SCENE_INSTANCES * sizeof(shaderio::SplatInstance),
+                                                  VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  m_dutil->DBG_NAME(m_instanceIndicesDevice.buffer);
+  m_dutil->DBG_NAME(m_instancesDevice.buffer);
+  updateStagingRing();
+  uploadInstanceIndices(0, (uint32_t)m_splatSet.size());
+  m_stagingRing.flush();
+  m_instancesDirty = true;
+
   // We create a command buffer in order to perform the copy to VRAM
   VkCommandBuffer cmd = m_app->createTempCmdBuffer();
 
@@ -1010,10 +2241,17 @@ void GaussianSplatting::initRendererBuffers()
 
   m_app->submitAndWaitTempCmdBuffer(cmd);
 
-  // Uniform buffer
-  m_frameInfoBuffer = m_alloc->createBuffer(sizeof(shaderio::FrameInfo), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+  // Uniform buffer, one slot per view and frame in flight
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(m_app->getPhysicalDevice(), &properties);
+  const VkDeviceSize alignment = properties.limits.minUniformBufferOffsetAlignment;
+  m_frameInfoSlotStride        = (sizeof(shaderio::FrameInfo) + alignment - 1) / alignment * alignment;
+  m_frameInfoBuffer = m_alloc->createBuffer(m_frameInfoSlotStride * FRAME_INFO_MAX_VIEWS * m_app->getFrameCycleSize(),
+                                            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
   m_dutil->DBG_NAME(m_frameInfoBuffer.buffer);
+  m_frameInfoMapped = static_cast<uint8_t*>(m_alloc->map(m_frameInfoBuffer));
+  m_frameInfoOffset = 0;
 }
 
 void GaussianSplatting::deinitRendererBuffers()
@@ -1033,43 +2271,28 @@ void GaussianSplatting::deinitRendererBuffers()
   m_alloc->destroy(const_cast<nvvk::Buffer&>(m_indirect));
   m_alloc->destroy(const_cast<nvvk::Buffer&>(m_indirectReadbackHost));
 
+  m_alloc->destroy(const_cast<nvvk::Buffer&>(m_instanceIndicesDevice));
+  m_alloc->destroy(const_cast<nvvk::Buffer&>(m_instancesDevice));
+
   m_alloc->destroy(const_cast<nvvk::Buffer&>(m_quadVertices));
   m_alloc->destroy(const_cast<nvvk::Buffer&>(m_quadIndices));
 
+  m_alloc->unmap(m_frameInfoBuffer);
   m_alloc->destroy(const_cast<nvvk::Buffer&>(m_frameInfoBuffer));
-}
-
-inline uint8_t toUint8(float v, float rangeMin, float rangeMax)
-{
-  float normalized = (v - rangeMin) / (rangeMax - rangeMin);
-  return static_cast<uint8_t>(std::clamp(std::round(normalized * 255.0f), 0.0f, 255.0f));
-};
-
-inline int formatSize(uint32_t format)
-{
-  if(format == FORMAT_FLOAT32)
-    return 4;
-  if(format == FORMAT_FLOAT16)
-    return 2;
-  if(format == FORMAT_UINT8)
-    return 1;
-  return 0;
-}
-
-inline void storeSh(int format, float* srcBuffer, uint32_t srcIndex, void* dstBuffer, uint32_t dstIndex)
-{
-  if(format == FORMAT_FLOAT32)
-    static_cast<float*>(dstBuffer)[dstIndex] = srcBuffer[srcIndex];
-  else if(format == FORMAT_FLOAT16)
-    static_cast<uint16_t*>(dstBuffer)[dstIndex] = glm::packHalf1x16(srcBuffer[srcIndex]);
-  else if(format == FORMAT_UINT8)
-    static_cast<uint8_t*>(dstBuffer)[dstIndex] = toUint8(srcBuffer[srcIndex], -1., 1.);
+  m_frameInfoMapped = nullptr;
 }
 
 ///////////////////
 // using data buffers to store splatset in VRAM
 
 void GaussianSplatting::initDataBuffers(void) {
+  TRACE_SCOPE("initDataBuffers");
+  m_dataDefines = m_defines;
+
+  // data are uploaded through the staging ring
+  updateStagingRing();
+  m_modelMemoryStats.hostStaging = m_stagingRing.getSize();
+
   switch(m_gsMode)
   {
     case GSMODE_3DGS:
@@ -1087,41 +2310,27 @@ void GaussianSplatting::initDataBuffers_3DGS(void)
 {
   auto       startTime  = std::chrono::high_resolution_clock::now();
   const auto splatCount = (uint32_t)m_splatSet.positions.size() / 3;
-
-  VkCommandBuffer    cmd                  = m_app->createTempCmdBuffer();
-  VkBufferUsageFlags hostBufferUsageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-  VkMemoryPropertyFlags hostMemoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  // the buffers have room for the instances added later to a composed scene
+  const auto capacity = getSplatCapacity();
 
   VkBufferUsageFlags deviceBufferUsageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
                                               | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
                                               | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
   VkMemoryPropertyFlags deviceMemoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
-  // set of buffer to be freed after command execution
-  std::vector<nvvk::Buffer> buffersToDestroy;
+  // the attributes are packed chunk by chunk in the staging ring,
+  // the copies to the device buffers run behind the packing
 
   // Centers
   {
-    const uint32_t bufferSize = splatCount * 3 * sizeof(float);
-
-    // allocate host and device buffers
-    nvvk::Buffer hostBuffer = m_alloc->createBuffer(bufferSize, hostBufferUsageFlags, hostMemoryPropertyFlags);
+    const VkDeviceSize bufferSize = (VkDeviceSize)capacity * 3 * sizeof(float);
 
     m_centersDevice = m_alloc->createBuffer(bufferSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
     m_dutil->DBG_NAME(m_centersDevice.buffer);
 
-    // map and fill host buffer
-    float* hostBufferMapped = static_cast<float*>(m_alloc->map(hostBuffer));
-    memcpy(hostBufferMapped, m_splatSet.positions.data(), bufferSize);
-    m_alloc->unmap(hostBuffer);
-
-    // copy from host buffer to device buffer
-    // barrier at the end of this method.
-    VkBufferCopy bc{.srcOffset = 0, .dstOffset = 0, .size = bufferSize};
-    vkCmdCopyBuffer(cmd, hostBuffer.buffer, m_centersDevice.buffer, 1, &bc);
-
-    // free host buffer after command execution
-    buffersToDestroy.push_back(hostBuffer);
+    m_stagingRing.uploadBuffer(m_centersDevice.buffer, 0, splatCount, 3 * sizeof(float), [&](void* dst, uint64_t first, uint64_t count) {
+      packCenters(m_splatSet, static_cast<float*>(dst), 3, (uint32_t)first, (uint32_t)count);
+    });
 
     // memory statistics
     m_modelMemoryStats.srcCenters  = bufferSize;
@@ -1131,58 +2340,17 @@ void GaussianSplatting::initDataBuffers_3DGS(void)
 
   // covariances
   {
-    const uint32_t bufferSize = splatCount * 2 * 3 * sizeof(float);
-
-    // allocate host and device buffers
-    nvvk::Buffer hostBuffer = m_alloc->createBuffer(bufferSize, hostBufferUsageFlags, hostMemoryPropertyFlags);
+    const VkDeviceSize bufferSize = (VkDeviceSize)capacity * 2 * 3 * sizeof(float);
 
     m_covariancesDevice = m_alloc->createBuffer(bufferSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
     m_dutil->DBG_NAME(m_covariancesDevice.buffer);
 
-    // map and fill host buffer
-    float* hostBufferMapped = static_cast<float*>(m_alloc->map(hostBuffer));
-
-    //for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
-    START_PAR_LOOP(splatCount, splatIdx)
-    {
-      const auto stride3 = splatIdx * 3;
-      const auto stride4 = splatIdx * 4;
-      const auto stride6 = splatIdx * 6;
-      glm::vec3  scale{std::exp(m_splatSet.scale[stride3 + 0]), std::exp(m_splatSet.scale[stride3 + 1]),
-                      std::exp(m_splatSet.scale[stride3 + 2])};
-
-      glm::quat rotation{m_splatSet.rotation[stride4 + 0], m_splatSet.rotation[stride4 + 1],
-                         m_splatSet.rotation[stride4 + 2], m_splatSet.rotation[stride4 + 3]};
-      rotation = glm::normalize(rotation);
-
-      // computes the covariance
-      const glm::mat3 scaleMatrix           = glm::mat3(glm::scale(scale));
-      const glm::mat3 rotationMatrix        = glm::mat3_cast(rotation);  // where rotation is a quaternion
-      const glm::mat3 covarianceMatrix      = rotationMatrix * scaleMatrix;
-      glm::mat3       transformedCovariance = covarianceMatrix * glm::transpose(covarianceMatrix);
-
-      hostBufferMapped[stride6 + 0] = glm::value_ptr(transformedCovariance)[0];
-      hostBufferMapped[stride6 + 1] = glm::value_ptr(transformedCovariance)[3];
-      hostBufferMapped[stride6 + 2] = glm::value_ptr(transformedCovariance)[6];
-
-      hostBufferMapped[stride6 + 3] = glm::value_ptr(transformedCovariance)[4];
-      hostBufferMapped[stride6 + 4] = glm::value_ptr(transformedCovariance)[7];
-      hostBufferMapped[stride6 + 5] = glm::value_ptr(transformedCovariance)[8];
-    }
-    END_PAR_LOOP();
-
-    m_alloc->unmap(hostBuffer);
-
-    // copy from host buffer to device buffer
-    // barrier at the end of this method.
-    VkBufferCopy bc{.srcOffset = 0, .dstOffset = 0, .size = bufferSize};
-    vkCmdCopyBuffer(cmd, hostBuffer.buffer, m_covariancesDevice.buffer, 1, &bc);
-
-    // free host buffer after command execution
-    buffersToDestroy.push_back(hostBuffer);
+    m_stagingRing.uploadBuffer(m_covariancesDevice.buffer, 0, splatCount, 6 * sizeof(float), [&](void* dst, uint64_t first, uint64_t count) {
+      packCovariances_3DGS(m_splatSet, static_cast<float*>(dst), (uint32_t)first, (uint32_t)count);
+    });
 
     // memory statistics
-    m_modelMemoryStats.srcCov  = (splatCount * (4 + 3)) * sizeof(float);
+    m_modelMemoryStats.srcCov  = (uint64_t)splatCount * (4 + 3) * sizeof(float);
     m_modelMemoryStats.odevCov = bufferSize;  // no compression
     m_modelMemoryStats.devCov  = bufferSize;  // covariance takes less space than rotation + scale
   }
@@ -1190,39 +2358,14 @@ void GaussianSplatting::initDataBuffers_3DGS(void)
   // Colors. SH degree 0 is not view dependent, so we directly transform to base color
   // this will make some economy of processing in the shader at each frame
   {
-    const uint32_t bufferSize = splatCount * 4 * sizeof(float);
-
-    // allocate host and device buffers
-    nvvk::Buffer hostBuffer = m_alloc->createBuffer(bufferSize, hostBufferUsageFlags, hostMemoryPropertyFlags);
+    const VkDeviceSize bufferSize = (VkDeviceSize)capacity * 4 * sizeof(float);
 
     m_colorsDevice = m_alloc->createBuffer(bufferSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
     m_dutil->DBG_NAME(m_colorsDevice.buffer);
 
-    // fill host buffer
-    float* hostBufferMapped = static_cast<float*>(m_alloc->map(hostBuffer));
-
-    //for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
-    START_PAR_LOOP(splatCount, splatIdx)
-    {
-      const auto  stride3           = splatIdx * 3;
-      const auto  stride4           = splatIdx * 4;
-      const float SH_C0             = 0.28209479177387814f;
-      hostBufferMapped[stride4 + 0] = glm::clamp(0.5f + SH_C0 * m_splatSet.f_dc[stride3 + 0], 0.0f, 1.0f);
-      hostBufferMapped[stride4 + 1] = glm::clamp(0.5f + SH_C0 * m_splatSet.f_dc[stride3 + 1], 0.0f, 1.0f);
-      hostBufferMapped[stride4 + 2] = glm::clamp(0.5f + SH_C0 * m_splatSet.f_dc[stride3 + 2], 0.0f, 1.0f);
-      hostBufferMapped[stride4 + 3] = glm::clamp(1.0f / (1.0f + std::exp(-m_splatSet.opacity[splatIdx])), 0.0f, 1.0f);
-    }
-    END_PAR_LOOP()
-
-    m_alloc->unmap(hostBuffer);
-
-    // copy from host buffer to device buffer
-    // barrier at the end of this method.
-    VkBufferCopy bc{.srcOffset = 0, .dstOffset = 0, .size = bufferSize};
-    vkCmdCopyBuffer(cmd, hostBuffer.buffer, m_colorsDevice.buffer, 1, &bc);
-
-    // free host buffer after command execution
-    buffersToDestroy.push_back(hostBuffer);
+    m_stagingRing.uploadBuffer(m_colorsDevice.buffer, 0, splatCount, 4 * sizeof(float), [&](void* dst, uint64_t first, uint64_t count) {
+      packColors_3DGS(m_splatSet, static_cast<float*>(dst), (uint32_t)first, (uint32_t)count);
+    });
 
     // memory statistics
     m_modelMemoryStats.srcSh0  = bufferSize;
@@ -1232,119 +2375,63 @@ void GaussianSplatting::initDataBuffers_3DGS(void)
 
   // Spherical harmonics of degree 1 to 3
   {
-    const uint32_t totalSphericalHarmonicsComponentCount    = (uint32_t)m_splatSet.f_rest.size() / splatCount;
-    const uint32_t sphericalHarmonicsCoefficientsPerChannel = totalSphericalHarmonicsComponentCount / 3;
-    // find the maximum SH degree stored in the file
-    int sphericalHarmonicsDegree = 0;
-    int splatStride              = 0;
-    if(sphericalHarmonicsCoefficientsPerChannel >= 3)
-    {
-      sphericalHarmonicsDegree = 1;
-      splatStride += 3 * 3;
-    }
-    if(sphericalHarmonicsCoefficientsPerChannel >= 8)
+    // SH degrees of the file, possibly reduced by the memory admission policy
+    const uint32_t splatStride = getShComponentCount(m_shDegreeUploaded);
+
+    // adaptive storage, each splat stores the bands up to its own degree
+    const bool            adaptive = useAdaptiveSh();
+    std::vector<uint32_t> shHeaders;
+    uint64_t              elementCount = (uint64_t)capacity * splatStride;
+    std::fill(std::begin(m_shAdaptiveDegreeCounts), std::end(m_shAdaptiveDegreeCounts), 0);
+    if(adaptive)
     {
-      sphericalHarmonicsDegree = 2;
-      splatStride += 5 * 3;
+      std::vector<uint8_t> degrees;
+      computeShDegrees_3DGS(m_splatSet, m_shAdaptiveTolerance, m_shDegreeUploaded, degrees);
+      elementCount = computeAdaptiveShLayout(degrees, m_defines.shFormat, shHeaders);
+      for(uint8_t degree : degrees)
+        m_shAdaptiveDegreeCounts[degree]++;
+      std::cout << "Adaptive SH degrees 0/1/2/3: " << m_shAdaptiveDegreeCounts[0] << "/" << m_shAdaptiveDegreeCounts[1]
+                << "/" << m_shAdaptiveDegreeCounts[2] << "/" << m_shAdaptiveDegreeCounts[3] << " splats" << std::endl;
     }
-    if(sphericalHarmonicsCoefficientsPerChannel == 15)
-    {
-      sphericalHarmonicsDegree = 3;
-      splatStride += 7 * 3;
-    }
-
-    int targetSplatStride = splatStride;  // same for the time beeing, would be less if we do not upload all src degrees
-
-    // allocate host and device buffers
-    const uint32_t bufferSize = splatCount * splatStride * formatSize(m_defines.shFormat);
 
-    nvvk::Buffer hostBuffer = m_alloc->createBuffer(bufferSize, hostBufferUsageFlags, hostMemoryPropertyFlags);
+    // allocate the device buffer, not empty even without SH so the binding stays valid
+    const VkDeviceSize bufferSize =
+        std::max((VkDeviceSize)elementCount * formatSize(m_defines.shFormat), VkDeviceSize(sizeof(float)));
 
     m_sphericalHarmonicsDevice = m_alloc->createBuffer(bufferSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
     m_dutil->DBG_NAME(m_sphericalHarmonicsDevice.buffer);
 
-    // fill host buffer
-    void* hostBufferMapped = m_alloc->map(hostBuffer);
-
     auto startShTime = std::chrono::high_resolution_clock::now();
 
-    // for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
-    START_PAR_LOOP(splatCount, splatIdx)
+    if(adaptive)
     {
-      const auto srcBase   = splatStride * splatIdx;
-      const auto destBase  = targetSplatStride * splatIdx;
-      int        dstOffset = 0;
-      // degree 1, three coefs per component
-      for(auto i = 0; i < 3; i++)
-      {
-        for(auto rgb = 0; rgb < 3; rgb++)
-        {
-          const auto srcIndex = srcBase + (sphericalHarmonicsCoefficientsPerChannel * rgb + i);
-          const auto dstIndex = destBase + dstOffset++;  // inc after add
-
-          storeSh(m_defines.shFormat, m_splatSet.f_rest.data(), srcIndex, hostBufferMapped, dstIndex);
-        }
-      }
-      // degree 2, five coefs per component
-      for(auto i = 0; i < 5; i++)
-      {
-        for(auto rgb = 0; rgb < 3; rgb++)
-        {
-          const auto srcIndex = srcBase + (sphericalHarmonicsCoefficientsPerChannel * rgb + 3 + i);
-          const auto dstIndex = destBase + dstOffset++;  // inc after add
-
-          storeSh(m_defines.shFormat, m_splatSet.f_rest.data(), srcIndex, hostBufferMapped, dstIndex);
-        }
-      }
-      // degree 3, seven coefs per component
-      for(auto i = 0; i < 7; i++)
-      {
-        for(auto rgb = 0; rgb < 3; rgb++)
-        {
-          const auto srcIndex = srcBase + (sphericalHarmonicsCoefficientsPerChannel * rgb + 3 + 5 + i);
-          const auto dstIndex = destBase + dstOffset++;  // inc after add
-
-          storeSh(m_defines.shFormat, m_splatSet.f_rest.data(), srcIndex, hostBufferMapped, dstIndex);
-        }
-      }
+      // chunks are made of elements of format, splats may be split between two chunks
+      m_stagingRing.uploadBuffer(m_sphericalHarmonicsDevice.buffer, 0, elementCount, formatSize(m_defines.shFormat),
+                                 [&](void* dst, uint64_t first, uint64_t count) {
+                                   packAdaptiveSphericalHarmonics_3DGS(m_splatSet, m_defines.shFormat, shHeaders, dst, first, count);
+                                 });
+    }
+    else if(splatStride > 0)
+    {
+      m_stagingRing.uploadBuffer(m_sphericalHarmonicsDevice.buffer, 0, splatCount, splatStride * formatSize(m_defines.shFormat),
+                                 [&](void* dst, uint64_t first, uint64_t count) {
+                                   packSphericalHarmonics_3DGS(m_splatSet, m_defines.shFormat, dst, splatStride,
+                                                               m_shDegreeUploaded, (uint32_t)first, (uint32_t)count);
+                                 });
     }
-    END_PAR_LOOP()
 
     auto      endShTime   = std::chrono::high_resolution_clock::now();
     long long buildShTime = std::chrono::duration_cast<std::chrono::milliseconds>(endShTime - startShTime).count();
     std::cout << "Sh data updated in " << buildShTime << "ms" << std::endl;
 
-    m_alloc->unmap(hostBuffer);
-
-    // copy from host buffer to device buffer
-    // barrier at the end of this method.
-    VkBufferCopy bc{.srcOffset = 0, .dstOffset = 0, .size = bufferSize};
-    vkCmdCopyBuffer(cmd, hostBuffer.buffer, m_sphericalHarmonicsDevice.buffer, 1, &bc);
-
-    // free host buffer after command execution
-    buffersToDestroy.push_back(hostBuffer);
-
     // memory statistics
-    m_modelMemoryStats.srcShOther  = (uint32_t)m_splatSet.f_rest.size() * sizeof(float);
+    m_modelMemoryStats.srcShOther  = m_splatSet.f_rest.size() * sizeof(float);
     m_modelMemoryStats.odevShOther = bufferSize;  // no compression or quantization
     m_modelMemoryStats.devShOther  = bufferSize;
   }
 
   // sync with end of copy to device
-  VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
-  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                       VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT,
-                       0, 1, &barrier, 0, NULL, 0, NULL);
-
-  m_app->submitAndWaitTempCmdBuffer(cmd);
-
-  // free temp buffers
-  for(auto& buffer : buffersToDestroy)
-  {
-    m_alloc->destroy(buffer);
-  }
+  m_stagingRing.flush();
 
   // update statistics totals
   m_modelMemoryStats.srcShAll  = m_modelMemoryStats.srcSh0 + m_modelMemoryStats.srcShOther;
@@ -1368,40 +2455,21 @@ void GaussianSplatting::initDataBuffers_SpaceTime_Lite(void)
   auto       startTime  = std::chrono::high_resolution_clock::now();
   const auto splatCount = (uint32_t)m_splatSet.positions.size() / 3;
 
-  VkCommandBuffer    cmd                  = m_app->createTempCmdBuffer();
-  VkBufferUsageFlags hostBufferUsageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-  VkMemoryPropertyFlags hostMemoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-
   VkBufferUsageFlags deviceBufferUsageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
                                               | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
                                               | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
   VkMemoryPropertyFlags deviceMemoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
-  // set of buffer to be freed after command execution
-  std::vector<nvvk::Buffer> buffersToDestroy;
-
   // Centers
   {
-    const uint32_t bufferSize = splatCount * 3 * sizeof(float);
-
-    // allocate host and device buffers
-    nvvk::Buffer hostBuffer = m_alloc->createBuffer(bufferSize, hostBufferUsageFlags, hostMemoryPropertyFlags);
+    const VkDeviceSize bufferSize = (VkDeviceSize)splatCount * 3 * sizeof(float);
 
     m_centersDevice = m_alloc->createBuffer(bufferSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
     m_dutil->DBG_NAME(m_centersDevice.buffer);
 
-    // map and fill host buffer
-    float* hostBufferMapped = static_cast<float*>(m_alloc->map(hostBuffer));
-    memcpy(hostBufferMapped, m_splatSet.positions.data(), bufferSize);
-    m_alloc->unmap(hostBuffer);
-
-    // copy from host buffer to device buffer
-    // barrier at the end of this method.
-    VkBufferCopy bc{.srcOffset = 0, .dstOffset = 0, .size = bufferSize};
-    vkCmdCopyBuffer(cmd, hostBuffer.buffer, m_centersDevice.buffer, 1, &bc);
-
-    // free host buffer after command execution
-    buffersToDestroy.push_back(hostBuffer);
+    m_stagingRing.uploadBuffer(m_centersDevice.buffer, 0, splatCount, 3 * sizeof(float), [&](void* dst, uint64_t first, uint64_t count) {
+      memcpy(dst, m_splatSet.positions.data() + first * 3, count * 3 * sizeof(float));
+    });
 
     // memory statistics
     m_modelMemoryStats.srcCenters  = bufferSize;
@@ -1411,58 +2479,14 @@ void GaussianSplatting::initDataBuffers_SpaceTime_Lite(void)
 
   // covariances
   { // we use this to store features6 in full model, so we do nothing here in lite model
-    const uint32_t bufferSize = splatCount * 2 * 3 * sizeof(float);
-
-    // allocate host and device buffers
-    nvvk::Buffer hostBuffer = m_alloc->createBuffer(bufferSize, hostBufferUsageFlags, hostMemoryPropertyFlags);
+    const VkDeviceSize bufferSize = (VkDeviceSize)splatCount * 2 * 3 * sizeof(float);
 
+    // allocated to keep the binding valid, nothing is uploaded
     m_covariancesDevice = m_alloc->createBuffer(bufferSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
     m_dutil->DBG_NAME(m_covariancesDevice.buffer);
 
-    // map and fill host buffer
-    float* hostBufferMapped = static_cast<float*>(m_alloc->map(hostBuffer));
-
-    //for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
-    START_PAR_LOOP(splatCount, splatIdx)
-    {
-      /*const auto stride3 = splatIdx * 3;
-      const auto stride4 = splatIdx * 4;
-      const auto stride6 = splatIdx * 6;
-      glm::vec3  scale{std::exp(m_splatSet.scale[stride3 + 0]), std::exp(m_splatSet.scale[stride3 + 1]),
-                      std::exp(m_splatSet.scale[stride3 + 2])};
-
-      glm::quat rotation{m_splatSet.rotation[stride4 + 0], m_splatSet.rotation[stride4 + 1],
-                         m_splatSet.rotation[stride4 + 2], m_splatSet.rotation[stride4 + 3]};
-      rotation = glm::normalize(rotation);
-
-      // computes the covariance
-      const glm::mat3 scaleMatrix           = glm::mat3(glm::scale(scale));
-      const glm::mat3 rotationMatrix        = glm::mat3_cast(rotation);  // where rotation is a quaternion
-      const glm::mat3 covarianceMatrix      = rotationMatrix * scaleMatrix;
-      glm::mat3       transformedCovariance = covarianceMatrix * glm::transpose(covarianceMatrix);
-
-      hostBufferMapped[stride6 + 0] = glm::value_ptr(transformedCovariance)[0];
-      hostBufferMapped[stride6 + 1] = glm::value_ptr(transformedCovariance)[3];
-      hostBufferMapped[stride6 + 2] = glm::value_ptr(transformedCovariance)[6];
-
-      hostBufferMapped[stride6 + 3] = glm::value_ptr(transformedCovariance)[4];
-      hostBufferMapped[stride6 + 4] = glm::value_ptr(transformedCovariance)[7];
-      hostBufferMapped[stride6 + 5] = glm::value_ptr(transformedCovariance)[8];*/
-    }
-    END_PAR_LOOP();
-
-    m_alloc->unmap(hostBuffer);
-
-    // copy from host buffer to device buffer
-    // barrier at the end of this method.
-    VkBufferCopy bc{.srcOffset = 0, .dstOffset = 0, .size = bufferSize};
-    vkCmdCopyBuffer(cmd, hostBuffer.buffer, m_covariancesDevice.buffer, 1, &bc);
-
-    // free host buffer after command execution
-    buffersToDestroy.push_back(hostBuffer);
-
     // memory statistics
-    m_modelMemoryStats.srcCov  = (splatCount * (4 + 3)) * sizeof(float);
+    m_modelMemoryStats.srcCov  = (uint64_t)splatCount * (4 + 3) * sizeof(float);
     m_modelMemoryStats.odevCov = bufferSize;  // no compression
     m_modelMemoryStats.devCov  = bufferSize;  // covariance takes less space than rotation + scale
   }
@@ -1470,38 +2494,25 @@ void GaussianSplatting::initDataBuffers_SpaceTime_Lite(void)
   // Colors. SH degree 0 is not view dependent, so we directly transform to base color
   // this will make some economy of processing in the shader at each frame
   {
-    const uint32_t bufferSize = splatCount * 4 * sizeof(float);
-
-    // allocate host and device buffers
-    nvvk::Buffer hostBuffer = m_alloc->createBuffer(bufferSize, hostBufferUsageFlags, hostMemoryPropertyFlags);
+    const VkDeviceSize bufferSize = (VkDeviceSize)splatCount * 4 * sizeof(float);
 
     m_colorsDevice = m_alloc->createBuffer(bufferSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
     m_dutil->DBG_NAME(m_colorsDevice.buffer);
 
-    // fill host buffer
-    float* hostBufferMapped = static_cast<float*>(m_alloc->map(hostBuffer));
-
-    //for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
-    START_PAR_LOOP(splatCount, splatIdx)
-    {
-      const auto  stride3           = splatIdx * 3;
-      const auto  stride4           = splatIdx * 4;
-      hostBufferMapped[stride4 + 0] = m_splatSet.f_dc[stride3 + 0];
-      hostBufferMapped[stride4 + 1] = m_splatSet.f_dc[stride3 + 1];
-      hostBufferMapped[stride4 + 2] = m_splatSet.f_dc[stride3 + 2];
-      hostBufferMapped[stride4 + 3] = 1.0f / (1.0f + std::exp(-m_splatSet.opacity[splatIdx]));
-    }
-    END_PAR_LOOP()
-
-    m_alloc->unmap(hostBuffer);
-
-    // copy from host buffer to device buffer
-    // barrier at the end of this method.
-    VkBufferCopy bc{.srcOffset = 0, .dstOffset = 0, .size = bufferSize};
-    vkCmdCopyBuffer(cmd, hostBuffer.buffer, m_colorsDevice.buffer, 1, &bc);
-
-    // free host buffer after command execution
-    buffersToDestroy.push_back(hostBuffer);
+    m_stagingRing.uploadBuffer(m_colorsDevice.buffer, 0, splatCount, 4 * sizeof(float), [&](void* dst, uint64_t first, uint64_t count) {
+      float* hostBufferMapped = static_cast<float*>(dst);
+      START_PAR_LOOP(count, i)
+      {
+        const auto  splatIdx          = first + i;
+        const auto  stride3           = splatIdx * 3;
+        const auto  stride4           = i * 4;
+        hostBufferMapped[stride4 + 0] = m_splatSet.f_dc[stride3 + 0];
+        hostBufferMapped[stride4 + 1] = m_splatSet.f_dc[stride3 + 1];
+        hostBufferMapped[stride4 + 2] = m_splatSet.f_dc[stride3 + 2];
+        hostBufferMapped[stride4 + 3] = 1.0f / (1.0f + std::exp(-m_splatSet.opacity[splatIdx]));
+      }
+      END_PAR_LOOP()
+    });
 
     // memory statistics
     m_modelMemoryStats.srcSh0  = bufferSize;
@@ -1512,59 +2523,46 @@ void GaussianSplatting::initDataBuffers_SpaceTime_Lite(void)
   // 3DGS: Spherical harmonics of degree 1 to 3
   // 4DGS: motion9 scale3 rot_omega8 trbf2
   {
-    const uint32_t bufferSize = splatCount * 22 * sizeof(float);
-
-    // allocate host and device buffers
-    nvvk::Buffer hostBuffer = m_alloc->createBuffer(bufferSize, hostBufferUsageFlags, hostMemoryPropertyFlags);
+    const VkDeviceSize bufferSize = (VkDeviceSize)splatCount * 22 * sizeof(float);
 
     m_sphericalHarmonicsDevice = m_alloc->createBuffer(bufferSize, deviceBufferUsageFlags, deviceMemoryPropertyFlags);
     m_dutil->DBG_NAME(m_sphericalHarmonicsDevice.buffer);
 
-    // fill host buffer
-    float* hostBufferMapped = static_cast<float*>(m_alloc->map(hostBuffer));
-
-    //for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
-    START_PAR_LOOP(splatCount, splatIdx)
-    {
-      const auto stride3                  = splatIdx * 3;
-      const auto stride4                  = splatIdx * 4;
-      const auto stride15            = splatIdx * 15;
-      const auto stride22            = splatIdx * 22;
-      hostBufferMapped[stride22 + 0]  = m_splatSet.f_rest[stride15 + 0];
-      hostBufferMapped[stride22 + 1]  = m_splatSet.f_rest[stride15 + 1];
-      hostBufferMapped[stride22 + 2]  = m_splatSet.f_rest[stride15 + 2];
-      hostBufferMapped[stride22 + 3]  = m_splatSet.f_rest[stride15 + 3];
-      hostBufferMapped[stride22 + 4]  = m_splatSet.f_rest[stride15 + 4];
-      hostBufferMapped[stride22 + 5]  = m_splatSet.f_rest[stride15 + 5];
-      hostBufferMapped[stride22 + 6]  = m_splatSet.f_rest[stride15 + 6];
-      hostBufferMapped[stride22 + 7]  = m_splatSet.f_rest[stride15 + 7];
-      hostBufferMapped[stride22 + 8]  = m_splatSet.f_rest[stride15 + 8];
-      hostBufferMapped[stride22 + 9]      = std::exp(m_splatSet.scale[stride3 + 0]);
-      hostBufferMapped[stride22 + 10]     = std::exp(m_splatSet.scale[stride3 + 1]);
-      hostBufferMapped[stride22 + 11]     = std::exp(m_splatSet.scale[stride3 + 2]);
-      hostBufferMapped[stride22 + 12]     = m_splatSet.rotation[stride4 + 0];
-      hostBufferMapped[stride22 + 13]     = m_splatSet.rotation[stride4 + 1];
-      hostBufferMapped[stride22 + 14]     = m_splatSet.rotation[stride4 + 2];
-      hostBufferMapped[stride22 + 15]     = m_splatSet.rotation[stride4 + 3];
-      hostBufferMapped[stride22 + 16]     = m_splatSet.f_rest[stride15 + 9];
-      hostBufferMapped[stride22 + 17]     = m_splatSet.f_rest[stride15 + 10];
-      hostBufferMapped[stride22 + 18]     = m_splatSet.f_rest[stride15 + 11];
-      hostBufferMapped[stride22 + 19]     = m_splatSet.f_rest[stride15 + 12];
-      hostBufferMapped[stride22 + 20]     = m_splatSet.f_rest[stride15 + 13];
-      auto temp_scale                     = std::exp(-m_splatSet.f_rest[stride15 + 14]);
-      hostBufferMapped[stride22 + 21]     = temp_scale * temp_scale;
-    }
-    END_PAR_LOOP()
-
-    m_alloc->unmap(hostBuffer);
-
-    // copy from host buffer to device buffer
-    // barrier at the end of this method.
-    VkBufferCopy bc{.srcOffset = 0, .dstOffset = 0, .size = bufferSize};
-    vkCmdCopyBuffer(cmd, hostBuffer.buffer, m_sphericalHarmonicsDevice.buffer, 1, &bc);
-
-    // free host buffer after command execution
-    buffersToDestroy.push_back(hostBuffer);
+    m_stagingRing.uploadBuffer(m_sphericalHarmonicsDevice.buffer, 0, splatCount, 22 * sizeof(float), [&](void* dst, uint64_t first, uint64_t count) {
+      float* hostBufferMapped = static_cast<float*>(dst);
+      START_PAR_LOOP(count, i)
+      {
+        const auto splatIdx                 = first + i;
+        const auto stride3                  = splatIdx * 3;
+        const auto stride4                  = splatIdx * 4;
+        const auto stride15                 = splatIdx * 15;
+        const auto stride22                 = i * 22;
+        hostBufferMapped[stride22 + 0]      = m_splatSet.f_rest[stride15 + 0];
+        hostBufferMapped[stride22 + 1]      = m_splatSet.f_rest[stride15 + 1];
+        hostBufferMapped[stride22 + 2]      = m_splatSet.f_rest[stride15 + 2];
+        hostBufferMapped[stride22 + 3]      = m_splatSet.f_rest[stride15 + 3];
+        hostBufferMapped[stride22 + 4]      = m_splatSet.f_rest[stride15 + 4];
+        hostBufferMapped[stride22 + 5]      = m_splatSet.f_rest[stride15 + 5];
+        hostBufferMapped[stride22 + 6]      = m_splatSet.f_rest[stride15 + 6];
+        hostBufferMapped[stride22 + 7]      = m_splatSet.f_rest[stride15 + 7];
+        hostBufferMapped[stride22 + 8]      = m_splatSet.f_rest[stride15 + 8];
+        hostBufferMapped[stride22 + 9]      = std::exp(m_splatSet.scale[stride3 + 0]);
+        hostBufferMapped[stride22 + 10]     = std::exp(m_splatSet.scale[stride3 + 1]);
+        hostBufferMapped[stride22 + 11]     = std::exp(m_splatSet.scale[stride3 + 2]);
+        hostBufferMapped[stride22 + 12]     = m_splatSet.rotation[stride4 + 0];
+        hostBufferMapped[stride22 + 13]     = m_splatSet.rotation[stride4 + 1];
+        hostBufferMapped[stride22 + 14]     = m_splatSet.rotation[stride4 + 2];
+        hostBufferMapped[stride22 + 15]     = m_splatSet.rotation[stride4 + 3];
+        hostBufferMapped[stride22 + 16]     = m_splatSet.f_rest[stride15 + 9];
+        hostBufferMapped[stride22 + 17]     = m_splatSet.f_rest[stride15 + 10];
+        hostBufferMapped[stride22 + 18]     = m_splatSet.f_rest[stride15 + 11];
+        hostBufferMapped[stride22 + 19]     = m_splatSet.f_rest[stride15 + 12];
+        hostBufferMapped[stride22 + 20]     = m_splatSet.f_rest[stride15 + 13];
+        auto temp_scale                     = std::exp(-m_splatSet.f_rest[stride15 + 14]);
+        hostBufferMapped[stride22 + 21]     = temp_scale * temp_scale;
+      }
+      END_PAR_LOOP()
+    });
 
     // memory statistics
     m_modelMemoryStats.srcSh0  = bufferSize;
@@ -1573,20 +2571,7 @@ void GaussianSplatting::initDataBuffers_SpaceTime_Lite(void)
   }
 
   // sync with end of copy to device
-  VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
-  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                       VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT,
-                       0, 1, &barrier, 0, NULL, 0, NULL);
-
-  m_app->submitAndWaitTempCmdBuffer(cmd);
-
-  // free temp buffers
-  for(auto& buffer : buffersToDestroy)
-  {
-    m_alloc->destroy(buffer);
-  }
+  m_stagingRing.flush();
 
   // update statistics totals
   m_modelMemoryStats.srcShAll  = m_modelMemoryStats.srcSh0 + m_modelMemoryStats.srcShOther;
@@ -1616,23 +2601,37 @@ void GaussianSplatting::deinitDataBuffers()
 ///////////////////
 // using texture maps to store splatset in VRAM
 
-void GaussianSplatting::initTexture(uint32_t         width,
-                                    uint32_t         height,
-                                    uint32_t         bufsize,
-                                    void*            data,
-                                    VkFormat         format,
-                                    const VkSampler& sampler,
-                                    nvvk::Texture&   texture)
+void GaussianSplatting::updateStagingRing()
+{
+  const VkDeviceSize ringSize = (VkDeviceSize)std::max(m_stagingRingSizeMB, 1u) * 1024 * 1024;
+  // the chunks are rounded, compare with the size before rounding
+  if(m_stagingRing.isValid() && m_stagingRingAllocatedMB == m_stagingRingSizeMB)
+    return;
+  // the splat data is read by the compute distance pass and by the raster stages
+  const VkPipelineStageFlags shaderStages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
+                                            | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | meshShaderStage();
+  m_stagingRing.deinit();
+  m_stagingRing.init(m_app, m_alloc.get(), ringSize, shaderStages);
+  m_stagingRingAllocatedMB = m_stagingRingSizeMB;
+}
+
+void GaussianSplatting::initTexture(uint32_t                         width,
+                                    uint32_t                         height,
+                                    VkFormat                         format,
+                                    VkDeviceSize                     texelSize,
+                                    VkDeviceSize                     elementSize,
+                                    const StagingRing::FillFunction& fill,
+                                    const VkSampler&                 sampler,
+                                    nvvk::Texture&                   texture)
 {
-  const VkSamplerCreateInfo sampler_info{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
-  const VkExtent2D          size        = {width, height};
-  const VkImageCreateInfo   create_info = nvvk::makeImage2DCreateInfo(size, format, VK_IMAGE_USAGE_SAMPLED_BIT, false);
+  const VkExtent2D        size        = {width, height};
+  const VkImageCreateInfo create_info = nvvk::makeImage2DCreateInfo(size, format, VK_IMAGE_USAGE_SAMPLED_BIT, false);
 
-  nvvk::CommandPool cpool(m_device, m_app->getQueue(0).familyIndex);
-  VkCommandBuffer   cmd = cpool.createCommandBuffer();
+  const nvvk::Image image = m_alloc->createImage(create_info);
+  texture                 = m_alloc->createTexture(image, nvvk::makeImage2DViewCreateInfo(image.image, format));
 
-  texture = m_alloc->createTexture(cmd, bufsize, data, create_info, sampler_info);
-  cpool.submitAndWait(cmd);
+  // the texels are written chunk by chunk, no full size copy of the map in host memory
+  m_stagingRing.uploadImage(texture.image, width, height, texelSize, elementSize, fill);
 
   texture.descriptor.sampler = sampler;
 }
@@ -1643,6 +2642,35 @@ void GaussianSplatting::deinitTexture(nvvk::Texture& texture)
 }
 
 void GaussianSplatting::initDataTextures(void)
+{
+  TRACE_SCOPE("initDataTextures");
+  m_dataDefines = m_defines;
+
+  // data are uploaded through the staging ring
+  updateStagingRing();
+  m_modelMemoryStats.hostStaging = m_stagingRing.getSize();
+
+  switch(m_gsMode)
+  {
+    case GSMODE_3DGS:
+      initDataTextures_3DGS();
+      break;
+    case GSMODE_SPACETIME_LITE:
+      initDataTextures_SpaceTime_Lite();
+      break;
+    default:
+      break;
+  }
+}
+
+// zeroes the elements of a chunk past the last splat, padding at the end of the data texture maps
+static void clearPadding(void* dst, uint64_t first, uint64_t count, uint64_t splatCount, VkDeviceSize elementSize)
+{
+  const uint64_t valid = first < splatCount ? std::min(count, splatCount - first) : 0;
+  memset(static_cast<uint8_t*>(dst) + valid * elementSize, 0, (count - valid) * elementSize);
+}
+
+void GaussianSplatting::initDataTextures_3DGS(void)
 {
   auto startTime = std::chrono::high_resolution_clock::now();
 
@@ -1659,117 +2687,55 @@ void GaussianSplatting::initDataTextures(void)
   // TODO: May pack as done for covariances not to waste alpha chanel ? but must
   // compare performance (1 lookup vs 2 lookups due to packing)
   {
-    glm::ivec2         mapSize = computeDataTextureSize(3, 3, splatCount);
-    std::vector<float> centers(mapSize.x * mapSize.y * 4);  // includes some padding and unused w channel
-    //for(uint32_t i = 0; i < splatCount; ++i)
-    START_PAR_LOOP(splatCount, splatIdx)
-    {
-      // we skip the alpha channel that is left undefined and not used in the shader
-      for(uint32_t cmp = 0; cmp < 3; ++cmp)
-      {
-        centers[splatIdx * 4 + cmp] = m_splatSet.positions[splatIdx * 3 + cmp];
-      }
-    }
-    END_PAR_LOOP()
-
-    // place the result in the dedicated texture map
-    initTexture(mapSize.x, mapSize.y, (uint32_t)centers.size() * sizeof(float), (void*)centers.data(),
-                VK_FORMAT_R32G32B32A32_SFLOAT, m_alloc->acquireSampler(sampler_info), m_centersMap);
+    glm::ivec2 mapSize = computeDataTextureSize(3, 3, splatCount);
+    // includes some padding and unused w channel
+    initTexture(mapSize.x, mapSize.y, VK_FORMAT_R32G32B32A32_SFLOAT, 4 * sizeof(float), 4 * sizeof(float),
+                [&](void* dst, uint64_t first, uint64_t count) {
+                  packCenters(m_splatSet, static_cast<float*>(dst), 4, (uint32_t)first, (uint32_t)count);
+                  clearPadding(dst, first, count, splatCount, 4 * sizeof(float));
+                },
+                m_alloc->acquireSampler(sampler_info), m_centersMap);
     // memory statistics
-    m_modelMemoryStats.srcCenters  = splatCount * 3 * sizeof(float);
-    m_modelMemoryStats.odevCenters = splatCount * 3 * sizeof(float);  // no compression or quantization yet
-    m_modelMemoryStats.devCenters  = mapSize.x * mapSize.y * 4 * sizeof(float);
+    m_modelMemoryStats.srcCenters  = (uint64_t)splatCount * 3 * sizeof(float);
+    m_modelMemoryStats.odevCenters = (uint64_t)splatCount * 3 * sizeof(float);  // no compression or quantization yet
+    m_modelMemoryStats.devCenters  = (uint64_t)mapSize.x * mapSize.y * 4 * sizeof(float);
   }
   // covariances
   {
-    glm::ivec2         mapSize = computeDataTextureSize(4, 6, splatCount);
-    std::vector<float> covariances(mapSize.x * mapSize.y * 4, 0.0f);
-    //for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
-    START_PAR_LOOP(splatCount, splatIdx)
-    {
-      const auto stride3 = splatIdx * 3;
-      const auto stride4 = splatIdx * 4;
-      const auto stride6 = splatIdx * 6;
-      glm::vec3  scale{std::exp(m_splatSet.scale[stride3 + 0]), std::exp(m_splatSet.scale[stride3 + 1]),
-                      std::exp(m_splatSet.scale[stride3 + 2])};
-
-      glm::quat rotation{m_splatSet.rotation[stride4 + 0], m_splatSet.rotation[stride4 + 1],
-                         m_splatSet.rotation[stride4 + 2], m_splatSet.rotation[stride4 + 3]};
-      rotation = glm::normalize(rotation);
-
-      // computes the covariance
-      const glm::mat3 scaleMatrix           = glm::mat3(glm::scale(scale));
-      const glm::mat3 rotationMatrix        = glm::mat3_cast(rotation);  // where rotation is a quaternion
-      const glm::mat3 covarianceMatrix      = rotationMatrix * scaleMatrix;
-      glm::mat3       transformedCovariance = covarianceMatrix * glm::transpose(covarianceMatrix);
-
-      covariances[stride6 + 0] = glm::value_ptr(transformedCovariance)[0];
-      covariances[stride6 + 1] = glm::value_ptr(transformedCovariance)[3];
-      covariances[stride6 + 2] = glm::value_ptr(transformedCovariance)[6];
-
-      covariances[stride6 + 3] = glm::value_ptr(transformedCovariance)[4];
-      covariances[stride6 + 4] = glm::value_ptr(transformedCovariance)[7];
-      covariances[stride6 + 5] = glm::value_ptr(transformedCovariance)[8];
-    }
-    END_PAR_LOOP()
-
-    // place the result in the dedicated texture map
-    initTexture(mapSize.x, mapSize.y, (uint32_t)covariances.size() * sizeof(float), (void*)covariances.data(),
-                VK_FORMAT_R32G32B32A32_SFLOAT, m_alloc->acquireSampler(sampler_info), m_covariancesMap);
+    glm::ivec2 mapSize = computeDataTextureSize(4, 6, splatCount);
+    initTexture(mapSize.x, mapSize.y, VK_FORMAT_R32G32B32A32_SFLOAT, 4 * sizeof(float), 6 * sizeof(float),
+                [&](void* dst, uint64_t first, uint64_t count) {
+                  packCovariances_3DGS(m_splatSet, static_cast<float*>(dst), (uint32_t)first, (uint32_t)count);
+                  clearPadding(dst, first, count, splatCount, 6 * sizeof(float));
+                },
+                m_alloc->acquireSampler(sampler_info), m_covariancesMap);
     // memory statistics
-    m_modelMemoryStats.srcCov  = (splatCount * (4 + 3)) * sizeof(float);
-    m_modelMemoryStats.odevCov = splatCount * 6 * sizeof(float);  // covariance takes less space than rotation + scale
-    m_modelMemoryStats.devCov  = mapSize.x * mapSize.y * 4 * sizeof(float);
+    m_modelMemoryStats.srcCov  = (uint64_t)splatCount * (4 + 3) * sizeof(float);
+    m_modelMemoryStats.odevCov = (uint64_t)splatCount * 6 * sizeof(float);  // covariance takes less space than rotation + scale
+    m_modelMemoryStats.devCov  = (uint64_t)mapSize.x * mapSize.y * 4 * sizeof(float);
   }
   // SH degree 0 is not view dependent, so we directly transform to base color
   // this will make some economy of processing in the shader at each frame
   {
-    glm::ivec2           mapSize = computeDataTextureSize(4, 4, splatCount);
-    std::vector<uint8_t> colors(mapSize.x * mapSize.y * 4);  // includes some padding
-    //for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
-    START_PAR_LOOP(splatCount, splatIdx)
-    {
-      const auto  stride3 = splatIdx * 3;
-      const auto  stride4 = splatIdx * 4;
-      const float SH_C0   = 0.28209479177387814f;
-      colors[stride4 + 0] = (uint8_t)glm::clamp(std::floor((0.5f + SH_C0 * m_splatSet.f_dc[stride3 + 0]) * 255), 0.0f, 255.0f);
-      colors[stride4 + 1] = (uint8_t)glm::clamp(std::floor((0.5f + SH_C0 * m_splatSet.f_dc[stride3 + 1]) * 255), 0.0f, 255.0f);
-      colors[stride4 + 2] = (uint8_t)glm::clamp(std::floor((0.5f + SH_C0 * m_splatSet.f_dc[stride3 + 2]) * 255), 0.0f, 255.0f);
-      colors[stride4 + 3] =
-          (uint8_t)glm::clamp(std::floor((1.0f / (1.0f + std::exp(-m_splatSet.opacity[splatIdx]))) * 255), 0.0f, 255.0f);
-    }
-    END_PAR_LOOP()
-    // place the result in the dedicated texture map
-    initTexture(mapSize.x, mapSize.y, (uint32_t)colors.size(), (void*)colors.data(), VK_FORMAT_R8G8B8A8_UNORM,
+    glm::ivec2 mapSize = computeDataTextureSize(4, 4, splatCount);
+    initTexture(mapSize.x, mapSize.y, VK_FORMAT_R8G8B8A8_UNORM, 4, 4,
+                [&](void* dst, uint64_t first, uint64_t count) {
+                  packColorsUnorm_3DGS(m_splatSet, static_cast<uint8_t*>(dst), (uint32_t)first, (uint32_t)count);
+                  clearPadding(dst, first, count, splatCount, 4);
+                },
                 m_alloc->acquireSampler(sampler_info), m_colorsMap);
     // memory statistics
-    m_modelMemoryStats.srcSh0  = splatCount * 4 * sizeof(float);  // original sh0 and opacity are floats
-    m_modelMemoryStats.odevSh0 = splatCount * 4 * sizeof(uint8_t);
-    m_modelMemoryStats.devSh0  = mapSize.x * mapSize.y * 4 * sizeof(uint8_t);
+    m_modelMemoryStats.srcSh0  = (uint64_t)splatCount * 4 * sizeof(float);  // original sh0 and opacity are floats
+    m_modelMemoryStats.odevSh0 = (uint64_t)splatCount * 4 * sizeof(uint8_t);
+    m_modelMemoryStats.devSh0  = (uint64_t)mapSize.x * mapSize.y * 4 * sizeof(uint8_t);
   }
   // Prepare the spherical harmonics of degree 1 to 3
   {
-    const uint32_t sphericalHarmonicsElementsPerTexel       = 4;
-    const uint32_t totalSphericalHarmonicsComponentCount    = (uint32_t)m_splatSet.f_rest.size() / splatCount;
-    const uint32_t sphericalHarmonicsCoefficientsPerChannel = totalSphericalHarmonicsComponentCount / 3;
+    const uint32_t sphericalHarmonicsElementsPerTexel = 4;
     // find the maximum SH degree stored in the file
-    int sphericalHarmonicsDegree = 0;
-    if(sphericalHarmonicsCoefficientsPerChannel >= 3)
-      sphericalHarmonicsDegree = 1;
-    if(sphericalHarmonicsCoefficientsPerChannel >= 8)
-      sphericalHarmonicsDegree = 2;
-    if(sphericalHarmonicsCoefficientsPerChannel >= 15)
-      sphericalHarmonicsDegree = 3;
+    const int sphericalHarmonicsComponentCount = getShComponentCount(getShDegree_3DGS(m_splatSet));
 
     // add some padding at each splat if needed for easy texture lookups
-    int sphericalHarmonicsComponentCount = 0;
-    if(sphericalHarmonicsDegree == 1)
-      sphericalHarmonicsComponentCount = 9;
-    if(sphericalHarmonicsDegree == 2)
-      sphericalHarmonicsComponentCount = 24;
-    if(sphericalHarmonicsDegree == 3)
-      sphericalHarmonicsComponentCount = 45;
-
     int paddedSphericalHarmonicsComponentCount = sphericalHarmonicsComponentCount;
     while(paddedSphericalHarmonicsComponentCount % 4 != 0)
       paddedSphericalHarmonicsComponentCount++;
@@ -1777,78 +2743,183 @@ void GaussianSplatting::initDataTextures(void)
     glm::ivec2 mapSize =
         computeDataTextureSize(sphericalHarmonicsElementsPerTexel, paddedSphericalHarmonicsComponentCount, splatCount);
 
-    const uint32_t bufferSize = mapSize.x * mapSize.y * sphericalHarmonicsElementsPerTexel * formatSize(m_defines.shFormat);
-
-    std::vector<uint8_t> paddedSHArray(bufferSize, 0);
-
-    void* data = (void*)paddedSHArray.data();
-
-    //for(uint32_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
-    START_PAR_LOOP(splatCount, splatIdx)
-    {
-      const auto srcBase   = totalSphericalHarmonicsComponentCount * splatIdx;
-      const auto destBase  = paddedSphericalHarmonicsComponentCount * splatIdx;
-      int        dstOffset = 0;
-      // degree 1, three coefs per component
-      for(auto i = 0; i < 3; i++)
-      {
-        for(auto rgb = 0; rgb < 3; rgb++)
-        {
-          const auto srcIndex = srcBase + (sphericalHarmonicsCoefficientsPerChannel * rgb + i);
-          const auto dstIndex = destBase + dstOffset++;  // inc after add
-
-          storeSh(m_defines.shFormat, m_splatSet.f_rest.data(), srcIndex, data, dstIndex);
-        }
-      }
-
-      // degree 2, five coefs per component
-      for(auto i = 0; i < 5; i++)
-      {
-        for(auto rgb = 0; rgb < 3; rgb++)
-        {
-          const auto srcIndex = srcBase + (sphericalHarmonicsCoefficientsPerChannel * rgb + 3 + i);
-          const auto dstIndex = destBase + dstOffset++;  // inc after add
-
-          storeSh(m_defines.shFormat, m_splatSet.f_rest.data(), srcIndex, data, dstIndex);
-        }
-      }
-      // degree 3, seven coefs per component
-      for(auto i = 0; i < 7; i++)
-      {
-        for(auto rgb = 0; rgb < 3; rgb++)
-        {
-          const auto srcIndex = srcBase + (sphericalHarmonicsCoefficientsPerChannel * rgb + 3 + 5 + i);
-          const auto dstIndex = destBase + dstOffset++;  // inc after add
-
-          storeSh(m_defines.shFormat, m_splatSet.f_rest.data(), srcIndex, data, dstIndex);
-        }
-      }
-    }
-    END_PAR_LOOP()
+    const VkDeviceSize bufferSize = (VkDeviceSize)mapSize.x * mapSize.y * sphericalHarmonicsElementsPerTexel * formatSize(m_defines.shFormat);
+    const VkDeviceSize texelSize  = sphericalHarmonicsElementsPerTexel * formatSize(m_defines.shFormat);
+    // without SH, one texel per splat keeps the chunks made of whole elements
+    const VkDeviceSize elementSize =
+        std::max(paddedSphericalHarmonicsComponentCount * (VkDeviceSize)formatSize(m_defines.shFormat), texelSize);
+
+    const auto fill = [&](void* dst, uint64_t first, uint64_t count) {
+      // zeroes the padding of each splat and the end of the map
+      memset(dst, 0, count * elementSize);
+      packSphericalHarmonics_3DGS(m_splatSet, m_defines.shFormat, dst, paddedSphericalHarmonicsComponentCount, 3,
+                                  (uint32_t)first, (uint32_t)count);
+    };
 
     // place the result in the dedicated texture map
     if(m_defines.shFormat == FORMAT_FLOAT32)
     {
-      initTexture(mapSize.x, mapSize.y, bufferSize, data, VK_FORMAT_R32G32B32A32_SFLOAT,
+      initTexture(mapSize.x, mapSize.y, VK_FORMAT_R32G32B32A32_SFLOAT, texelSize, elementSize, fill,
                   m_alloc->acquireSampler(sampler_info), m_sphericalHarmonicsMap);
     }
     else if(m_defines.shFormat == FORMAT_FLOAT16)
     {
-      initTexture(mapSize.x, mapSize.y, bufferSize, data, VK_FORMAT_R16G16B16A16_SFLOAT,
+      initTexture(mapSize.x, mapSize.y, VK_FORMAT_R16G16B16A16_SFLOAT, texelSize, elementSize, fill,
                   m_alloc->acquireSampler(sampler_info), m_sphericalHarmonicsMap);
     }
     else if(m_defines.shFormat == FORMAT_UINT8)
     {
-      initTexture(mapSize.x, mapSize.y, bufferSize, data, VK_FORMAT_R8G8B8A8_UNORM,
+      initTexture(mapSize.x, mapSize.y, VK_FORMAT_R8G8B8A8_UNORM, texelSize, elementSize, fill,
                   m_alloc->acquireSampler(sampler_info), m_sphericalHarmonicsMap);
     }
 
     // memory statistics
-    m_modelMemoryStats.srcShOther  = (uint32_t)m_splatSet.f_rest.size() * sizeof(float);
-    m_modelMemoryStats.odevShOther = (uint32_t)m_splatSet.f_rest.size() * formatSize(m_defines.shFormat);
+    m_modelMemoryStats.srcShOther  = m_splatSet.f_rest.size() * sizeof(float);
+    m_modelMemoryStats.odevShOther = m_splatSet.f_rest.size() * formatSize(m_defines.shFormat);
     m_modelMemoryStats.devShOther  = bufferSize;
   }
 
+  // sync with end of copy to device
+  m_stagingRing.flush();
+
+  // update statistics totals
+  m_modelMemoryStats.srcShAll  = m_modelMemoryStats.srcSh0 + m_modelMemoryStats.srcShOther;
+  m_modelMemoryStats.odevShAll = m_modelMemoryStats.odevSh0 + m_modelMemoryStats.odevShOther;
+  m_modelMemoryStats.devShAll  = m_modelMemoryStats.devSh0 + m_modelMemoryStats.devShOther;
+
+  m_modelMemoryStats.srcAll =
+      m_modelMemoryStats.srcCenters + m_modelMemoryStats.srcCov + m_modelMemoryStats.srcSh0 + m_modelMemoryStats.srcShOther;
+  m_modelMemoryStats.odevAll = m_modelMemoryStats.odevCenters + m_modelMemoryStats.odevCov + m_modelMemoryStats.odevSh0
+                               + m_modelMemoryStats.odevShOther;
+  m_modelMemoryStats.devAll =
+      m_modelMemoryStats.devCenters + m_modelMemoryStats.devCov + m_modelMemoryStats.devSh0 + m_modelMemoryStats.devShOther;
+
+  auto      endTime   = std::chrono::high_resolution_clock::now();
+  long long buildTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+  std::cout << "Data textures updated in " << buildTime << "ms" << std::endl;
+}
+
+void GaussianSplatting::initDataTextures_SpaceTime_Lite(void)
+{
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  const auto splatCount = (uint32_t)m_splatSet.positions.size() / 3;
+
+  // will create a texture sampler using nearest filtering mode foe each texture map
+  // samplers will be released by texture destruction.
+  VkSamplerCreateInfo sampler_info{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+  sampler_info.magFilter  = VK_FILTER_NEAREST;
+  sampler_info.minFilter  = VK_FILTER_NEAREST;
+  sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+
+  // centers (3 components but texture map is only allowed with 4 components)
+  {
+    glm::ivec2 mapSize = computeDataTextureSize(3, 3, splatCount);
+    // includes some padding and unused w channel
+    initTexture(mapSize.x, mapSize.y, VK_FORMAT_R32G32B32A32_SFLOAT, 4 * sizeof(float), 4 * sizeof(float),
+                [&](void* dst, uint64_t first, uint64_t count) {
+                  packCenters(m_splatSet, static_cast<float*>(dst), 4, (uint32_t)first, (uint32_t)count);
+                  clearPadding(dst, first, count, splatCount, 4 * sizeof(float));
+                },
+                m_alloc->acquireSampler(sampler_info), m_centersMap);
+    // memory statistics
+    m_modelMemoryStats.srcCenters  = (uint64_t)splatCount * 3 * sizeof(float);
+    m_modelMemoryStats.odevCenters = (uint64_t)splatCount * 3 * sizeof(float);  // no compression or quantization yet
+    m_modelMemoryStats.devCenters  = (uint64_t)mapSize.x * mapSize.y * 4 * sizeof(float);
+  }
+  // covariances are time dependent and evaluated in the shaders from the
+  // spacetime features, we only allocate a single texel to keep the descriptor valid
+  {
+    initTexture(1, 1, VK_FORMAT_R32G32B32A32_SFLOAT, 4 * sizeof(float), 4 * sizeof(float),
+                [&](void* dst, uint64_t first, uint64_t count) { memset(dst, 0, count * 4 * sizeof(float)); },
+                m_alloc->acquireSampler(sampler_info), m_covariancesMap);
+    // memory statistics, rotation and scale are accounted with the spacetime features
+    m_modelMemoryStats.srcCov  = 0;
+    m_modelMemoryStats.odevCov = 0;
+    m_modelMemoryStats.devCov  = 4 * sizeof(float);
+  }
+  // colors, the lite model stores the base color directly in f_dc
+  {
+    glm::ivec2 mapSize = computeDataTextureSize(4, 4, splatCount);
+    initTexture(mapSize.x, mapSize.y, VK_FORMAT_R8G8B8A8_UNORM, 4, 4,
+                [&](void* dst, uint64_t first, uint64_t count) {
+                  uint8_t* colors = static_cast<uint8_t*>(dst);
+                  START_PAR_LOOP(getPackCount(m_splatSet, (uint32_t)first, (uint32_t)count), i)
+                  {
+                    const auto splatIdx = first + i;
+                    const auto stride3  = splatIdx * 3;
+                    const auto stride4  = i * 4;
+                    colors[stride4 + 0] = (uint8_t)glm::clamp(std::floor(m_splatSet.f_dc[stride3 + 0] * 255), 0.0f, 255.0f);
+                    colors[stride4 + 1] = (uint8_t)glm::clamp(std::floor(m_splatSet.f_dc[stride3 + 1] * 255), 0.0f, 255.0f);
+                    colors[stride4 + 2] = (uint8_t)glm::clamp(std::floor(m_splatSet.f_dc[stride3 + 2] * 255), 0.0f, 255.0f);
+                    colors[stride4 + 3] = (uint8_t)glm::clamp(
+                        std::floor((1.0f / (1.0f + std::exp(-m_splatSet.opacity[splatIdx]))) * 255), 0.0f, 255.0f);
+                  }
+                  END_PAR_LOOP()
+                  clearPadding(dst, first, count, splatCount, 4);
+                },
+                m_alloc->acquireSampler(sampler_info), m_colorsMap);
+    // memory statistics
+    m_modelMemoryStats.srcSh0  = (uint64_t)splatCount * 4 * sizeof(float);  // original f_dc and opacity are floats
+    m_modelMemoryStats.odevSh0 = (uint64_t)splatCount * 4 * sizeof(uint8_t);
+    m_modelMemoryStats.devSh0  = (uint64_t)mapSize.x * mapSize.y * 4 * sizeof(uint8_t);
+  }
+  // spacetime features, motion9 scale3 rot4 omega4 trbf2, stored in the SH texture map
+  // using the same component order as the data buffer padded to SPACETIME_TEXELS_PER_SPLAT texels.
+  // 8 bit quantization is not suitable for these values so FORMAT_UINT8 falls back to float16.
+  {
+    const uint32_t elementsPerTexel = 4;
+    const uint32_t paddedComponentCount = SPACETIME_TEXELS_PER_SPLAT * elementsPerTexel;
+    const int      featuresFormat = m_defines.shFormat == FORMAT_FLOAT32 ? FORMAT_FLOAT32 : FORMAT_FLOAT16;
+
+    glm::ivec2 mapSize = computeDataTextureSize(elementsPerTexel, paddedComponentCount, splatCount);
+
+    const VkDeviceSize bufferSize  = (VkDeviceSize)mapSize.x * mapSize.y * elementsPerTexel * formatSize(featuresFormat);
+    const VkDeviceSize texelSize   = elementsPerTexel * formatSize(featuresFormat);
+    const VkDeviceSize elementSize = paddedComponentCount * formatSize(featuresFormat);
+
+    initTexture(
+        mapSize.x, mapSize.y, featuresFormat == FORMAT_FLOAT32 ? VK_FORMAT_R32G32B32A32_SFLOAT : VK_FORMAT_R16G16B16A16_SFLOAT,
+        texelSize, elementSize,
+        [&](void* dst, uint64_t first, uint64_t count) {
+          // zeroes the padding of each splat and the end of the map
+          memset(dst, 0, count * elementSize);
+          START_PAR_LOOP(getPackCount(m_splatSet, (uint32_t)first, (uint32_t)count), idx)
+          {
+            const auto splatIdx = first + idx;
+            const auto stride3  = splatIdx * 3;
+            const auto stride4  = splatIdx * 4;
+            const auto stride15 = splatIdx * 15;
+
+            float features[SPACETIME_FEATURES_PER_SPLAT];
+            for(auto i = 0; i < 9; ++i)
+              features[i] = m_splatSet.f_rest[stride15 + i];  // motion
+            for(auto i = 0; i < 3; ++i)
+              features[9 + i] = std::exp(m_splatSet.scale[stride3 + i]);
+            for(auto i = 0; i < 4; ++i)
+              features[12 + i] = m_splatSet.rotation[stride4 + i];
+            for(auto i = 0; i < 4; ++i)
+              features[16 + i] = m_splatSet.f_rest[stride15 + 9 + i];  // omega
+            features[20]          = m_splatSet.f_rest[stride15 + 13];  // trbf center
+            const auto trbfScale  = std::exp(-m_splatSet.f_rest[stride15 + 14]);
+            features[21]          = trbfScale * trbfScale;
+
+            for(auto i = 0; i < SPACETIME_FEATURES_PER_SPLAT; ++i)
+              storeSh(featuresFormat, features, i, dst, paddedComponentCount * idx + i);
+          }
+          END_PAR_LOOP()
+        },
+        m_alloc->acquireSampler(sampler_info), m_sphericalHarmonicsMap);
+
+    // memory statistics
+    m_modelMemoryStats.srcShOther  = (uint64_t)splatCount * (3 + 4 + 15) * sizeof(float);
+    m_modelMemoryStats.odevShOther = (uint64_t)splatCount * SPACETIME_FEATURES_PER_SPLAT * formatSize(featuresFormat);
+    m_modelMemoryStats.devShOther  = bufferSize;
+  }
+
+  // sync with end of copy to device
+  m_stagingRing.flush();
+
   // update statistics totals
   m_modelMemoryStats.srcShAll  = m_modelMemoryStats.srcSh0 + m_modelMemoryStats.srcShOther;
   m_modelMemoryStats.odevShAll = m_modelMemoryStats.odevSh0 + m_modelMemoryStats.odevShOther;
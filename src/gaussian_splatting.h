@@ -77,9 +77,18 @@
 #include "shaders/shaderio.h"
 
 #include "splat_set.h"
+#include "splat_generator.h"
 #include "gs_mode.h"
 #include "ply_async_loader.h"
 #include "splat_sorter_async.h"
+#include "benchmark_runner.h"
+#include "trace_recorder.h"
+#include "trace_gpu_timer.h"
+#include "pipeline_statistics.h"
+#include "staging_ring.h"
+#include "frame_governor.h"
+#include "pose_predictor.h"
+#include "splat_scene.h"
 
 enum Mode
 {
@@ -103,11 +112,36 @@ public:  // Methods specializing IAppElement
   void onResize(VkCommandBuffer cmd, const VkExtent2D& size) override;
 
   void onRender(VkCommandBuffer cmd) override;
-  void renderView(VkCommandBuffer cmd, void* view, void* camera, void* image = nullptr);
+  // image is the swapchain image of the view (of image view view), copied to the desktop mirror if mirror is set.
+  // depthImage is the D32 image of the XR depth swapchain of the view, only written if isXrDepthActive()
+  void renderView(VkCommandBuffer cmd, void* view, void* camera, void* image, bool mirror, void* depthImage = nullptr);
+  // late latch, replaces the camera of a view already recorded in the current frame (XR CameraConstants).
+  // must be called before the submission of the frame, the sort keeps the camera used at recording
+  void latchViewCamera(uint32_t view, const void* camera);
   
   Mode m_mode = Mode::PC;
+  // switches between desktop and headset rendering, the scene and its device data are kept
+  void setMode(Mode mode);
+
+  // desktop mirror of the headset in XR mode. The window is only refreshed on mirror
+  // frames so the headset frames never wait for the desktop swapchain, see AppCtrl
+  enum MirrorPolicy
+  {
+    MIRROR_OFF,          // the headset view is not copied, the window shows the UI at m_mirrorMaxRate
+    MIRROR_EVERY_N,      // once every m_mirrorInterval headset frames
+    MIRROR_CAPPED_RATE,  // at most m_mirrorMaxRate times per second
+  };
+  int   m_mirrorPolicy   = MIRROR_CAPPED_RATE;
+  int   m_mirrorInterval = 4;
+  float m_mirrorMaxRate  = 30.0f;  // in Hz
+  float m_mirrorScale    = 0.5f;   // resolution of the mirror relative to the viewport
+  glm::vec2 m_mirrorUvMax = {1.0f, 1.0f};  // G-Buffer region written by the last mirror blit
   GSMode m_gsMode = GSMode::GSMode_3DGS;
   bool   m_headsetSupportUnorm = false;
+  bool   m_supportSubgroupBallot = false;
+  bool   m_supportMeshShader     = false;
+  bool   m_supportBarycentric    = false;
+  bool   m_supportMemoryBudget   = false;  // VK_EXT_memory_budget is enabled on the device
 
   struct ShaderDefines
   {
@@ -118,42 +152,63 @@ public:  // Methods specializing IAppElement
     bool pointCloudModeEnabled   = false;
     int  shFormat                = FORMAT_FLOAT32;
     int  dataStorage             = STORAGE_BUFFERS;
+    bool shAdaptive              = false;  // per splat SH degree with variable length storage, data buffers only
     bool fragmentBarycentric     = true;
+    bool distSubgroupCompaction  = true;  // one atomic per subgroup instead of per splat in dist.comp
+    bool overdrawMode            = false;  // displays the number of fragments per pixel, PC mode only
+    bool xrDepthLayer            = true;   // submits a depth layer with the color, XR mode only
+    bool upscaling               = false;  // renders at a reduced resolution then upscales, not in overdraw mode
+    float renderScale[2]         = {0.7f, 0.7f};  // per XR view, the first one in PC mode, in [MIN_RENDER_SCALE,1]
+    bool  foveation              = false;  // fixed foveated LOD, cheaper splats away from the view center
+    float foveaInnerRadius       = 0.35f;  // full quality inside, in NDC
+    float foveaOuterRadius       = 0.9f;   // lowest quality outside, in NDC
+    float foveaMinContribution   = 1.0f;   // extra contribution cull at the outer radius, in pixels
+    float foveaMinRadius         = 1.0f;   // splats smaller than this at the outer radius are culled, in pixels
+    int   foveaShDegree          = 1;      // SH degree beyond the outer radius, in [0,3]
 
     bool  pause = false;
     float span  = 1.0f;
     float speed = 1.0f;
 
     void adjust4xr() { 
-      dataStorage = STORAGE_BUFFERS;
       shFormat    = FORMAT_FLOAT16;
       fragmentBarycentric = false;
       frustumCulling      = FRUSTUM_CULLING_AT_DIST;
       pause               = false;
+      overdrawMode        = false;
     }
   };
 
-  struct RenderSettings
+  // size of the headset views, zero if the runtime does not support depth layers.
+  // to be set before entering the XR mode, the resources are created with the pipelines
+  void setXrDepthExtent(const VkExtent2D& extent) { m_xrDepthExtent = extent; }
+  inline bool isXrDepthActive() const
   {
-    GaussianSplatting::ShaderDefines m_defines;
-    GSMode                           m_gsMode;
-    std::string                      m_sceneName;
-  };
-
-  void getRenderSettings(RenderSettings& settings) { 
-    settings.m_defines = m_defines;
-    settings.m_gsMode  = m_gsMode;
-    settings.m_sceneName = m_loadedSceneFilename;
+    return m_defines.xrDepthLayer && m_mode == Mode::XR && m_xrDepthExtent.width > 0 && m_xrDepthExtent.height > 0;
   }
-
-  void setRenderSettings(RenderSettings& settings)
+  // size of the headset views, to be set before entering the XR mode
+  void setXrViewExtent(const VkExtent2D& extent) { m_xrViewExtent = extent; }
+  // size of the area rendered for a view of the given size, smaller than the view in reduced resolution rendering
+  VkExtent2D getRenderExtent(uint32_t view, const VkExtent2D& extent) const;
+  // the pipelines writing the depth are built, the depth swapchain images given to renderView are written
+  inline bool isXrDepthReady() const { return m_xrDepthBuffer.buffer != VK_NULL_HANDLE; }
+
+  // frame budget of the frame governor in XR mode in ms, the display period of the runtime
+  void setFrameBudget(float budget) { m_frameBudget = budget; }
+
+  // pose of the headset (center of the eyes) in the XR local space at the predicted display time of the
+  // current frame, times in seconds. The CPU sort of the XR mode is computed for this pose extrapolated
+  // to the display of the sort result
+  void setXrHeadPose(double displayTime, double displayPeriod, const PosePredictor::Pose& pose);
+
+  // applies the viewer options of the command line, to be invoked before attaching the element
+  void parseCommandLine(int argc, char** argv);
+
+  // triggers the generation of a synthetic scene at next frame
+  void setGeneratorSettings(const SplatGeneratorSettings& settings)
   {
-    settings.m_defines.adjust4xr();
-    m_defines                 = settings.m_defines;
-    m_gsMode              = settings.m_gsMode;
-    m_sceneToLoadFilename     = settings.m_sceneName;
-    m_plyLoader.m_gsMode      = m_gsMode;
-    addToRecentFiles(m_sceneToLoadFilename);
+    m_generatorSettings = settings;
+    m_sceneToGenerate   = true;
   }
 
   void onUIRender() override;
@@ -170,6 +225,13 @@ public:  // Methods specializing IAppElement
   void      initRecentSceneScale();
   glm::mat4 getLoadedSceneCamera() { return m_recentSceneParams[0].first; }
 
+  // headless benchmark mode, settings must be provided before attaching the element
+  void setBenchmarkSettings(const BenchmarkSettings& settings);
+  // number of headless frames needed to run the complete benchmark
+  uint32_t getBenchmarkFrameCount() const;
+  // writes the benchmark report
+  void onLastHeadlessFrame() override;
+
 private:  // Methods
   void renderPC(VkCommandBuffer cmd);
   void renderXR(VkCommandBuffer cmd);
@@ -177,6 +239,10 @@ private:  // Methods
 
   void deinitGbuffers();
 
+  // the mesh shader stage if VK_EXT_mesh_shader is enabled, 0 otherwise, to be
+  // combined in the stage masks of the barriers since it is invalid without the extension
+  VkPipelineStageFlags meshShaderStage() const { return m_supportMeshShader ? VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT : 0; }
+
   // Initializes all that is related to the scene based
   // on current parameters. VRAM Data, shaders, pipelines.
   // Invoked on scene load success.
@@ -200,6 +266,62 @@ private:  // Methods
   // free scene (splat set) from RAM
   void deinitScene();
 
+  // scene composition, the splat sets of the instances are concatenated in m_splatSet.
+  // true if the shaders must apply the instance table (several, transformed or hidden instances)
+  bool isSceneComposed() const;
+  // number of splats the renderer and data buffers are allocated for, at least the splat count
+  uint32_t getSplatCapacity() const { return std::max((uint32_t)m_splatSet.size(), m_splatCapacity); }
+  // instances not removed, the removed ones keep their slot of the table until the next rebuild
+  size_t getLiveInstanceCount() const;
+  // appends the splat set loaded in m_instanceSplatSet as a new instance. Only the range of the
+  // instance is uploaded if it fits the buffers, the scene storage is rebuilt otherwise.
+  // the CPU sorter must not be sorting since the positions are modified
+  void addLoadedInstance();
+  // hides the instance, its splats stay in the buffers until the next rebuild. The rebuild
+  // is requested once the removed splats are half of the scene
+  void removeInstance(size_t instanceId);
+  // drops the removed instances and reallocates the buffers with room for the next instances
+  void rebuildSceneStorage();
+  // uploads the instance index of the splats in [first, first + count) through the staging ring
+  void uploadInstanceIndices(uint32_t first, uint32_t count);
+  // uploads the instance table if it was modified, to be invoked before the sort
+  void uploadInstancesIfNeeded(VkCommandBuffer cmd);
+  // positions of the splats in the scene for the CPU sorter, composed scenes only
+  void updateSortPositions();
+
+  // frees the host copies of the splat attributes once uploaded, only the positions
+  // are kept for the CPU sorter. Does nothing if m_releaseHostData is not set.
+  void releaseHostSplatData();
+  // reloads the released attributes from the source of the scene (ply file or generator),
+  // to be invoked before any access to the attributes. returns false on failure,
+  // the attributes stay released in that case.
+  bool restoreHostSplatData();
+
+  // computes the importance thresholds of the splat budget levels of the frame governor,
+  // to be invoked before releaseHostSplatData since the attributes are needed.
+  void updateImportanceThresholds();
+  // runs the frame governor on the averaged GPU times, once per frame before the rebuilds
+  void updateFrameGovernor();
+
+  // memory admission policy, to be invoked before the upload of the splat set.
+  // if the estimated device footprint of the model exceeds the budget, downgrades the
+  // SH format then the uploaded SH degree (data buffers only) until it fits.
+  void applyMemoryAdmissionPolicy();
+
+  // estimated device memory footprint of the splat set for the given storage and SH format,
+  // with SH coefficients up to shDegree (data textures always store all the degrees of the file)
+  uint64_t estimateModelDeviceMemory(int dataStorage, int shFormat, uint32_t shDegree);
+  // true if the SH are stored with a per splat degree, depends on the defines and on the
+  // SH degree uploaded, so it is the same for initShaders and initDataBuffers_3DGS
+  bool useAdaptiveSh() const;
+
+  // device memory that can be used by the model, the smallest of the available
+  // budget of the device local heap and of the user budget (m_memoryBudgetMB)
+  uint64_t getModelMemoryBudget();
+
+  // refreshes m_heapBudgets from the allocator
+  void updateHeapBudgets();
+
   // create the buffers on the device and upload
   // the splat set data from host to device
   void initDataBuffers(void);
@@ -212,6 +334,8 @@ private:  // Methods
   // create the texture maps on the device and upload
   // the splat set data from host to device
   void initDataTextures(void);
+  void initDataTextures_3DGS(void);
+  void initDataTextures_SpaceTime_Lite(void);
 
   // release textures at next frame
   void deinitDataTextures(void);
@@ -230,7 +354,19 @@ private:  // Methods
 
   // Create texture, upload data and assign sampler
   // sampler will be released by deinitTexture
-  void initTexture(uint32_t width, uint32_t height, uint32_t bufsize, void* data, VkFormat format, const VkSampler& sampler, nvvk::Texture& texture);
+  // the texels are filled by fill in the staging ring, elementSize bytes per splat,
+  // the upload is completed by the flush of the ring
+  void initTexture(uint32_t                         width,
+                   uint32_t                         height,
+                   VkFormat                         format,
+                   VkDeviceSize                     texelSize,
+                   VkDeviceSize                     elementSize,
+                   const StagingRing::FillFunction& fill,
+                   const VkSampler&                 sampler,
+                   nvvk::Texture&                   texture);
+
+  // (re)creates the upload staging ring if its size does not match m_stagingRingSizeMB
+  void updateStagingRing();
 
   // Destroy texture at once, texture must not be in use
   void deinitTexture(nvvk::Texture& texture);
@@ -248,9 +384,10 @@ private:  // Methods
   // be modified by the user interface
   inline void resetRenderSettings()
   {
-    m_frameInfo   = {};
-    m_defines     = {};
-    m_cpuLazySort = true;
+    m_frameInfo          = {};
+    m_defines            = {};
+    m_defines.shAdaptive = m_shAdaptiveDefault;
+    m_cpuLazySort        = true;
   }
 
   // reset the memory usage stats
@@ -261,11 +398,21 @@ private:  // Methods
 
   // Updates frame information uniform buffer and frame camera info
   void updateAndUploadFrameInfoUBO(VkCommandBuffer cmd, const uint32_t splatCount, const void* data = nullptr);
+  // sets the camera related fields of frameInfo from the XR CameraConstants of the view
+  void setFrameInfoCamera(shaderio::FrameInfo& frameInfo, const void* camera, uint32_t view);
+  // sets the foveated LOD fields of frameInfo, after its projection matrix
+  void setFrameInfoFovea(shaderio::FrameInfo& frameInfo) const;
 
   void tryConsumeAndUploadCpuSortingResult(VkCommandBuffer cmd, const uint32_t splatCount);
+  // viewpoint of the CPU sort in the space of the splat positions, the predicted head pose in XR mode
+  void getCpuSortViewpoint(glm::vec3& camDir, glm::vec3& camCop) const;
 
   void processSortingOnGPU(VkCommandBuffer cmd, const uint32_t splatCount);
 
+  // returns true if the GPU sort must be performed for the current frame
+  // according to m_gpuSortPolicy, records the sorting state if so
+  bool isGpuSortNeeded(const uint32_t splatCount);
+
   void drawSplatPrimitives(VkCommandBuffer cmd, const uint32_t splatCount);
 
   // for statistics display in the UI
@@ -277,11 +424,57 @@ private:  // Methods
 
   void updateRenderingMemoryStatistics(VkCommandBuffer cmd, const uint32_t splatCount);
 
+  // overdraw render mode, the per pixel fragment counts of the splat
+  // draw are accumulated in m_overdrawImage then summarized by a compute pass
+  inline bool isOverdrawModeActive() const { return m_defines.overdrawMode && m_mode == Mode::PC; }
+  // resources follow the pipelines life cycle and the size of the G-Buffer
+  void initOverdrawResources();
+  void deinitOverdrawResources();
+  void updateOverdrawDescriptors();
+  // resets the counters, to be invoked before the rendering
+  void clearOverdraw(VkCommandBuffer cmd);
+  // builds the histogram and the heatmap, then copies the summary in the readback ring
+  void processOverdraw(VkCommandBuffer cmd);
+
+  // XR depth layer, the fragment shader keeps per pixel the depth of the nearest fragment
+  // reaching XR_DEPTH_OPACITY in m_xrDepthBuffer, which is then copied in the depth swapchain image
+  void initXrDepthResources();
+  void deinitXrDepthResources();
+  // resets the depths to the far plane, to be invoked before the rendering of a view
+  void clearXrDepth(VkCommandBuffer cmd);
+  // copies the depths of the view to the depth swapchain image, left in depth attachment layout
+  void copyXrDepth(VkCommandBuffer cmd, VkImage depthImage, const VkExtent2D& extent);
+
+  // reduced resolution rendering, the splats are rasterized in a part of m_upscaleInput then upscaled by a
+  // compute pass to the G-Buffer in PC mode, to m_upscaleOutput in XR mode, which is then copied to the
+  // swapchain image (the swapchain formats do not support storage). The targets have the size of the
+  // views, so the render scale changes without rebuild. Active as well when the governor lowers the scale.
+  inline bool isUpscaleActive() const
+  {
+    return (m_defines.upscaling || m_governor.getLevel(KNOB_RENDER_SCALE) > 0) && !isOverdrawModeActive();
+  }
+  // resources follow the pipelines life cycle and the size of the G-Buffer (PC) or of the views (XR)
+  void initUpscaleResources();
+  void deinitUpscaleResources();
+  void updateUpscaleDescriptors();
+  // upscales the rendered area of the view, to be invoked after the rendering
+  void processUpscale(VkCommandBuffer cmd, const VkExtent2D& outputExtent);
+  // copies the upscaled view to the swapchain image, left in color attachment layout
+  void copyUpscaleOutput(VkCommandBuffer cmd, VkImage image, const VkExtent2D& extent);
+
   ////////
   // Benchmarking
 
   void benchmarkAdvance();
 
+  // headless benchmark submethods, see gaussian_splatting_benchmark.cpp
+  // advances the benchmark before rendering the frame, returns false if the frame must not be rendered
+  bool benchmarkStep();
+  // loads the scene synchronously and inits the renderer
+  bool benchmarkLoadScene();
+  void benchmarkApplyConfig(uint32_t configId);
+  void benchmarkCollectResult(uint32_t configId);
+
   ////////
   // UI
 
@@ -293,7 +486,11 @@ private:  // Methods
     GUI_PIPELINE,         // the rendering pipeline to use
     GUI_FRUSTUM_CULLING,  // where to perform frustum culling (or disabled)
     GUI_SH_FORMAT,         // data format for storage of SH in VRAM
-    GUI_GSMODE
+    GUI_GSMODE,
+    GUI_GPU_SORT_POLICY,   // when to perform the GPU sort
+    GUI_SPLAT_DISTRIBUTION, // spatial distribution of synthetic scenes
+    GUI_SPLAT_ORDER,        // spatial reordering of the splats at load time
+    GUI_MIRROR_POLICY       // refresh of the desktop mirror in XR mode
   };
 
   // initialize UI specifics
@@ -313,14 +510,46 @@ private:  // Attributes
   // Recent files list
   std::vector<std::string> m_recentFiles;
   std::vector<std::pair<glm::mat4, float>> m_recentSceneParams;
+  // triggers the generation of a synthetic scene at next frame when set
+  bool m_sceneToGenerate = false;
+  // triggers the load of a splat set to add as an instance at next frame when set to non empty string
+  std::string m_instanceToAddFilename;
+  bool        m_loadingInstance = false;  // the loader fills m_instanceSplatSet
+  SplatSet    m_instanceSplatSet;
+  // parameters of the synthetic scene generator
+  SplatGeneratorSettings m_generatorSettings;
   // scene loader
   PlyAsyncLoader m_plyLoader;
   // loaded model
   SplatSet m_splatSet;
+  // free the host copies of the splat attributes (but the positions) once uploaded to the device
+  bool m_releaseHostData = false;
+  // the attributes of m_splatSet are released, they can be reloaded from m_hostDataSource
+  bool                         m_hostDataReleased = false;
+  PlyAsyncLoader::LoadSettings m_hostDataSource;
+  // instances were added to or removed from the loaded model, which then cannot be reloaded
+  bool m_sceneEdited = false;
+
+  // instances of the composed scene, a single one covering the model if not composed
+  std::vector<SceneInstance> m_instances;
+  bool                       m_instancesDirty  = false;  // the instance table must be uploaded
+  bool                       m_compactScene    = false;  // drop the removed instances once the CPU sorter is idle
+  bool                       m_sceneInstancing = false;  // SCENE_INSTANCING of the current shaders
+  uint32_t                   m_splatCapacity   = 0;      // splats the buffers are allocated for, 0 for the splat count
+  nvvk::Buffer               m_instanceIndicesDevice;    // instance index of each splat
+  nvvk::Buffer               m_instancesDevice;          // table of MAX_SCENE_INSTANCES SplatInstance
 
   // counting benchmark steps
   int m_benchmarkId = 0;
 
+  // headless benchmark mode
+  BenchmarkSettings            m_benchSettings;
+  std::vector<CameraKey>       m_benchCameraPath;
+  std::vector<BenchmarkResult> m_benchResults;
+  uint32_t                     m_benchFrame           = 0;
+  bool                         m_benchFailed          = false;
+  bool                         m_benchConfigSupported = true;
+
   // hide/show ui elements
   bool m_showUI = true;
   // UI utility for choice menus
@@ -333,6 +562,12 @@ private:  // Attributes
   nvvkhl::Application*                     m_app{nullptr};
   std::shared_ptr<nvvkhl::ElementProfiler> m_profiler;
   std::shared_ptr<nvvkhl::ElementProfiler> m_benchmark;
+  // GPU sections of the trace capture
+  TraceGpuTimer m_gpuTrace;
+  // number of frames of a trace capture started from the UI
+  uint32_t m_traceFrameCount = 300;
+  // pipeline statistics queries around the splat draws
+  PipelineStatistics m_pipelineStats;
   std::unique_ptr<nvvk::DebugUtil>         m_dutil;
   std::shared_ptr<nvvkhl::AllocVma>        m_alloc;
 
@@ -355,6 +590,22 @@ private:  // Attributes
   shaderio::IndirectParams m_indirectReadback;      // readback values
   bool m_canCollectReadback = false;  // tells wether readback will be available in Host buffer at next frame
 
+  // overdraw render mode, the summary is read back through a ring of host slots, a slot is
+  // read just before being written again, one frame cycle later, so the readback never stalls
+  nvvk::Texture           m_overdrawImage;        // R32 fragment count per pixel
+  nvvk::Buffer            m_overdrawStatsDevice;  // OverdrawStats accumulated by the compute pass
+  nvvk::Buffer            m_overdrawStatsHost;    // readback ring, one OverdrawStats per slot
+  std::vector<bool>       m_overdrawSlotPending;  // slot written and not yet read
+  uint32_t                m_overdrawSlot = 0;
+  shaderio::OverdrawStats m_overdrawStats;        // last summary read back
+  bool                    m_overdrawStatsValid = false;
+  VkExtent2D              m_xrDepthExtent{0, 0};
+  VkExtent2D              m_xrViewExtent{0, 0};
+  nvvk::Buffer            m_xrDepthBuffer;  // XR depth layer, one float per pixel of a view
+  nvvk::Texture           m_upscaleInput;   // reduced resolution rendering target, shared by the views
+  nvvk::Texture           m_upscaleOutput;  // upscaled view, XR mode only
+  static constexpr float  MIN_RENDER_SCALE = 0.25f;
+
   //
   nvvk::Buffer m_quadVertices;  // Buffer of vertices for the splat quad
   nvvk::Buffer m_quadIndices;   // Buffer of indices for the splat quad
@@ -362,10 +613,33 @@ private:  // Attributes
   // trigger a rebuild of the shaders and pipelines at next frame
   bool m_updateShaders = false;
 
+  // adapts the culls and the SH degree to keep the GPU frame time under the frame budget
+  FrameGovernor      m_governor;
+  std::vector<float> m_importanceThresholds;  // per KNOB_SPLAT_BUDGET level, empty if not available
+  float              m_frameBudget = 0.0f;    // ms, XR mode only
+
   // trigger a rebuild of the data in VRAM (textures or buffers) at next frame
   // also triggers shaders and pipeline rebuild
   bool m_updateData = false;
 
+  // device memory budget of the model in MB, the available heap budget is used if 0
+  uint32_t m_memoryBudgetMB = 0;
+  // host memory used to upload the model, the staging ring is kept between uploads
+  uint32_t    m_stagingRingSizeMB      = 64;
+  uint32_t    m_stagingRingAllocatedMB = 0;
+  StagingRing m_stagingRing;
+  // SH degree stored in the data buffers, lower than the one of the file
+  // if reduced by the memory admission policy
+  uint32_t m_shDegreeUploaded = 3;
+  // adaptive SH storage after a reset of the render settings, set from the command line
+  bool m_shAdaptiveDefault = false;
+  // color error tolerated when dropping the higher SH bands of a splat, adaptive SH storage only
+  float m_shAdaptiveTolerance = 1.0f / 255.0f;
+  // number of splats stored with each SH degree, adaptive SH storage only
+  uint32_t m_shAdaptiveDegreeCounts[4] = {};
+  // budgets of the memory heaps, refreshed with the rendering memory statistics
+  std::vector<VmaBudget> m_heapBudgets;
+
   // Data textures
   VkSampler     m_sampler;  // texture sampler
   nvvk::Texture m_centersMap;
@@ -386,9 +660,51 @@ private:  // Attributes
   SplatSorterAsync      m_cpuSorter;
   bool                  m_cpuLazySort = true;  // if true, sorting starts only if viewpoint changed
   std::vector<uint32_t> m_splatIndices;        // the array of cpu sorted indices to use for rendering
+  // positions transformed by the instances, sorted instead of the model positions in composed scenes
+  std::vector<float> m_sortPositions;
+  bool               m_sortPositionsDirty = true;  // rebuilt, and a sort forced, when the sorter is idle
+  // the CPU sort result is consumed frames after its start, in XR it is computed for the head pose
+  // extrapolated to the display time of the frame expected to consume it
+  bool          m_cpuSortPrediction = true;
+  PosePredictor m_xrHeadPoses;
+  double        m_xrDisplayTime     = 0.0;   // s, predicted display time of the current frame
+  double        m_xrDisplayPeriod   = 0.0;   // s
+  uint64_t      m_frameIndex        = 0;     // incremented once per frame
+  uint64_t      m_cpuSortStartFrame = 0;     // frame the last sort was started
+  float         m_cpuSortLatency    = 1.0f;  // frames from the start of a sort to its consumption, averaged
+  static constexpr double MAX_PREDICTION_HORIZON = 0.1;  // s, the extrapolation diverges beyond
   // GPU radix sort
   VrdxSorter m_gpuSorter = VK_NULL_HANDLE;
 
+  // GPU sorting policy, when the sort is skipped the indices and the indirect
+  // parameters produced by the last sort are reused for rendering
+  enum GpuSortPolicy
+  {
+    GPU_SORT_ALWAYS,        // sort at each frame
+    GPU_SORT_LAZY,          // sort only if view, projection or timestamp changed
+    GPU_SORT_EVERY_N,       // sort once every m_gpuSortInterval frames
+    GPU_SORT_ON_THRESHOLD,  // sort only if viewpoint moved or turned beyond thresholds
+  };
+  int      m_gpuSortPolicy            = GPU_SORT_LAZY;
+  uint32_t m_gpuSortInterval          = 4;      // in frames, for GPU_SORT_EVERY_N
+  float    m_gpuSortAngleThreshold    = 1.0f;   // in degrees, for GPU_SORT_ON_THRESHOLD
+  float    m_gpuSortDistanceThreshold = 0.01f;  // in world units, for GPU_SORT_ON_THRESHOLD
+  bool     m_gpuSortSkipped           = false;  // true if last processSortingOnGPU reused previous results
+  // state of the last GPU sort, invalidated when indices or pipelines are rebuilt
+  struct GpuSortState
+  {
+    bool      valid = false;
+    uint32_t  frame = 0;
+    uint32_t  view  = 0;  // index of the view in the frame
+    uint32_t  splatCount = 0;
+    glm::mat4 viewMatrix{1.0f};
+    glm::mat4 projectionMatrix{1.0f};
+    float     sceneScale      = 1.0f;
+    float     frustumDilation = 0.0f;
+    float     timestamp       = 0.0f;
+  } m_gpuLastSort;
+  uint32_t m_gpuSortFrame = 0;
+
   // buffers used by GPU and/or CPU sort
   nvvk::Buffer m_splatIndicesHost;      // Buffer of splat indices on host for transfers (used by CPU sort)
   nvvk::Buffer m_splatIndicesDevice;    // Buffer of splat indices on device (used by CPU and GPU sort)
@@ -405,76 +721,104 @@ private:  // Attributes
     nvvk::ShaderModuleID meshShader;
     nvvk::ShaderModuleID vertexShader;
     nvvk::ShaderModuleID fragmentShader;
+    nvvk::ShaderModuleID overdrawShader;
+    nvvk::ShaderModuleID upscaleShader;
   } m_shaders;
 
   // This fields will be transformed to compilation definitions
   // and prepend to the shader code by initShaders
   ShaderDefines m_defines;
+  // m_defines the data storage in use was built with, the storage settings of m_defines
+  // are reverted to them if the data storage cannot be rebuilt
+  ShaderDefines m_dataDefines;
+  // why the last data storage rebuild failed, empty on success, reported in the UI
+  std::string m_dataStorageError;
 
   // Pipelines
   VkPipeline          m_graphicsPipeline     = VK_NULL_HANDLE;  // The graphic pipeline to render using vertex shaders
   VkPipeline          m_graphicsPipelineMesh = VK_NULL_HANDLE;  // The graphic pipeline to render using mesh shaders
   VkPipeline          m_computePipeline{};                      // The compute pipeline to compute distances and cull
+  VkPipeline          m_overdrawPipeline     = VK_NULL_HANDLE;  // The compute pipeline of the overdraw render mode
+  VkPipeline          m_upscalePipeline      = VK_NULL_HANDLE;  // The compute pipeline of the reduced resolution rendering
   shaderio::FrameInfo m_frameInfo{};      // Frame parameters, sent to device using a uniform buffer
   nvvk::Buffer        m_frameInfoBuffer;  // uniform buffer to store frame info
+  // the uniform buffer holds one frame info per view and frame in flight, persistently
+  // mapped so that the XR cameras can be patched after recording, see latchViewCamera
+  static const uint32_t FRAME_INFO_MAX_VIEWS = 2;
+  uint8_t*              m_frameInfoMapped     = nullptr;
+  VkDeviceSize          m_frameInfoSlotStride = 0;
+  uint32_t              m_frameInfoOffset     = 0;  // dynamic offset of the frame info used by the commands being recorded
+  uint32_t              m_frameViewIndex      = 0;  // index of the next view recorded in the current frame
+  shaderio::FrameInfo* getFrameInfoSlot(uint32_t view)
+  {
+    const uint32_t slot = m_app->getFrameCycleIndex() * FRAME_INFO_MAX_VIEWS + std::min(view, FRAME_INFO_MAX_VIEWS - 1);
+    return reinterpret_cast<shaderio::FrameInfo*>(m_frameInfoMapped + slot * m_frameInfoSlotStride);
+  }
 
   // Model related memory usage statistics
   struct ModelMemoryStats
   {
     // Memory footprint on host memory
 
-    uint32_t srcAll     = 0;  // RAM bytes used for all the data of source model
-    uint32_t srcCenters = 0;  // RAM bytes used for splat centers of source model
+    uint64_t srcAll     = 0;  // RAM bytes used for all the data of source model
+    uint64_t srcCenters = 0;  // RAM bytes used for splat centers of source model
     // covariance
-    uint32_t srcCov = 0;
+    uint64_t srcCov = 0;
     // spherical harmonics coeficients
-    uint32_t srcShAll   = 0;  // RAM bytes used for all the SH coefs of source model
-    uint32_t srcSh0     = 0;  // RAM bytes used for SH degree 0 of source model
-    uint32_t srcShOther = 0;  // RAM bytes used for SH degree 1 of source model
+    uint64_t srcShAll   = 0;  // RAM bytes used for all the SH coefs of source model
+    uint64_t srcSh0     = 0;  // RAM bytes used for SH degree 0 of source model
+    uint64_t srcShOther = 0;  // RAM bytes used for SH degree 1 of source model
 
     // Memory footprint on device memory (allocated)
 
-    uint32_t devAll     = 0;  // GRAM bytes used for all the data of source model
-    uint32_t devCenters = 0;  // GRAM bytes used for splat centers of source model
+    uint64_t devAll     = 0;  // GRAM bytes used for all the data of source model
+    uint64_t devCenters = 0;  // GRAM bytes used for splat centers of source model
     // covariance
-    uint32_t devCov = 0;
+    uint64_t devCov = 0;
     // spherical harmonics coeficients
-    uint32_t devShAll   = 0;  // GRAM bytes used for all the SH coefs of source model
-    uint32_t devSh0     = 0;  // GRAM bytes used for SH degree 0 of source model
-    uint32_t devShOther = 0;  // GRAM bytes used for SH degree 1 of source model
+    uint64_t devShAll   = 0;  // GRAM bytes used for all the SH coefs of source model
+    uint64_t devSh0     = 0;  // GRAM bytes used for SH degree 0 of source model
+    uint64_t devShOther = 0;  // GRAM bytes used for SH degree 1 of source model
 
 
     // Actual data size within textures (a.k.a. mem footprint minus padding and
     // eventual unused components)
 
-    uint32_t odevAll     = 0;  // GRAM bytes used for all the data of source model
-    uint32_t odevCenters = 0;  // GRAM bytes used for splat centers of source model
+    uint64_t odevAll     = 0;  // GRAM bytes used for all the data of source model
+    uint64_t odevCenters = 0;  // GRAM bytes used for splat centers of source model
     // covariance
-    uint32_t odevCov = 0;
+    uint64_t odevCov = 0;
     // spherical harmonics coeficients
-    uint32_t odevShAll   = 0;  // GRAM bytes used for all the SH coefs of source model
-    uint32_t odevSh0     = 0;  // GRAM bytes used for SH degree 0 of source model
-    uint32_t odevShOther = 0;  // GRAM bytes used for SH degree 1 of source model
+    uint64_t odevShAll   = 0;  // GRAM bytes used for all the SH coefs of source model
+    uint64_t odevSh0     = 0;  // GRAM bytes used for SH degree 0 of source model
+    uint64_t odevShOther = 0;  // GRAM bytes used for SH degree 1 of source model
+
+    // Transient host memory used to upload the model
+
+    uint64_t hostStaging = 0;  // peak of the staging memory alive at once during the last upload
   } m_modelMemoryStats;
 
   // Rendering (sorting and splatting) related memory usage statistics
   struct RenderMemoryStats
   {
-    uint32_t usedUboFrameInfo = 0;  // used = alloc all the time
-    uint32_t usedIndirect     = 0;  // used = alloc all the time, for the active pipeline
-
-    uint32_t hostAllocDistances = 0;  // used = alloc
-    uint32_t hostAllocIndices   = 0;  // used = alloc
-
-    uint32_t allocIndices      = 0;
-    uint32_t usedIndices       = 0;
-    uint32_t allocDistances    = 0;
-    uint32_t usedDistances     = 0;
-    uint32_t allocVdrxInternal = 0;  // used is unknown
-
-    uint32_t hostTotal        = 0;
-    uint32_t deviceUsedTotal  = 0;
-    uint32_t deviceAllocTotal = 0;
+    uint64_t usedUboFrameInfo = 0;  // used = alloc all the time
+    uint64_t usedIndirect     = 0;  // used = alloc all the time, for the active pipeline
+
+    uint64_t hostAllocDistances = 0;  // used = alloc
+    uint64_t hostAllocIndices   = 0;  // used = alloc
+
+    uint64_t allocIndices      = 0;
+    uint64_t usedIndices       = 0;
+    uint64_t allocDistances    = 0;
+    uint64_t usedDistances     = 0;
+    uint64_t allocVdrxInternal = 0;  // used is unknown
+    uint64_t allocOverdraw     = 0;  // overdraw render mode only, used = alloc
+    uint64_t hostAllocOverdraw = 0;  // overdraw readback ring
+    uint64_t allocUpscale      = 0;  // reduced resolution rendering only, used = alloc
+
+    uint64_t hostTotal        = 0;
+    uint64_t deviceUsedTotal  = 0;
+    uint64_t deviceAllocTotal = 0;
 
   } m_renderMemoryStats;
 };
@@ -0,0 +1,229 @@
+// Headless benchmark mode of the GaussianSplatting element.
+// The benchmark is driven from onRender, since in headless mode the
+// application only calls onUIRender once before rendering all the frames.
+
+#include <gaussian_splatting.h>
+
+// frames rendered before measuring, lets the profiler collect valid values after a reset
+static const uint32_t BENCHMARK_WARMUP_FRAMES = nvh::Profiler::CONFIG_DELAY + nvh::Profiler::FRAME_DELAY;
+
+void GaussianSplatting::setBenchmarkSettings(const BenchmarkSettings& settings)
+{
+  m_benchSettings = settings;
+  m_benchResults.clear();
+  m_benchFrame  = 0;
+  m_benchFailed = false;
+
+  m_gsMode             = (GSMode)settings.gsMode;
+  m_plyLoader.m_gsMode        = m_gsMode;
+  m_plyLoader.m_splatOrder    = settings.splatOrder;
+  m_plyLoader.m_pruneSettings = settings.prune;
+  m_shAdaptiveTolerance       = settings.shAdaptiveTolerance;
+  m_enableDefaultScene = false;
+  // collected if supported by the device
+  m_pipelineStats.m_enabled = true;
+
+  if(!settings.cameraPathFilename.empty() && !loadCameraPath(settings.cameraPathFilename, m_benchCameraPath))
+  {
+    std::cerr << "Error: benchmark camera path is invalid, the default camera will be used" << std::endl;
+    m_benchCameraPath.clear();
+  }
+}
+
+uint32_t GaussianSplatting::getBenchmarkFrameCount() const
+{
+  // one extra frame to collect the results of the last configuration
+  return m_benchSettings.configCount() * (BENCHMARK_WARMUP_FRAMES + m_benchSettings.framesPerConfig) + 1;
+}
+
+bool GaussianSplatting::benchmarkLoadScene()
+{
+  const std::string sceneName =
+      m_benchSettings.synthetic ? getSyntheticSceneName(m_benchSettings.generator) : m_benchSettings.sceneFilename;
+  std::cout << "Benchmark: loading scene " << sceneName << std::endl;
+  const bool started = m_benchSettings.synthetic ? m_plyLoader.generateScene(m_benchSettings.generator, m_splatSet) :
+                                                   m_plyLoader.loadScene(m_benchSettings.sceneFilename, m_splatSet);
+  if(!started)
+  {
+    std::cerr << "Error: cannot start scene load while loader is not ready status=" << m_plyLoader.getStatus() << std::endl;
+    return false;
+  }
+  // no UI to poll the async loader, so we wait for it
+  while(m_plyLoader.getStatus() == PlyAsyncLoader::State::E_LOADING)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  if(m_plyLoader.getStatus() != PlyAsyncLoader::State::E_LOADED)
+  {
+    std::cerr << "Error: invalid scene " << sceneName << std::endl;
+    deinitScene();
+    m_plyLoader.reset();
+    return false;
+  }
+  m_loadedSceneFilename = sceneName;
+  initAll();
+  m_plyLoader.reset();
+  return true;
+}
+
+void GaussianSplatting::benchmarkApplyConfig(uint32_t configId)
+{
+  const BenchmarkConfig config = getBenchmarkConfig(m_benchSettings, configId);
+
+  std::cout << "Benchmark: configuration " << configId + 1 << "/" << m_benchSettings.configCount()
+            << " pipeline=" << config.pipeline << " sorting=" << config.sorting << " storage=" << config.storage
+            << " shFormat=" << config.shFormat << " maxShDegree=" << config.maxShDegree << std::endl;
+
+  m_benchConfigSupported = config.pipeline != PIPELINE_MESH || m_supportMeshShader;
+
+  const ShaderDefines previousDefines = m_defines;
+
+  m_selectedPipeline          = config.pipeline;
+  m_frameInfo.sortingMethod   = config.sorting;
+  m_defines.dataStorage       = (int)config.storage;
+  m_defines.shFormat          = (int)config.shFormat;
+  m_defines.maxShDegree       = (int)config.maxShDegree;
+  m_defines.shAdaptive        = m_benchSettings.shAdaptive != 0;
+  m_defines.overdrawMode      = m_benchSettings.overdraw != 0;
+  // same rule as in the UI, culling at distance stage is only possible with GPU sorting
+  m_defines.frustumCulling = config.sorting == SORTING_GPU_SYNC_RADIX ? FRUSTUM_CULLING_AT_DIST : FRUSTUM_CULLING_AT_RASTER;
+  // measures the cost of a full sort at each frame
+  m_gpuSortPolicy = GPU_SORT_ALWAYS;
+
+  if(previousDefines.dataStorage != m_defines.dataStorage || previousDefines.shFormat != m_defines.shFormat
+     || previousDefines.shAdaptive != m_defines.shAdaptive)
+  {
+    reinitDataStorage();
+    // the previous data storage is kept, the shaders are rebuilt for it
+    if(!m_dataStorageError.empty())
+    {
+      m_benchConfigSupported = false;
+      reinitShaders();
+    }
+  }
+  else if(previousDefines.maxShDegree != m_defines.maxShDegree || previousDefines.frustumCulling != m_defines.frustumCulling
+          || previousDefines.overdrawMode != m_defines.overdrawMode)
+  {
+    reinitShaders();
+  }
+
+  m_distTime = m_sortTime = 0.0;
+  m_profiler->reset(nvh::Profiler::CONFIG_DELAY);
+}
+
+void GaussianSplatting::benchmarkCollectResult(uint32_t configId)
+{
+  BenchmarkResult result;
+  result.config    = getBenchmarkConfig(m_benchSettings, configId);
+  result.supported = m_benchConfigSupported;
+
+  if(result.supported)
+  {
+    double cpuTime = 0.0, gpuTime = 0.0;
+    // nullptr is the outermost scope, i.e. the CPU time of the frame
+    if(m_profiler->getAveragedValues(nullptr, cpuTime, gpuTime))
+      result.cpuFrame = cpuTime / 1000.0;
+    if(m_profiler->getAveragedValues("GPU Dist", cpuTime, gpuTime))
+      result.gpuDist = gpuTime / 1000.0;
+    if(m_profiler->getAveragedValues("GPU Sort", cpuTime, gpuTime))
+      result.gpuSort = gpuTime / 1000.0;
+    if(m_profiler->getAveragedValues("Rendering", cpuTime, gpuTime))
+      result.gpuRendering = gpuTime / 1000.0;
+
+    result.cpuDist = m_distTime;
+    result.cpuSort = m_sortTime;
+
+    result.visibleSplats = m_frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX ? m_indirectReadback.instanceCount :
+                                                                                 (uint32_t)m_splatSet.size();
+
+    const PipelineStatisticsValues& stats = m_pipelineStats.getValues();
+    result.vertexInvocations   = stats.vertexInvocations;
+    result.clippingInvocations = stats.clippingInvocations;
+    result.clippingPrimitives  = stats.clippingPrimitives;
+    result.fragmentInvocations = stats.fragmentInvocations;
+
+    if(isOverdrawModeActive() && m_overdrawStatsValid)
+    {
+      const uint64_t fragments = (uint64_t(m_overdrawStats.fragmentsHigh) << 32) | m_overdrawStats.fragmentsLow;
+      uint64_t       pixels    = 0;
+      result.overdrawHistogram.assign(std::begin(m_overdrawStats.histogram), std::end(m_overdrawStats.histogram));
+      for(uint32_t count : result.overdrawHistogram)
+        pixels += count;
+      result.overdrawMax      = m_overdrawStats.maxCount;
+      result.overdrawMean     = m_overdrawStats.coveredPixels ? (double)fragments / m_overdrawStats.coveredPixels : 0.0;
+      result.overdrawCoverage = pixels ? (double)m_overdrawStats.coveredPixels / pixels : 0.0;
+    }
+  }
+
+  result.modelHostUsed     = m_modelMemoryStats.srcAll;
+  result.modelDeviceUsed   = m_modelMemoryStats.odevAll;
+  result.modelDeviceAlloc  = m_modelMemoryStats.devAll;
+  result.renderHostUsed    = m_renderMemoryStats.hostTotal;
+  result.renderDeviceUsed  = m_renderMemoryStats.deviceUsedTotal;
+  result.renderDeviceAlloc = m_renderMemoryStats.deviceAllocTotal;
+
+  m_benchResults.push_back(result);
+}
+
+bool GaussianSplatting::benchmarkStep()
+{
+  if(m_benchFailed)
+    return false;
+
+  const uint32_t framesPerConfig = BENCHMARK_WARMUP_FRAMES + m_benchSettings.framesPerConfig;
+  const uint32_t configId        = m_benchFrame / framesPerConfig;
+  const uint32_t configFrame     = m_benchFrame % framesPerConfig;
+  m_benchFrame++;
+
+  if(configId == 0 && configFrame == 0)
+  {
+    if(!benchmarkLoadScene())
+    {
+      m_benchFailed = true;
+      return false;
+    }
+  }
+  else if(configFrame == 0)
+  {
+    benchmarkCollectResult(configId - 1);
+  }
+
+  if(configId >= m_benchSettings.configCount())
+    return false;  // extra frame used to collect last results
+
+  if(configFrame == 0)
+    benchmarkApplyConfig(configId);
+
+  // replay the camera path over the measured frames
+  if(!m_benchCameraPath.empty())
+  {
+    const float t = configFrame < BENCHMARK_WARMUP_FRAMES ?
+                        0.0f :
+                        float(configFrame - BENCHMARK_WARMUP_FRAMES) / float(std::max(1u, m_benchSettings.framesPerConfig - 1));
+    const CameraKey key = sampleCameraPath(m_benchCameraPath, t);
+    CameraManip.setLookat(key.eye, key.center, key.up);
+  }
+
+  return m_benchConfigSupported;
+}
+
+void GaussianSplatting::onLastHeadlessFrame()
+{
+  if(!m_benchSettings.enabled)
+    return;
+
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(m_app->getPhysicalDevice(), &properties);
+
+  if(m_benchFailed)
+  {
+    std::cerr << "Error: benchmark failed, no report written" << std::endl;
+    return;
+  }
+
+  if(writeBenchmarkReport(m_benchSettings.reportFilename, m_benchSettings, properties.deviceName,
+                          (uint32_t)m_splatSet.size(), m_benchResults))
+  {
+    std::cout << "Benchmark report written to " << m_benchSettings.reportFilename << std::endl;
+  }
+}
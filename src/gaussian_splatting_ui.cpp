@@ -77,6 +77,11 @@ void GaussianSplatting::initGui()
   // Sorting method selector
   m_ui.enumAdd(GUI_SORTING, SORTING_GPU_SYNC_RADIX, "GPU radix sort");
   m_ui.enumAdd(GUI_SORTING, SORTING_CPU_ASYNC_MULTI, "CPU async std multi");
+  // GPU sorting policy selector
+  m_ui.enumAdd(GUI_GPU_SORT_POLICY, GPU_SORT_ALWAYS, "Every frame");
+  m_ui.enumAdd(GUI_GPU_SORT_POLICY, GPU_SORT_LAZY, "Lazy");
+  m_ui.enumAdd(GUI_GPU_SORT_POLICY, GPU_SORT_EVERY_N, "Every N frames");
+  m_ui.enumAdd(GUI_GPU_SORT_POLICY, GPU_SORT_ON_THRESHOLD, "On viewpoint threshold");
   //
   m_ui.enumAdd(GUI_SH_FORMAT, FORMAT_FLOAT32, "Float 32");
   m_ui.enumAdd(GUI_SH_FORMAT, FORMAT_FLOAT16, "Float 16");
@@ -84,6 +89,18 @@ void GaussianSplatting::initGui()
   // gs mode
   m_ui.enumAdd(GUI_GSMODE, GSMODE_3DGS, "3dgs");
   m_ui.enumAdd(GUI_GSMODE, GSMODE_SPACETIME_LITE, "spacetime-lite");
+
+  m_ui.enumAdd(GUI_SPLAT_DISTRIBUTION, SPLAT_DISTRIBUTION_UNIFORM_BOX, "Uniform box");
+  m_ui.enumAdd(GUI_SPLAT_DISTRIBUTION, SPLAT_DISTRIBUTION_SURFACE_SHELL, "Surface shell");
+  m_ui.enumAdd(GUI_SPLAT_DISTRIBUTION, SPLAT_DISTRIBUTION_CLUSTERED_CITY, "Clustered city");
+
+  m_ui.enumAdd(GUI_SPLAT_ORDER, SPLAT_ORDER_NONE, "File order");
+  m_ui.enumAdd(GUI_SPLAT_ORDER, SPLAT_ORDER_MORTON, "Morton curve");
+  m_ui.enumAdd(GUI_SPLAT_ORDER, SPLAT_ORDER_HILBERT, "Hilbert curve");
+
+  m_ui.enumAdd(GUI_MIRROR_POLICY, MIRROR_OFF, "Off");
+  m_ui.enumAdd(GUI_MIRROR_POLICY, MIRROR_EVERY_N, "Every N frames");
+  m_ui.enumAdd(GUI_MIRROR_POLICY, MIRROR_CAPPED_RATE, "Capped rate");
 }
 
 void GaussianSplatting::onUIRender()
@@ -96,8 +113,10 @@ void GaussianSplatting::onUIRender()
     ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0F, 0.0F));
     ImGui::Begin("Viewport");
 
-    // Display the G-Buffer image
-    ImGui::Image(m_gBuffers->getDescriptorSet(), ImGui::GetContentRegionAvail());
+    // Display the G-Buffer image, the XR mirror only covers its top left corner which is
+    // stretched to the whole viewport
+    const glm::vec2 uvMax = m_mode == Mode::XR ? m_mirrorUvMax : glm::vec2(1.0f);
+    ImGui::Image(m_gBuffers->getDescriptorSet(), ImGui::GetContentRegionAvail(), ImVec2(0.0f, 0.0f), ImVec2(uvMax.x, uvMax.y));
 
     {
       float  size        = 25.F;
@@ -114,7 +133,7 @@ void GaussianSplatting::onUIRender()
 
 #ifdef WITH_DEFAULT_SCENE_FEATURE
   // load a default scene if none was provided by command line
-  if(m_enableDefaultScene && m_loadedSceneFilename.empty() && m_sceneToLoadFilename.empty()
+  if(m_enableDefaultScene && m_loadedSceneFilename.empty() && m_sceneToLoadFilename.empty() && !m_sceneToGenerate
      && m_plyLoader.getStatus() == PlyAsyncLoader::State::E_READY)
   {
     const std::vector<std::string> defaultSearchPaths = {NVPSystem::exePath() + PROJECT_DOWNLOAD_RELDIRECTORY,
@@ -154,6 +173,50 @@ void GaussianSplatting::onUIRender()
     m_sceneToLoadFilename.clear();
   }
 
+  // do we need to generate a synthetic scene ?
+  if(m_sceneToGenerate && m_plyLoader.getStatus() == PlyAsyncLoader::State::E_READY)
+  {
+    // reset if a scene already exists
+    if(m_splatSet.size())
+    {
+      deinitAll();
+    }
+
+    m_loadedSceneFilename = getSyntheticSceneName(m_generatorSettings);
+    //
+    vkDeviceWaitIdle(m_device);
+
+    std::cout << "Start generating scene " << m_loadedSceneFilename << std::endl;
+    if(!m_plyLoader.generateScene(m_generatorSettings, m_splatSet))
+    {
+      // this should never occur since status is READY.
+      std::cout << "Error: cannot start scene generation while loader is not ready status=" << m_plyLoader.getStatus() << std::endl;
+    }
+    else
+    {
+      // open the modal window that will collect results
+      ImGui::OpenPopup("Loading");
+    }
+
+    // reset request
+    m_sceneToGenerate = false;
+  }
+
+  // do we need to load a splat set to add to the scene ?
+  if(!m_instanceToAddFilename.empty() && m_plyLoader.getStatus() == PlyAsyncLoader::State::E_READY)
+  {
+    // the scene keeps being rendered, the loader fills a set of its own
+    std::cout << "Start loading instance " << m_instanceToAddFilename << std::endl;
+    if(m_splatSet.size() && m_plyLoader.loadScene(m_instanceToAddFilename, m_instanceSplatSet))
+    {
+      m_loadingInstance = true;
+      ImGui::OpenPopup("Loading");
+    }
+
+    // reset request
+    m_instanceToAddFilename.clear();
+  }
+
   // display loading jauge modal window
   // Always center this window when appearing
   ImVec2 center = ImGui::GetMainViewport()->GetCenter();
@@ -180,10 +243,19 @@ void GaussianSplatting::onUIRender()
         ImGui::Text("Error: invalid ply file");
         if(ImGui::Button("Ok", ImVec2(120, 0)))
         {
-          m_loadedSceneFilename = "";
-          // destroy scene just in case it was
-          // loaded but not properly since in error
-          deinitScene();
+          if(m_loadingInstance)
+          {
+            // the scene is left as is
+            m_instanceSplatSet = {};
+            m_loadingInstance  = false;
+          }
+          else
+          {
+            m_loadedSceneFilename = "";
+            // destroy scene just in case it was
+            // loaded but not properly since in error
+            deinitScene();
+          }
           // set ready for next load
           m_plyLoader.reset();
           ImGui::CloseCurrentPopup();
@@ -191,11 +263,24 @@ void GaussianSplatting::onUIRender()
       }
       break;
       case PlyAsyncLoader::State::E_LOADED: {
+        if(m_loadingInstance)
+        {
+          // the positions of the scene are appended to, wait for the CPU sorter to release them
+          if(m_cpuSorter.isSorting())
+            break;
+          addLoadedInstance();
+          m_loadingInstance = false;
+          m_plyLoader.reset();
+          ImGui::CloseCurrentPopup();
+          break;
+        }
         initAll();
         // set ready for next load
         m_plyLoader.reset();
         ImGui::CloseCurrentPopup();
-        addToRecentFiles(m_loadedSceneFilename);
+        // synthetic scenes are not files
+        if(!isSyntheticSceneName(m_loadedSceneFilename))
+          addToRecentFiles(m_loadedSceneFilename);
       }
       break;
       default: {
@@ -205,6 +290,21 @@ void GaussianSplatting::onUIRender()
     ImGui::EndPopup();
   }
 
+  // the positions of the scene are compacted, wait for the CPU sorter to release them
+  if(m_compactScene && !m_cpuSorter.isSorting())
+  {
+    m_compactScene = false;
+    if(restoreHostSplatData())
+      rebuildSceneStorage();
+  }
+
+  // lowers or raises the quality knobs according to the GPU frame time
+  updateFrameGovernor();
+
+  // the instance table is only applied by the shaders of composed scenes
+  if(m_splatSet.size() && isSceneComposed() != m_sceneInstancing)
+    m_updateShaders = true;
+
   // will rebuild data set according
   // to parameter change
   if(m_updateData && m_splatSet.size())
@@ -228,9 +328,9 @@ void GaussianSplatting::onUIRender()
 
   if(ImGui::Begin("Settings"))
   {
-    if(m_gsMode == GSMode::GSMode_3DGS && ImGui::CollapsingHeader("Data storage and format", ImGuiTreeNodeFlags_DefaultOpen))
+    if(ImGui::CollapsingHeader("Data storage and format", ImGuiTreeNodeFlags_DefaultOpen))
     {
-      PE::begin("##3DGS format");
+      PE::begin(m_gsMode == GSMode::GSMode_3DGS ? "##3DGS format" : "##Spacetime-lite format");
       if(PE::entry(
              "Default settings", [&] { return ImGui::Button("Reset"); }, "resets to default settings"))
       {
@@ -247,10 +347,91 @@ void GaussianSplatting::onUIRender()
       }
       if(PE::entry(
              "SH format", [&]() { return m_ui.enumCombobox(GUI_SH_FORMAT, "##ID", &m_defines.shFormat); },
-             "Selects storage format for SH coefficient, balancing precision and memory usage"))
+             "Selects storage format for SH coefficient, balancing precision and memory usage.\n"
+             "In spacetime mode, selects the format of the motion features stored in textures\n"
+             "(8 bit falls back to float 16)."))
+      {
+        m_updateData = true;
+      }
+      ImGui::BeginDisabled(m_defines.dataStorage != STORAGE_BUFFERS || m_gsMode != GSMode::GSMode_3DGS);
+      if(PE::Checkbox("Adaptive SH degree", &m_defines.shAdaptive,
+                      "Data buffers only. Each splat stores the SH bands up to its own degree,\n"
+                      "the higher bands with a negligible contribution to the color are dropped."))
+      {
+        m_updateData = true;
+      }
+      ImGui::BeginDisabled(!m_defines.shAdaptive);
+      if(PE::entry(
+             "SH tolerance",
+             [&]() {
+               ImGui::SliderFloat("##ID", &m_shAdaptiveTolerance, 0.0f, 0.1f, "%.4f", ImGuiSliderFlags_Logarithmic);
+               return ImGui::IsItemDeactivatedAfterEdit();
+             },
+             "Maximum color error (in [0,1]) introduced by dropping the higher SH bands of a splat."))
+      {
+        m_updateData = true;
+      }
+      if(useAdaptiveSh())
+        PE::Text("Splats per SH degree", "%u / %u / %u / %u", m_shAdaptiveDegreeCounts[0], m_shAdaptiveDegreeCounts[1],
+                 m_shAdaptiveDegreeCounts[2], m_shAdaptiveDegreeCounts[3]);
+      ImGui::EndDisabled();
+      ImGui::EndDisabled();
+      PE::entry(
+          "Splat order", [&]() { return m_ui.enumCombobox(GUI_SPLAT_ORDER, "##ID", &m_plyLoader.m_splatOrder); },
+          "Spatial reordering of the splats applied when the next scene is loaded.\n"
+          "Splats close in space are stored close in memory, improving the cache usage\n"
+          "of the rendering and of the CPU sorter.");
+      if(PE::InputIntClamped("Memory budget (MB)", (int*)&m_memoryBudgetMB, 0, 1024 * 1024, 256, 1024,
+                             ImGuiInputTextFlags_EnterReturnsTrue,
+                             "Device memory budget of the model, 0 uses the available budget of the device heap.\n"
+                             "If the model does not fit, the SH format then the SH degree (data buffers only)\n"
+                             "are downgraded at load time."))
       {
         m_updateData = true;
       }
+      PE::InputIntClamped("Staging ring (MB)", (int*)&m_stagingRingSizeMB, 1, 4096, 16, 64, ImGuiInputTextFlags_EnterReturnsTrue,
+                          "Host memory used to upload the model, the attributes are packed and\n"
+                          "copied to the device chunk by chunk. Applied at the next upload.");
+      if(PE::Checkbox("Release host data", &m_releaseHostData,
+                      "Frees the host copy of the splat attributes once uploaded, only the positions\n"
+                      "are kept for the CPU sorter. The attributes are reloaded from the file (or\n"
+                      "regenerated) when the data storage changes or when exporting."))
+      {
+        if(m_releaseHostData)
+          releaseHostSplatData();
+        else
+          restoreHostSplatData();
+      }
+      if(!m_dataStorageError.empty())
+        PE::Text("Error", "%s, the previous storage is kept", m_dataStorageError.c_str());
+      PE::end();
+    }
+
+    if(ImGui::CollapsingHeader("Pruning"))
+    {
+      auto& settings = m_plyLoader.m_pruneSettings;
+      PE::begin("##Pruning");
+      PE::Checkbox("Prune at load", &settings.enabled,
+                   "Removes the negligible splats when the next scene is loaded,\n"
+                   "saving memory, sorting time and vertex work on every frame.");
+      ImGui::BeginDisabled(!settings.enabled);
+      PE::SliderFloat("Min opacity", &settings.minOpacity, 0.0f, 0.1f, "%.4f", ImGuiSliderFlags_Logarithmic,
+                      "Splats with a lower opacity (after the sigmoid) are removed.");
+      PE::SliderFloat("Min size ratio", &settings.minSizeRatio, 0.0f, 0.01f, "%.6f", ImGuiSliderFlags_Logarithmic,
+                      "Splats with a size (geometric mean of the scales) lower than this\n"
+                      "ratio of the scene radius are removed, 0 disables the test.");
+      PE::SliderFloat("Max distance ratio", &settings.maxDistanceRatio, 0.0f, 100.0f, "%.1f", ImGuiSliderFlags_Logarithmic,
+                      "Splats farther from the scene center than this ratio of the scene radius\n"
+                      "are removed, 0 disables the test. Center and radius are medians, robust to outliers.");
+      PE::InputIntClamped("Splat budget", (int*)&settings.maxSplatCount, 0, 1 << 30, 100000, 1000000,
+                          ImGuiInputTextFlags_EnterReturnsTrue,
+                          "Keeps at most this number of splats, the ones with the highest\n"
+                          "opacity x projected area, 0 disables the budget.");
+      ImGui::EndDisabled();
+      const SplatPruneStats stats = m_plyLoader.getPruneStats();
+      PE::Text("Pruned splats", "%s / %s", formatSize((size_t)stats.prunedCount()).c_str(),
+               formatSize((size_t)stats.inputCount).c_str());
+      PE::Text("Saved memory", "%s", formatMemorySize((size_t)stats.bytesSaved).c_str());
       PE::end();
     }
 
@@ -284,17 +465,42 @@ void GaussianSplatting::onUIRender()
         }
       }
 
+      ImGui::BeginDisabled(m_frameInfo.sortingMethod != SORTING_GPU_SYNC_RADIX);
+      PE::entry(
+          "GPU sorting policy", [&]() { return m_ui.enumCombobox(GUI_GPU_SORT_POLICY, "##ID", &m_gpuSortPolicy); },
+          "Selects when the GPU sort is performed. When skipped, the indices of the last sort are reused.\n"
+          "Lazy: sorts only if view, projection or timestamp changed.\n"
+          "Every N frames: sorts once every N frames.\n"
+          "On viewpoint threshold: sorts only if the camera moved or turned beyond the thresholds.\n"
+          "Note: with frustum culling at distance stage, reduced rate sorting also delays the culling.");
+      if(m_gpuSortPolicy == GPU_SORT_EVERY_N)
+        PE::SliderInt("Sort every N frames", (int*)&m_gpuSortInterval, 1, 60);
+      if(m_gpuSortPolicy == GPU_SORT_ON_THRESHOLD)
+      {
+        PE::SliderFloat("Angle threshold", &m_gpuSortAngleThreshold, 0.0f, 10.0f, "%.2f deg");
+        PE::SliderFloat("Distance threshold", &m_gpuSortDistanceThreshold, 0.0f, 1.0f, "%.3f");
+      }
+      PE::Text("GPU sorting state", m_gpuSortSkipped ? "Reused" : "Sorted");
+      ImGui::EndDisabled();
+
+      ImGui::BeginDisabled(m_frameInfo.sortingMethod != SORTING_GPU_SYNC_RADIX || !m_supportSubgroupBallot);
+      if(PE::Checkbox("Subgroup compaction", &m_defines.distSubgroupCompaction,
+                      "Compacts the visible splats per subgroup in the distance shader,\n"
+                      "using a single atomic per subgroup instead of one per visible splat."))
+        m_updateShaders = true;
+      ImGui::EndDisabled();
+
       ImGui::BeginDisabled(m_frameInfo.sortingMethod == SORTING_GPU_SYNC_RADIX);
       PE::Checkbox("Lazy CPU sorting", &m_cpuLazySort, "Perform sorting only if viewpoint changes");
+      PE::Checkbox("Pose predicted CPU sorting", &m_cpuSortPrediction,
+                   "XR mode, sorts for the head pose extrapolated to the display of the frame expected to consume\n"
+                   "the result (the sort latency in frames, see statistics). Reduces the popping when the head turns.");
 
-      PE::Text("CPU sorting state", m_cpuSorter.getStatus() == SplatSorterAsync::E_SORTING ? "Sorting" : "Idled");
+      PE::Text("CPU sorting state", m_cpuSorter.isSorting() ? "Sorting" : "Idled");
       ImGui::EndDisabled();
-      if(m_gsMode == GSMode::GSMode_3DGS)
-      {
-        PE::entry(
-            "Rasterization", [&]() { return m_ui.enumCombobox(GUI_PIPELINE, "##ID", &m_selectedPipeline); },
-            "Selects the rendering pipeline, either Mesh Shader or Vertex Shader.");
-      }
+      PE::entry(
+          "Rasterization", [&]() { return m_ui.enumCombobox(GUI_PIPELINE, "##ID", &m_selectedPipeline); },
+          "Selects the rendering pipeline, either Mesh Shader or Vertex Shader.");
       
       // Radio buttons for exclusive selection
       PE::entry(
@@ -352,6 +558,8 @@ void GaussianSplatting::onUIRender()
         if(PE::SliderInt("Maximum SH degree", (int*)&m_defines.maxShDegree, 0, 3, "%d", 0,
                          "Sets the highest degree of Spherical Harmonics (SH) used for view-dependent effects."))
           m_updateShaders = true;
+        if(m_defines.dataStorage == STORAGE_BUFFERS && m_defines.maxShDegree > (int)m_shDegreeUploaded)
+          PE::Text("SH degree in memory", "%d", m_shDegreeUploaded);
 
         if(PE::Checkbox("Show SH deg > 0 only", &m_defines.showShOnly,
                         "Removes the base color from SH degree 0, applying only color deduced from \n"
@@ -369,7 +577,94 @@ void GaussianSplatting::onUIRender()
                       "This helps analyze splat distribution and scales, especially when combined with Splat Scale adjustments."))
         m_updateShaders = true;
 
+      ImGui::BeginDisabled(m_mode != Mode::PC);
+      if(PE::Checkbox("Overdraw mode", &m_defines.overdrawMode,
+                      "Displays the number of fragments blended per pixel as a heatmap, from dark blue (one fragment)\n"
+                      "to dark red (16K fragments and more). A summary histogram is given in the statistics. PC mode only."))
+        m_updateShaders = true;
+      ImGui::EndDisabled();
+
+      ImGui::BeginDisabled(isOverdrawModeActive());
+      if(PE::Checkbox("Reduced resolution", &m_defines.upscaling,
+                      "Rasterizes the splats at a reduced resolution then upscales the image with a compute pass\n"
+                      "(bicubic, clamped to the nearest texels along the edges). Lowers the blending cost of the\n"
+                      "fill bound scenes, about by the square of the render scale. Not in overdraw mode."))
+        m_updateShaders = true;
+      ImGui::BeginDisabled(!m_defines.upscaling);
+      if(m_mode == Mode::XR)
+      {
+        PE::SliderFloat("Render scale left", &m_defines.renderScale[0], MIN_RENDER_SCALE, 1.0f, "%.2f", 0,
+                        "Resolution of the left eye relative to the swapchain, in each dimension.");
+        PE::SliderFloat("Render scale right", &m_defines.renderScale[1], MIN_RENDER_SCALE, 1.0f, "%.2f", 0,
+                        "Resolution of the right eye relative to the swapchain, in each dimension.");
+      }
+      else
+      {
+        PE::SliderFloat("Render scale", &m_defines.renderScale[0], MIN_RENDER_SCALE, 1.0f, "%.2f", 0,
+                        "Resolution relative to the viewport, in each dimension.");
+      }
+      ImGui::EndDisabled();
+      ImGui::EndDisabled();
+
+      PE::Checkbox("Foveated LOD", &m_defines.foveation,
+                   "Fixed foveation, lowers the cost of the splats away from the view center where the lenses\n"
+                   "blur the image anyway. From the inner to the outer radius, the contribution and size culls\n"
+                   "grow up to their peripheral value, the SH degree is lowered beyond the outer radius.\n"
+                   "Radii are in normalized device coordinates, 1 is the border of the image.");
+      ImGui::BeginDisabled(!m_defines.foveation);
+      PE::SliderFloat("Fovea inner radius", &m_defines.foveaInnerRadius, 0.0f, 1.5f, "%.2f", 0,
+                      "Full quality inside this radius.");
+      PE::SliderFloat("Fovea outer radius", &m_defines.foveaOuterRadius, 0.0f, 1.5f, "%.2f", 0,
+                      "Peripheral quality outside this radius, kept above the inner radius.");
+      PE::SliderFloat("Peripheral contribution", &m_defines.foveaMinContribution, 0.0f, 8.0f, "%.2f", 0,
+                      "Culls the peripheral splats whose opacity x area at one standard deviation is under this\n"
+                      "number of pixels, added to the cull of the frame governor.");
+      PE::SliderFloat("Peripheral min radius", &m_defines.foveaMinRadius, 0.0f, 4.0f, "%.2f", 0,
+                      "Culls the peripheral splats whose largest radius at one standard deviation is under this\n"
+                      "number of pixels.");
+      PE::SliderInt("Peripheral SH degree", &m_defines.foveaShDegree, 0, 3, "%d", 0,
+                    "SH degree beyond the outer radius, capped by the SH degree of the shaders. Degree 0 skips\n"
+                    "the fetch of the SH coefficients.");
+      ImGui::EndDisabled();
+
+      ImGui::BeginDisabled(!m_pipelineStats.isSupported());
+      PE::Checkbox("Pipeline statistics", &m_pipelineStats.m_enabled,
+                   "Collects the pipeline statistics of the splat draws (see statistics), values are read back\n"
+                   "with a delay of a few frames to avoid stalls.");
+      ImGui::EndDisabled();
+
+      PE::end();
+    }
+
+    if(ImGui::CollapsingHeader("Frame governor"))
+    {
+      auto& settings = m_governor.settings;
+      PE::begin("##Frame governor");
+      PE::Checkbox("Enable", &settings.enabled,
+                   "Lowers the quality when the GPU frame time stays over the target and raises it back when it stays\n"
+                   "well under, the knobs are lowered in order: contribution cull, splat budget, render scale then SH degree.\n"
+                   "The budget is the display period in XR mode.");
+      ImGui::BeginDisabled(!settings.enabled);
+      PE::SliderFloat("Target ratio", &settings.targetRatio, 0.5f, 1.0f, "%.2f", 0,
+                      "The GPU frame time is kept under this ratio of the frame budget.");
+      PE::SliderFloat("Raise ratio", &settings.raiseRatio, 0.3f, settings.targetRatio, "%.2f", 0,
+                      "The quality is raised back when the GPU frame time is under this ratio of the frame budget.");
+      PE::SliderFloat("PC target rate", &settings.pcTargetRate, 30.0f, 240.0f, "%.0f Hz", 0, "Frame budget in PC mode.");
+      ImGui::EndDisabled();
+      PE::Text("GPU frame time (ms)", "%.2f / %.2f", m_governor.getLastFrameTime(), m_governor.getLastBudget());
+      for(uint32_t k = 0; k < KNOB_COUNT; ++k)
+      {
+        const GovernorKnob knob = (GovernorKnob)k;
+        PE::Text(FrameGovernor::getKnobName(knob), "%d / %d", m_governor.getLevel(knob), FrameGovernor::getLevelCount(knob) - 1);
+      }
+      if(m_importanceThresholds.empty())
+        PE::Text("Importance thresholds", "not available in this mode");
       PE::end();
+      // most recent first
+      const auto& decisions = m_governor.getDecisions();
+      for(auto it = decisions.rbegin(); it != decisions.rend(); ++it)
+        ImGui::Text("%.1fs %s %d -> %d (%.2f / %.2f ms)", it->time, FrameGovernor::getKnobName(it->knob), it->fromLevel,
+                    it->toLevel, it->frameTime, it->budget);
     }
 
     if(ImGui::CollapsingHeader("Statistics", ImGuiTreeNodeFlags_DefaultOpen))
@@ -416,8 +711,53 @@ void GaussianSplatting::onUIRender()
         PE::begin("##Sorting statistics");
         PE::Text("CPU Distances  (ms)", "%.3f", m_distTime);
         PE::Text("CPU Sorting  (ms)", "%.3f", m_sortTime);
+        PE::Text("CPU Sort latency (frames)", "%.1f", m_cpuSortLatency);
         PE::end();
       }
+
+      if(m_pipelineStats.isSupported() && m_pipelineStats.m_enabled
+         && ImGui::BeginTable("Pipeline stats", 3, ImGuiTableFlags_BordersOuter))
+      {
+        const PipelineStatisticsValues& stats = m_pipelineStats.getValues();
+        auto addRow = [](const char* name, uint64_t value) {
+          ImGui::TableNextRow();
+          ImGui::TableNextColumn();
+          ImGui::Text("%s", name);
+          ImGui::TableNextColumn();
+          ImGui::Text("%s", formatSize(value).c_str());
+          ImGui::TableNextColumn();
+          ImGui::Text("%llu", (unsigned long long)value);
+        };
+        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthFixed, 170.0f);
+        ImGui::TableSetupColumn("Size short", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Size Fill", ImGuiTableColumnFlags_WidthStretch);
+        addRow("Vertex invocations", stats.vertexInvocations);
+        addRow("Clipping invocations", stats.clippingInvocations);
+        addRow("Clipping primitives", stats.clippingPrimitives);
+        addRow("Fragment invocations", stats.fragmentInvocations);
+        ImGui::EndTable();
+      }
+
+      if(isOverdrawModeActive() && m_overdrawStatsValid)
+      {
+        const shaderio::OverdrawStats& stats     = m_overdrawStats;
+        const uint64_t                 fragments = (uint64_t(stats.fragmentsHigh) << 32) | stats.fragmentsLow;
+        uint64_t                       pixels    = 0;
+        float                          histogram[OVERDRAW_HISTOGRAM_BINS];
+        for(uint32_t i = 0; i < OVERDRAW_HISTOGRAM_BINS; ++i)
+        {
+          pixels += stats.histogram[i];
+          // log scale, bins of high counts are usually small
+          histogram[i] = std::log10(1.0f + (float)stats.histogram[i]);
+        }
+        PE::begin("##Overdraw statistics");
+        PE::Text("Overdraw coverage", "%.1f %%", pixels ? 100.0 * stats.coveredPixels / pixels : 0.0);
+        PE::Text("Overdraw mean", "%.2f", stats.coveredPixels ? (double)fragments / stats.coveredPixels : 0.0);
+        PE::Text("Overdraw max", "%u", stats.maxCount);
+        PE::end();
+        ImGui::PlotHistogram("##Overdraw histogram", histogram, OVERDRAW_HISTOGRAM_BINS, 0,
+                             "pixels per log2 fragment count (log10)", 0.0f, FLT_MAX, ImVec2(-1.0f, 80.0f));
+      }
     }
     if(ImGui::CollapsingHeader("Mode", ImGuiTreeNodeFlags_DefaultOpen))
     {
@@ -425,17 +765,30 @@ void GaussianSplatting::onUIRender()
       bool xr = m_mode == Mode::PC ? false : true;
       if(PE::Checkbox("Enter XR", &xr))
       {
-        if(xr && m_mode == Mode::PC)
-        {
-          m_app->setSwitchMode(true);
-          m_app->close();
-        }
-        else if(!xr && m_mode == Mode::XR)
+        // done by the application controller before the next frame, the scene is kept
+        if(xr != (m_mode == Mode::XR))
         {
           m_app->setSwitchMode(true);
-          m_app->close();
         }
       }
+      PE::entry(
+          "Desktop mirror", [&]() { return m_ui.enumCombobox(GUI_MIRROR_POLICY, "##ID", &m_mirrorPolicy); },
+          "Selects how often the desktop window is refreshed in XR mode, the headset frames never wait for it.\n"
+          "Off: the headset view is not copied, the UI is refreshed at the capped rate.\n"
+          "Every N frames: once every N headset frames.\n"
+          "Capped rate: at most the given number of times per second.");
+      if(m_mirrorPolicy == MIRROR_EVERY_N)
+        PE::SliderInt("Mirror every N frames", &m_mirrorInterval, 1, 30);
+      else
+        PE::SliderFloat("Mirror rate", &m_mirrorMaxRate, 1.0f, 120.0f, "%.0f Hz");
+      PE::SliderFloat("Mirror resolution", &m_mirrorScale, 0.1f, 1.0f, "%.2f", 0, "Resolution of the mirror relative to the viewport");
+      ImGui::BeginDisabled(m_xrDepthExtent.width == 0);
+      if(PE::Checkbox("Depth layer", &m_defines.xrDepthLayer,
+                      "Submits with the color a per pixel depth, the depth of the nearest splat fragment reaching 50% opacity.\n"
+                      "Allows the runtime to reproject the missed frames with the head position, not only its rotation.\n"
+                      "Disabled if the runtime does not support XR_KHR_composition_layer_depth."))
+        m_updateShaders = true;
+      ImGui::EndDisabled();
 
       if(PE::entry(
              "gaussian mode", [&]() { return m_ui.enumCombobox(GUI_GSMODE, "##ID", &m_gsMode); },
@@ -456,6 +809,108 @@ void GaussianSplatting::onUIRender()
       
       PE::end();
     }
+    if(ImGui::CollapsingHeader("Scene composition"))
+    {
+      PE::begin("##Scene composition");
+      // the instances can be added to 3DGS scenes only, the spacetime features are not merged
+      ImGui::BeginDisabled(m_splatSet.size() == 0 || m_gsMode != GSMode::GSMode_3DGS
+                           || getLiveInstanceCount() >= MAX_SCENE_INSTANCES);
+      if(PE::entry(
+             "Add instance", [&] { return ImGui::Button("Open file"); },
+             "Loads a splat set and adds it to the scene, the splats of all the instances are sorted together"))
+      {
+        m_instanceToAddFilename = NVPSystem::windowOpenFileDialog(m_app->getWindowHandle(), "Load ply file", "PLY(.ply)");
+      }
+      ImGui::EndDisabled();
+      // instances are uploaded in place until the capacity is reached, the buffers are then rebuilt
+      PE::Text("Splat capacity", "%d", getSplatCapacity());
+      PE::end();
+
+      const size_t liveCount = getLiveInstanceCount();
+      for(size_t i = 0; i < m_instances.size(); ++i)
+      {
+        SceneInstance& instance = m_instances[i];
+        if(instance.removed)
+          continue;
+        ImGui::PushID((int)i);
+        if(ImGui::TreeNode("##instance", "%s (%d splats)", instance.name.c_str(), instance.splatCount))
+        {
+          PE::begin("##Instance");
+          bool changed = PE::Checkbox("Visible", &instance.visible);
+          changed |= PE::DragFloat3("Translation", &instance.translation.x, 0.01f);
+          changed |= PE::DragFloat3("Rotation", &instance.rotation.x, 0.5f, -180.0f, 180.0f, "%.1f", 0,
+                                    "Euler angles in degrees, applied in X, Y then Z order");
+          changed |= PE::DragFloat("Scale", &instance.scale, 0.01f, 0.01f, 100.0f, "%.2f", 0, "Uniform scale");
+          // the scene keeps at least one instance
+          ImGui::BeginDisabled(liveCount < 2);
+          if(PE::entry("Remove", [&] { return ImGui::Button("Remove"); },
+                       "Hides the instance, its splats are dropped when the buffers are rebuilt"))
+          {
+            removeInstance(i);
+          }
+          ImGui::EndDisabled();
+          PE::end();
+          if(changed)
+          {
+            m_instancesDirty     = true;
+            m_sortPositionsDirty = true;
+          }
+          ImGui::TreePop();
+        }
+        ImGui::PopID();
+      }
+    }
+    if(ImGui::CollapsingHeader("Synthetic scene"))
+    {
+      PE::begin("##Synthetic scene");
+      PE::entry("Distribution",
+                [&]() { return m_ui.enumCombobox(GUI_SPLAT_DISTRIBUTION, "##ID", &m_generatorSettings.distribution); });
+      PE::entry(
+          "Splat count",
+          [&]() {
+            const uint32_t step = 100000;
+            return ImGui::InputScalar("##ID", ImGuiDataType_U32, &m_generatorSettings.splatCount, &step);
+          },
+          "Number of generated splats, in [1K, 50M]");
+      PE::entry("Seed", [&]() { return ImGui::InputScalar("##ID", ImGuiDataType_U32, &m_generatorSettings.seed); });
+      PE::SliderFloat("Extent", &m_generatorSettings.extent, 0.5f, 50.0f, "%.1f", 0, "Half size of the scene bounding box");
+      if(m_generatorSettings.distribution == SPLAT_DISTRIBUTION_CLUSTERED_CITY)
+      {
+        PE::SliderInt("Buildings", (int*)&m_generatorSettings.clusterCount, 1, 1024);
+      }
+      PE::entry(
+          "Splat size",
+          [&]() {
+            return ImGui::DragFloatRange2("##ID", &m_generatorSettings.scaleRange[0], &m_generatorSettings.scaleRange[1],
+                                          0.001f, 0.0001f, 1.0f, "%.4f", "%.4f");
+          },
+          "Min and max mean axis length in world units, log-uniform distribution");
+      PE::SliderFloat("Anisotropy", &m_generatorSettings.anisotropy, 1.0f, 20.0f, "%.1f", 0,
+                      "Max ratio between the largest and the smallest axis of a splat");
+      PE::entry(
+          "Opacity",
+          [&]() {
+            return ImGui::DragFloatRange2("##ID", &m_generatorSettings.opacityRange[0],
+                                          &m_generatorSettings.opacityRange[1], 0.01f, 0.0f, 1.0f, "%.2f", "%.2f");
+          },
+          "Min and max opacity, uniform distribution");
+      if(m_gsMode == GSMode::GSMode_3DGS)
+      {
+        PE::SliderInt("SH degree", (int*)&m_generatorSettings.shDegree, 0, 3);
+        PE::SliderFloat("SH amplitude", &m_generatorSettings.shAmplitude, 0.0f, 1.0f);
+      }
+      else
+      {
+        PE::SliderFloat("Motion amplitude", &m_generatorSettings.motionAmplitude, 0.0f, 5.0f, "%.2f", 0,
+                        "Max displacement of a splat over one time unit");
+        PE::SliderFloat("Rotation speed", &m_generatorSettings.rotationSpeed, 0.0f, 5.0f);
+      }
+      if(PE::entry("Generate", [&] { return ImGui::Button("Generate"); }, "Replaces the current scene by the synthetic one"))
+      {
+        m_sceneToGenerate = true;
+      }
+      PE::end();
+    }
   }
   ImGui::End();
 
@@ -465,6 +920,30 @@ void GaussianSplatting::onUIRender()
     {
       ImGuiH::CameraWidget();
     }
+    if(ImGui::CollapsingHeader("Trace capture"))
+    {
+      TraceRecorder& recorder = TraceRecorder::instance();
+      PE::begin("##Trace capture");
+      PE::SliderInt("Frames", (int*)&m_traceFrameCount, 1, 3000, "%d", 0,
+                    "Number of frames written to the chrome://tracing file");
+      if(recorder.isRecording())
+      {
+        PE::Text("Remaining frames", "%d", recorder.getRemainingFrames());
+        if(PE::entry("Stop", [&] { return ImGui::Button("Stop"); }, "Writes the frames captured so far"))
+          recorder.stop();
+      }
+      else if(PE::entry("Capture", [&] { return ImGui::Button("Capture"); },
+                        "Records the loader, sorter and render threads and the GPU sections"))
+      {
+        std::string filename = NVPSystem::windowSaveFileDialog(m_app->getWindowHandle(), "Save trace file", "JSON(.json)");
+        if(!filename.empty())
+          recorder.start(filename, m_traceFrameCount);
+      }
+      const std::string lastFilename = recorder.getLastFilename();
+      if(!lastFilename.empty())
+        PE::Text("Last capture", "%s", lastFilename.c_str());
+      PE::end();
+    }
   }
   ImGui::End();
 
@@ -531,6 +1010,27 @@ void GaussianSplatting::onUIRender()
       ImGui::Text("%s", formatMemorySize(m_modelMemoryStats.odevAll).c_str());
       ImGui::TableNextColumn();
       ImGui::Text("%s", formatMemorySize(m_modelMemoryStats.devAll).c_str());
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("Upload staging");
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_modelMemoryStats.hostStaging).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(0).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(0).c_str());
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text(m_hostDataReleased ? "Host splat set (released)" : "Host splat set");
+      ImGui::TableNextColumn();
+      const size_t hostSplatSetBytes = (m_splatSet.positions.size() + m_splatSet.f_dc.size() + m_splatSet.f_rest.size()
+                                        + m_splatSet.opacity.size() + m_splatSet.scale.size() + m_splatSet.rotation.size())
+                                       * sizeof(float);
+      ImGui::Text("%s", formatMemorySize(hostSplatSetBytes).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(0).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(0).c_str());
       ImGui::EndTable();
     }
     ImGui::Separator();
@@ -590,6 +1090,24 @@ void GaussianSplatting::onUIRender()
                             .c_str());
       ImGui::TableNextRow();
       ImGui::TableNextColumn();
+      ImGui::Text("Overdraw");
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.hostAllocOverdraw).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.allocOverdraw).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.allocOverdraw).c_str());
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("Upscaling");
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(0).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.allocUpscale).c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.allocUpscale).c_str());
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
       ImGui::Text("Sub-total");
       ImGui::TableNextColumn();
       ImGui::Text("%s", formatMemorySize(m_renderMemoryStats.hostTotal).c_str());
@@ -616,6 +1134,32 @@ void GaussianSplatting::onUIRender()
       ImGui::Text("%s", formatMemorySize(m_modelMemoryStats.devAll + m_renderMemoryStats.deviceAllocTotal).c_str());
       ImGui::EndTable();
     }
+    ImGui::Separator();
+    // process wide usage, includes the G-Buffers and what is allocated out of this sample
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(m_alloc->vma(), &memoryProperties);
+    if(ImGui::BeginTable("Heaps", 4, ImGuiTableFlags_None))
+    {
+      ImGui::TableSetupColumn(m_supportMemoryBudget ? "Heap" : "Heap (estimated)", ImGuiTableColumnFlags_WidthStretch);
+      ImGui::TableSetupColumn("Allocated", ImGuiTableColumnFlags_WidthStretch);
+      ImGui::TableSetupColumn("Usage", ImGuiTableColumnFlags_WidthStretch);
+      ImGui::TableSetupColumn("Budget", ImGuiTableColumnFlags_WidthStretch);
+      ImGui::TableHeadersRow();
+      for(uint32_t i = 0; i < (uint32_t)m_heapBudgets.size(); ++i)
+      {
+        const bool deviceLocal = memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("%d %s", i, deviceLocal ? "Device" : "Host");
+        ImGui::TableNextColumn();
+        ImGui::Text("%s", formatMemorySize(m_heapBudgets[i].statistics.blockBytes).c_str());
+        ImGui::TableNextColumn();
+        ImGui::Text("%s", formatMemorySize(m_heapBudgets[i].usage).c_str());
+        ImGui::TableNextColumn();
+        ImGui::Text("%s", formatMemorySize(m_heapBudgets[i].budget).c_str());
+      }
+      ImGui::EndTable();
+    }
   }
   ImGui::End();
 }
@@ -636,7 +1180,19 @@ void GaussianSplatting::onUIMenu()
     }
     if(ImGui::MenuItem("Re Open", "F5", false, m_loadedSceneFilename != ""))
     {
-      m_sceneToLoadFilename = m_loadedSceneFilename;
+      if(isSyntheticSceneName(m_loadedSceneFilename))
+        m_sceneToGenerate = true;
+      else
+        m_sceneToLoadFilename = m_loadedSceneFilename;
+    }
+    if(ImGui::MenuItem("Export ply file", "", false, m_splatSet.size() > 0))
+    {
+      std::string filename = NVPSystem::windowSaveFileDialog(m_app->getWindowHandle(), "Export ply file", "PLY(.ply)");
+      if(!filename.empty() && restoreHostSplatData())
+      {
+        writeSplatSetPly(filename, m_splatSet, m_gsMode);
+        releaseHostSplatData();
+      }
     }
     if(ImGui::BeginMenu("Recent Files"))
     {
@@ -16,16 +16,19 @@
  * SPDX-FileCopyrightText: Copyright (c) 2023-2025, NVIDIA CORPORATION.
  * SPDX-License-Identifier: Apache-2.0
  */
-#define SWITCH_CHECK(x, y)                                                                                               \
+#define SWITCH_CHECK(x, y)                                                                                             \
   {                                                                                                                    \
     XrResult result = (x);                                                                                             \
     if(!XR_SUCCEEDED(result))                                                                                          \
     {                                                                                                                  \
-      std::cerr << "ERROR: Fail to switch mode: " << y <<  std::endl;                                                             \
-      ifSwitchMode = true;                                                                                     \
-      return;                                                                                                   \
+      std::cerr << "ERROR: Fail to switch mode: " << y << std::endl;                                                   \
+      xrEnv->EndSession();                                                                                             \
+      return false;                                                                                                    \
     }                                                                                                                  \
-  } 
+  }
+
+#include <chrono>
+#include <thread>
 
 #include <gaussian_splatting.h>
 #include <Common/GraphicsAPI.h>
@@ -36,42 +39,42 @@
 class AppCtrl
 {
 public:
-  std::unique_ptr<nvvkhl::Application> app = nullptr;
   std::shared_ptr<GraphicsAPI_Vulkan> graphicsAPI = nullptr;
+  std::shared_ptr<OpenXREnv>          xrEnv       = nullptr;  // null if no OpenXR runtime was found
+
+  Mode currentMode = Mode::PC;
 
-  bool ifSwitchMode = false;
-  Mode currentMode  = Mode::PC;
+  // synthetic scene requested from the command line, generated at first frame
+  SplatGeneratorSettings m_generatorSettings;
+  // command line, the viewer options are applied to the GaussianSplatting element
+  int    m_argc = 0;
+  char** m_argv = nullptr;
 
-  GaussianSplatting::RenderSettings m_renderSettings;
+  // desktop mirror in XR mode, see GaussianSplatting::MirrorPolicy
+  uint64_t                              m_xrFrameIndex = 0;
+  std::chrono::steady_clock::time_point m_lastMirrorTime;
+  bool                                  m_desktopVsync = true;  // restored when leaving XR
 
+  // The device, the application and the scene live for the whole run. When an OpenXR runtime
+  // is present the device is created with the extensions it requires, so switching between
+  // the desktop and the headset only creates or destroys the XR session and its swapchains.
   void run()
   {
-    while(true)
+    // Openxr-Vulkan Context if a runtime is available, desktop only Vulkan context otherwise
+    xrEnv       = std::make_shared<OpenXREnv>(GraphicsAPI_Type::VULKAN);
+    graphicsAPI = std::make_shared<GraphicsAPI_Vulkan>();
+    if(XR_SUCCEEDED(xrEnv->InitVulkan())
+       && XR_SUCCEEDED(graphicsAPI->init(xrEnv->GetXrInstance(), xrEnv->GetXrSystemId())))
     {
-      ifSwitchMode = false;
-      if(currentMode == Mode::PC)
-      {
-        runPC();
-      }
-      else if(currentMode == Mode::XR)
-      {
-        runXR();
-      }
-      if(ifSwitchMode)
-      {
-        currentMode = currentMode == Mode::XR ? Mode::PC : Mode::XR;
-      }
-      else
-      {
-        break;
-      }
+      xrEnv->GetGraphicsAPI(graphicsAPI);
+    }
+    else
+    {
+      std::cerr << "No OpenXR runtime or no compatible device available, XR mode is disabled" << std::endl;
+      xrEnv.reset();
+      graphicsAPI = std::make_shared<GraphicsAPI_Vulkan>();
+      graphicsAPI->init();
     }
-  }
-
-  void runPC() {
-    // Vulkan Context
-    graphicsAPI = std::make_shared<GraphicsAPI_Vulkan>();
-    graphicsAPI->init();
     // Application setup
     nvvkhl::ApplicationCreateInfo appSetup;
     appSetup.name                  = fmt::format("{}", PROJECT_NAME);
@@ -103,9 +106,11 @@ public:
     auto profiler = std::make_shared<nvvkhl::ElementProfiler>(true);
     // create the core of the sample
     auto gaussianSplatting = std::make_shared<GaussianSplatting>(profiler, nullptr);
+    gaussianSplatting->m_supportMemoryBudget = graphicsAPI->memoryBudgetEnabled;
+    gaussianSplatting->parseCommandLine(m_argc, m_argv);
 
     // Add all application elements including our sample specific gaussianSplatting
-    app->addElement(gaussianSplatting);
+    app->addElement(gaussianSplatting);  // this should be the first to add
     app->addElement(std::make_shared<nvvkhl::ElementCamera>());
     app->addElement(std::make_shared<nvvkhl::ElementDefaultWindowTitle>("", fmt::format("({})", "GLSL")));  // Window title info//
     app->addElement(profiler);
@@ -113,111 +118,242 @@ public:
     //
     gaussianSplatting->registerRecentFilesHandler();
     gaussianSplatting->registerRecentSceneParamsHandler();
+    app->loadIniSettings();  // register then load .ini
     gaussianSplatting->m_mode = Mode::PC;
-    app->run();
-    ifSwitchMode = app->ifSwitchMode();
-    gaussianSplatting->getRenderSettings(m_renderSettings);
+    currentMode               = Mode::PC;
+    if(m_generatorSettings.enabled)
+    {
+      gaussianSplatting->setGeneratorSettings(m_generatorSettings);
+      m_generatorSettings.enabled = false;
+    }
+
+    std::function<void(nvvkhl::Application*)> frameFunc = [this, gaussianSplatting](nvvkhl::Application* app) {
+      // requested from the UI during the previous frame
+      if(app->ifSwitchMode())
+      {
+        app->setSwitchMode(false);
+        if(currentMode == Mode::PC)
+          enterXR(app, gaussianSplatting);
+        else
+          leaveXR(app, gaussianSplatting);
+      }
+
+      if(currentMode == Mode::XR)
+        renderXRFrame(app, gaussianSplatting);
+      else
+        renderPCFrame(app);
+    };
+
+    app->runXR(frameFunc);
+
+    vkDeviceWaitIdle(graphicsAPI->device);
+    if(currentMode == Mode::XR)
+    {
+      xrEnv->EndSession();
+    }
     app.reset();
+    frameFunc = nullptr;
     gaussianSplatting.reset();  // this module used vmaAllocator which is corresponded with vk objects, so deconstruct before graphicsAPI
     profiler.reset();
+    xrEnv.reset();
     graphicsAPI.reset();
   }
 
-  void runXR() {
-    // Openxr-Vulkan Context
-    std::shared_ptr<OpenXREnv> xrEnv = std::make_shared<OpenXREnv>(GraphicsAPI_Type::VULKAN);
-    graphicsAPI                      = std::make_shared<GraphicsAPI_Vulkan>();
-    SWITCH_CHECK(xrEnv->InitVulkan(), "fail to create openxr instance or get systemId");
-    SWITCH_CHECK(graphicsAPI->init(xrEnv->GetXrInstance(), xrEnv->GetXrSystemId()), "fail to create openxr compatible vulkan objects");
-    xrEnv->GetGraphicsAPI(graphicsAPI);
-    SWITCH_CHECK(xrEnv->InitSession(), "fail to create openxr session or swapchain");
-    xrEnv->InitController();
+  // renders the benchmark sweep offscreen and exits
+  void runBenchmark(const BenchmarkSettings& settings)
+  {
+    // Vulkan Context, no surface needed
+    graphicsAPI = std::make_shared<GraphicsAPI_Vulkan>();
+    graphicsAPI->init(true);
     // Application setup
     nvvkhl::ApplicationCreateInfo appSetup;
-    appSetup.name                  = fmt::format("{}", PROJECT_NAME);
-    appSetup.vSync                 = true;
-    appSetup.hasUndockableViewport = true;
-    appSetup.instance              = graphicsAPI->instance;
-    appSetup.device                = graphicsAPI->device;
-    appSetup.physicalDevice        = graphicsAPI->physicalDevice;
+    appSetup.name           = fmt::format("{}", PROJECT_NAME);
+    appSetup.vSync          = false;
+    appSetup.headless       = true;
+    appSetup.windowSize     = {settings.resolution[0], settings.resolution[1]};
+    appSetup.instance       = graphicsAPI->instance;
+    appSetup.device         = graphicsAPI->device;
+    appSetup.physicalDevice = graphicsAPI->physicalDevice;
     appSetup.queues.push_back({graphicsAPI->queueFamilyIndex, graphicsAPI->queueIndex, graphicsAPI->queue});
 
-    // Setting up the layout of the application
-    appSetup.dockSetup = [](ImGuiID viewportID) {
-      // right side panel container
-      ImGuiID settingID = ImGui::DockBuilderSplitNode(viewportID, ImGuiDir_Right, 0.25F, nullptr, &viewportID);
-      ImGui::DockBuilderDockWindow("Settings", settingID);
-      ImGui::DockBuilderDockWindow("Misc", settingID);
-
-      // bottom panel container
-      ImGuiID memoryID = ImGui::DockBuilderSplitNode(viewportID, ImGuiDir_Down, 0.35F, nullptr, &viewportID);
-      ImGui::DockBuilderDockWindow("Memory Statistics", memoryID);
-      ImGuiID profilerID = ImGui::DockBuilderSplitNode(memoryID, ImGuiDir_Right, 0.33F, nullptr, &memoryID);
-      ImGui::DockBuilderDockWindow("Profiler", profilerID);
-    };
+    // create the profiler element
+    auto profiler = std::make_shared<nvvkhl::ElementProfiler>(false);
+    // create the core of the sample
+    auto gaussianSplatting = std::make_shared<GaussianSplatting>(profiler, nullptr);
+    gaussianSplatting->m_mode = Mode::PC;
+    gaussianSplatting->m_supportMemoryBudget = graphicsAPI->memoryBudgetEnabled;
+    gaussianSplatting->parseCommandLine(m_argc, m_argv);
+    gaussianSplatting->setBenchmarkSettings(settings);
+    appSetup.headlessFrameCount = gaussianSplatting->getBenchmarkFrameCount();
 
     // Create the application
     auto app = std::make_unique<nvvkhl::Application>(appSetup);
 
-    // create the profiler element
-    auto profiler = std::make_shared<nvvkhl::ElementProfiler>(true);
-    // create the core of the sample
-    auto gaussianSplatting = std::make_shared<GaussianSplatting>(profiler, nullptr);
-    gaussianSplatting->m_headsetSupportUnorm = xrEnv->SupportUnorm();
-    // Add all application elements including our sample specific gaussianSplatting
-    app->addElement(gaussianSplatting); // this should be the first to add
+    app->addElement(gaussianSplatting);
     app->addElement(std::make_shared<nvvkhl::ElementCamera>());
-    app->addElement(std::make_shared<nvvkhl::ElementDefaultWindowTitle>("", fmt::format("({})", "GLSL")));  // Window title info//
     app->addElement(profiler);
-    app->addElement(std::make_shared<nvvkhl::ElementNvml>());
-    //
-    gaussianSplatting->registerRecentFilesHandler();
-    gaussianSplatting->registerRecentSceneParamsHandler();
-    app->loadIniSettings(); // register then load .ini
-    gaussianSplatting->setRenderSettings(m_renderSettings);
-    gaussianSplatting->m_mode = Mode::XR;
+    app->run();
+    app.reset();
+    gaussianSplatting.reset();  // this module used vmaAllocator which is corresponded with vk objects, so deconstruct before graphicsAPI
+    profiler.reset();
+    graphicsAPI.reset();
+  }
 
+private:
+  // creates the XR session and its swapchains on the existing device, stays in PC mode on failure
+  bool enterXR(nvvkhl::Application* app, const std::shared_ptr<GaussianSplatting>& gaussianSplatting)
+  {
+    if(!xrEnv)
+    {
+      std::cerr << "ERROR: Fail to switch mode: no OpenXR runtime was found at startup" << std::endl;
+      return false;
+    }
+    // the previous frames may still use the desktop resources the session creation touches
+    vkDeviceWaitIdle(graphicsAPI->device);
+    SWITCH_CHECK(xrEnv->InitSession(), "fail to create openxr session or swapchain");
+    xrEnv->InitController();
+
+    gaussianSplatting->m_headsetSupportUnorm = xrEnv->SupportUnorm();
+    gaussianSplatting->setXrDepthExtent(xrEnv->GetDepthExtent());
+    gaussianSplatting->setXrViewExtent(xrEnv->GetViewExtent());
+    gaussianSplatting->setMode(Mode::XR);
     xrEnv->m_player.head.worldMatrix = glm::inverse(gaussianSplatting->getLoadedSceneCamera());
     gaussianSplatting->initRecentSceneScale();
 
-    std::function<void(nvvkhl::Application*)> renderFunc = [xrEnv, gaussianSplatting](nvvkhl::Application* app) {
-      xrEnv->PollEvents();
-      if(!xrEnv->AppRunning())
-      {
-        app->close();
-      }
-      VkCommandBuffer cmd = app->beginFrame();
-      if(cmd != nullptr && xrEnv->SessionRunning())
+    // the mirror is presented without waiting for the display (mailbox or immediate)
+    m_desktopVsync = app->isVsync();
+    app->setVsync(false);
+    app->setRenderWhenMinimized(true);
+    m_xrFrameIndex = 0;
+    currentMode    = Mode::XR;
+    return true;
+  }
+
+  // destroys the XR session, the scene and the device resources are kept
+  void leaveXR(nvvkhl::Application* app, const std::shared_ptr<GaussianSplatting>& gaussianSplatting)
+  {
+    // the swapchain images must not be in use anymore
+    vkDeviceWaitIdle(graphicsAPI->device);
+    xrEnv->EndSession();
+    gaussianSplatting->setMode(Mode::PC);
+    gaussianSplatting->setXrDepthExtent({0, 0});
+    gaussianSplatting->setXrViewExtent({0, 0});
+    app->setVsync(m_desktopVsync);
+    app->setRenderWhenMinimized(false);
+    currentMode = Mode::PC;
+  }
+
+  // true if the desktop window is refreshed during this headset frame
+  bool isMirrorFrame(nvvkhl::Application* app, const GaussianSplatting& gaussianSplatting)
+  {
+    if(app->isMinimized())
+      return false;
+
+    const auto now = std::chrono::steady_clock::now();
+    bool       mirror;
+    if(gaussianSplatting.m_mirrorPolicy == GaussianSplatting::MIRROR_EVERY_N)
+    {
+      mirror = m_xrFrameIndex % std::max(gaussianSplatting.m_mirrorInterval, 1) == 0;
+    }
+    else
+    {
+      const std::chrono::duration<float> period(1.0f / std::max(gaussianSplatting.m_mirrorMaxRate, 1.0f));
+      mirror = now - m_lastMirrorTime >= period;
+    }
+    if(mirror)
+      m_lastMirrorTime = now;
+    return mirror;
+  }
+
+  void renderPCFrame(nvvkhl::Application* app)
+  {
+    VkCommandBuffer cmd = app->beginFrame();
+    if(cmd != VK_NULL_HANDLE)
+    {
+      app->drawFrame(cmd);
+      app->endFrame(cmd);
+      app->presentFrame();
+    }
+  }
+
+  // The headset views are recorded before the desktop frame, in the same command buffer.
+  // The frames paced by the headset only go through the desktop swapchain on mirror frames,
+  // the other ones are submitted offscreen so the headset never waits for the window.
+  void renderXRFrame(nvvkhl::Application* app, const std::shared_ptr<GaussianSplatting>& gaussianSplatting)
+  {
+    xrEnv->PollEvents();
+    if(!xrEnv->AppRunning())
+    {
+      // the runtime ended the session, back to the desktop at next frame
+      app->setSwitchMode(true);
+    }
+
+    const bool xrFrame = xrEnv->SessionRunning();
+    bool       present = true;
+    if(xrFrame)
+    {
+      present = isMirrorFrame(app, *gaussianSplatting);
+      ++m_xrFrameIndex;
+    }
+    else if(app->isMinimized())
+    {
+      // nothing paces the loop until the session runs
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      return;
+    }
+
+    VkCommandBuffer cmd = present ? app->beginFrame() : app->beginOffscreenFrame();
+    if(cmd == VK_NULL_HANDLE && xrFrame)
+    {
+      // the desktop swapchain is being rebuilt, the headset frame goes on without it
+      present = false;
+      cmd     = app->beginOffscreenFrame();
+    }
+    if(cmd == VK_NULL_HANDLE)
+      return;
+
+    RenderLayerInfo renderLayerInfo;
+    if(xrFrame && xrEnv->BeginFrame(renderLayerInfo))
+    {
+      gaussianSplatting->setFrameBudget(xrEnv->GetDisplayPeriod());
+      const bool mirror = present && gaussianSplatting->m_mirrorPolicy != GaussianSplatting::MIRROR_OFF;
+      if(xrEnv->RenderLayer(renderLayerInfo, cmd, gaussianSplatting, mirror))
       {
-          RenderLayerInfo renderLayerInfo;
-          if(xrEnv->BeginFrame(renderLayerInfo))
-          {
-            if(xrEnv->RenderLayer(renderLayerInfo, cmd, gaussianSplatting))
-            {
-              renderLayerInfo.layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&renderLayerInfo.layerProjection));
-            }
-          }
-          app->drawFrame(cmd);
-          app->endFrame(cmd);   // submit before release swapchain image
-          app->presentFrame();
-          xrEnv->EndFrame(renderLayerInfo);
-          // handle controller input(except poses which are already handled)
-          if(xrEnv->m_input->GetSelectClickData(Inputspace::SideEnum::RIGHT))
-          {
-            gaussianSplatting->updateRecentSceneParams();
-          }
-          gaussianSplatting->updateRecentSceneScale(xrEnv->m_input->GetThumbStickData(Inputspace::SideEnum::RIGHT).x);
+        renderLayerInfo.layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&renderLayerInfo.layerProjection));
       }
+    }
+    // the views are located again as late as possible, right before the submission
+    auto lateLatch = [&]() {
+      if(renderLayerInfo.frameBegun && !renderLayerInfo.layers.empty())
+        xrEnv->LateLatchViews(renderLayerInfo, gaussianSplatting);
     };
-
-    app->runXR(renderFunc);
-    ifSwitchMode = app->ifSwitchMode();
-    app.reset();
-    renderFunc = nullptr;
-    gaussianSplatting.reset();  // this module used vmaAllocator which is corresponded with vk objects, so deconstruct before graphicsAPI
-    profiler.reset();
-    xrEnv.reset();
-    graphicsAPI.reset();
+    // submit before release swapchain image
+    if(present)
+    {
+      app->drawFrame(cmd);
+      lateLatch();
+      app->endFrame(cmd);
+      app->presentFrame();
+    }
+    else
+    {
+      app->drawOffscreenFrame(cmd);
+      lateLatch();
+      app->endOffscreenFrame(cmd);
+    }
+    if(xrFrame)
+    {
+      xrEnv->EndFrame(renderLayerInfo);
+    }
+    TraceRecorder::instance().endFrame();
+    if(!xrFrame)
+      return;
+    // handle controller input(except poses which are already handled)
+    if(xrEnv->m_input->GetSelectClickData(Inputspace::SideEnum::RIGHT))
+    {
+      gaussianSplatting->updateRecentSceneParams();
+    }
+    gaussianSplatting->updateRecentSceneScale(xrEnv->m_input->GetThumbStickData(Inputspace::SideEnum::RIGHT).x);
   }
 };
 
@@ -225,8 +361,63 @@ public:
 // with a GaussianSplatting element.
 int main(int argc, char** argv)
 {
+  SplatGeneratorSettings generatorSettings;
+  if(!parseGeneratorArguments(argc, argv, generatorSettings))
+  {
+    return 1;
+  }
+  BenchmarkSettings benchmarkSettings;
+  if(!parseBenchmarkArguments(argc, argv, benchmarkSettings))
+  {
+    return 1;
+  }
+  TraceSettings traceSettings;
+  if(!parseTraceArguments(argc, argv, traceSettings))
+  {
+    return 1;
+  }
+
+  // writes the synthetic scene without starting the viewer
+  if(generatorSettings.enabled && !generatorSettings.outputFilename.empty())
+  {
+    const GSMode gsMode = generatorSettings.outputGsMode == GSMODE_3DGS ? GSMode_3DGS : GSMode_SPACETIME_LITE;
+    SplatSet     splatSet;
+    if(!generateSplatSet(generatorSettings, gsMode, splatSet)
+       || !writeSplatSetPly(generatorSettings.outputFilename, splatSet, gsMode))
+    {
+      return 1;
+    }
+    return 0;
+  }
+
+  if(benchmarkSettings.synthetic)
+  {
+    if(!generatorSettings.enabled)
+    {
+      std::cerr << "Error: -benchSynthetic requires -generate <splat count>" << std::endl;
+      return 1;
+    }
+    benchmarkSettings.generator = generatorSettings;
+  }
+
+  // captures from the first frame, including the loading of the scene
+  if(!traceSettings.filename.empty())
+  {
+    TraceRecorder::instance().start(traceSettings.filename, traceSettings.frameCount);
+  }
+
   std::unique_ptr<AppCtrl> appController = std::make_unique<AppCtrl>();
-  appController->run();
+  appController->m_generatorSettings = generatorSettings;
+  appController->m_argc              = argc;
+  appController->m_argv              = argv;
+  if(benchmarkSettings.enabled)
+  {
+    appController->runBenchmark(benchmarkSettings);
+  }
+  else
+  {
+    appController->run();
+  }
   
 
   return 0;
@@ -9,6 +9,7 @@
 #include <OpenXRHelper.h>
 #include "gaussian_splatting.h"
 #include "Input.h"
+#include "trace_recorder.h"
 
 XrVector3f operator-(XrVector3f a, XrVector3f b) {
     return {a.x - b.x, a.y - b.y, a.z - b.z};
@@ -68,6 +69,8 @@ XrResult OpenXREnv::InitSession()
     return XR_SUCCESS;
 }
 void OpenXREnv::Destroy() {
+    StopFramePacing();
+    m_input.reset();
     DestroySwapchains();
     DestroyReferenceSpace();
     DestroySession();
@@ -138,6 +141,13 @@ XrResult OpenXREnv::CreateInstance()
             XR_TUT_LOG_ERROR("Failed to find OpenXR instance extension: " << requestedInstanceExtension);
         }
     }
+    // Optional extensions, the features using them are disabled if not found.
+    for (auto &extensionProperty : extensionProperties) {
+        if (strcmp(XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME, extensionProperty.extensionName) == 0) {
+            m_activeInstanceExtensions.push_back(XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME);
+            m_depthLayerSupported = true;
+        }
+    }
     // Fill out an XrInstanceCreateInfo structure and create an XrInstance.
     XrInstanceCreateInfo instanceCI{XR_TYPE_INSTANCE_CREATE_INFO};
     instanceCI.createFlags = 0;
@@ -278,6 +288,20 @@ XrResult OpenXREnv::CreateSession()
     OPENXR_LOG(xrCreateSession(m_xrInstance, &sessionCI, &m_session), "Failed to create Session.");
     return XR_SUCCESS;
 }
+void OpenXREnv::EndSession()
+{
+    StopFramePacing();
+    // the action spaces belong to the session
+    m_input.reset();
+    DestroySwapchains();
+    DestroyReferenceSpace();
+    DestroySession();
+    m_colorSwapchainInfos.clear();
+    m_depthSwapchainInfos.clear();
+    m_sessionState       = XR_SESSION_STATE_UNKNOWN;
+    m_sessionRunning     = false;
+    m_applicationRunning = true;
+}
 XrResult OpenXREnv::DestroySession()
 {
     // Destroy the XrSession.
@@ -346,20 +370,24 @@ void OpenXREnv::PollEvents()
                 sessionBeginInfo.primaryViewConfigurationType = m_viewConfiguration;
                 OPENXR_CHECK(xrBeginSession(m_session, &sessionBeginInfo), "Failed to begin Session.");
                 m_sessionRunning = true;
+                StartFramePacing();
             }
             if (sessionStateChanged->state == XR_SESSION_STATE_STOPPING) {
-                // SessionState is stopping. End the XrSession.
+                // SessionState is stopping. End the XrSession, no frame must be waited anymore.
+                StopFramePacing();
                 OPENXR_CHECK(xrEndSession(m_session), "Failed to end Session.");
                 m_sessionRunning = false;
             }
             if (sessionStateChanged->state == XR_SESSION_STATE_EXITING) {
                 // SessionState is exiting. Exit the application.
+                StopFramePacing();
                 m_sessionRunning = false;
                 m_applicationRunning = false;
             }
             if (sessionStateChanged->state == XR_SESSION_STATE_LOSS_PENDING) {
                 // SessionState is loss pending. Exit the application.
                 // It's possible to try a reestablish an XrInstance and XrSession, but we will simply exit here.
+                StopFramePacing();
                 m_sessionRunning = false;
                 m_applicationRunning = false;
             }
@@ -410,7 +438,9 @@ XrResult OpenXREnv::CreateSwapchains()
         // Color.
         XrSwapchainCreateInfo swapchainCI{XR_TYPE_SWAPCHAIN_CREATE_INFO};
         swapchainCI.createFlags = 0;
-        swapchainCI.usageFlags  = XR_SWAPCHAIN_USAGE_TRANSFER_SRC_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
+        // transfer destination for the upscaled views of the reduced resolution rendering
+        swapchainCI.usageFlags  = XR_SWAPCHAIN_USAGE_TRANSFER_SRC_BIT | XR_SWAPCHAIN_USAGE_TRANSFER_DST_BIT
+                                 | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
         swapchainCI.format = m_graphicsAPI->SelectColorSwapchainFormat(formats);                // Use GraphicsAPI to select the first compatible format.
         swapchainCI.sampleCount = 1;  // Not Use the recommended values from the XrViewConfigurationView.
         swapchainCI.width = m_viewConfigurationViews[i].recommendedImageRectWidth;
@@ -452,12 +482,44 @@ XrResult OpenXREnv::CreateSwapchains()
             colorSwapchainInfo.imageViews.push_back(m_graphicsAPI->CreateImageView(imageViewCI));
         }
     }
+    // Per view, a depth swapchain for the depth layer. The depths are copied as floats, only D32 is used.
+    if (m_depthLayerSupported && std::find(formats.begin(), formats.end(), (int64_t)VK_FORMAT_D32_SFLOAT) != formats.end()) {
+        m_depthSwapchainInfos.resize(m_viewConfigurationViews.size());
+        for (size_t i = 0; i < m_viewConfigurationViews.size(); i++) {
+            SwapchainInfo &depthSwapchainInfo = m_depthSwapchainInfos[i];
+            XrSwapchainCreateInfo swapchainCI{XR_TYPE_SWAPCHAIN_CREATE_INFO};
+            swapchainCI.createFlags = 0;
+            swapchainCI.usageFlags  = XR_SWAPCHAIN_USAGE_TRANSFER_DST_BIT | XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+            swapchainCI.format      = VK_FORMAT_D32_SFLOAT;
+            swapchainCI.sampleCount = 1;
+            swapchainCI.width       = m_viewConfigurationViews[i].recommendedImageRectWidth;
+            swapchainCI.height      = m_viewConfigurationViews[i].recommendedImageRectHeight;
+            swapchainCI.faceCount   = 1;
+            swapchainCI.arraySize   = 1;
+            swapchainCI.mipCount    = 1;
+            OPENXR_LOG(xrCreateSwapchain(m_session, &swapchainCI, &depthSwapchainInfo.swapchain), "Failed to create Depth Swapchain");
+            depthSwapchainInfo.swapchainFormat = swapchainCI.format;
+
+            uint32_t depthSwapchainImageCount = 0;
+            OPENXR_LOG(xrEnumerateSwapchainImages(depthSwapchainInfo.swapchain, 0, &depthSwapchainImageCount, nullptr),
+                       "Failed to enumerate Depth Swapchain Images.");
+            XrSwapchainImageBaseHeader* depthSwapchainImages =
+                m_graphicsAPI->AllocateSwapchainImageData(depthSwapchainInfo.swapchain, GraphicsAPI::SwapchainType::DEPTH,
+                                                          depthSwapchainImageCount);
+            OPENXR_LOG(xrEnumerateSwapchainImages(depthSwapchainInfo.swapchain, depthSwapchainImageCount,
+                                                  &depthSwapchainImageCount, depthSwapchainImages),
+                       "Failed to enumerate Depth Swapchain Images.");
+        }
+    }
+    else if (m_depthLayerSupported) {
+        std::cout << "No D32 depth swapchain format, the depth layer is disabled" << std::endl;
+    }
     return XR_SUCCESS;
 }
 XrResult OpenXREnv::DestroySwapchains()
 {
-    // Per view in the view configuration:
-    for(size_t i = 0; i < m_viewConfigurationViews.size(); i++)
+    // Per view in the view configuration, the swapchains may not have been created if the session failed.
+    for(size_t i = 0; i < m_colorSwapchainInfos.size(); i++)
     {
         SwapchainInfo& colorSwapchainInfo = m_colorSwapchainInfos[i];
 
@@ -469,6 +531,7 @@ XrResult OpenXREnv::DestroySwapchains()
                 m_graphicsAPI->DestroyImageView(imageView);
             }
         }
+        colorSwapchainInfo.imageViews.clear();
 
         // Free the Swapchain Image Data.
         if(colorSwapchainInfo.swapchain)
@@ -483,16 +546,108 @@ XrResult OpenXREnv::DestroySwapchains()
             colorSwapchainInfo.swapchain = XR_NULL_HANDLE;
         }
     }
+    for(SwapchainInfo& depthSwapchainInfo : m_depthSwapchainInfos)
+    {
+        if(depthSwapchainInfo.swapchain)
+        {
+            m_graphicsAPI->FreeSwapchainImageData(depthSwapchainInfo.swapchain);
+            OPENXR_LOG(xrDestroySwapchain(depthSwapchainInfo.swapchain), "Failed to destroy Depth Swapchain");
+            depthSwapchainInfo.swapchain = XR_NULL_HANDLE;
+        }
+    }
     return XR_SUCCESS;
 }
+void OpenXREnv::StartFramePacing()
+{
+    if(m_pacingThread.joinable())
+        return;
+
+    m_pacingStop      = false;
+    m_pacingActive    = true;
+    m_pacedFrameReady = false;
+    m_pacedFrameBegun = true;
+    m_pacingThread    = std::thread([this]() {
+        TraceRecorder::instance().setThreadName("XR pacing");
+        while(true)
+        {
+            // a frame can only be waited once the previous one has begun
+            {
+                std::unique_lock<std::mutex> lock(m_pacingMutex);
+                m_pacingCV.wait(lock, [this] { return m_pacingStop || m_pacedFrameBegun; });
+                if(m_pacingStop)
+                    break;
+                m_pacedFrameBegun = false;
+            }
+            XrFrameState    frameState{XR_TYPE_FRAME_STATE};
+            XrFrameWaitInfo frameWaitInfo{XR_TYPE_FRAME_WAIT_INFO};
+            XrResult        result;
+            {
+                TRACE_SCOPE("xrWaitFrame");
+                result = xrWaitFrame(m_session, &frameWaitInfo, &frameState);
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_pacingMutex);
+                m_pacedFrameResult = result;
+                m_pacedFrameState  = frameState;
+                m_pacedFrameReady  = true;
+            }
+            m_pacingCV.notify_all();
+            if(!XR_SUCCEEDED(result))
+                break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_pacingMutex);
+            m_pacingActive = false;
+        }
+        m_pacingCV.notify_all();
+    });
+}
+
+void OpenXREnv::StopFramePacing()
+{
+    if(!m_pacingThread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_pacingMutex);
+        m_pacingStop = true;
+    }
+    m_pacingCV.notify_all();
+    // returns after the xrWaitFrame in progress if any
+    m_pacingThread.join();
+    m_pacedFrameReady = false;
+}
+
 bool OpenXREnv::BeginFrame(RenderLayerInfo& renderLayerInfo) {
-    m_frameState = {XR_TYPE_FRAME_STATE};
-    // Get the XrFrameState for timing and rendering info.
-    XrFrameWaitInfo frameWaitInfo{XR_TYPE_FRAME_WAIT_INFO};
-    OPENXR_CHECK(xrWaitFrame(m_session, &frameWaitInfo, &m_frameState), "Failed to wait for XR Frame.");
+    // Get the XrFrameState for timing and rendering info, waited by the pacing thread.
+    XrResult waitResult;
+    {
+        TRACE_SCOPE("WaitPacedFrame");
+        std::unique_lock<std::mutex> lock(m_pacingMutex);
+        m_pacingCV.wait(lock, [this] { return m_pacedFrameReady || !m_pacingActive; });
+        if(!m_pacedFrameReady)
+            return false;
+        m_frameState      = m_pacedFrameState;
+        waitResult        = m_pacedFrameResult;
+        m_pacedFrameReady = false;
+    }
+    OPENXR_CHECK(waitResult, "Failed to wait for XR Frame.");
+    if(!XR_SUCCEEDED(waitResult))
+        return false;
     // Tell the OpenXR compositor that the application is beginning the frame.
     XrFrameBeginInfo frameBeginInfo{XR_TYPE_FRAME_BEGIN_INFO};
-    OPENXR_CHECK(xrBeginFrame(m_session, &frameBeginInfo), "Failed to begin the XR Frame.");
+    XrResult         beginResult;
+    {
+        TRACE_SCOPE("xrBeginFrame");
+        beginResult = xrBeginFrame(m_session, &frameBeginInfo);
+    }
+    // the next frame can be waited while this one is recorded
+    {
+        std::lock_guard<std::mutex> lock(m_pacingMutex);
+        m_pacedFrameBegun = true;
+    }
+    m_pacingCV.notify_all();
+    OPENXR_CHECK(beginResult, "Failed to begin the XR Frame.");
+    renderLayerInfo.frameBegun = XR_SUCCEEDED(beginResult);
     // Variables for rendering and layer composition.
     renderLayerInfo.predictedDisplayTime = m_frameState.predictedDisplayTime;
     // Check that the session is active and that we should render.
@@ -503,6 +658,9 @@ bool OpenXREnv::BeginFrame(RenderLayerInfo& renderLayerInfo) {
 
 void OpenXREnv::EndFrame(RenderLayerInfo& renderLayerInfo)
 {
+    if(!renderLayerInfo.frameBegun)
+        return;
+    TRACE_SCOPE("EndFrame");
     for(uint32_t i = 0; i < renderLayerInfo.layerProjectionViews.size(); i++)
     {
         // Give the swapchain image back to OpenXR, allowing the compositor to use the image.
@@ -510,6 +668,12 @@ void OpenXREnv::EndFrame(RenderLayerInfo& renderLayerInfo)
         OPENXR_CHECK(xrReleaseSwapchainImage(m_colorSwapchainInfos[i].swapchain, &releaseInfo),
                      "Failed to release Image back to the Color Swapchain");
     }
+    for(uint32_t i = 0; i < renderLayerInfo.layerDepthInfos.size(); i++)
+    {
+        XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
+        OPENXR_CHECK(xrReleaseSwapchainImage(m_depthSwapchainInfos[i].swapchain, &releaseInfo),
+                     "Failed to release Image back to the Depth Swapchain");
+    }
     // Fill out the XrCompositionLayerProjection structure for usage with xrEndFrame().
     renderLayerInfo.layerProjection.layerFlags =
         XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT | XR_COMPOSITION_LAYER_CORRECT_CHROMATIC_ABERRATION_BIT;
@@ -528,8 +692,9 @@ void OpenXREnv::EndFrame(RenderLayerInfo& renderLayerInfo)
 void OpenXREnv::RenderFrame(RenderLayerInfo& renderLayerInfo)
 {
 }
-bool OpenXREnv::RenderLayer(RenderLayerInfo& renderLayerInfo, VkCommandBuffer cmd, std::shared_ptr<GaussianSplatting> gsRenderer)
+bool OpenXREnv::RenderLayer(RenderLayerInfo& renderLayerInfo, VkCommandBuffer cmd, std::shared_ptr<GaussianSplatting> gsRenderer, bool mirror)
 {
+    TRACE_SCOPE("RenderLayer");
     // Locate the views from the view configuration within the (reference) space at the display time.
     std::vector<XrView> views(m_viewConfigurationViews.size(), {XR_TYPE_VIEW});
     XrViewState viewState{XR_TYPE_VIEW_STATE};  // Will contain information on whether the position and/or orientation is valid and/or tracked.
@@ -547,6 +712,9 @@ bool OpenXREnv::RenderLayer(RenderLayerInfo& renderLayerInfo, VkCommandBuffer cm
     }
     // Resize the layer projection views to match the view count. The layer projection views are used in the layer projection.
     renderLayerInfo.layerProjectionViews.resize(viewCount, {XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW});
+    // The depth is submitted if the renderer writes it for this frame.
+    const bool depth = m_depthSwapchainInfos.size() >= viewCount && gsRenderer->isXrDepthReady();
+    renderLayerInfo.layerDepthInfos.assign(depth ? viewCount : 0, {XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR});
     // Per view in the view configuration:
     for(uint32_t i = 0; i < viewCount; i++)
     {
@@ -560,8 +728,18 @@ bool OpenXREnv::RenderLayer(RenderLayerInfo& renderLayerInfo, VkCommandBuffer cm
         XrSwapchainImageWaitInfo waitInfo = {XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
         waitInfo.timeout                  = XR_INFINITE_DURATION;
         OPENXR_CHECK(xrWaitSwapchainImage(colorSwapchainInfo.swapchain, &waitInfo), "Failed to wait for Image from the Color Swapchain");
+        if(depth)
+        {
+            OPENXR_CHECK(xrAcquireSwapchainImage(m_depthSwapchainInfos[i].swapchain, &acquireInfo, &depthImageIndex[i]),
+                         "Failed to acquire Image from the Depth Swapchain");
+            OPENXR_CHECK(xrWaitSwapchainImage(m_depthSwapchainInfos[i].swapchain, &waitInfo),
+                         "Failed to wait for Image from the Depth Swapchain");
+        }
     }
     SyncAction(views);
+    const XrViewStateFlags tracked = XR_VIEW_STATE_ORIENTATION_VALID_BIT | XR_VIEW_STATE_POSITION_VALID_BIT;
+    if((viewState.viewStateFlags & tracked) == tracked)
+        SetHeadPose(views, viewCount, renderLayerInfo.predictedDisplayTime, *gsRenderer);
     auto head = glm::inverse(m_player.head.worldMatrix);
     memcpy(&cameraConstants.head, &head, 16 * 4);
 
@@ -573,8 +751,6 @@ bool OpenXREnv::RenderLayer(RenderLayerInfo& renderLayerInfo, VkCommandBuffer cm
         const uint32_t& width    = m_viewConfigurationViews[i].recommendedImageRectWidth;
         const uint32_t& height   = m_viewConfigurationViews[i].recommendedImageRectHeight;
         GraphicsAPI::Viewport viewport = {0.0f, 0.0f, (float)width, (float)height, 0.0f, 1.0f};
-        float           nearZ    = 0.09f;
-        float           farZ     = 2000.0f;
         // Fill out the XrCompositionLayerProjectionView structure specifying the pose and fov from the view.
         // This also associates the swapchain image with this layer projection view.
         renderLayerInfo.layerProjectionViews[i]                    = {XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW};
@@ -586,22 +762,94 @@ bool OpenXREnv::RenderLayer(RenderLayerInfo& renderLayerInfo, VkCommandBuffer cm
         renderLayerInfo.layerProjectionViews[i].subImage.imageRect.extent.width  = static_cast<int32_t>(width);
         renderLayerInfo.layerProjectionViews[i].subImage.imageRect.extent.height = static_cast<int32_t>(height);
         renderLayerInfo.layerProjectionViews[i].subImage.imageArrayIndex = 0;  // Useful for multiview rendering.
-        // Compute the view-projection transform.
-        // All matrices (including OpenXR's) are column-major, right-handed.
-        XrMatrix4x4f_CreateProjectionFov(&cameraConstants.Proj, m_apiType, views[i].fov, nearZ, farZ);
-        XrMatrix4x4f toView;
-        XrVector3f   scale1m{1.0f, 1.0f, 1.0f};
-        XrMatrix4x4f_CreateTranslationRotationScale(&toView, &views[i].pose.position, &views[i].pose.orientation, &scale1m);
-        XrMatrix4x4f_InvertRigidBody(&cameraConstants.View, &toView);
-        cameraConstants.pos = views[i].pose.position;
-        cameraConstants.viewport = {(int)width, (int)height};
+        // Chain the depth of the view, in the [0,1] range of the projection, for the positional reprojection.
+        void* depthImage = nullptr;
+        if(depth)
+        {
+            XrCompositionLayerDepthInfoKHR& depthInfo = renderLayerInfo.layerDepthInfos[i];
+            depthInfo.subImage.swapchain              = m_depthSwapchainInfos[i].swapchain;
+            // only the rendered area is written in reduced resolution rendering, the depth is not upscaled
+            const VkExtent2D depthExtent              = gsRenderer->getRenderExtent(i, {width, height});
+            depthInfo.subImage.imageRect.offset       = {0, 0};
+            depthInfo.subImage.imageRect.extent       = {(int32_t)depthExtent.width, (int32_t)depthExtent.height};
+            depthInfo.subImage.imageArrayIndex        = 0;
+            depthInfo.minDepth                        = 0.0f;
+            depthInfo.maxDepth                        = 1.0f;
+            depthInfo.nearZ                           = m_nearZ;
+            depthInfo.farZ                            = m_farZ;
+            renderLayerInfo.layerProjectionViews[i].next = &depthInfo;
+            depthImage = m_graphicsAPI->GetSwapchainImage(m_depthSwapchainInfos[i].swapchain, depthImageIndex[i]);
+        }
+        SetViewCamera(cameraConstants, views[i], width, height);
         // record render cmd
         gsRenderer->renderView(cmd, colorSwapchainInfo.imageViews[colorImageIndex[i]], (void*)&cameraConstants,
-                               i == 1 ? m_graphicsAPI->GetSwapchainImage(colorSwapchainInfo.swapchain, colorImageIndex[i]) : nullptr);
+                               m_graphicsAPI->GetSwapchainImage(colorSwapchainInfo.swapchain, colorImageIndex[i]),
+                               mirror && i == 1, depthImage);
     }
     return true;
 }
 
+void OpenXREnv::SetViewCamera(CameraConstants& camera, const XrView& view, uint32_t width, uint32_t height)
+{
+    // Compute the view-projection transform.
+    // All matrices (including OpenXR's) are column-major, right-handed.
+    XrMatrix4x4f_CreateProjectionFov(&camera.Proj, m_apiType, view.fov, m_nearZ, m_farZ);
+    XrMatrix4x4f toView;
+    XrVector3f   scale1m{1.0f, 1.0f, 1.0f};
+    XrMatrix4x4f_CreateTranslationRotationScale(&toView, &view.pose.position, &view.pose.orientation, &scale1m);
+    XrMatrix4x4f_InvertRigidBody(&camera.View, &toView);
+    camera.pos      = view.pose.position;
+    camera.viewport = {(int)width, (int)height};
+}
+
+void OpenXREnv::LateLatchViews(RenderLayerInfo& renderLayerInfo, std::shared_ptr<GaussianSplatting> gsRenderer)
+{
+    TRACE_SCOPE("LateLatchViews");
+    // Locate the views again for the same display time, the prediction is closer to the display so more accurate.
+    std::vector<XrView> views(m_viewConfigurationViews.size(), {XR_TYPE_VIEW});
+    XrViewState viewState{XR_TYPE_VIEW_STATE};
+    XrViewLocateInfo viewLocateInfo{XR_TYPE_VIEW_LOCATE_INFO};
+    viewLocateInfo.viewConfigurationType = m_viewConfiguration;
+    viewLocateInfo.displayTime           = renderLayerInfo.predictedDisplayTime;
+    viewLocateInfo.space                 = m_localSpace;
+    uint32_t viewCount                   = 0;
+    XrResult result =
+        xrLocateViews(m_session, &viewLocateInfo, &viewState, static_cast<uint32_t>(views.size()), &viewCount, views.data());
+    // keep the poses used at recording if the new ones are not tracked
+    const XrViewStateFlags tracked = XR_VIEW_STATE_ORIENTATION_VALID_BIT | XR_VIEW_STATE_POSITION_VALID_BIT;
+    if(result != XR_SUCCESS || (viewState.viewStateFlags & tracked) != tracked
+       || viewCount != renderLayerInfo.layerProjectionViews.size())
+        return;
+    // the head (locomotion) matrix of cameraConstants is the one of the recording
+    CameraConstants camera = cameraConstants;
+    for(uint32_t i = 0; i < viewCount; i++)
+    {
+        // the compositor reprojects from the pose given in the layer, it must be the one used to render
+        renderLayerInfo.layerProjectionViews[i].pose = views[i].pose;
+        renderLayerInfo.layerProjectionViews[i].fov  = views[i].fov;
+        SetViewCamera(camera, views[i], m_viewConfigurationViews[i].recommendedImageRectWidth,
+                      m_viewConfigurationViews[i].recommendedImageRectHeight);
+        gsRenderer->latchViewCamera(i, &camera);
+    }
+    // replaces the sample of the same display time
+    SetHeadPose(views, viewCount, renderLayerInfo.predictedDisplayTime, *gsRenderer);
+}
+
+void OpenXREnv::SetHeadPose(const std::vector<XrView>& views, uint32_t viewCount, XrTime displayTime, GaussianSplatting& gsRenderer)
+{
+    if(viewCount == 0)
+        return;
+    PosePredictor::Pose pose;
+    pose.position = glm::vec3(0.0f);
+    for(uint32_t i = 0; i < viewCount; i++)
+        pose.position += glm::vec3(views[i].pose.position.x, views[i].pose.position.y, views[i].pose.position.z);
+    pose.position /= (float)viewCount;
+    // the eyes have the same orientation on current headsets
+    const XrQuaternionf& q = views[0].pose.orientation;
+    pose.orientation       = glm::quat(q.w, q.x, q.y, q.z);
+    gsRenderer.setXrHeadPose(displayTime * 1e-9, m_frameState.predictedDisplayPeriod * 1e-9, pose);
+}
+
 CameraConstants* OpenXREnv::GetCamera() {
     return &cameraConstants;
 }
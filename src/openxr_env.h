@@ -4,6 +4,10 @@
 #include <GraphicsAPI_Vulkan.h>
 #include <OpenXRDebugUtils.h>
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include <xr_linear_algebra.h>
 #include "Input.h"
 #include "gameMechanics/GameBehaviour.h"
@@ -15,9 +19,11 @@ class GaussianSplatting;
 struct RenderLayerInfo
 {
   XrTime                                        predictedDisplayTime = 0;
+  bool                                          frameBegun           = false;  // xrBeginFrame succeeded, xrEndFrame is due
   std::vector<XrCompositionLayerBaseHeader*>    layers;
   XrCompositionLayerProjection                  layerProjection = {XR_TYPE_COMPOSITION_LAYER_PROJECTION};
   std::vector<XrCompositionLayerProjectionView> layerProjectionViews;
+  std::vector<XrCompositionLayerDepthInfoKHR>   layerDepthInfos;  // chained to the projection views, empty without depth
 };
 struct CameraConstants
 {
@@ -50,13 +56,20 @@ public:
   XrResult CreateSwapchains();
 
   void Destroy();
+  // destroys the session and its swapchains, the instance is kept so that
+  // a new session can be created later on the same Vulkan device
+  void EndSession();
   XrResult DestroySwapchains();
   XrResult DestroyReferenceSpace();
   XrResult DestroySession();
   void DestroyDebugMessenger();
   XrResult DestroyInstance();
 
-  bool RenderLayer(RenderLayerInfo& renderLayerInfo, VkCommandBuffer cmd, std::shared_ptr<GaussianSplatting> gsRenderer);
+  // the second view is copied to the desktop viewport if mirror is set
+  bool RenderLayer(RenderLayerInfo& renderLayerInfo, VkCommandBuffer cmd, std::shared_ptr<GaussianSplatting> gsRenderer, bool mirror);
+  // locates the views again just before the submission of the recorded frame and patches
+  // the cameras of the renderer and the poses of the projection layer with the fresher poses
+  void LateLatchViews(RenderLayerInfo& renderLayerInfo, std::shared_ptr<GaussianSplatting> gsRenderer);
   void RenderFrame(RenderLayerInfo& renderLayerInfo);
   void SyncAction(std::vector<XrView>& views);
   bool BeginFrame(RenderLayerInfo& renderLayerInfo);
@@ -64,6 +77,12 @@ public:
 
   void PollEvents();
 
+  // Frame pipelining: a pacing thread calls xrWaitFrame for frame N+1 as soon as
+  // xrBeginFrame of frame N is done, so the wait overlaps the recording and the
+  // submission of frame N on the render thread. Runs while the session is running.
+  void StartFramePacing();
+  void StopFramePacing();
+
   bool SessionRunning() const;
   bool AppRunning() const;
 
@@ -71,6 +90,22 @@ public:
   VkImageView      GetXRImageView(int view);
   XrInstance       GetXrInstance() { return m_xrInstance; }
   XrSystemId       GetXrSystemId() { return m_systemID; }
+  // size of the depth swapchain images, zero if the runtime does not support depth layers
+  VkExtent2D GetDepthExtent() const
+  {
+    if(m_depthSwapchainInfos.empty())
+      return {0, 0};
+    return GetViewExtent();
+  }
+  // size of the views, the one of the first view (all views have the same size on current headsets)
+  VkExtent2D GetViewExtent() const
+  {
+    if(m_viewConfigurationViews.empty())
+      return {0, 0};
+    return {m_viewConfigurationViews[0].recommendedImageRectWidth, m_viewConfigurationViews[0].recommendedImageRectHeight};
+  }
+  // predicted display period of the current frame in ms, the frame budget of the frame governor
+  float GetDisplayPeriod() const { return m_frameState.predictedDisplayPeriod * 1e-6f; }
   bool             SupportUnorm()
   {
     return m_colorSwapchainInfos[0].swapchainFormat == VK_FORMAT_B8G8R8A8_UNORM
@@ -79,6 +114,14 @@ public:
   void InitController();
 
 private:
+  // fills the projection, view, position and viewport of the camera of a located view
+  void SetViewCamera(CameraConstants& camera, const XrView& view, uint32_t width, uint32_t height);
+  // gives the pose of the center of the eyes to the renderer, the CPU sort extrapolates it
+  void SetHeadPose(const std::vector<XrView>& views, uint32_t viewCount, XrTime displayTime, GaussianSplatting& gsRenderer);
+  // clip planes of the projection, also given to the runtime with the depth layer
+  const float m_nearZ = 0.09f;
+  const float m_farZ  = 2000.0f;
+
   XrInstance               m_xrInstance               = XR_NULL_HANDLE;
   std::vector<const char*> m_activeAPILayers          = {};
   std::vector<const char*> m_activeInstanceExtensions = {};
@@ -112,6 +155,10 @@ private:
   };
   std::vector<SwapchainInfo> m_colorSwapchainInfos = {};
   uint32_t                   colorImageIndex[2];
+  // XR_KHR_composition_layer_depth, D32 swapchains written by copy, empty if not supported
+  bool                       m_depthLayerSupported = false;
+  std::vector<SwapchainInfo> m_depthSwapchainInfos = {};
+  uint32_t                   depthImageIndex[2];
 
   std::vector<XrEnvironmentBlendMode> m_applicationEnvironmentBlendModes = {XR_ENVIRONMENT_BLEND_MODE_OPAQUE,
                                                                             XR_ENVIRONMENT_BLEND_MODE_ADDITIVE};
@@ -122,6 +169,17 @@ private:
   XrSpace m_localSpace = XR_NULL_HANDLE;
   XrFrameState m_frameState{XR_TYPE_FRAME_STATE};
 
+  // frame pacing, see StartFramePacing
+  std::thread             m_pacingThread;
+  std::mutex              m_pacingMutex;
+  std::condition_variable m_pacingCV;
+  bool                    m_pacingStop        = false;
+  bool                    m_pacingActive      = false;  // the thread may still provide frames
+  bool                    m_pacedFrameReady   = false;  // m_pacedFrameState waited, not begun yet
+  bool                    m_pacedFrameBegun   = true;   // the next xrWaitFrame may be called
+  XrResult                m_pacedFrameResult  = XR_SUCCESS;
+  XrFrameState            m_pacedFrameState{XR_TYPE_FRAME_STATE};
+
   // In STAGE space, viewHeightM should be 0. In LOCAL space, it should be offset downwards, below the viewer's initial position.
   float m_viewHeightM = 1.5f;
   CameraConstants cameraConstants;
@@ -0,0 +1,109 @@
+#include "pipeline_statistics.h"
+
+#include <nvvkhl/application.hpp>
+
+PipelineStatistics::Scope::Scope(PipelineStatistics* stats, VkCommandBuffer cmd, uint32_t query)
+    : m_stats(stats)
+    , m_cmd(cmd)
+    , m_query(query)
+{
+  vkCmdBeginQuery(m_cmd, m_stats->m_queryPool, m_query, 0);
+}
+
+PipelineStatistics::Scope::~Scope()
+{
+  if(m_stats)
+    vkCmdEndQuery(m_cmd, m_stats->m_queryPool, m_query);
+}
+
+void PipelineStatistics::init(nvvkhl::Application* app)
+{
+  m_device = app->getDevice();
+
+  VkPhysicalDeviceFeatures features;
+  vkGetPhysicalDeviceFeatures(app->getPhysicalDevice(), &features);
+  if(!features.pipelineStatisticsQuery)
+    return;
+
+  // one more slot than frames in flight, so a slot is always completed when reused
+  m_slotDraws.assign(app->getFrameCycleSize() + 1, 0);
+  m_currentSlot = 0;
+
+  // results are returned in the order of the flag bits
+  VkQueryPoolCreateInfo createInfo{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+  createInfo.queryType  = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+  createInfo.queryCount = (uint32_t)m_slotDraws.size() * MAX_DRAWS_PER_FRAME;
+  createInfo.pipelineStatistics =
+      VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT
+      | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+  if(vkCreateQueryPool(m_device, &createInfo, nullptr, &m_queryPool) != VK_SUCCESS)
+  {
+    m_queryPool = VK_NULL_HANDLE;
+    return;
+  }
+
+  // queries must be reset before their first use, next resets are done by endFrame
+  VkCommandBuffer cmd = app->createTempCmdBuffer();
+  vkCmdResetQueryPool(cmd, m_queryPool, 0, createInfo.queryCount);
+  app->submitAndWaitTempCmdBuffer(cmd);
+}
+
+void PipelineStatistics::deinit()
+{
+  if(m_queryPool != VK_NULL_HANDLE)
+    vkDestroyQueryPool(m_device, m_queryPool, nullptr);
+  m_queryPool = VK_NULL_HANDLE;
+  m_slotDraws.clear();
+  m_values = {};
+}
+
+PipelineStatistics::Scope PipelineStatistics::scope(VkCommandBuffer cmd)
+{
+  if(m_queryPool == VK_NULL_HANDLE || !m_enabled)
+    return {};
+
+  uint32_t& draws = m_slotDraws[m_currentSlot];
+  if(draws >= MAX_DRAWS_PER_FRAME)
+    return {};
+
+  return {this, cmd, m_currentSlot * MAX_DRAWS_PER_FRAME + draws++};
+}
+
+void PipelineStatistics::endFrame(VkCommandBuffer cmd)
+{
+  if(m_queryPool == VK_NULL_HANDLE)
+    return;
+
+  m_currentSlot = (m_currentSlot + 1) % (uint32_t)m_slotDraws.size();
+  // results of the frame that used the slot one cycle ago
+  collect(m_currentSlot);
+
+  vkCmdResetQueryPool(cmd, m_queryPool, m_currentSlot * MAX_DRAWS_PER_FRAME, MAX_DRAWS_PER_FRAME);
+}
+
+void PipelineStatistics::collect(uint32_t slotIndex)
+{
+  const uint32_t draws = m_slotDraws[slotIndex];
+  m_slotDraws[slotIndex] = 0;
+  if(draws == 0)
+    return;
+
+  uint64_t results[MAX_DRAWS_PER_FRAME * VALUES_PER_QUERY];
+  // no wait flag, the values of the previous frame are kept if not available
+  if(vkGetQueryPoolResults(m_device, m_queryPool, slotIndex * MAX_DRAWS_PER_FRAME, draws,
+                           draws * VALUES_PER_QUERY * sizeof(uint64_t), results, VALUES_PER_QUERY * sizeof(uint64_t),
+                           VK_QUERY_RESULT_64_BIT)
+     != VK_SUCCESS)
+    return;
+
+  m_values           = {};
+  m_values.drawCount = draws;
+  for(uint32_t i = 0; i < draws; ++i)
+  {
+    const uint64_t* values = results + i * VALUES_PER_QUERY;
+    m_values.vertexInvocations += values[0];
+    m_values.clippingInvocations += values[1];
+    m_values.clippingPrimitives += values[2];
+    m_values.fragmentInvocations += values[3];
+  }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+namespace nvvkhl {
+class Application;
+}
+
+// Pipeline statistics of the splat draws of one frame
+struct PipelineStatisticsValues
+{
+  uint64_t vertexInvocations   = 0;  // vertex shader invocations, zero with the mesh pipeline
+  uint64_t clippingInvocations = 0;  // primitives entering the clipping stage
+  uint64_t clippingPrimitives  = 0;  // primitives output by the clipping stage
+  uint64_t fragmentInvocations = 0;  // fragment shader invocations, including the discarded ones
+  uint32_t drawCount           = 0;  // number of instrumented draws (one per view)
+};
+
+// Pipeline statistics queries around the splat draws. The results of a frame are
+// read one frame cycle later, when its command buffer is known to be completed,
+// so the collection never stalls the CPU.
+// Mesh shader invocations would require the meshShaderQueries feature, which is kept
+// disabled on the device, with the mesh pipeline the clipping invocations give the
+// number of primitives emitted by the mesh shaders.
+class PipelineStatistics
+{
+public:
+  // Scoped query, inactive if the statistics are disabled or not supported
+  class Scope
+  {
+  public:
+    Scope() = default;
+    Scope(PipelineStatistics* stats, VkCommandBuffer cmd, uint32_t query);
+    ~Scope();
+
+    Scope(const Scope&)            = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    PipelineStatistics* m_stats = nullptr;
+    VkCommandBuffer     m_cmd   = VK_NULL_HANDLE;
+    uint32_t            m_query = 0;
+  };
+
+  void init(nvvkhl::Application* app);
+  void deinit();
+
+  bool isSupported() const { return m_queryPool != VK_NULL_HANDLE; }
+
+  // the statistics are collected only if enabled
+  bool m_enabled = false;
+
+  // starts a query ended by the destruction of the returned object,
+  // both must happen within the same rendering scope
+  Scope scope(VkCommandBuffer cmd);
+
+  // to be called once at the end of each frame, out of any rendering
+  void endFrame(VkCommandBuffer cmd);
+
+  // values of the last collected frame
+  const PipelineStatisticsValues& getValues() const { return m_values; }
+
+private:
+  void collect(uint32_t slotIndex);
+
+  static const uint32_t MAX_DRAWS_PER_FRAME = 4;
+  static const uint32_t VALUES_PER_QUERY    = 4;
+
+  VkDevice    m_device    = VK_NULL_HANDLE;
+  VkQueryPool m_queryPool = VK_NULL_HANDLE;
+
+  std::vector<uint32_t>    m_slotDraws;  // queries written in each slot
+  uint32_t                 m_currentSlot = 0;
+  PipelineStatisticsValues m_values;
+};
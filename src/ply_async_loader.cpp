@@ -18,6 +18,7 @@
  */
 
 //
+#include <algorithm>
 #include <fstream>
 #include <array>
 #include <chrono>
@@ -29,7 +30,7 @@
 
 //
 #include "ply_async_loader.h"
-#include "gaussian_splatting.h"
+#include "trace_recorder.h"
 
 bool PlyAsyncLoader::loadScene(std::string filename, SplatSet& output)
 {
@@ -41,12 +42,61 @@ bool PlyAsyncLoader::loadScene(std::string filename, SplatSet& output)
 
   // setup load info and wakeup the thread
   m_filename = filename;
+  m_generate = false;
   m_output   = &output;
   m_loadCV.notify_all();
 
   return true;
 }
 
+bool PlyAsyncLoader::generateScene(const SplatGeneratorSettings& settings, SplatSet& output)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if(m_status != E_READY)
+  {
+    return false;
+  }
+
+  // setup generation info and wakeup the thread
+  m_filename          = getSyntheticSceneName(settings);
+  m_generate          = true;
+  m_generatorSettings = settings;
+  m_output            = &output;
+  m_loadCV.notify_all();
+
+  return true;
+}
+
+bool PlyAsyncLoader::loadSceneSync(std::string filename, SplatSet& output)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_status != E_SHUTDOWN)
+    {
+      return false;
+    }
+    m_generate = false;
+  }
+  return innerLoad(filename, output);
+}
+
+bool PlyAsyncLoader::loadSync(const LoadSettings& settings, SplatSet& output)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_status != E_SHUTDOWN)
+    {
+      return false;
+    }
+    m_generate          = settings.generate;
+    m_generatorSettings = settings.generatorSettings;
+  }
+  m_gsMode        = settings.gsMode;
+  m_splatOrder    = settings.splatOrder;
+  m_pruneSettings = settings.pruneSettings;
+  return innerLoad(settings.filename, output);
+}
+
 bool PlyAsyncLoader::initialize()
 {
   // original state shall be shutdown
@@ -58,6 +108,7 @@ bool PlyAsyncLoader::initialize()
 
   // starts the thread
   m_loader = std::thread([this]() {
+    TraceRecorder::instance().setThreadName("Loader");
     //
     std::unique_lock<std::mutex> lock(m_mutex);
     m_status = E_READY;
@@ -134,15 +185,63 @@ bool PlyAsyncLoader::reset()
 }
 
 bool PlyAsyncLoader::innerLoad(std::string filename, SplatSet& output) {
-  switch(m_gsMode)
+  TRACE_SCOPE("Load scene");
+  bool loaded = false;
+  if(m_generate)
   {
-    case GSMode_3DGS:
-      return innerLoad_3DGS(filename, output);
-    case GSMode_SPACETIME_LITE:
-      return innerLoad_SpaceTime_Lite(filename, output);
-    default:
-      return false;
+    loaded = generateSplatSet(m_generatorSettings, m_gsMode, output, [this](float progress) { setProgress(progress); });
   }
+  else
+  {
+    switch(m_gsMode)
+    {
+      case GSMode_3DGS:
+        loaded = innerLoad_3DGS(filename, output);
+        break;
+      case GSMode_SPACETIME_LITE:
+        loaded = innerLoad_SpaceTime_Lite(filename, output);
+        break;
+      default:
+        break;
+    }
+  }
+  if(loaded && m_pruneSettings.enabled)
+  {
+    TRACE_SCOPE("Prune splats");
+    auto            startTime = std::chrono::high_resolution_clock::now();
+    SplatPruneStats stats;
+    pruneSplatSet(output, m_pruneSettings, stats);
+    auto      endTime   = std::chrono::high_resolution_clock::now();
+    long long pruneTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+    std::cout << "Pruned " << stats.prunedCount() << " of " << stats.inputCount << " splats (opacity "
+              << stats.prunedOpacity << ", size " << stats.prunedSize << ", distance " << stats.prunedDistance
+              << ", budget " << stats.prunedBudget << "), " << stats.bytesSaved / (1024 * 1024) << "MB saved in "
+              << pruneTime << "ms" << std::endl;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pruneStats = stats;
+  }
+  else
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pruneStats            = {};
+    m_pruneStats.inputCount = output.size();
+  }
+  if(loaded && m_splatOrder != SPLAT_ORDER_NONE)
+  {
+    TRACE_SCOPE("Reorder splats");
+    auto startTime = std::chrono::high_resolution_clock::now();
+    reorderSplatSet(output, (SplatOrder)m_splatOrder);
+    auto      endTime     = std::chrono::high_resolution_clock::now();
+    long long reorderTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+    std::cout << "Splats reordered along the " << (m_splatOrder == SPLAT_ORDER_HILBERT ? "Hilbert" : "Morton")
+              << " curve in " << reorderTime << "ms" << std::endl;
+  }
+  if(loaded)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastLoadSettings = {filename, m_generate, m_generatorSettings, m_gsMode, m_splatOrder, m_pruneSettings};
+  }
+  return loaded;
 }
 
 bool PlyAsyncLoader::innerLoad_3DGS(std::string filename, SplatSet& output)
@@ -181,17 +280,37 @@ bool PlyAsyncLoader::innerLoad_3DGS(std::string filename, SplatSet& output)
       uint32_t       loaded = 0;
 
       // put that first so the loading progress looks better
-      if(reader.find_properties(indices, 45, "f_rest_0", "f_rest_1", "f_rest_2", "f_rest_3", "f_rest_4", "f_rest_5",
-                                "f_rest_6", "f_rest_7", "f_rest_8", "f_rest_9", "f_rest_10", "f_rest_11", "f_rest_12",
-                                "f_rest_13", "f_rest_14", "f_rest_15", "f_rest_16", "f_rest_17", "f_rest_18",
-                                "f_rest_19", "f_rest_20", "f_rest_21", "f_rest_22", "f_rest_23", "f_rest_24",
-                                "f_rest_25", "f_rest_26", "f_rest_27", "f_rest_28", "f_rest_29", "f_rest_30", "f_rest_31",
-                                "f_rest_32", "f_rest_33", "f_rest_34", "f_rest_35", "f_rest_36", "f_rest_37", "f_rest_38",
-                                "f_rest_39", "f_rest_40", "f_rest_41", "f_rest_42", "f_rest_43", "f_rest_44"))
+      // files of a lower SH degree only store the bands they use (3, 8 or 15 coefficients per
+      // channel), they are expanded to 15 per channel and the missing bands are zero
+      for(uint32_t shDegree = 3; shDegree >= 1; --shDegree)
       {
-        reader.extract_properties(indices, 45, miniply::PLYPropertyType::Float, output.f_rest.data());
+        const uint32_t perChannel = (shDegree + 1) * (shDegree + 1) - 1;
+        bool           found      = true;
+        for(uint32_t i = 0; i < 3 * perChannel && found; ++i)
+        {
+          indices[i] = reader.find_property(("f_rest_" + std::to_string(i)).c_str());
+          found      = indices[i] != miniply::kInvalidIndex;
+        }
+        if(!found)
+          continue;
+        if(perChannel == 15)
+        {
+          reader.extract_properties(indices, 45, miniply::PLYPropertyType::Float, output.f_rest.data());
+        }
+        else
+        {
+          std::vector<float> rest(size_t(numVerts) * 3 * perChannel);
+          reader.extract_properties(indices, 3 * perChannel, miniply::PLYPropertyType::Float, rest.data());
+          std::fill(output.f_rest.begin(), output.f_rest.end(), 0.0f);
+          for(size_t splatIdx = 0; splatIdx < numVerts; ++splatIdx)
+          {
+            for(uint32_t rgb = 0; rgb < 3; ++rgb)
+              std::copy_n(&rest[(splatIdx * 3 + rgb) * perChannel], perChannel, &output.f_rest[splatIdx * 45 + 15 * rgb]);
+          }
+        }
         loaded += numVerts * 45;
         setProgress(float(loaded) / float(total));
+        break;
       }
       if(reader.find_properties(indices, 3, "x", "y", "z"))
       {
@@ -28,6 +28,9 @@
 //
 #include "splat_set.h"
 #include "gs_mode.h"
+#include "splat_generator.h"
+#include "splat_reorder.h"
+#include "splat_prune.h"
 //
 class PlyAsyncLoader
 {
@@ -42,6 +45,22 @@ public:
   };
 
   GSMode m_gsMode;
+  // spatial reordering of the splats once loaded or generated (SplatOrder), opt-in
+  uint32_t m_splatOrder = SPLAT_ORDER_NONE;
+  // pruning of the negligible splats once loaded or generated, before the reordering
+  SplatPruneSettings m_pruneSettings;
+
+  // everything that defines the content of a loaded splat set,
+  // loading twice with the same settings gives the same splat set
+  struct LoadSettings
+  {
+    std::string            filename;  // the ply pathname, or the synthetic scene name
+    bool                   generate = false;
+    SplatGeneratorSettings generatorSettings;
+    GSMode                 gsMode     = GSMode_3DGS;
+    uint32_t               splatOrder = SPLAT_ORDER_NONE;
+    SplatPruneSettings     pruneSettings;
+  };
 
 public:
   // starts the loader thread
@@ -60,6 +79,15 @@ public:
   // return false if loader not in idled state
   // output must not be accessed if status is not LOADED or READY (after reset)
   bool loadScene(std::string filename, SplatSet& output);
+  // triggers the generation of a synthetic scene, same workflow as loadScene
+  // return false if loader not in idled state
+  bool generateScene(const SplatGeneratorSettings& settings, SplatSet& output);
+  // loads in the calling thread, the loader thread must not be started
+  // (state is E_SHUTDOWN), used for benchmarking and command line tools
+  bool loadSceneSync(std::string filename, SplatSet& output);
+  // loads or generates in the calling thread using settings instead of the loader attributes,
+  // the loader thread must not be started. Used to reload a splat set.
+  bool loadSync(const LoadSettings& settings, SplatSet& output);
   // cancel scene loading if possible
   // non blocking, may have no effect
   void cancel();
@@ -85,6 +113,18 @@ public:
     std::lock_guard<std::mutex> lock(m_mutex);
     return m_progress;
   }
+  // settings of the last successful load
+  [[nodiscard]] inline LoadSettings getLastLoadSettings()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastLoadSettings;
+  }
+  // statistics of the pruning of the last loaded model
+  [[nodiscard]] inline SplatPruneStats getPruneStats()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pruneStats;
+  }
 
 private:
   // actually loads the scene
@@ -113,12 +153,18 @@ private:
   // loader wakeup condition
   mutable std::condition_variable m_loadCV;
 
-  // the ply pathname
+  // the ply pathname, or the synthetic scene name
   std::string m_filename = "";
+  // generate a synthetic scene instead of loading m_filename
+  bool                   m_generate = false;
+  SplatGeneratorSettings m_generatorSettings;
   // the output data storage
   SplatSet* m_output = nullptr;
   // the loading percentage
   float m_progress = 0.0f;
+  // result of the pruning of the last load
+  SplatPruneStats m_pruneStats;
+  LoadSettings    m_lastLoadSettings;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "pose_predictor.h"
+
+#include <algorithm>
+#include <cmath>
+
+void PosePredictor::addSample(double time, const Pose& pose)
+{
+  if(m_count > 0)
+  {
+    Sample& last = m_samples[(m_first + m_count - 1) % MAX_SAMPLES];
+    if(time == last.time)
+    {
+      last.pose = pose;
+      return;
+    }
+    // the time went backward, a new session
+    if(time < last.time)
+      reset();
+  }
+  if(m_count < MAX_SAMPLES)
+  {
+    m_samples[(m_first + m_count) % MAX_SAMPLES] = {time, pose};
+    m_count++;
+  }
+  else
+  {
+    m_samples[m_first] = {time, pose};
+    m_first            = (m_first + 1) % MAX_SAMPLES;
+  }
+}
+
+PosePredictor::Pose PosePredictor::predict(double time, double maxHorizon) const
+{
+  if(m_count == 0)
+    return {};
+  const Sample& newest = sample(m_count - 1);
+  const Sample& oldest = sample(0);
+  const double  window = newest.time - oldest.time;
+  // the velocities are not measurable below a millisecond
+  if(m_count < 2 || window < 1e-3)
+    return newest.pose;
+
+  const float horizon = (float)std::clamp(time - newest.time, 0.0, maxHorizon);
+
+  Pose result;
+  // linear velocity over the window
+  const glm::vec3 velocity = (newest.pose.position - oldest.pose.position) / (float)window;
+  result.position          = newest.pose.position + velocity * horizon;
+
+  // angular velocity over the window, the rotation from the oldest to the newest on the shortest path
+  glm::quat delta = newest.pose.orientation * glm::inverse(oldest.pose.orientation);
+  if(delta.w < 0.0f)
+    delta = -delta;
+  const float angle = glm::angle(delta);
+  if(angle < 1e-6f)
+  {
+    result.orientation = newest.pose.orientation;
+    return result;
+  }
+  const float rate   = angle / (float)window;
+  result.orientation = glm::normalize(glm::angleAxis(rate * horizon, glm::axis(delta)) * newest.pose.orientation);
+  return result;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include <glm/vec3.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Extrapolation of a rigid pose, the headset, from its last few samples. The linear and the
+// angular velocities are assumed constant over the window of samples. Used to sort the splats
+// on the CPU for the pose expected when the result of the sort is displayed, frames later.
+class PosePredictor
+{
+public:
+  struct Pose
+  {
+    glm::vec3 position{0.0f};
+    glm::quat orientation{1.0f, 0.0f, 0.0f, 0.0f};
+  };
+
+  void reset() { m_count = 0; }
+  // time in seconds, increasing. A sample at the time of the last one replaces it
+  // (the views located again for the same display time are more accurate)
+  void addSample(double time, const Pose& pose);
+  bool isValid() const { return m_count > 0; }
+  // pose at the given time, extrapolated over at most maxHorizon seconds after the last sample
+  Pose predict(double time, double maxHorizon) const;
+
+private:
+  static const size_t MAX_SAMPLES = 4;
+  struct Sample
+  {
+    double time = 0.0;
+    Pose   pose;
+  };
+  const Sample& sample(size_t i) const { return m_samples[(m_first + i) % MAX_SAMPLES]; }
+
+  std::array<Sample, MAX_SAMPLES> m_samples{};  // ring of the last samples, the oldest at m_first
+  size_t                          m_first = 0;
+  size_t                          m_count = 0;
+};
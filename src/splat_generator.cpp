@@ -0,0 +1,396 @@
+#include "splat_generator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <nvh/parametertools.hpp>
+
+#include "utilities.h"
+
+// zero order SH basis constant, converts an rgb color to f_dc
+static const float SH_C0 = 0.28209479177387814f;
+
+// Small counter based random generator (splitmix64).
+// Each splat seeds its own instance from (seed, splatIdx) so that
+// the output does not depend on how the loop is split among threads.
+struct SplatRandom
+{
+  uint64_t state;
+
+  SplatRandom(uint32_t seed, uint64_t stream)
+      : state((uint64_t(seed) << 32) ^ (stream * 0x9E3779B97F4A7C15ull))
+  {
+  }
+
+  uint64_t next()
+  {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z          = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+  // in [0,1)
+  float uniform() { return float(next() >> 40) * (1.0f / 16777216.0f); }
+  float uniform(float a, float b) { return a + (b - a) * uniform(); }
+  float normal()
+  {
+    const float u1 = std::max(uniform(), 1e-7f);
+    const float u2 = uniform();
+    return std::sqrt(-2.0f * std::log(u1)) * std::cos(6.28318530718f * u2);
+  }
+  // uniformly distributed unit quaternion
+  glm::quat rotation() { return glm::normalize(glm::quat(normal(), normal(), normal(), normal())); }
+};
+
+// building of the clustered city distribution
+struct SplatBuilding
+{
+  glm::vec3 center;    // center of the footprint on the ground
+  glm::vec3 halfSize;  // half width, height, half depth
+  glm::vec3 color;
+};
+
+// smooth color field so that the scenes are not pure noise
+static glm::vec3 colorAt(const glm::vec3& p, float extent)
+{
+  const glm::vec3 q = p * (3.0f / std::max(extent, 1e-3f));
+  return glm::vec3(0.5f) + 0.4f * glm::vec3(std::sin(q.x + 0.3f), std::sin(q.y * 1.3f + 2.1f), std::sin(q.z * 0.7f + 4.2f));
+}
+
+static glm::vec3 samplePosition(const SplatGeneratorSettings& settings, const std::vector<SplatBuilding>& buildings, SplatRandom& rnd, glm::vec3& color)
+{
+  const float extent = settings.extent;
+  glm::vec3   p;
+
+  switch(settings.distribution)
+  {
+    case SPLAT_DISTRIBUTION_SURFACE_SHELL: {
+      const glm::vec3 dir    = glm::normalize(glm::vec3(rnd.normal(), rnd.normal(), rnd.normal()) + glm::vec3(1e-6f));
+      const float     radius = extent * (0.8f + 0.02f * rnd.normal());
+      p                      = dir * radius;
+      color                  = colorAt(p, extent);
+    }
+    break;
+    case SPLAT_DISTRIBUTION_CLUSTERED_CITY: {
+      // one fifth of the splats on the ground, the others on the buildings walls and roofs
+      if(buildings.empty() || rnd.uniform() < 0.2f)
+      {
+        p     = glm::vec3(rnd.uniform(-extent, extent), 0.0f, rnd.uniform(-extent, extent));
+        color = glm::vec3(0.35f) + 0.1f * colorAt(p, extent);
+        break;
+      }
+      const SplatBuilding& b    = buildings[std::min(size_t(rnd.uniform() * buildings.size()), buildings.size() - 1)];
+      const uint32_t       face = std::min(uint32_t(rnd.uniform() * 5.0f), 4u);  // 4 walls and the roof
+      const float          u    = rnd.uniform(-1.0f, 1.0f);
+      const float          v    = rnd.uniform(0.0f, 1.0f);
+      switch(face)
+      {
+        case 0:
+          p = b.center + glm::vec3(b.halfSize.x, v * b.halfSize.y, u * b.halfSize.z);
+          break;
+        case 1:
+          p = b.center + glm::vec3(-b.halfSize.x, v * b.halfSize.y, u * b.halfSize.z);
+          break;
+        case 2:
+          p = b.center + glm::vec3(u * b.halfSize.x, v * b.halfSize.y, b.halfSize.z);
+          break;
+        case 3:
+          p = b.center + glm::vec3(u * b.halfSize.x, v * b.halfSize.y, -b.halfSize.z);
+          break;
+        default:
+          p = b.center + glm::vec3(u * b.halfSize.x, b.halfSize.y, rnd.uniform(-1.0f, 1.0f) * b.halfSize.z);
+      }
+      color = b.color * (0.85f + 0.15f * rnd.uniform());
+    }
+    break;
+    default: {
+      p     = glm::vec3(rnd.uniform(-extent, extent), rnd.uniform(-extent, extent), rnd.uniform(-extent, extent));
+      color = colorAt(p, extent);
+    }
+  }
+  return p;
+}
+
+bool parseGeneratorArguments(int argc, char** argv, SplatGeneratorSettings& settings)
+{
+  uint32_t splatCount = 0;
+
+  nvh::ParameterList parameters;
+  parameters.add("generate|generates a synthetic scene with the given number of splats instead of loading a ply file", &splatCount);
+  parameters.add("generateDistribution|0=uniform box 1=surface shell 2=clustered city", &settings.distribution);
+  parameters.add("generateSeed|seed of the synthetic scene", &settings.seed);
+  parameters.add("generateExtent|half size of the synthetic scene", &settings.extent);
+  parameters.add("generateClusters|number of buildings of the clustered city", &settings.clusterCount);
+  parameters.add("generateScale|min and max splat size in world units", settings.scaleRange, nullptr, 2);
+  parameters.add("generateAnisotropy|max ratio between the largest and smallest splat axis", &settings.anisotropy);
+  parameters.add("generateOpacity|min and max splat opacity", settings.opacityRange, nullptr, 2);
+  parameters.add("generateShDegree|SH degree of the synthetic scene in [0,3]", &settings.shDegree);
+  parameters.add("generateMotion|spacetime max displacement of a splat over one time unit", &settings.motionAmplitude);
+  parameters.add("generateOutput|writes the synthetic scene to the given ply file and exits", &settings.outputFilename);
+  parameters.add("generateOutputGsMode|gaussian mode of the written ply file, 0=3dgs 1=spacetime-lite", &settings.outputGsMode);
+
+  // skip executable name
+  parameters.applyTokens((uint32_t)argc - 1, (const char**)argv + 1, "-", ".");
+
+  if(splatCount == 0)
+    return true;
+
+  if(settings.distribution > SPLAT_DISTRIBUTION_CLUSTERED_CITY)
+  {
+    std::cerr << "Error: invalid synthetic scene distribution " << settings.distribution << std::endl;
+    return false;
+  }
+
+  settings.enabled    = true;
+  settings.splatCount = std::clamp(splatCount, SPLAT_GENERATOR_MIN_COUNT, SPLAT_GENERATOR_MAX_COUNT);
+  settings.shDegree   = std::min(settings.shDegree, 3u);
+  return true;
+}
+
+bool generateSplatSet(const SplatGeneratorSettings& settings, GSMode gsMode, SplatSet& output, std::function<void(float)> progress)
+{
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  const uint32_t splatCount = std::clamp(settings.splatCount, SPLAT_GENERATOR_MIN_COUNT, SPLAT_GENERATOR_MAX_COUNT);
+  const uint32_t restCount  = gsMode == GSMode_3DGS ? 45 : 15;
+  const uint32_t shDegree   = std::min(settings.shDegree, 3u);
+  // number of SH coefficients per color channel for degrees 1 to shDegree
+  const uint32_t shCoeffs = (shDegree + 1) * (shDegree + 1) - 1;
+
+  if(settings.splatCount != splatCount)
+  {
+    std::cout << "Warning: synthetic splat count clamped to " << splatCount << std::endl;
+  }
+
+  output.positions.resize(size_t(splatCount) * 3);
+  output.scale.resize(size_t(splatCount) * 3);
+  output.rotation.resize(size_t(splatCount) * 4);
+  output.opacity.resize(splatCount);
+  output.f_dc.resize(size_t(splatCount) * 3);
+  output.f_rest.assign(size_t(splatCount) * restCount, 0.0f);
+
+  // buildings are shared by all the splats, generated from a dedicated stream
+  std::vector<SplatBuilding> buildings;
+  if(settings.distribution == SPLAT_DISTRIBUTION_CLUSTERED_CITY)
+  {
+    SplatRandom rnd(settings.seed, ~0ull);
+    buildings.resize(std::max(settings.clusterCount, 1u));
+    for(auto& b : buildings)
+    {
+      const float extent = settings.extent;
+      b.halfSize         = glm::vec3(rnd.uniform(0.03f, 0.12f), rnd.uniform(0.1f, 0.8f), rnd.uniform(0.03f, 0.12f)) * extent;
+      b.center           = glm::vec3(rnd.uniform(-extent + b.halfSize.x, extent - b.halfSize.x), 0.0f,
+                                     rnd.uniform(-extent + b.halfSize.z, extent - b.halfSize.z));
+      b.color            = glm::vec3(rnd.uniform(0.3f, 0.9f), rnd.uniform(0.3f, 0.9f), rnd.uniform(0.3f, 0.9f));
+    }
+  }
+
+  const float logScaleMin   = std::log(std::max(std::min(settings.scaleRange[0], settings.scaleRange[1]), 1e-6f));
+  const float logScaleMax   = std::log(std::max(std::max(settings.scaleRange[0], settings.scaleRange[1]), 1e-6f));
+  const float logAnisotropy = 0.5f * std::log(std::max(settings.anisotropy, 1.0f));
+  const float opacityMin    = std::clamp(std::min(settings.opacityRange[0], settings.opacityRange[1]), 0.001f, 0.999f);
+  const float opacityMax    = std::clamp(std::max(settings.opacityRange[0], settings.opacityRange[1]), 0.001f, 0.999f);
+  const float trbfMin       = std::max(std::min(settings.trbfScaleRange[0], settings.trbfScaleRange[1]), 1e-3f);
+  const float trbfMax       = std::max(std::max(settings.trbfScaleRange[0], settings.trbfScaleRange[1]), 1e-3f);
+
+  // generates by slices to report progress
+  const uint32_t sliceSize = std::max(splatCount / 32u, 65536u);
+  for(uint32_t sliceStart = 0; sliceStart < splatCount; sliceStart += sliceSize)
+  {
+    const uint32_t sliceCount = std::min(sliceSize, splatCount - sliceStart);
+
+    START_PAR_LOOP(sliceCount, sliceIdx)
+    {
+      const size_t splatIdx = size_t(sliceStart) + sliceIdx;
+      SplatRandom  rnd(settings.seed, splatIdx);
+
+      glm::vec3       color;
+      const glm::vec3 position = samplePosition(settings, buildings, rnd, color);
+      output.positions[splatIdx * 3 + 0] = position.x;
+      output.positions[splatIdx * 3 + 1] = position.y;
+      output.positions[splatIdx * 3 + 2] = position.z;
+
+      // log scales around a log-uniform mean axis length
+      const float logScale = rnd.uniform(logScaleMin, logScaleMax);
+      for(uint32_t i = 0; i < 3; ++i)
+        output.scale[splatIdx * 3 + i] = logScale + rnd.uniform(-logAnisotropy, logAnisotropy);
+
+      // 3DGS stores w first, spacetime stores w last
+      const glm::quat q = rnd.rotation();
+      if(gsMode == GSMode_3DGS)
+      {
+        output.rotation[splatIdx * 4 + 0] = q.w;
+        output.rotation[splatIdx * 4 + 1] = q.x;
+        output.rotation[splatIdx * 4 + 2] = q.y;
+        output.rotation[splatIdx * 4 + 3] = q.z;
+      }
+      else
+      {
+        output.rotation[splatIdx * 4 + 0] = q.x;
+        output.rotation[splatIdx * 4 + 1] = q.y;
+        output.rotation[splatIdx * 4 + 2] = q.z;
+        output.rotation[splatIdx * 4 + 3] = q.w;
+      }
+
+      // logit of the opacity
+      const float alpha             = rnd.uniform(opacityMin, opacityMax);
+      output.opacity[splatIdx]      = std::log(alpha / (1.0f - alpha));
+      // 3DGS stores the SH band 0, spacetime stores the linear color
+      const glm::vec3 baseColor = glm::clamp(color, 0.0f, 1.0f);
+      for(uint32_t i = 0; i < 3; ++i)
+        output.f_dc[splatIdx * 3 + i] = gsMode == GSMode_3DGS ? (baseColor[i] - 0.5f) / SH_C0 : baseColor[i];
+
+      float* rest = &output.f_rest[splatIdx * restCount];
+      if(gsMode == GSMode_3DGS)
+      {
+        // channel major layout, 15 coefficients per channel, amplitude decreasing with the band
+        for(uint32_t channel = 0; channel < 3; ++channel)
+        {
+          for(uint32_t coeff = 0; coeff < shCoeffs; ++coeff)
+          {
+            const float band            = std::floor(std::sqrt(float(coeff + 1)));
+            rest[channel * 15 + coeff] = rnd.uniform(-1.0f, 1.0f) * settings.shAmplitude / band;
+          }
+        }
+      }
+      else
+      {
+        // motion9 (linear, quadratic, cubic), omega4, trbf center, trbf scale
+        for(uint32_t i = 0; i < 9; ++i)
+          rest[i] = rnd.uniform(-1.0f, 1.0f) * settings.motionAmplitude / float(1 << (i / 3));
+        for(uint32_t i = 9; i < 13; ++i)
+          rest[i] = rnd.uniform(-1.0f, 1.0f) * settings.rotationSpeed;
+        rest[13] = rnd.uniform();
+        rest[14] = std::log(rnd.uniform(trbfMin, trbfMax));
+      }
+    }
+    END_PAR_LOOP()
+
+    if(progress)
+      progress(float(sliceStart + sliceCount) / float(splatCount));
+  }
+
+  auto      endTime = std::chrono::high_resolution_clock::now();
+  long long genTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+  std::cout << "Synthetic scene " << getSyntheticSceneName(settings) << " generated in " << genTime << "ms" << std::endl;
+
+  return true;
+}
+
+bool writeSplatSetPly(const std::string& filename, const SplatSet& splatSet, GSMode gsMode, uint32_t shDegree)
+{
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  const size_t splatCount = splatSet.size();
+  if(splatCount == 0)
+  {
+    std::cout << "Error: no splat to write" << std::endl;
+    return false;
+  }
+
+  // property names in the order of the SplatSet storage, as expected by the loader.
+  // the SH coefficients are stored per channel, 15 per channel in the splat set and
+  // only the ones of the bands up to shDegree in the file
+  std::vector<std::string> restNames;
+  std::vector<std::string> rotationNames;
+  size_t                   storedRestCount = 15;
+  uint32_t                 shPerChannel    = 0;
+  if(gsMode == GSMode_3DGS)
+  {
+    storedRestCount = 45;
+    shDegree        = std::min(shDegree, 3u);
+    shPerChannel    = (shDegree + 1) * (shDegree + 1) - 1;
+    for(uint32_t i = 0; i < 3 * shPerChannel; ++i)
+      restNames.push_back("f_rest_" + std::to_string(i));
+    rotationNames = {"rot_0", "rot_1", "rot_2", "rot_3"};
+  }
+  else
+  {
+    for(uint32_t i = 0; i < 9; ++i)
+      restNames.push_back("motion_" + std::to_string(i));
+    restNames.insert(restNames.end(), {"omega_1", "omega_2", "omega_3", "omega_0", "trbf_center", "trbf_scale"});
+    rotationNames = {"rot_1", "rot_2", "rot_3", "rot_0"};
+  }
+  const size_t restCount = restNames.size();
+  if(splatSet.f_rest.size() != splatCount * storedRestCount)
+  {
+    std::cout << "Error: splat set does not match the selected gaussian mode" << std::endl;
+    return false;
+  }
+
+  std::ofstream file(filename, std::ios::binary);
+  if(!file.is_open())
+  {
+    std::cout << "Error: cannot open file for writing: " << filename << std::endl;
+    return false;
+  }
+
+  file << "ply\nformat binary_little_endian 1.0\n";
+  file << "element vertex " << splatCount << "\n";
+  for(const char* name : {"x", "y", "z", "f_dc_0", "f_dc_1", "f_dc_2"})
+    file << "property float " << name << "\n";
+  for(const auto& name : restNames)
+    file << "property float " << name << "\n";
+  for(const char* name : {"opacity", "scale_0", "scale_1", "scale_2"})
+    file << "property float " << name << "\n";
+  for(const auto& name : rotationNames)
+    file << "property float " << name << "\n";
+  file << "end_header\n";
+
+  // rows are interleaved, written by batches to bound the temporary memory
+  const size_t       rowSize   = 3 + 3 + restCount + 1 + 3 + 4;
+  const size_t       batchSize = 65536;
+  std::vector<float> batch(batchSize * rowSize);
+  for(size_t start = 0; start < splatCount; start += batchSize)
+  {
+    const size_t count = std::min(batchSize, splatCount - start);
+    float*       row   = batch.data();
+    for(size_t splatIdx = start; splatIdx < start + count; ++splatIdx)
+    {
+      row = std::copy_n(&splatSet.positions[splatIdx * 3], 3, row);
+      row = std::copy_n(&splatSet.f_dc[splatIdx * 3], 3, row);
+      if(gsMode == GSMode_3DGS)
+      {
+        for(uint32_t rgb = 0; rgb < 3; ++rgb)
+          row = std::copy_n(&splatSet.f_rest[splatIdx * storedRestCount + 15 * rgb], shPerChannel, row);
+      }
+      else
+      {
+        row = std::copy_n(&splatSet.f_rest[splatIdx * storedRestCount], restCount, row);
+      }
+      row = std::copy_n(&splatSet.opacity[splatIdx], 1, row);
+      row = std::copy_n(&splatSet.scale[splatIdx * 3], 3, row);
+      row = std::copy_n(&splatSet.rotation[splatIdx * 4], 4, row);
+    }
+    file.write(reinterpret_cast<const char*>(batch.data()), count * rowSize * sizeof(float));
+  }
+
+  if(!file.good())
+  {
+    std::cout << "Error: failed to write file: " << filename << std::endl;
+    return false;
+  }
+
+  auto      endTime   = std::chrono::high_resolution_clock::now();
+  long long writeTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+  std::cout << "File " << filename << " written in " << writeTime << "ms" << std::endl;
+
+  return true;
+}
+
+std::string getSyntheticSceneName(const SplatGeneratorSettings& settings)
+{
+  static const char* distributionNames[] = {"box", "shell", "city"};
+
+  std::stringstream name;
+  name << "synthetic:" << distributionNames[std::min(settings.distribution, 2u)] << ":" << settings.splatCount << ":seed"
+       << settings.seed;
+  return name.str();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "splat_set.h"
+#include "gs_mode.h"
+
+// bounds of the generated splat count
+static const uint32_t SPLAT_GENERATOR_MIN_COUNT = 1000;
+static const uint32_t SPLAT_GENERATOR_MAX_COUNT = 50000000;
+
+// spatial distribution of the generated splats
+enum SplatDistribution
+{
+  SPLAT_DISTRIBUTION_UNIFORM_BOX,     // uniform in a cube
+  SPLAT_DISTRIBUTION_SURFACE_SHELL,   // thin shell around a sphere, close to object captures
+  SPLAT_DISTRIBUTION_CLUSTERED_CITY,  // ground plane and box shaped buildings, close to large scale captures
+};
+
+// Parameters of the synthetic scene generator.
+// The generated set only depends on these parameters and on the gaussian mode,
+// not on the number of threads, so scaling measures are reproducible on any machine.
+struct SplatGeneratorSettings
+{
+  bool        enabled = false;  // set by the -generate command line option
+  std::string outputFilename;   // if not empty the generated set is written to this ply file
+  uint32_t    outputGsMode = GSMode_3DGS;  // gaussian mode of the written ply file
+
+  uint32_t splatCount   = 1000000;  // in [1K, 50M]
+  uint32_t seed         = 1;
+  uint32_t distribution = SPLAT_DISTRIBUTION_UNIFORM_BOX;
+  float    extent       = 5.0f;  // half size of the scene bounding box
+  uint32_t clusterCount = 64;    // number of buildings for the clustered distribution
+  // splat size in world units, log-uniform distribution of the mean axis length
+  float scaleRange[2] = {0.005f, 0.05f};
+  // max ratio between the largest and the smallest axis of a splat
+  float anisotropy = 4.0f;
+  // uniform distribution of the splat opacity (after activation)
+  float opacityRange[2] = {0.2f, 1.0f};
+  // 3DGS only, SH coefficients above this degree are set to zero
+  uint32_t shDegree    = 3;
+  float    shAmplitude = 0.2f;
+  // spacetime only, max displacement of a splat and angular speed over one time unit
+  float motionAmplitude = 0.5f;
+  float rotationSpeed   = 0.5f;
+  // spacetime only, uniform distribution of the temporal radial basis function scale
+  float trbfScaleRange[2] = {0.2f, 1.0f};
+};
+
+// parses the -generate* command line arguments, returns false on error.
+// settings.enabled is set if a scene generation was requested.
+bool parseGeneratorArguments(int argc, char** argv, SplatGeneratorSettings& settings);
+
+// generates the splat set in the same representation as the ply loader (log scales, logit opacities)
+// progress, if provided, is called with values in [0,1]
+bool generateSplatSet(const SplatGeneratorSettings& settings, GSMode gsMode, SplatSet& output, std::function<void(float)> progress = nullptr);
+
+// writes the splat set as a binary ply file readable by the loader in the same gaussian mode.
+// 3DGS only, the f_rest properties of the SH bands above shDegree are not written
+bool writeSplatSetPly(const std::string& filename, const SplatSet& splatSet, GSMode gsMode, uint32_t shDegree = 3);
+
+// name used in place of a filename for generated scenes, e.g. "synthetic:city:1000000:seed1"
+std::string getSyntheticSceneName(const SplatGeneratorSettings& settings);
+inline bool isSyntheticSceneName(const std::string& name)
+{
+  return name.rfind("synthetic:", 0) == 0;
+}
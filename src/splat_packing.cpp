@@ -0,0 +1,318 @@
+#include "splat_packing.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+void packCenters(const SplatSet& splatSet, float* dst, uint32_t dstStride, uint32_t first, uint32_t count)
+{
+  const uint32_t packCount = getPackCount(splatSet, first, count);
+  if(packCount == 0)
+    return;
+
+  const float* src = splatSet.positions.data() + (size_t)first * 3;
+  if(dstStride == 3)
+  {
+    std::copy(src, src + (size_t)packCount * 3, dst);
+    return;
+  }
+
+  START_PAR_LOOP(packCount, splatIdx)
+  {
+    // extra channels are left untouched, not used in the shaders
+    for(uint32_t cmp = 0; cmp < 3; ++cmp)
+    {
+      dst[splatIdx * dstStride + cmp] = src[splatIdx * 3 + cmp];
+    }
+  }
+  END_PAR_LOOP()
+}
+
+void packCovariances_3DGS(const SplatSet& splatSet, float* dst, uint32_t first, uint32_t count)
+{
+  const uint32_t packCount = getPackCount(splatSet, first, count);
+
+  START_PAR_LOOP(packCount, splatIdx)
+  {
+    const auto stride3 = (size_t)(first + splatIdx) * 3;
+    const auto stride4 = (size_t)(first + splatIdx) * 4;
+    const auto stride6 = splatIdx * 6;
+    glm::vec3  scale{std::exp(splatSet.scale[stride3 + 0]), std::exp(splatSet.scale[stride3 + 1]),
+                    std::exp(splatSet.scale[stride3 + 2])};
+
+    glm::quat rotation{splatSet.rotation[stride4 + 0], splatSet.rotation[stride4 + 1], splatSet.rotation[stride4 + 2],
+                       splatSet.rotation[stride4 + 3]};
+    rotation = glm::normalize(rotation);
+
+    // computes the covariance
+    const glm::mat3 scaleMatrix           = glm::mat3(scale.x, 0.0f, 0.0f, 0.0f, scale.y, 0.0f, 0.0f, 0.0f, scale.z);
+    const glm::mat3 rotationMatrix        = glm::mat3_cast(rotation);  // where rotation is a quaternion
+    const glm::mat3 covarianceMatrix      = rotationMatrix * scaleMatrix;
+    glm::mat3       transformedCovariance = covarianceMatrix * glm::transpose(covarianceMatrix);
+
+    dst[stride6 + 0] = glm::value_ptr(transformedCovariance)[0];
+    dst[stride6 + 1] = glm::value_ptr(transformedCovariance)[3];
+    dst[stride6 + 2] = glm::value_ptr(transformedCovariance)[6];
+
+    dst[stride6 + 3] = glm::value_ptr(transformedCovariance)[4];
+    dst[stride6 + 4] = glm::value_ptr(transformedCovariance)[7];
+    dst[stride6 + 5] = glm::value_ptr(transformedCovariance)[8];
+  }
+  END_PAR_LOOP()
+}
+
+void packColors_3DGS(const SplatSet& splatSet, float* dst, uint32_t first, uint32_t count)
+{
+  const uint32_t packCount = getPackCount(splatSet, first, count);
+
+  START_PAR_LOOP(packCount, splatIdx)
+  {
+    const auto  srcIdx  = (size_t)first + splatIdx;
+    const auto  stride3 = srcIdx * 3;
+    const auto  stride4 = splatIdx * 4;
+    const float SH_C0   = 0.28209479177387814f;
+    dst[stride4 + 0]    = glm::clamp(0.5f + SH_C0 * splatSet.f_dc[stride3 + 0], 0.0f, 1.0f);
+    dst[stride4 + 1]    = glm::clamp(0.5f + SH_C0 * splatSet.f_dc[stride3 + 1], 0.0f, 1.0f);
+    dst[stride4 + 2]    = glm::clamp(0.5f + SH_C0 * splatSet.f_dc[stride3 + 2], 0.0f, 1.0f);
+    dst[stride4 + 3]    = glm::clamp(1.0f / (1.0f + std::exp(-splatSet.opacity[srcIdx])), 0.0f, 1.0f);
+  }
+  END_PAR_LOOP()
+}
+
+void packColorsUnorm_3DGS(const SplatSet& splatSet, uint8_t* dst, uint32_t first, uint32_t count)
+{
+  const uint32_t packCount = getPackCount(splatSet, first, count);
+
+  START_PAR_LOOP(packCount, splatIdx)
+  {
+    const auto  srcIdx  = (size_t)first + splatIdx;
+    const auto  stride3 = srcIdx * 3;
+    const auto  stride4 = splatIdx * 4;
+    const float SH_C0   = 0.28209479177387814f;
+    dst[stride4 + 0]    = (uint8_t)glm::clamp(std::floor((0.5f + SH_C0 * splatSet.f_dc[stride3 + 0]) * 255), 0.0f, 255.0f);
+    dst[stride4 + 1]    = (uint8_t)glm::clamp(std::floor((0.5f + SH_C0 * splatSet.f_dc[stride3 + 1]) * 255), 0.0f, 255.0f);
+    dst[stride4 + 2]    = (uint8_t)glm::clamp(std::floor((0.5f + SH_C0 * splatSet.f_dc[stride3 + 2]) * 255), 0.0f, 255.0f);
+    dst[stride4 + 3] =
+        (uint8_t)glm::clamp(std::floor((1.0f / (1.0f + std::exp(-splatSet.opacity[srcIdx]))) * 255), 0.0f, 255.0f);
+  }
+  END_PAR_LOOP()
+}
+
+uint32_t getShDegree_3DGS(const SplatSet& splatSet)
+{
+  const auto splatCount = splatSet.size();
+  if(splatCount == 0)
+    return 0;
+
+  const auto coefficientsPerChannel = splatSet.f_rest.size() / splatCount / 3;
+  if(coefficientsPerChannel >= 15)
+    return 3;
+  if(coefficientsPerChannel >= 8)
+    return 2;
+  if(coefficientsPerChannel >= 3)
+    return 1;
+  return 0;
+}
+
+void packSphericalHarmonics_3DGS(const SplatSet& splatSet,
+                                 uint32_t        format,
+                                 void*           dst,
+                                 uint32_t        dstStride,
+                                 uint32_t        maxShDegree,
+                                 uint32_t        first,
+                                 uint32_t        count)
+{
+  const auto     splatCount = (uint32_t)splatSet.size();
+  const uint32_t packCount  = getPackCount(splatSet, first, count);
+  if(packCount == 0)
+    return;
+
+  const uint32_t srcStride              = (uint32_t)(splatSet.f_rest.size() / splatCount);
+  const uint32_t coefficientsPerChannel = srcStride / 3;
+  const uint32_t shDegree               = std::min(getShDegree_3DGS(splatSet), maxShDegree);
+  const float*   src                    = splatSet.f_rest.data();
+
+  START_PAR_LOOP(packCount, splatIdx)
+  {
+    const auto srcBase   = srcStride * (first + splatIdx);
+    const auto destBase  = dstStride * splatIdx;
+    int        dstOffset = 0;
+    // degree d has 2d+1 coefs per component, starting after the d*d-1 coefs of lower degrees
+    for(uint32_t degree = 1; degree <= shDegree; degree++)
+    {
+      const uint32_t firstCoef = degree * degree - 1;
+      for(uint32_t i = 0; i < 2 * degree + 1; i++)
+      {
+        for(uint32_t rgb = 0; rgb < 3; rgb++)
+        {
+          const auto srcIndex = srcBase + (coefficientsPerChannel * rgb + firstCoef + i);
+          const auto dstIndex = destBase + dstOffset++;  // inc after add
+
+          storeSh(format, src, srcIndex, dst, dstIndex);
+        }
+      }
+    }
+  }
+  END_PAR_LOOP()
+}
+
+void quantizeSphericalHarmonics_3DGS(SplatSet& splatSet, uint32_t format, uint32_t maxShDegree)
+{
+  const auto splatCount = (uint32_t)splatSet.size();
+  if(splatCount == 0)
+    return;
+
+  const uint32_t srcStride              = (uint32_t)(splatSet.f_rest.size() / splatCount);
+  const uint32_t coefficientsPerChannel = srcStride / 3;
+  float*         sh                     = splatSet.f_rest.data();
+
+  START_PAR_LOOP(splatCount, splatIdx)
+  {
+    for(uint32_t rgb = 0; rgb < 3; rgb++)
+    {
+      for(uint32_t i = 0; i < coefficientsPerChannel; i++)
+      {
+        float& value = sh[srcStride * splatIdx + coefficientsPerChannel * rgb + i];
+        // coefficient i belongs to the degree d such that d*d-1 <= i < (d+1)*(d+1)-1
+        const uint32_t degree = (uint32_t)std::sqrt(float(i + 1));
+        if(degree > maxShDegree)
+          value = 0.0f;
+        else if(format == FORMAT_FLOAT16)
+          value = glm::unpackHalf1x16(glm::packHalf1x16(value));
+        else if(format == FORMAT_UINT8)
+          value = toUint8(value, -1., 1.) * (2.0f / 255.0f) - 1.0f;
+      }
+    }
+  }
+  END_PAR_LOOP()
+}
+
+void computeShDegrees_3DGS(const SplatSet& splatSet, float tolerance, uint32_t maxShDegree, std::vector<uint8_t>& degrees)
+{
+  const auto splatCount = (uint32_t)splatSet.size();
+  degrees.resize(splatCount);
+  if(splatCount == 0)
+    return;
+
+  const uint32_t srcStride              = (uint32_t)(splatSet.f_rest.size() / splatCount);
+  const uint32_t coefficientsPerChannel = srcStride / 3;
+  const uint32_t shDegree               = std::min(getShDegree_3DGS(splatSet), maxShDegree);
+  const float*   src                    = splatSet.f_rest.data();
+
+  // max of |Y_lm| over the sphere for the band l
+  float bandBound[4];
+  for(uint32_t degree = 0; degree <= 3; degree++)
+    bandBound[degree] = std::sqrt(float(2 * degree + 1) / (4.0f * 3.14159265f));
+
+  START_PAR_LOOP(splatCount, splatIdx)
+  {
+    const auto srcBase = srcStride * splatIdx;
+    // error bound per channel when the bands above degree are dropped, from the highest band
+    float    error[3] = {0.0f, 0.0f, 0.0f};
+    uint32_t degree   = shDegree;
+    for(; degree > 0; degree--)
+    {
+      const uint32_t first = degree * degree - 1;
+      bool           fits  = true;
+      for(uint32_t rgb = 0; rgb < 3; rgb++)
+      {
+        float norm2 = 0.0f;
+        for(uint32_t i = 0; i < 2 * degree + 1; i++)
+        {
+          const float c = src[srcBase + coefficientsPerChannel * rgb + first + i];
+          norm2 += c * c;
+        }
+        error[rgb] += bandBound[degree] * std::sqrt(norm2);
+        // also false for NaN, the band is then kept
+        fits = fits && error[rgb] <= tolerance;
+      }
+      if(!fits)
+        break;
+    }
+    degrees[splatIdx] = (uint8_t)degree;
+  }
+  END_PAR_LOOP()
+}
+
+uint64_t computeAdaptiveShLayout(const std::vector<uint8_t>& degrees, uint32_t format, std::vector<uint32_t>& headers)
+{
+  const size_t splatCount = degrees.size();
+  headers.resize(splatCount);
+
+  // the headers are 32 bit words at the beginning of the buffer
+  uint64_t offset = (uint64_t)splatCount * sizeof(uint32_t) / formatSize(format);
+  for(size_t splatIdx = 0; splatIdx < splatCount; ++splatIdx)
+  {
+    if(offset >= SH_ADAPTIVE_MAX_OFFSET)
+      return 0;
+    headers[splatIdx] = (uint32_t)(offset << 2) | degrees[splatIdx];
+    offset += getShComponentCount(degrees[splatIdx]);
+  }
+  return offset;
+}
+
+void packAdaptiveSphericalHarmonics_3DGS(const SplatSet& splatSet, uint32_t format, const std::vector<uint32_t>& headers, void* dst)
+{
+  packAdaptiveSphericalHarmonics_3DGS(splatSet, format, headers, dst, 0, std::numeric_limits<uint64_t>::max());
+}
+
+void packAdaptiveSphericalHarmonics_3DGS(const SplatSet&              splatSet,
+                                         uint32_t                     format,
+                                         const std::vector<uint32_t>& headers,
+                                         void*                        dst,
+                                         uint64_t                     firstElement,
+                                         uint64_t                     elementCount)
+{
+  const auto splatCount = (uint32_t)splatSet.size();
+  if(splatCount == 0 || headers.size() != splatCount || elementCount == 0)
+    return;
+
+  const uint32_t srcStride              = (uint32_t)(splatSet.f_rest.size() / splatCount);
+  const uint32_t coefficientsPerChannel = srcStride / 3;
+  const float*   src                    = splatSet.f_rest.data();
+  const uint64_t elementSize            = formatSize(format);
+  const uint64_t endElement = firstElement + std::min(elementCount, std::numeric_limits<uint64_t>::max() - firstElement);
+
+  // part of the headers in the range, the header region is a whole number of elements
+  const uint64_t headerElements = (uint64_t)splatCount * sizeof(uint32_t) / elementSize;
+  if(firstElement < headerElements)
+  {
+    const uint64_t firstByte = firstElement * elementSize;
+    const uint64_t endByte   = std::min(headerElements, endElement) * elementSize;
+    memcpy(dst, reinterpret_cast<const uint8_t*>(headers.data()) + firstByte, endByte - firstByte);
+  }
+
+  // splats with coefficients in the range, offsets are increasing with the splat index
+  const auto offsetLess = [](uint64_t offset, uint32_t header) { return offset < (header >> 2); };
+  const auto firstSplat = (uint32_t)std::max<ptrdiff_t>(
+      std::upper_bound(headers.begin(), headers.end(), firstElement, offsetLess) - headers.begin() - 1, 0);
+  const auto endSplat = (uint32_t)(std::upper_bound(headers.begin(), headers.end(), endElement - 1, offsetLess) - headers.begin());
+  if(endSplat <= firstSplat)
+    return;
+
+  START_PAR_LOOP(endSplat - firstSplat, i)
+  {
+    const auto splatIdx  = firstSplat + i;
+    const auto srcBase   = srcStride * splatIdx;
+    const auto shDegree  = headers[splatIdx] & 3;
+    uint64_t   dstOffset = headers[splatIdx] >> 2;
+    for(uint32_t degree = 1; degree <= shDegree; degree++)
+    {
+      const uint32_t firstCoef = degree * degree - 1;
+      for(uint32_t c = 0; c < 2 * degree + 1; c++)
+      {
+        for(uint32_t rgb = 0; rgb < 3; rgb++, dstOffset++)
+        {
+          if(dstOffset >= firstElement && dstOffset < endElement)
+            storeSh(format, src, srcBase + (coefficientsPerChannel * rgb + firstCoef + c), dst, (uint32_t)(dstOffset - firstElement));
+        }
+      }
+    }
+  }
+  END_PAR_LOOP()
+}
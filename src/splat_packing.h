@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <glm/gtc/packing.hpp>  // Required for half-float operations
+
+#include "shaders/shaderio.h"
+#include "splat_set.h"
+
+// CPU side conversion of a 3DGS splat set into the layouts uploaded to VRAM.
+// These loops do not depend on Vulkan so that they can be called by the
+// renderer on mapped staging memory and by the CPU benchmark on plain arrays.
+
+inline uint8_t toUint8(float v, float rangeMin, float rangeMax)
+{
+  float normalized = (v - rangeMin) / (rangeMax - rangeMin);
+  return static_cast<uint8_t>(std::clamp(std::round(normalized * 255.0f), 0.0f, 255.0f));
+};
+
+inline int formatSize(uint32_t format)
+{
+  if(format == FORMAT_FLOAT32)
+    return 4;
+  if(format == FORMAT_FLOAT16)
+    return 2;
+  if(format == FORMAT_UINT8)
+    return 1;
+  return 0;
+}
+
+inline void storeSh(int format, const float* srcBuffer, uint32_t srcIndex, void* dstBuffer, uint32_t dstIndex)
+{
+  if(format == FORMAT_FLOAT32)
+    static_cast<float*>(dstBuffer)[dstIndex] = srcBuffer[srcIndex];
+  else if(format == FORMAT_FLOAT16)
+    static_cast<uint16_t*>(dstBuffer)[dstIndex] = glm::packHalf1x16(srcBuffer[srcIndex]);
+  else if(format == FORMAT_UINT8)
+    static_cast<uint8_t*>(dstBuffer)[dstIndex] = toUint8(srcBuffer[srcIndex], -1., 1.);
+}
+
+// The pack functions convert the splats [first, first + count) of the set, the first one is
+// written at the beginning of dst. count is clamped to the end of the set, the whole set is
+// packed by default. Ranges allow to pack directly in the chunks of the upload staging ring.
+
+// number of splats of the range [first, first + count) that are in the set
+inline uint32_t getPackCount(const SplatSet& splatSet, uint32_t first, uint32_t count)
+{
+  const auto splatCount = (uint32_t)splatSet.size();
+  return first < splatCount ? std::min(count, splatCount - first) : 0;
+}
+
+// copies the positions, dstStride floats per splat (3 for buffers, 4 for RGBA textures)
+void packCenters(const SplatSet& splatSet, float* dst, uint32_t dstStride, uint32_t first = 0, uint32_t count = ~0u);
+
+// upper triangle of the 3D covariance matrix, 6 consecutive floats per splat
+void packCovariances_3DGS(const SplatSet& splatSet, float* dst, uint32_t first = 0, uint32_t count = ~0u);
+
+// SH degree 0 transformed to base color, and activated opacity, 4 floats per splat
+void packColors_3DGS(const SplatSet& splatSet, float* dst, uint32_t first = 0, uint32_t count = ~0u);
+// same as packColors_3DGS, quantized to 8 bit unorm
+void packColorsUnorm_3DGS(const SplatSet& splatSet, uint8_t* dst, uint32_t first = 0, uint32_t count = ~0u);
+
+// returns the maximum SH degree stored in the splat set, in [0,3]
+uint32_t getShDegree_3DGS(const SplatSet& splatSet);
+// number of SH components (degree 1 to 3, 3 channels) per splat for a given degree
+inline uint32_t getShComponentCount(uint32_t shDegree)
+{
+  return shDegree == 0 ? 0 : ((shDegree + 1) * (shDegree + 1) - 1) * 3;
+}
+
+// SH coefficients of degree 1 to min(getShDegree_3DGS(), maxShDegree), interleaved per coefficient
+// (rgb rgb ...), converted to format (FORMAT_*), dstStride elements per splat (allows padding).
+void packSphericalHarmonics_3DGS(const SplatSet& splatSet,
+                                 uint32_t        format,
+                                 void*           dst,
+                                 uint32_t        dstStride,
+                                 uint32_t        maxShDegree = 3,
+                                 uint32_t        first       = 0,
+                                 uint32_t        count       = ~0u);
+
+// rounds the SH coefficients of degree 1 to 3 to the precision of format (FORMAT_*) and zeroes the
+// bands above maxShDegree, the splat set keeps its float layout. Used by the offline converter to
+// bake the quantization of the SH storage in the output files.
+void quantizeSphericalHarmonics_3DGS(SplatSet& splatSet, uint32_t format, uint32_t maxShDegree = 3);
+
+// Adaptive SH storage (data buffers only), each splat stores the SH bands up to its own degree.
+// The buffer starts with one 32 bit header per splat, (offset << 2) | degree, where offset is the
+// index in elements of format of the first coefficient of the splat, followed by the coefficients
+// of all the splats (same interleaving as packSphericalHarmonics_3DGS, no padding).
+static const uint32_t SH_ADAPTIVE_MAX_OFFSET = 1u << 30;
+
+// minimal SH degree of each splat in [0,maxShDegree] such that the color error introduced by
+// dropping the higher bands stays below tolerance. The error of band l is bounded using
+// |sum_m c_lm Y_lm| <= sqrt((2l+1)/(4pi)) * |c_l| (addition theorem and Cauchy-Schwarz).
+void computeShDegrees_3DGS(const SplatSet& splatSet, float tolerance, uint32_t maxShDegree, std::vector<uint8_t>& degrees);
+
+// builds the per splat headers, returns the number of elements of the buffer (headers included),
+// or 0 if the offsets do not fit in the headers
+uint64_t computeAdaptiveShLayout(const std::vector<uint8_t>& degrees, uint32_t format, std::vector<uint32_t>& headers);
+
+// fills the buffer described by headers, dst must hold the number of elements returned by computeAdaptiveShLayout
+void packAdaptiveSphericalHarmonics_3DGS(const SplatSet& splatSet, uint32_t format, const std::vector<uint32_t>& headers, void* dst);
+// fills the elements [firstElement, firstElement + elementCount) of the buffer (headers included),
+// the first one is written at the beginning of dst. Splats may be split between two ranges.
+void packAdaptiveSphericalHarmonics_3DGS(const SplatSet&              splatSet,
+                                         uint32_t                     format,
+                                         const std::vector<uint32_t>& headers,
+                                         void*                        dst,
+                                         uint64_t                     firstElement,
+                                         uint64_t                     elementCount);
@@ -0,0 +1,159 @@
+#include "splat_prune.h"
+#include "splat_reorder.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+enum PruneReason : uint8_t
+{
+  PRUNE_KEEP,
+  PRUNE_OPACITY,
+  PRUNE_SIZE,
+  PRUNE_DISTANCE,
+};
+
+// median of the values, partially reorders them
+static float median(std::vector<float>& values)
+{
+  if(values.empty())
+    return 0.0f;
+  auto middle = values.begin() + values.size() / 2;
+  std::nth_element(values.begin(), middle, values.end());
+  return *middle;
+}
+
+// robust scene center and radius, see SplatPruneSettings
+static void computeSceneBounds(const SplatSet& splatSet, float center[3], float& radius)
+{
+  const size_t       splatCount = splatSet.size();
+  std::vector<float> values(splatCount);
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    START_PAR_LOOP(splatCount, splatIdx)
+    {
+      values[splatIdx] = splatSet.positions[splatIdx * 3 + axis];
+    }
+    END_PAR_LOOP()
+    center[axis] = median(values);
+  }
+
+  START_PAR_LOOP(splatCount, splatIdx)
+  {
+    const float* p  = &splatSet.positions[splatIdx * 3];
+    const float  dx = p[0] - center[0], dy = p[1] - center[1], dz = p[2] - center[2];
+    values[splatIdx] = std::sqrt(dx * dx + dy * dy + dz * dz);
+  }
+  END_PAR_LOOP()
+  radius = median(values);
+}
+
+bool pruneSplatSet(SplatSet& splatSet, const SplatPruneSettings& settings, SplatPruneStats& stats)
+{
+  const size_t splatCount = splatSet.size();
+  stats                   = {};
+  stats.inputCount        = splatCount;
+  if(!settings.enabled || splatCount == 0)
+    return false;
+
+  float center[3] = {};
+  float radius    = 0.0f;
+  if(settings.minSizeRatio > 0.0f || settings.maxDistanceRatio > 0.0f)
+    computeSceneBounds(splatSet, center, radius);
+
+  // the tests are done in the space of the stored values, opacity is a logit and scales are logarithms
+  const float minOpacity      = std::clamp(settings.minOpacity, 1e-6f, 1.0f - 1e-6f);
+  const float minOpacityLogit = std::log(minOpacity / (1.0f - minOpacity));
+  const bool  testSize        = settings.minSizeRatio > 0.0f && radius > 0.0f;
+  const float minLogSizeSum   = testSize ? 3.0f * std::log(settings.minSizeRatio * radius) : 0.0f;
+  const bool  testDistance    = settings.maxDistanceRatio > 0.0f && radius > 0.0f;
+  const float maxDistance     = settings.maxDistanceRatio * radius;
+  const float maxDistance2    = maxDistance * maxDistance;
+
+  std::vector<uint8_t> reasons(splatCount);
+  START_PAR_LOOP(splatCount, splatIdx)
+  {
+    const float* p      = &splatSet.positions[splatIdx * 3];
+    const float* s      = &splatSet.scale[splatIdx * 3];
+    const float  dx     = p[0] - center[0], dy = p[1] - center[1], dz = p[2] - center[2];
+    uint8_t      reason = PRUNE_KEEP;
+    // negated tests so NaN values are pruned
+    if(!(splatSet.opacity[splatIdx] >= minOpacityLogit))
+      reason = PRUNE_OPACITY;
+    else if(testSize && !(s[0] + s[1] + s[2] >= minLogSizeSum))
+      reason = PRUNE_SIZE;
+    else if(testDistance && !(dx * dx + dy * dy + dz * dz <= maxDistance2))
+      reason = PRUNE_DISTANCE;
+    reasons[splatIdx] = reason;
+  }
+  END_PAR_LOOP()
+
+  // parallel compaction, count kept splats per block then write their indices
+  const uint32_t        blockCount = getParallelBlockCount(splatCount);
+  std::vector<uint64_t> blockCounts(blockCount * 4, 0);
+  parallelBlocks(splatCount, blockCount, [&](uint32_t block, size_t begin, size_t end) {
+    uint64_t* counts = &blockCounts[block * 4];
+    for(size_t i = begin; i < end; ++i)
+      counts[reasons[i]]++;
+  });
+  std::vector<size_t> blockOffsets(blockCount);
+  size_t              keptCount = 0;
+  for(uint32_t block = 0; block < blockCount; ++block)
+  {
+    blockOffsets[block] = keptCount;
+    keptCount += blockCounts[block * 4 + PRUNE_KEEP];
+    stats.prunedOpacity += blockCounts[block * 4 + PRUNE_OPACITY];
+    stats.prunedSize += blockCounts[block * 4 + PRUNE_SIZE];
+    stats.prunedDistance += blockCounts[block * 4 + PRUNE_DISTANCE];
+  }
+  std::vector<uint32_t> kept(keptCount);
+  parallelBlocks(splatCount, blockCount, [&](uint32_t block, size_t begin, size_t end) {
+    size_t dst = blockOffsets[block];
+    for(size_t i = begin; i < end; ++i)
+    {
+      if(reasons[i] == PRUNE_KEEP)
+        kept[dst++] = (uint32_t)i;
+    }
+  });
+  reasons = {};
+
+  // prune to budget, keeps the splats with the highest opacity x area of the largest cross section
+  if(settings.maxSplatCount > 0 && keptCount > settings.maxSplatCount)
+  {
+    std::vector<std::pair<float, uint32_t>> ranked(keptCount);
+    START_PAR_LOOP(keptCount, i)
+    {
+      const uint32_t splatIdx = kept[i];
+      const float*   s        = &splatSet.scale[splatIdx * 3];
+      const float    opacity  = 1.0f / (1.0f + std::exp(-splatSet.opacity[splatIdx]));
+      const float    smallest = std::min({s[0], s[1], s[2]});
+      ranked[i]               = {opacity * std::exp(s[0] + s[1] + s[2] - smallest), splatIdx};
+    }
+    END_PAR_LOOP()
+    std::nth_element(ranked.begin(), ranked.begin() + settings.maxSplatCount, ranked.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+    kept.resize(settings.maxSplatCount);
+    START_PAR_LOOP(settings.maxSplatCount, i)
+    {
+      kept[i] = ranked[i].second;
+    }
+    END_PAR_LOOP()
+    // keeps the order of the file, the spatial reordering is done afterward
+    std::sort(kept.begin(), kept.end());
+    stats.prunedBudget = keptCount - settings.maxSplatCount;
+    keptCount          = settings.maxSplatCount;
+  }
+
+  if(keptCount == splatCount)
+    return true;
+
+  const size_t floatsPerSplat = (splatSet.positions.size() + splatSet.f_dc.size() + splatSet.f_rest.size()
+                                 + splatSet.opacity.size() + splatSet.scale.size() + splatSet.rotation.size())
+                                / splatCount;
+  stats.bytesSaved = (splatCount - keptCount) * floatsPerSplat * sizeof(float);
+
+  gatherSplats(splatSet, kept);
+  return true;
+}
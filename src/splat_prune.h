@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "splat_set.h"
+
+// Load time pruning of the splats that do not contribute to the image.
+// Trained scenes contain many almost transparent or tiny splats that still
+// cost memory, sorting and vertex work on every frame.
+struct SplatPruneSettings
+{
+  bool enabled = false;
+  // splats with a lower opacity (after the sigmoid) are removed, 1/255 by default
+  float minOpacity = 1.0f / 255.0f;
+  // splats with a size (geometric mean of the three scales) lower than this ratio
+  // of the scene radius are removed, 0 disables the test
+  float minSizeRatio = 1e-5f;
+  // splats farther from the scene center than this ratio of the scene radius are removed,
+  // 0 disables the test. The scene center is the per axis median of the positions and the
+  // scene radius is the median distance to this center, so a few outliers do not affect them.
+  float maxDistanceRatio = 0.0f;
+  // prune to budget, keeps at most this number of splats, the ones with the highest
+  // opacity x projected area. 0 disables the budget.
+  uint32_t maxSplatCount = 0;
+};
+
+// number of splats removed by each criterion, a splat is counted by the first test it fails
+struct SplatPruneStats
+{
+  uint64_t inputCount     = 0;
+  uint64_t prunedOpacity  = 0;
+  uint64_t prunedSize     = 0;
+  uint64_t prunedDistance = 0;
+  uint64_t prunedBudget   = 0;
+  uint64_t bytesSaved     = 0;  // host memory of the removed splats
+
+  inline uint64_t prunedCount() const { return prunedOpacity + prunedSize + prunedDistance + prunedBudget; }
+};
+
+// removes the splats that fail the tests from the set, keeping the order of the others.
+// returns false if nothing was done (pruning disabled or empty set)
+bool pruneSplatSet(SplatSet& splatSet, const SplatPruneSettings& settings, SplatPruneStats& stats);
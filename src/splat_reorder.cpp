@@ -0,0 +1,244 @@
+#include "splat_reorder.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+// inserts two zero bits between each of the SPLAT_ORDER_BITS low bits of v
+static inline uint64_t spreadBits(uint32_t v)
+{
+  uint64_t x = v & 0x1fffff;
+  x          = (x | x << 32) & 0x1f00000000ffffull;
+  x          = (x | x << 16) & 0x1f0000ff0000ffull;
+  x          = (x | x << 8) & 0x100f00f00f00f00full;
+  x          = (x | x << 4) & 0x10c30c30c30c30c3ull;
+  x          = (x | x << 2) & 0x1249249249249249ull;
+  return x;
+}
+
+static inline uint64_t mortonCode(uint32_t x, uint32_t y, uint32_t z)
+{
+  return (spreadBits(x) << 2) | (spreadBits(y) << 1) | spreadBits(z);
+}
+
+// transposed Hilbert index, from J. Skilling, "Programming the Hilbert curve", AIP 2004.
+// the index is made of the bits of the transformed coordinates read from the most significant one.
+static inline uint64_t hilbertCode(uint32_t x, uint32_t y, uint32_t z)
+{
+  uint32_t       X[3] = {x, y, z};
+  const uint32_t M    = 1u << (SPLAT_ORDER_BITS - 1);
+  // inverse undo
+  for(uint32_t Q = M; Q > 1; Q >>= 1)
+  {
+    const uint32_t P = Q - 1;
+    for(int i = 0; i < 3; i++)
+    {
+      if(X[i] & Q)
+      {
+        X[0] ^= P;  // invert
+      }
+      else
+      {
+        const uint32_t t = (X[0] ^ X[i]) & P;  // exchange
+        X[0] ^= t;
+        X[i] ^= t;
+      }
+    }
+  }
+  // gray encode
+  for(int i = 1; i < 3; i++)
+    X[i] ^= X[i - 1];
+  uint32_t t = 0;
+  for(uint32_t Q = M; Q > 1; Q >>= 1)
+  {
+    if(X[2] & Q)
+      t ^= Q - 1;
+  }
+  for(int i = 0; i < 3; i++)
+    X[i] ^= t;
+
+  return mortonCode(X[0], X[1], X[2]);
+}
+
+void computeSpatialCodes(const SplatSet& splatSet, SplatOrder order, std::vector<uint64_t>& codes)
+{
+  const size_t splatCount = splatSet.size();
+  codes.resize(splatCount);
+  if(splatCount == 0)
+    return;
+
+  const float* positions = splatSet.positions.data();
+
+  // bounding box, non finite positions are ignored
+  const uint32_t                        blockCount = getParallelBlockCount(splatCount);
+  std::vector<std::array<float, 6>>     blockBounds(blockCount);
+  parallelBlocks(splatCount, blockCount, [&](uint32_t block, size_t begin, size_t end) {
+    std::array<float, 6> bounds = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                                   std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(),
+                                   -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()};
+    for(size_t i = begin; i < end; ++i)
+    {
+      for(int axis = 0; axis < 3; ++axis)
+      {
+        const float p = positions[i * 3 + axis];
+        if(!std::isfinite(p))
+          continue;
+        bounds[axis]     = std::min(bounds[axis], p);
+        bounds[axis + 3] = std::max(bounds[axis + 3], p);
+      }
+    }
+    blockBounds[block] = bounds;
+  });
+  std::array<float, 6> bounds = blockBounds[0];
+  for(const auto& b : blockBounds)
+  {
+    for(int axis = 0; axis < 3; ++axis)
+    {
+      bounds[axis]     = std::min(bounds[axis], b[axis]);
+      bounds[axis + 3] = std::max(bounds[axis + 3], b[axis + 3]);
+    }
+  }
+
+  // same scale on the three axis, so the cells of the curve are cubes
+  float extent = 0.0f;
+  for(int axis = 0; axis < 3; ++axis)
+    extent = std::max(extent, bounds[axis + 3] - bounds[axis]);
+  const float maxCell = float((1u << SPLAT_ORDER_BITS) - 1);
+  const float scale   = extent > 0.0f ? maxCell / extent : 0.0f;
+
+  START_PAR_LOOP(splatCount, splatIdx)
+  {
+    uint32_t q[3];
+    for(int axis = 0; axis < 3; ++axis)
+    {
+      const float p = (positions[splatIdx * 3 + axis] - bounds[axis]) * scale;
+      // also maps NaN to 0
+      q[axis] = p > 0.0f ? (uint32_t)std::min(p, maxCell) : 0u;
+    }
+    codes[splatIdx] = order == SPLAT_ORDER_HILBERT ? hilbertCode(q[0], q[1], q[2]) : mortonCode(q[0], q[1], q[2]);
+  }
+  END_PAR_LOOP()
+}
+
+void sortSpatialCodes(std::vector<uint64_t>& codes, std::vector<uint32_t>& permutation)
+{
+  static const uint32_t RADIX_BITS = 11;
+  static const uint32_t RADIX      = 1u << RADIX_BITS;
+
+  const size_t count = codes.size();
+  permutation.resize(count);
+  START_PAR_LOOP(count, i)
+  {
+    permutation[i] = (uint32_t)i;
+  }
+  END_PAR_LOOP()
+
+  const uint32_t                        blockCount = getParallelBlockCount(count);
+  std::vector<std::array<size_t, RADIX>> histograms(blockCount);
+  std::vector<uint64_t>                 codesTmp(count);
+  std::vector<uint32_t>                 permutationTmp(count);
+
+  for(uint32_t shift = 0; shift < 3 * SPLAT_ORDER_BITS; shift += RADIX_BITS)
+  {
+    // histogram of the digit in each block
+    parallelBlocks(count, blockCount, [&](uint32_t block, size_t begin, size_t end) {
+      auto& histogram = histograms[block];
+      histogram.fill(0);
+      for(size_t i = begin; i < end; ++i)
+        histogram[(codes[i] >> shift) & (RADIX - 1)]++;
+    });
+
+    // digit is the same for all the codes, nothing to do for this pass
+    bool trivialPass = false;
+    for(uint32_t digit = 0; digit < RADIX && !trivialPass; ++digit)
+    {
+      size_t digitCount = 0;
+      for(uint32_t block = 0; block < blockCount; ++block)
+        digitCount += histograms[block][digit];
+      trivialPass = digitCount == count;
+    }
+    if(trivialPass)
+      continue;
+
+    // output offset of each digit in each block, blocks in order for a stable sort
+    size_t offset = 0;
+    for(uint32_t digit = 0; digit < RADIX; ++digit)
+    {
+      for(uint32_t block = 0; block < blockCount; ++block)
+      {
+        const size_t digitCount   = histograms[block][digit];
+        histograms[block][digit] = offset;
+        offset += digitCount;
+      }
+    }
+
+    // scatter
+    parallelBlocks(count, blockCount, [&](uint32_t block, size_t begin, size_t end) {
+      auto& offsets = histograms[block];
+      for(size_t i = begin; i < end; ++i)
+      {
+        const size_t dst    = offsets[(codes[i] >> shift) & (RADIX - 1)]++;
+        codesTmp[dst]       = codes[i];
+        permutationTmp[dst] = permutation[i];
+      }
+    });
+    codes.swap(codesTmp);
+    permutation.swap(permutationTmp);
+  }
+}
+
+// gathers the elements of one attribute, stride values per splat
+static void gatherAttribute(std::vector<float>& attribute, size_t splatCount, const std::vector<uint32_t>& indices)
+{
+  if(attribute.empty() || attribute.size() % splatCount != 0)
+    return;
+
+  const size_t       stride = attribute.size() / splatCount;
+  const size_t       count  = indices.size();
+  std::vector<float> gathered(count * stride);
+  START_PAR_LOOP(count, splatIdx)
+  {
+    std::copy_n(attribute.data() + indices[splatIdx] * stride, stride, gathered.data() + splatIdx * stride);
+  }
+  END_PAR_LOOP()
+  attribute.swap(gathered);
+}
+
+void gatherSplats(SplatSet& splatSet, const std::vector<uint32_t>& indices)
+{
+  const size_t splatCount = splatSet.size();
+  if(splatCount == 0)
+    return;
+
+  // one attribute at a time to limit the peak memory
+  gatherAttribute(splatSet.positions, splatCount, indices);
+  gatherAttribute(splatSet.f_dc, splatCount, indices);
+  gatherAttribute(splatSet.f_rest, splatCount, indices);
+  gatherAttribute(splatSet.opacity, splatCount, indices);
+  gatherAttribute(splatSet.scale, splatCount, indices);
+  gatherAttribute(splatSet.rotation, splatCount, indices);
+}
+
+void applySplatPermutation(SplatSet& splatSet, const std::vector<uint32_t>& permutation)
+{
+  if(permutation.size() != splatSet.size())
+    return;
+  gatherSplats(splatSet, permutation);
+}
+
+bool reorderSplatSet(SplatSet& splatSet, SplatOrder order, std::vector<uint32_t>* permutation)
+{
+  if(order == SPLAT_ORDER_NONE || splatSet.size() == 0)
+    return false;
+
+  std::vector<uint64_t> codes;
+  std::vector<uint32_t> localPermutation;
+  std::vector<uint32_t>& perm = permutation ? *permutation : localPermutation;
+
+  computeSpatialCodes(splatSet, order, codes);
+  sortSpatialCodes(codes, perm);
+  applySplatPermutation(splatSet, perm);
+  return true;
+}
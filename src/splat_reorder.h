@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "splat_set.h"
+
+// Spatial ordering of the splats applied at load time.
+// Splats close in space end up close in memory, which improves the cache hit rate
+// of the attribute fetches through the sorted indices and of the CPU sorter.
+enum SplatOrder : uint32_t
+{
+  SPLAT_ORDER_NONE,     // keeps the order of the file
+  SPLAT_ORDER_MORTON,   // Z-order curve
+  SPLAT_ORDER_HILBERT,  // Hilbert curve, better locality, a bit more expensive to compute
+};
+
+// number of bits per axis of the quantized positions, the codes use 3 * SPLAT_ORDER_BITS bits
+static const uint32_t SPLAT_ORDER_BITS = 21;
+
+// computes one code per splat along the curve, from the positions quantized
+// in the bounding box of the set (same scale on the three axis)
+void computeSpatialCodes(const SplatSet& splatSet, SplatOrder order, std::vector<uint64_t>& codes);
+
+// stable parallel LSD radix sort of the codes, permutation[i] is the original index
+// of the i-th sorted code. codes are sorted in place.
+void sortSpatialCodes(std::vector<uint64_t>& codes, std::vector<uint32_t>& permutation);
+
+// keeps the splats of the given indices, splat i of the result is splat indices[i] of the input.
+// used to reorder (permutation) or to compact (increasing subset) the set.
+void gatherSplats(SplatSet& splatSet, const std::vector<uint32_t>& indices);
+
+// reorders every attribute of the splat set consistently,
+// splat i of the result is splat permutation[i] of the input
+void applySplatPermutation(SplatSet& splatSet, const std::vector<uint32_t>& permutation);
+
+// computes, sorts and applies the codes, returns false if nothing was done (empty set or SPLAT_ORDER_NONE)
+// the applied permutation is returned if requested
+bool reorderSplatSet(SplatSet& splatSet, SplatOrder order, std::vector<uint32_t>* permutation = nullptr);
@@ -0,0 +1,118 @@
+#include "splat_scene.h"
+
+#include <algorithm>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "utilities.h"
+
+glm::mat4 SceneInstance::getTransform() const
+{
+  glm::mat4 transform = glm::translate(glm::mat4(1.0f), translation);
+  transform           = glm::rotate(transform, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+  transform           = glm::rotate(transform, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+  transform           = glm::rotate(transform, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+  return glm::scale(transform, glm::vec3(scale));
+}
+
+namespace {
+// values per splat of an attribute
+size_t getStride(const std::vector<float>& attribute, size_t splatCount)
+{
+  return splatCount ? attribute.size() / splatCount : 0;
+}
+
+// SH coefficients of degree 1 to 3, the channels one after the other for each splat, with
+// dstPerChannel coefficients per channel instead of srcPerChannel. The added bands are zeroed
+std::vector<float> resizeSh(const std::vector<float>& src, size_t splatCount, size_t srcPerChannel, size_t dstPerChannel)
+{
+  std::vector<float> dst(splatCount * 3 * dstPerChannel, 0.0f);
+  const size_t       copied = std::min(srcPerChannel, dstPerChannel);
+  START_PAR_LOOP(splatCount, splatIdx)
+  {
+    for(size_t rgb = 0; rgb < 3; rgb++)
+    {
+      const float* s = &src[(splatIdx * 3 + rgb) * srcPerChannel];
+      std::copy(s, s + copied, &dst[(splatIdx * 3 + rgb) * dstPerChannel]);
+    }
+  }
+  END_PAR_LOOP()
+  return dst;
+}
+
+void append(std::vector<float>& dst, const std::vector<float>& src)
+{
+  dst.insert(dst.end(), src.begin(), src.end());
+}
+
+void erase(std::vector<float>& attribute, size_t stride, size_t first, size_t count)
+{
+  if(stride == 0)
+    return;
+  attribute.erase(attribute.begin() + first * stride, attribute.begin() + (first + count) * stride);
+}
+}  // namespace
+
+bool appendSplatSet(SplatSet& dst, const SplatSet& src, bool& layoutChanged)
+{
+  layoutChanged         = false;
+  const size_t dstCount = dst.size();
+  const size_t srcCount = src.size();
+  if(srcCount == 0)
+    return true;
+  if(dstCount == 0)
+  {
+    dst           = src;
+    layoutChanged = true;
+    return true;
+  }
+
+  for(auto attribute : {&SplatSet::f_dc, &SplatSet::opacity, &SplatSet::scale, &SplatSet::rotation})
+  {
+    if(getStride(dst.*attribute, dstCount) != getStride(src.*attribute, srcCount))
+      return false;
+  }
+
+  // the sets may come with different SH degrees
+  const size_t dstShStride = getStride(dst.f_rest, dstCount);
+  const size_t srcShStride = getStride(src.f_rest, srcCount);
+  if(dstShStride != srcShStride)
+  {
+    if(dstShStride % 3 != 0 || srcShStride % 3 != 0)
+      return false;
+    if(srcShStride > dstShStride)
+    {
+      dst.f_rest    = resizeSh(dst.f_rest, dstCount, dstShStride / 3, srcShStride / 3);
+      layoutChanged = true;
+      append(dst.f_rest, src.f_rest);
+    }
+    else
+    {
+      append(dst.f_rest, resizeSh(src.f_rest, srcCount, srcShStride / 3, dstShStride / 3));
+    }
+  }
+  else
+  {
+    append(dst.f_rest, src.f_rest);
+  }
+
+  append(dst.positions, src.positions);
+  append(dst.f_dc, src.f_dc);
+  append(dst.opacity, src.opacity);
+  append(dst.scale, src.scale);
+  append(dst.rotation, src.rotation);
+  return true;
+}
+
+void eraseSplatRange(SplatSet& splatSet, size_t first, size_t count)
+{
+  const size_t splatCount = splatSet.size();
+  count                   = std::min(count, splatCount - std::min(first, splatCount));
+  if(count == 0)
+    return;
+  for(auto attribute : {&SplatSet::positions, &SplatSet::f_dc, &SplatSet::f_rest, &SplatSet::opacity, &SplatSet::scale,
+                        &SplatSet::rotation})
+  {
+    erase(splatSet.*attribute, getStride(splatSet.*attribute, splatCount), first, count);
+  }
+}
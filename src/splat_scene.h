@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "splat_set.h"
+
+// Instance of a splat set in a composed scene. The splat sets of the instances are concatenated
+// in a single set, so a single sort orders the splats of all the instances for the blending.
+struct SceneInstance
+{
+  std::string name;
+  uint32_t    splatOffset = 0;  // first splat in the concatenated set and in the device buffers
+  uint32_t    splatCount  = 0;
+  glm::vec3   translation{0.0f};
+  glm::vec3   rotation{0.0f};  // euler angles in degrees, applied in X, Y then Z order
+  float       scale   = 1.0f;  // uniform, the covariances and the SH directions stay valid
+  bool        visible = true;
+  // the splats of a removed instance stay in the device buffers, hidden, until the next rebuild
+  bool removed = false;
+
+  // splat set to scene
+  glm::mat4 getTransform() const;
+  bool      isIdentity() const { return translation == glm::vec3(0.0f) && rotation == glm::vec3(0.0f) && scale == 1.0f; }
+};
+
+// appends the splats of src to dst. The SH coefficients of the two sets are brought to the higher
+// degree (the missing bands are zeroed), layoutChanged is then set if the stride of dst changed.
+// Returns false if the sets cannot be merged (attributes missing from one of them).
+bool appendSplatSet(SplatSet& dst, const SplatSet& src, bool& layoutChanged);
+
+// removes count splats starting at first
+void eraseSplatRange(SplatSet& splatSet, size_t first, size_t count);
@@ -19,6 +19,7 @@
 
 #include "splat_sorter_async.h"
 #include "utilities.h"
+#include "trace_recorder.h"
 
 // for parallel processing
 #include <algorithm>
@@ -38,6 +39,8 @@ bool SplatSorterAsync::initialize()
 
   // starts the thread
   m_sorter = std::thread([this]() {
+    TraceRecorder::instance().setThreadName("Sorter");
+
     std::unique_lock<std::mutex> lock(m_mutex);
     m_status = E_READY;
     lock.unlock();
@@ -103,15 +106,18 @@ bool SplatSorterAsync::innerSort()
   m_indices.resize(splatCount);
 
   // compute distances in parallel
-  START_PAR_LOOP(distances.size(), splatIdx)
   {
-    const auto pos = &((*m_positions)[splatIdx * 3]);
-    // distance to plane
-    const float dist    = std::abs(plane[0] * pos[0] + plane[1] * pos[1] + plane[2] * pos[2] + plane[3]) * divider;
-    distances[splatIdx] = dist;
-    m_indices[splatIdx] = (uint32_t)splatIdx;
+    TRACE_SCOPE("CPU Dist");
+    START_PAR_LOOP(distances.size(), splatIdx)
+    {
+      const auto pos = &((*m_positions)[splatIdx * 3]);
+      // distance to plane
+      const float dist    = std::abs(plane[0] * pos[0] + plane[1] * pos[1] + plane[2] * pos[2] + plane[3]) * divider;
+      distances[splatIdx] = dist;
+      m_indices[splatIdx] = (uint32_t)splatIdx;
+    }
+    END_PAR_LOOP()
   }
-  END_PAR_LOOP()
 
   auto time1 = std::chrono::high_resolution_clock::now();
   m_distTime = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(time1 - startTime).count();
@@ -120,7 +126,14 @@ bool SplatSorterAsync::innerSort()
   auto compare = [&](size_t i, size_t j) { return distances[i] > distances[j]; };
 
   // Sorting the array with respect to distance keys
-  std::sort(std::execution::par_unseq, m_indices.begin(), m_indices.end(), compare);
+  // the parallel policy cannot be bounded, so only the single thread case is honored
+  {
+    TRACE_SCOPE("CPU Sort");
+    if(getParallelThreadCount() == 1)
+      std::sort(m_indices.begin(), m_indices.end(), compare);
+    else
+      std::sort(std::execution::par_unseq, m_indices.begin(), m_indices.end(), compare);
+  }
 
   auto time2 = std::chrono::high_resolution_clock::now();
   m_sortTime = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(time2 - time1).count();
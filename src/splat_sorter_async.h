@@ -61,6 +61,13 @@ public:
     std::lock_guard<std::mutex> lock(m_mutex);
     return m_status;
   }
+  // true from sortAsync until the result is available, the status is still E_READY
+  // until the sorter thread wakes up. Positions must not be accessed while sorting
+  inline bool isSorting()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_status == E_SORTING || m_startRequested;
+  }
   // triggers a new sort, only if viewpoint's
   // position or orientation did change since last run
   // return false if sorter not in READY state or if camera did not move
@@ -70,7 +77,7 @@ public:
   inline bool sortAsync(const glm::vec3& camDir, const glm::vec3& camCop, std::vector<float>& positions, bool lazy = true)
   {
     std::lock_guard<std::mutex> lock(m_mutex);
-    if(m_status != E_READY)
+    if(m_status != E_READY || m_startRequested)
     {
       return false;
     }
@@ -105,6 +112,30 @@ public:
     }
   }
 
+  // sorts in the calling thread, the sorter thread must not be started
+  // (state is E_SHUTDOWN), used for benchmarking
+  inline bool sortSync(const glm::vec3&       camDir,
+                       const glm::vec3&       camCop,
+                       std::vector<float>&    positions,
+                       std::vector<uint32_t>& indices,
+                       double&                distTime,
+                       double&                sortTime)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if(m_status != E_SHUTDOWN)
+        return false;
+      m_sortDir   = camDir;
+      m_sortCop   = camCop;
+      m_positions = &positions;
+    }
+    const bool result = innerSort();
+    distTime          = m_distTime;
+    sortTime          = m_sortTime;
+    indices.swap(m_indices);
+    return result;
+  }
+
 private:
   bool innerSort();
 
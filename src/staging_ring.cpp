@@ -0,0 +1,178 @@
+#include "staging_ring.h"
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+#include <nvvk/images_vk.hpp>
+#include <nvvkhl/application.hpp>
+
+void StagingRing::init(nvvkhl::Application*     app,
+                       nvvk::ResourceAllocator* alloc,
+                       VkDeviceSize             ringSize,
+                       VkPipelineStageFlags     shaderStages,
+                       uint32_t                 chunkCount)
+{
+  m_device       = app->getDevice();
+  m_queue        = app->getQueue(0).queue;
+  m_alloc        = alloc;
+  m_shaderStages = shaderStages;
+
+  // chunk offsets stay aligned for any texel size and copy offset
+  chunkCount  = std::max(chunkCount, 2u);
+  m_chunkSize = std::max(ringSize / chunkCount, MIN_CHUNK_SIZE) / 256 * 256;
+
+  m_buffer = m_alloc->createBuffer(m_chunkSize * chunkCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  m_mapped = static_cast<uint8_t*>(m_alloc->map(m_buffer));
+
+  VkCommandPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+  poolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+  poolInfo.queueFamilyIndex = app->getQueue(0).familyIndex;
+  vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_cmdPool);
+
+  m_chunks.resize(chunkCount);
+  std::vector<VkCommandBuffer> cmds(chunkCount);
+  VkCommandBufferAllocateInfo allocInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+  allocInfo.commandPool        = m_cmdPool;
+  allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount = chunkCount;
+  vkAllocateCommandBuffers(m_device, &allocInfo, cmds.data());
+
+  VkFenceCreateInfo fenceInfo{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+  for(uint32_t i = 0; i < chunkCount; ++i)
+  {
+    m_chunks[i].cmd = cmds[i];
+    vkCreateFence(m_device, &fenceInfo, nullptr, &m_chunks[i].fence);
+  }
+  m_nextChunk = 0;
+}
+
+void StagingRing::deinit()
+{
+  if(!isValid())
+    return;
+
+  for(auto& chunk : m_chunks)
+  {
+    if(chunk.pending)
+      vkWaitForFences(m_device, 1, &chunk.fence, VK_TRUE, UINT64_MAX);
+    vkDestroyFence(m_device, chunk.fence, nullptr);
+  }
+  m_chunks.clear();
+  vkDestroyCommandPool(m_device, m_cmdPool, nullptr);
+  m_cmdPool = VK_NULL_HANDLE;
+
+  m_alloc->unmap(m_buffer);
+  m_alloc->destroy(m_buffer);
+  m_mapped    = nullptr;
+  m_chunkSize = 0;
+}
+
+StagingRing::Chunk& StagingRing::acquireChunk()
+{
+  Chunk& chunk = m_chunks[m_nextChunk];
+  m_nextChunk  = (m_nextChunk + 1) % (uint32_t)m_chunks.size();
+
+  // the copy of the previous use of the chunk must be completed before it is overwritten
+  if(chunk.pending)
+  {
+    vkWaitForFences(m_device, 1, &chunk.fence, VK_TRUE, UINT64_MAX);
+    chunk.pending = false;
+  }
+  vkResetFences(m_device, 1, &chunk.fence);
+  vkResetCommandBuffer(chunk.cmd, 0);
+
+  VkCommandBufferBeginInfo beginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(chunk.cmd, &beginInfo);
+  return chunk;
+}
+
+void StagingRing::submitChunk(Chunk& chunk)
+{
+  vkEndCommandBuffer(chunk.cmd);
+
+  VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers    = &chunk.cmd;
+  vkQueueSubmit(m_queue, 1, &submitInfo, chunk.fence);
+  chunk.pending = true;
+}
+
+void StagingRing::uploadBuffer(VkBuffer dst, VkDeviceSize dstOffset, uint64_t elementCount, VkDeviceSize elementSize, const FillFunction& fill)
+{
+  const uint64_t elementsPerChunk = m_chunkSize / elementSize;
+
+  for(uint64_t first = 0; first < elementCount; first += elementsPerChunk)
+  {
+    const uint64_t count = std::min(elementsPerChunk, elementCount - first);
+
+    Chunk& chunk = acquireChunk();
+    fill(chunkData(chunk), first, count);
+
+    VkBufferCopy bc{.srcOffset = chunkOffset(chunk), .dstOffset = dstOffset + first * elementSize, .size = count * elementSize};
+    vkCmdCopyBuffer(chunk.cmd, m_buffer.buffer, dst, 1, &bc);
+    submitChunk(chunk);
+  }
+}
+
+void StagingRing::uploadImage(VkImage image, uint32_t width, uint32_t height, VkDeviceSize texelSize, VkDeviceSize elementSize, const FillFunction& fill)
+{
+  // chunks are made of groups of rows holding a whole number of elements
+  const VkDeviceSize rowSize      = width * texelSize;
+  const VkDeviceSize groupSize    = std::lcm(rowSize, elementSize);
+  const uint32_t     rowsPerGroup = (uint32_t)(groupSize / rowSize);
+  if(groupSize > m_chunkSize)
+  {
+    std::cerr << "Error: staging chunks are too small for a " << width << " texels wide image" << std::endl;
+    return;
+  }
+  const uint32_t rowsPerChunk = (uint32_t)(m_chunkSize / groupSize) * rowsPerGroup;
+
+  for(uint32_t firstRow = 0; firstRow < height; firstRow += rowsPerChunk)
+  {
+    const uint32_t     rowCount = std::min(rowsPerChunk, height - firstRow);
+    const VkDeviceSize size     = rowCount * rowSize;
+
+    Chunk& chunk = acquireChunk();
+    // the last element may be partially copied, it still fits in the chunk
+    fill(chunkData(chunk), firstRow * rowSize / elementSize, (size + elementSize - 1) / elementSize);
+
+    if(firstRow == 0)
+      nvvk::cmdBarrierImageLayout(chunk.cmd, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset                = chunkOffset(chunk);
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset                 = {0, (int32_t)firstRow, 0};
+    region.imageExtent                 = {width, rowCount, 1};
+    vkCmdCopyBufferToImage(chunk.cmd, m_buffer.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    if(firstRow + rowCount == height)
+      nvvk::cmdBarrierImageLayout(chunk.cmd, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    submitChunk(chunk);
+  }
+}
+
+void StagingRing::flush()
+{
+  if(!isValid())
+    return;
+
+  // submissions execute in order on the queue, one barrier covers all the copies
+  Chunk&          chunk = acquireChunk();
+  VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  vkCmdPipelineBarrier(chunk.cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, m_shaderStages, 0, 1, &barrier, 0, NULL, 0, NULL);
+  submitChunk(chunk);
+
+  for(auto& c : m_chunks)
+  {
+    if(c.pending)
+      vkWaitForFences(m_device, 1, &c.fence, VK_TRUE, UINT64_MAX);
+    c.pending = false;
+  }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <nvvk/resourceallocator_vk.hpp>
+
+namespace nvvkhl {
+class Application;
+}
+
+// Persistently mapped staging buffer split in chunks, used to upload the splat set.
+// The data is written directly in a chunk, then copied to the device resource by a
+// command buffer submitted with its own fence, so the CPU fills the next chunks while
+// the previous ones are being copied. A chunk is reused once its fence is signaled,
+// the host memory used by an upload is bounded by the size of the ring.
+class StagingRing
+{
+public:
+  // writes count elements starting at element first to dst (chunk memory, not initialized)
+  using FillFunction = std::function<void(void* dst, uint64_t first, uint64_t count)>;
+
+  // the ring is split in chunkCount chunks of at least MIN_CHUNK_SIZE bytes, shaderStages
+  // are the pipeline stages reading the uploaded resources
+  void init(nvvkhl::Application*     app,
+            nvvk::ResourceAllocator* alloc,
+            VkDeviceSize             ringSize,
+            VkPipelineStageFlags     shaderStages,
+            uint32_t                 chunkCount = 4);
+  void deinit();
+
+  bool         isValid() const { return !m_chunks.empty(); }
+  VkDeviceSize getSize() const { return m_chunkSize * m_chunks.size(); }
+
+  // uploads elementCount elements of elementSize bytes to dst, starting at dstOffset
+  void uploadBuffer(VkBuffer dst, VkDeviceSize dstOffset, uint64_t elementCount, VkDeviceSize elementSize, const FillFunction& fill);
+
+  // uploads a 2D image of width x height texels of texelSize bytes, seen as a linear array of
+  // elements of elementSize bytes (one element per splat), the elements past the end of the data
+  // must be filled as padding. The image goes from the undefined to the shader read only layout.
+  void uploadImage(VkImage image, uint32_t width, uint32_t height, VkDeviceSize texelSize, VkDeviceSize elementSize, const FillFunction& fill);
+
+  // makes the uploads visible to the shaders and waits for their completion
+  void flush();
+
+  // the rows of a chunk of image must hold a whole number of elements
+  static const VkDeviceSize MIN_CHUNK_SIZE = 4 * 1024 * 1024;
+
+private:
+  struct Chunk
+  {
+    VkCommandBuffer cmd     = VK_NULL_HANDLE;
+    VkFence         fence   = VK_NULL_HANDLE;
+    bool            pending = false;  // submitted, fence not waited yet
+  };
+
+  // waits for the next chunk to be available and begins its command buffer
+  Chunk& acquireChunk();
+  void   submitChunk(Chunk& chunk);
+  // mapped memory and offset in the ring of a chunk
+  uint8_t*     chunkData(const Chunk& chunk) { return m_mapped + chunkOffset(chunk); }
+  VkDeviceSize chunkOffset(const Chunk& chunk) const { return (&chunk - m_chunks.data()) * m_chunkSize; }
+
+  VkDevice                 m_device = VK_NULL_HANDLE;
+  VkQueue                  m_queue  = VK_NULL_HANDLE;
+  nvvk::ResourceAllocator* m_alloc  = nullptr;
+  VkPipelineStageFlags     m_shaderStages = 0;  // stages waiting for the uploads in flush()
+
+  VkCommandPool      m_cmdPool = VK_NULL_HANDLE;
+  nvvk::Buffer       m_buffer;
+  uint8_t*           m_mapped    = nullptr;
+  VkDeviceSize       m_chunkSize = 0;
+  std::vector<Chunk> m_chunks;
+  uint32_t           m_nextChunk = 0;
+};
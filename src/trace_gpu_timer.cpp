@@ -0,0 +1,150 @@
+#include "trace_gpu_timer.h"
+#include "trace_recorder.h"
+
+#include <nvvkhl/application.hpp>
+
+TraceGpuTimer::Section::Section(TraceGpuTimer* timer, VkCommandBuffer cmd, uint32_t query)
+    : m_timer(timer)
+    , m_cmd(cmd)
+    , m_query(query)
+{
+  vkCmdWriteTimestamp(m_cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timer->m_queryPool, m_query);
+}
+
+TraceGpuTimer::Section::~Section()
+{
+  if(m_timer)
+    vkCmdWriteTimestamp(m_cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timer->m_queryPool, m_query + 1);
+}
+
+void TraceGpuTimer::init(nvvkhl::Application* app)
+{
+  m_app    = app;
+  m_device = app->getDevice();
+
+  // no timestamps on this queue, sections stay inactive
+  uint32_t familyCount = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(app->getPhysicalDevice(), &familyCount, nullptr);
+  std::vector<VkQueueFamilyProperties> families(familyCount);
+  vkGetPhysicalDeviceQueueFamilyProperties(app->getPhysicalDevice(), &familyCount, families.data());
+  const uint32_t validBits = families[app->getQueue(0).familyIndex].timestampValidBits;
+  if(validBits == 0)
+    return;
+  m_tickMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(app->getPhysicalDevice(), &properties);
+  m_tickPeriod = properties.limits.timestampPeriod;
+
+  // one more slot than frames in flight, so a slot is always completed when reused
+  m_slots.resize(app->getFrameCycleSize() + 1);
+  m_currentSlot = 0;
+
+  VkQueryPoolCreateInfo createInfo{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+  createInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+  // the last query is used by the calibration
+  createInfo.queryCount = (uint32_t)m_slots.size() * MAX_SECTIONS_PER_FRAME * 2 + 1;
+  vkCreateQueryPool(m_device, &createInfo, nullptr, &m_queryPool);
+}
+
+void TraceGpuTimer::deinit()
+{
+  if(m_queryPool != VK_NULL_HANDLE)
+    vkDestroyQueryPool(m_device, m_queryPool, nullptr);
+  m_queryPool  = VK_NULL_HANDLE;
+  m_calibrated = false;
+  m_slots.clear();
+}
+
+TraceGpuTimer::Section TraceGpuTimer::section(const char* name, VkCommandBuffer cmd)
+{
+  if(m_queryPool == VK_NULL_HANDLE || !TraceRecorder::instance().isRecording())
+    return {};
+  if(!m_calibrated && !calibrate())
+    return {};
+
+  FrameSlot& slot = m_slots[m_currentSlot];
+  if(slot.names.size() >= MAX_SECTIONS_PER_FRAME)
+    return {};
+
+  const auto query = (uint32_t)((m_currentSlot * MAX_SECTIONS_PER_FRAME + slot.names.size()) * 2);
+  slot.names.push_back(name);
+  slot.frame   = TraceRecorder::instance().getFrameIndex();
+  slot.pending = true;
+  return {this, cmd, query};
+}
+
+void TraceGpuTimer::endFrame(VkCommandBuffer cmd)
+{
+  if(m_queryPool == VK_NULL_HANDLE)
+    return;
+
+  m_currentSlot = (m_currentSlot + 1) % (uint32_t)m_slots.size();
+  // results of the frame that used the slot one cycle ago
+  collect(m_currentSlot);
+
+  if(!TraceRecorder::instance().isRecording())
+  {
+    // next capture will calibrate again
+    m_calibrated = false;
+    return;
+  }
+  if(m_calibrated)
+    vkCmdResetQueryPool(cmd, m_queryPool, m_currentSlot * MAX_SECTIONS_PER_FRAME * 2, MAX_SECTIONS_PER_FRAME * 2);
+}
+
+bool TraceGpuTimer::calibrate()
+{
+  // blocks once per capture, the device is idle so the submit latency is minimal
+  vkDeviceWaitIdle(m_device);
+  for(auto& slot : m_slots)
+    slot = {};
+
+  const uint32_t calibrationQuery = (uint32_t)m_slots.size() * MAX_SECTIONS_PER_FRAME * 2;
+
+  VkCommandBuffer cmd = m_app->createTempCmdBuffer();
+  vkCmdResetQueryPool(cmd, m_queryPool, 0, calibrationQuery + 1);
+  vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, calibrationQuery);
+  const double submitTime = TraceRecorder::instance().now();
+  m_app->submitAndWaitTempCmdBuffer(cmd);
+  const double completionTime = TraceRecorder::instance().now();
+
+  uint64_t tick = 0;
+  if(vkGetQueryPoolResults(m_device, m_queryPool, calibrationQuery, 1, sizeof(uint64_t), &tick, sizeof(uint64_t),
+                           VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT)
+     != VK_SUCCESS)
+    return false;
+
+  m_gpuBaseTick = tick & m_tickMask;
+  m_cpuBaseTime = 0.5 * (submitTime + completionTime);
+  m_calibrated  = true;
+  return true;
+}
+
+void TraceGpuTimer::collect(uint32_t slotIndex)
+{
+  FrameSlot& slot = m_slots[slotIndex];
+  if(!slot.pending)
+    return;
+
+  const auto            queryCount = (uint32_t)slot.names.size() * 2;
+  std::vector<uint64_t> ticks(queryCount);
+  if(m_calibrated
+     && vkGetQueryPoolResults(m_device, m_queryPool, slotIndex * MAX_SECTIONS_PER_FRAME * 2, queryCount,
+                              ticks.size() * sizeof(uint64_t), ticks.data(), sizeof(uint64_t),
+                              VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT)
+            == VK_SUCCESS)
+  {
+    auto toCpuTime = [&](uint64_t tick) {
+      return m_cpuBaseTime + double((tick - m_gpuBaseTick) & m_tickMask) * m_tickPeriod * 0.001;
+    };
+    for(size_t i = 0; i < slot.names.size(); ++i)
+    {
+      const double start = toCpuTime(ticks[i * 2]);
+      const double end   = toCpuTime(ticks[i * 2 + 1]);
+      TraceRecorder::instance().addGpuEvent(slot.names[i], start, end - start, slot.frame);
+    }
+  }
+  slot.names.clear();
+  slot.pending = false;
+}
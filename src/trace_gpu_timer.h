@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+namespace nvvkhl {
+class Application;
+}
+
+// GPU side of the trace capture (see TraceRecorder), timestamps of the render
+// sections are read back with a delay of one frame cycle and added on the GPU track.
+// GPU ticks are aligned to the recorder time base once per capture: a timestamp is
+// submitted on an idle device and matched to the middle of the CPU submit/wait
+// interval, so the alignment error stays below half of this interval.
+// GPU sections of the frames still in flight when the capture ends are not written.
+class TraceGpuTimer
+{
+public:
+  // Scoped GPU section, inactive if no capture is running
+  class Section
+  {
+  public:
+    Section() = default;
+    Section(TraceGpuTimer* timer, VkCommandBuffer cmd, uint32_t query);
+    ~Section();
+
+    Section(const Section&)            = delete;
+    Section& operator=(const Section&) = delete;
+
+  private:
+    TraceGpuTimer*  m_timer = nullptr;
+    VkCommandBuffer m_cmd   = VK_NULL_HANDLE;
+    uint32_t        m_query = 0;
+  };
+
+  void init(nvvkhl::Application* app);
+  void deinit();
+
+  // starts a section ended by the destruction of the returned object
+  Section section(const char* name, VkCommandBuffer cmd);
+
+  // to be called once at the end of each frame, out of any rendering
+  void endFrame(VkCommandBuffer cmd);
+
+private:
+  // sections of one frame
+  struct FrameSlot
+  {
+    std::vector<std::string> names;
+    uint64_t                 frame   = 0;
+    bool                     pending = false;  // queries written, results not yet read
+  };
+
+  bool calibrate();
+  void collect(uint32_t slotIndex);
+
+  static const uint32_t MAX_SECTIONS_PER_FRAME = 64;
+
+  nvvkhl::Application* m_app         = nullptr;
+  VkDevice             m_device      = VK_NULL_HANDLE;
+  VkQueryPool          m_queryPool   = VK_NULL_HANDLE;
+  float                m_tickPeriod  = 1.0f;  // nanoseconds per tick
+  uint64_t             m_tickMask    = ~0ull;
+  bool                 m_calibrated  = false;
+  uint64_t             m_gpuBaseTick = 0;
+  double               m_cpuBaseTime = 0.0;  // microseconds in the recorder time base
+
+  std::vector<FrameSlot> m_slots;
+  uint32_t               m_currentSlot = 0;
+};
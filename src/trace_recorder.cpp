@@ -0,0 +1,216 @@
+#include "trace_recorder.h"
+
+#include <fstream>
+#include <iostream>
+
+#include <nvh/parametertools.hpp>
+
+#ifdef NVP_SUPPORTS_NVTOOLSEXT
+#define NVTX_STDINT_TYPES_ALREADY_DEFINED
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+// identifier of the GPU track in the trace, thread identifiers start at 1
+static const uint32_t TRACE_GPU_TRACK = 0;
+
+bool parseTraceArguments(int argc, char** argv, TraceSettings& settings)
+{
+  nvh::ParameterList parameters;
+  parameters.add("trace|writes a chrome://tracing JSON timeline of the first frames to the given file", &settings.filename);
+  parameters.add("traceFrames|number of frames of the timeline", &settings.frameCount);
+
+  // skip executable name
+  parameters.applyTokens((uint32_t)argc - 1, (const char**)argv + 1, "-", ".");
+
+  if(!settings.filename.empty() && settings.frameCount == 0)
+  {
+    std::cerr << "Error: -traceFrames must be greater than 0" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+TraceRecorder& TraceRecorder::instance()
+{
+  static TraceRecorder recorder;
+  return recorder;
+}
+
+TraceRecorder::TraceRecorder()
+    : m_startTime(std::chrono::high_resolution_clock::now())
+{
+  m_threadNames.push_back("GPU");
+}
+
+bool TraceRecorder::start(const std::string& filename, uint32_t frameCount)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if(m_recording || filename.empty() || frameCount == 0)
+    return false;
+
+  m_filename = filename;
+  m_events.clear();
+  m_events.reserve(64 * frameCount);
+  m_remainingFrames = frameCount;
+  m_recording       = true;
+  std::cout << "Trace capture started for " << frameCount << " frames" << std::endl;
+  return true;
+}
+
+void TraceRecorder::stop()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if(!m_recording)
+    return;
+  m_recording       = false;
+  m_remainingFrames = 0;
+  if(write())
+  {
+    m_lastFilename = m_filename;
+    std::cout << "Trace written to " << m_filename << std::endl;
+  }
+  m_events.clear();
+  m_events.shrink_to_fit();
+}
+
+std::string TraceRecorder::getLastFilename() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_lastFilename;
+}
+
+void TraceRecorder::setThreadName(const std::string& name)
+{
+#ifdef NVP_SUPPORTS_NVTOOLSEXT
+  nvtxNameOsThreadA(0, name.c_str());
+#endif
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_threadNames[getThreadId()] = name;
+}
+
+double TraceRecorder::now() const
+{
+  auto time = std::chrono::high_resolution_clock::now();
+  return 0.001 * std::chrono::duration_cast<std::chrono::nanoseconds>(time - m_startTime).count();
+}
+
+void TraceRecorder::addEvent(const char* name, double startUs, double durationUs, uint64_t frame)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if(!m_recording)
+    return;
+  m_events.push_back({name, 'X', getThreadId(), startUs, durationUs, frame});
+}
+
+void TraceRecorder::addGpuEvent(const std::string& name, double startUs, double durationUs, uint64_t frame)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if(!m_recording)
+    return;
+  m_events.push_back({name, 'X', TRACE_GPU_TRACK, startUs, durationUs, frame});
+}
+
+void TraceRecorder::addInstant(const char* name)
+{
+#ifdef NVP_SUPPORTS_NVTOOLSEXT
+  nvtxMarkA(name);
+#endif
+  if(!isRecording())
+    return;
+  const double time = now();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if(!m_recording)
+    return;
+  m_events.push_back({name, 'i', getThreadId(), time, 0.0, getFrameIndex()});
+}
+
+void TraceRecorder::endFrame()
+{
+  m_frameIndex++;
+  // the last frame is completed
+  if(isRecording() && --m_remainingFrames == 0)
+    stop();
+}
+
+uint32_t TraceRecorder::getThreadId()
+{
+  auto it = m_threadIds.find(std::this_thread::get_id());
+  if(it != m_threadIds.end())
+    return it->second;
+
+  const auto threadId                        = (uint32_t)m_threadNames.size();
+  m_threadIds[std::this_thread::get_id()] = threadId;
+  m_threadNames.push_back("Thread " + std::to_string(threadId));
+  return threadId;
+}
+
+// escapes the characters that would break the JSON strings
+static std::string jsonEscape(const std::string& str)
+{
+  std::string result;
+  for(char c : str)
+  {
+    if(c == '"' || c == '\\')
+      result += '\\';
+    result += c;
+  }
+  return result;
+}
+
+bool TraceRecorder::write()
+{
+  std::ofstream file(m_filename);
+  if(!file.is_open())
+  {
+    std::cerr << "Error: cannot write trace file " << m_filename << std::endl;
+    return false;
+  }
+
+  file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+  // track names, GPU first
+  for(uint32_t i = 0; i < (uint32_t)m_threadNames.size(); ++i)
+  {
+    file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << i << ", \"args\": {\"name\": \""
+         << jsonEscape(m_threadNames[i]) << "\"}},\n";
+    file << "{\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << i
+         << ", \"args\": {\"sort_index\": " << i << "}},\n";
+  }
+  for(size_t i = 0; i < m_events.size(); ++i)
+  {
+    const Event& e = m_events[i];
+    file << "{\"name\": \"" << jsonEscape(e.name) << "\", \"ph\": \"" << e.phase << "\", \"pid\": 1, \"tid\": " << e.threadId
+         << ", \"ts\": " << std::fixed << e.start;
+    if(e.phase == 'X')
+      file << ", \"dur\": " << e.duration;
+    else
+      file << ", \"s\": \"t\"";
+    file << ", \"args\": {\"frame\": " << e.frame << "}}" << (i + 1 < m_events.size() ? ",\n" : "\n");
+  }
+  file << "]}\n";
+  return true;
+}
+
+TraceScope::TraceScope(const char* name)
+    : m_name(name)
+{
+#ifdef NVP_SUPPORTS_NVTOOLSEXT
+  nvtxRangePushA(name);
+#endif
+  TraceRecorder& recorder = TraceRecorder::instance();
+  if(recorder.isRecording())
+  {
+    m_start = recorder.now();
+    m_frame = recorder.getFrameIndex();
+  }
+}
+
+TraceScope::~TraceScope()
+{
+#ifdef NVP_SUPPORTS_NVTOOLSEXT
+  nvtxRangePop();
+#endif
+  if(m_start < 0.0)
+    return;
+  TraceRecorder& recorder = TraceRecorder::instance();
+  recorder.addEvent(m_name, m_start, recorder.now() - m_start, m_frame);
+}
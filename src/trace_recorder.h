@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Timeline of the loader, sorter and render threads.
+// Scopes are forwarded to NVTX when nvpro_core is configured with SUPPORT_NVTOOLSEXT,
+// so they show up in Nsight Systems, and recorded in memory while a capture is running.
+// A capture covers a given number of frames and is written in the chrome://tracing
+// (Trace Event Format) JSON format, GPU sections are added on a separate track.
+// Each event carries the index of the frame during which it started, which makes
+// a sort result consumed one frame late directly visible.
+
+// Settings of the capture, parsed from the command line
+struct TraceSettings
+{
+  std::string filename;        // capture starts at first frame if not empty
+  uint32_t    frameCount = 300;
+};
+
+// parses the -trace* command line arguments, returns false on error.
+// a capture is requested if settings.filename is not empty.
+bool parseTraceArguments(int argc, char** argv, TraceSettings& settings);
+
+class TraceRecorder
+{
+public:
+  static TraceRecorder& instance();
+
+  // starts a capture of frameCount frames, the file is written after the last frame.
+  // returns false if a capture is already running
+  bool start(const std::string& filename, uint32_t frameCount);
+  // writes what was captured so far
+  void stop();
+
+  inline bool isRecording() const { return m_recording.load(std::memory_order_relaxed); }
+  // remaining frames of the running capture
+  inline uint32_t getRemainingFrames() const { return m_remainingFrames.load(); }
+  // file written by the last capture, empty if none
+  std::string getLastFilename() const;
+
+  // names the calling thread in the trace
+  void setThreadName(const std::string& name);
+
+  // microseconds since the recorder creation, time base of all the events
+  double now() const;
+
+  // complete event of the calling thread
+  void addEvent(const char* name, double startUs, double durationUs, uint64_t frame);
+  // complete event on the GPU track, times already converted to the CPU time base
+  void addGpuEvent(const std::string& name, double startUs, double durationUs, uint64_t frame);
+  // instant event of the calling thread
+  void addInstant(const char* name);
+
+  // index of the frame being recorded
+  inline uint64_t getFrameIndex() const { return m_frameIndex.load(std::memory_order_relaxed); }
+  // to be called once at the end of each frame by the render thread
+  void endFrame();
+
+private:
+  TraceRecorder();
+
+  struct Event
+  {
+    std::string name;
+    char        phase    = 'X';  // X=complete, i=instant
+    uint32_t    threadId = 0;
+    double      start    = 0.0;
+    double      duration = 0.0;
+    uint64_t    frame    = 0;
+  };
+
+  // returns the trace identifier of the calling thread, registers it if needed, m_mutex must be locked
+  uint32_t getThreadId();
+  bool     write();
+
+  const std::chrono::high_resolution_clock::time_point m_startTime;
+
+  std::atomic_bool     m_recording{false};
+  std::atomic_uint32_t m_remainingFrames{0};
+  std::atomic_uint64_t m_frameIndex{0};
+
+  mutable std::mutex                           m_mutex;
+  std::string                                  m_filename;
+  std::string                                  m_lastFilename;
+  std::vector<Event>                           m_events;
+  std::unordered_map<std::thread::id, uint32_t> m_threadIds;
+  std::vector<std::string>                     m_threadNames;
+};
+
+// Scoped CPU section, NVTX range and trace event
+class TraceScope
+{
+public:
+  explicit TraceScope(const char* name);
+  ~TraceScope();
+
+  TraceScope(const TraceScope&)            = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+  const char* m_name;
+  double      m_start = -1.0;  // negative if not recorded
+  uint64_t    m_frame = 0;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
@@ -20,8 +20,24 @@
 #ifndef _UTILITIES_H_
 #define _UTILITIES_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+
 #include <nvh/parallel_work.hpp>
 
+// Number of threads used by the parallel loops, 0 means one per hardware thread.
+// Only changed by the CPU benchmark to measure scaling.
+inline uint32_t& parallelThreadCountOverride()
+{
+  static uint32_t count = 0;
+  return count;
+}
+inline uint32_t getParallelThreadCount()
+{
+  return parallelThreadCountOverride() ? parallelThreadCountOverride() : (uint32_t)std::thread::hardware_concurrency();
+}
+
 // Example using the parallel loop macro
 // constexpr uint32_t N = 100;
 // START_PAR_LOOP( N, i)
@@ -34,7 +50,30 @@
         SIZE, [&](int INDEX, int tidx) {
 
 #define END_PAR_LOOP()                                                                                                 \
-  }, (uint32_t)std::thread::hardware_concurrency());                                                                   \
+  }, getParallelThreadCount());                                                                                        \
   }
 
+// Number of blocks for parallelBlocks, a few blocks per thread for load
+// balancing, not too small to amortize the per block partial results.
+inline uint32_t getParallelBlockCount(size_t count)
+{
+  const size_t blockCount = std::min<size_t>(getParallelThreadCount() * 4, count / 4096 + 1);
+  return (uint32_t)std::max<size_t>(blockCount, 1);
+}
+
+// Runs fn(block, begin, end) in parallel over blockCount contiguous blocks of [0,count),
+// for passes that need per block partial results (histograms, prefix sums, reductions).
+template <typename F>
+inline void parallelBlocks(size_t count, uint32_t blockCount, F&& fn)
+{
+  nvh::parallel_batches_indexed<1>(
+      blockCount,
+      [&](int block, int) {
+        const size_t begin = count * block / blockCount;
+        const size_t end   = count * (block + 1) / blockCount;
+        fn((uint32_t)block, begin, end);
+      },
+      getParallelThreadCount());
+}
+
 #endif
@@ -0,0 +1,348 @@
+// Offline preprocessing of 3DGS and spacetime-lite PLY files, for build machines without GPU.
+// Each input is loaded, pruned, spatially reordered, its SH quantized to the precision of the
+// target storage, then written as one or several PLY files loadable by the viewer.
+// Needs no Vulkan device. The files of a batch are processed in parallel.
+//
+// usage: splat_converter [options] file.ply [file.ply ...]
+//   -out dir                    output directory (default: next to the input file). The inputs
+//                               of a batch must have different file names.
+//   -suffix str                 appended to the output file names (default: _opt)
+//   -gsMode 0|1                 0=3dgs 1=spacetime-lite
+//   -order 0|1|2                spatial reordering, 0=file 1=morton 2=hilbert (default: 1)
+//   -prune 0|1                  prunes the negligible splats (default: 1)
+//   -pruneMinOpacity f          see SplatPruneSettings
+//   -pruneMinSize f
+//   -pruneMaxDistance f
+//   -pruneBudget n
+//   -quantize 0|1|2             rounds the SH to fp32 (no change), fp16 or uint8 precision, 3dgs only
+//   -maxShDegree d              drops the SH bands above d from the output, 3dgs only
+//   -chunkSize n                splits the output in files of n consecutive splats, 0=single file.
+//                               Chunks are spatially coherent when the splats are reordered.
+//   -jobs n                     number of files processed in parallel (default: 2)
+//   -report file.json           JSON statistics of the batch (default: splat_converter.json)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nvh/parametertools.hpp>
+
+#include "ply_async_loader.h"
+#include "splat_generator.h"
+#include "splat_packing.h"
+
+struct ConverterSettings
+{
+  std::vector<std::string> inputFilenames;
+  std::string              outputDirectory;
+  std::string              suffix         = "_opt";
+  std::string              reportFilename = "splat_converter.json";
+  uint32_t                 gsMode         = GSMode_3DGS;
+  uint32_t                 splatOrder     = SPLAT_ORDER_MORTON;
+  SplatPruneSettings       prune;
+  uint32_t                 quantize    = FORMAT_FLOAT32;
+  uint32_t                 maxShDegree = 3;
+  uint32_t                 chunkSize   = 0;
+  uint32_t                 jobs        = 2;
+
+  ConverterSettings() { prune.enabled = true; }
+};
+
+// bounds of one output file
+struct ChunkInfo
+{
+  std::string filename;
+  size_t      splatCount = 0;
+  float       boundsMin[3];
+  float       boundsMax[3];
+};
+
+struct ConverterResult
+{
+  std::string            inputFilename;
+  bool                   success     = false;
+  uint64_t               inputBytes  = 0;
+  uint64_t               outputBytes = 0;
+  SplatPruneStats        pruneStats;
+  size_t                 outputSplatCount = 0;
+  double                 loadTime         = 0.0;  // ms, includes pruning and reordering
+  double                 writeTime        = 0.0;  // ms
+  std::vector<ChunkInfo> chunks;
+};
+
+static bool parseArguments(int argc, char** argv, ConverterSettings& settings)
+{
+  // the file names are relative to the working directory
+  std::string        inputFilename;
+  nvh::ParameterList parameters;
+  parameters.addFilename(".ply|input file, several files can be given",
+                         &inputFilename, [&](uint32_t) { settings.inputFilenames.push_back(inputFilename); });
+  parameters.add("out|output directory", &settings.outputDirectory);
+  parameters.add("suffix|appended to the output file names", &settings.suffix);
+  parameters.add("report|JSON statistics of the batch", &settings.reportFilename);
+  parameters.add("gsMode|0=3dgs 1=spacetime-lite", &settings.gsMode, nullptr, 1, GSMode_3DGS, GSMode_SPACETIME_LITE);
+  parameters.add("order|0=file 1=morton 2=hilbert", &settings.splatOrder, nullptr, 1, SPLAT_ORDER_NONE, SPLAT_ORDER_HILBERT);
+  parameters.add("prune|prunes the negligible splats", &settings.prune.enabled);
+  parameters.add("pruneMinOpacity", &settings.prune.minOpacity);
+  parameters.add("pruneMinSize", &settings.prune.minSizeRatio);
+  parameters.add("pruneMaxDistance", &settings.prune.maxDistanceRatio);
+  parameters.add("pruneBudget", &settings.prune.maxSplatCount);
+  parameters.add("quantize|0=fp32 1=fp16 2=uint8", &settings.quantize, nullptr, 1, FORMAT_FLOAT32, FORMAT_UINT8);
+  parameters.add("maxShDegree|highest SH band kept, 3dgs only", &settings.maxShDegree, nullptr, 1, 0, 3);
+  parameters.add("chunkSize|splats per output file, 0=single file", &settings.chunkSize);
+  parameters.add("jobs|files processed in parallel", &settings.jobs, nullptr, 1, 1);
+
+  // skip executable name, unknown arguments are reported by the parameter list
+  parameters.applyTokens((uint32_t)argc - 1, (const char**)argv + 1, "-", ".");
+  if(settings.inputFilenames.empty())
+  {
+    std::cerr << "Error: no input file" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// copies the splats [begin, begin + count) in a new set
+static SplatSet extractSplats(const SplatSet& splatSet, size_t begin, size_t count)
+{
+  SplatSet   chunk;
+  const auto copyRange = [&](const std::vector<float>& src, std::vector<float>& dst) {
+    const size_t stride = src.size() / splatSet.size();
+    dst.assign(src.begin() + begin * stride, src.begin() + (begin + count) * stride);
+  };
+  copyRange(splatSet.positions, chunk.positions);
+  copyRange(splatSet.f_dc, chunk.f_dc);
+  copyRange(splatSet.f_rest, chunk.f_rest);
+  copyRange(splatSet.opacity, chunk.opacity);
+  copyRange(splatSet.scale, chunk.scale);
+  copyRange(splatSet.rotation, chunk.rotation);
+  return chunk;
+}
+
+static ChunkInfo getChunkInfo(const std::string& filename, const SplatSet& splatSet)
+{
+  ChunkInfo info;
+  info.filename   = filename;
+  info.splatCount = splatSet.size();
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    info.boundsMin[axis] = std::numeric_limits<float>::max();
+    info.boundsMax[axis] = -std::numeric_limits<float>::max();
+  }
+  for(size_t i = 0; i < splatSet.size(); ++i)
+  {
+    for(int axis = 0; axis < 3; ++axis)
+    {
+      info.boundsMin[axis] = std::min(info.boundsMin[axis], splatSet.positions[i * 3 + axis]);
+      info.boundsMax[axis] = std::max(info.boundsMax[axis], splatSet.positions[i * 3 + axis]);
+    }
+  }
+  return info;
+}
+
+// output file of an input, without the chunk index and the extension
+static std::filesystem::path getOutputStem(const ConverterSettings& settings, const std::string& inputFilename)
+{
+  const std::filesystem::path inputPath(inputFilename);
+  const std::filesystem::path outputDirectory =
+      settings.outputDirectory.empty() ? inputPath.parent_path() : std::filesystem::path(settings.outputDirectory);
+  return outputDirectory / (inputPath.stem().string() + settings.suffix);
+}
+
+static ConverterResult convertFile(const ConverterSettings& settings, const std::string& inputFilename)
+{
+  ConverterResult result;
+  result.inputFilename = inputFilename;
+
+  std::error_code ec;
+  result.inputBytes = std::filesystem::file_size(inputFilename, ec);
+  if(ec)
+    result.inputBytes = 0;
+
+  // the loader prunes and reorders the splats once loaded
+  const GSMode   gsMode = (GSMode)settings.gsMode;
+  SplatSet       splatSet;
+  PlyAsyncLoader loader;
+  loader.m_gsMode        = gsMode;
+  loader.m_splatOrder    = settings.splatOrder;
+  loader.m_pruneSettings = settings.prune;
+
+  auto startTime = std::chrono::high_resolution_clock::now();
+  if(!loader.loadSceneSync(inputFilename, splatSet) || splatSet.size() == 0)
+  {
+    std::cerr << "Error: failed to load " << inputFilename << std::endl;
+    return result;
+  }
+  result.pruneStats = loader.getPruneStats();
+
+  // spacetime features are not SH, they are kept as is
+  // the bands above maxShDegree are not written
+  if(gsMode == GSMode_3DGS && settings.quantize != FORMAT_FLOAT32)
+    quantizeSphericalHarmonics_3DGS(splatSet, settings.quantize, settings.maxShDegree);
+  auto endTime    = std::chrono::high_resolution_clock::now();
+  result.loadTime = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+
+  const std::filesystem::path stem = getOutputStem(settings, inputFilename);
+
+  startTime               = std::chrono::high_resolution_clock::now();
+  const size_t splatCount = splatSet.size();
+  const size_t chunkSize  = settings.chunkSize > 0 ? settings.chunkSize : splatCount;
+  const size_t chunkCount = (splatCount + chunkSize - 1) / chunkSize;
+  result.outputSplatCount = splatCount;
+  for(size_t chunk = 0; chunk < chunkCount; ++chunk)
+  {
+    std::string name = stem.filename().string();
+    if(chunkCount > 1)
+    {
+      // room for the whole size_t range
+      char index[32];
+      snprintf(index, sizeof(index), "_chunk%04zu", chunk);
+      name += index;
+    }
+    const std::string filename = (stem.parent_path() / (name + ".ply")).string();
+
+    const size_t begin = chunk * chunkSize;
+    const size_t count = std::min(chunkSize, splatCount - begin);
+    bool         written;
+    if(chunkCount > 1)
+    {
+      const SplatSet chunkSet = extractSplats(splatSet, begin, count);
+      written                 = writeSplatSetPly(filename, chunkSet, gsMode, settings.maxShDegree);
+      result.chunks.push_back(getChunkInfo(filename, chunkSet));
+    }
+    else
+    {
+      written = writeSplatSetPly(filename, splatSet, gsMode, settings.maxShDegree);
+      result.chunks.push_back(getChunkInfo(filename, splatSet));
+    }
+    if(!written)
+      return result;
+    const uint64_t fileBytes = std::filesystem::file_size(filename, ec);
+    result.outputBytes += ec ? 0 : fileBytes;
+  }
+  endTime          = std::chrono::high_resolution_clock::now();
+  result.writeTime = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+  result.success   = true;
+  return result;
+}
+
+static std::string quote(const std::string& str)
+{
+  std::string out = "\"";
+  for(char c : str)
+  {
+    if(c == '"' || c == '\\')
+      out += '\\';
+    out += c;
+  }
+  return out + "\"";
+}
+
+static bool writeReport(const ConverterSettings& settings, const std::vector<ConverterResult>& results)
+{
+  std::ofstream file(settings.reportFilename);
+  if(!file.is_open())
+  {
+    std::cerr << "Error: cannot write report " << settings.reportFilename << std::endl;
+    return false;
+  }
+  file << "{\n";
+  file << "  \"gsMode\": " << settings.gsMode << ", \"splatOrder\": " << settings.splatOrder
+       << ", \"quantize\": " << settings.quantize << ", \"maxShDegree\": " << settings.maxShDegree
+       << ", \"chunkSize\": " << settings.chunkSize << ",\n";
+  file << "  \"pruning\": {\"enabled\": " << (settings.prune.enabled ? "true" : "false")
+       << ", \"minOpacity\": " << settings.prune.minOpacity << ", \"minSizeRatio\": " << settings.prune.minSizeRatio
+       << ", \"maxDistanceRatio\": " << settings.prune.maxDistanceRatio
+       << ", \"maxSplatCount\": " << settings.prune.maxSplatCount << "},\n";
+  file << "  \"files\": [\n";
+  for(size_t i = 0; i < results.size(); ++i)
+  {
+    const ConverterResult& r = results[i];
+    const SplatPruneStats& p = r.pruneStats;
+    file << "    {\n";
+    file << "      \"input\": " << quote(r.inputFilename) << ", \"success\": " << (r.success ? "true" : "false") << ",\n";
+    file << "      \"inputSplats\": " << p.inputCount << ", \"outputSplats\": " << r.outputSplatCount
+         << ", \"inputBytes\": " << r.inputBytes << ", \"outputBytes\": " << r.outputBytes << ",\n";
+    file << "      \"pruned\": {\"opacity\": " << p.prunedOpacity << ", \"size\": " << p.prunedSize
+         << ", \"distance\": " << p.prunedDistance << ", \"budget\": " << p.prunedBudget << "},\n";
+    file << "      \"timingsMs\": {\"load\": " << r.loadTime << ", \"write\": " << r.writeTime << "},\n";
+    file << "      \"chunks\": [";
+    for(size_t c = 0; c < r.chunks.size(); ++c)
+    {
+      const ChunkInfo& chunk = r.chunks[c];
+      file << (c ? ",\n" : "\n") << "        {\"file\": " << quote(chunk.filename) << ", \"splats\": " << chunk.splatCount
+           << ", \"min\": [" << chunk.boundsMin[0] << ", " << chunk.boundsMin[1] << ", " << chunk.boundsMin[2]
+           << "], \"max\": [" << chunk.boundsMax[0] << ", " << chunk.boundsMax[1] << ", " << chunk.boundsMax[2] << "]}";
+    }
+    file << (r.chunks.empty() ? "]\n" : "\n      ]\n");
+    file << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  file << "  ]\n}\n";
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  ConverterSettings settings;
+  if(!parseArguments(argc, argv, settings))
+    return 1;
+
+  // inputs of the same name from different directories would overwrite each other with -out
+  std::set<std::filesystem::path> outputStems;
+  for(const auto& filename : settings.inputFilenames)
+  {
+    if(!outputStems.insert(std::filesystem::absolute(getOutputStem(settings, filename)).lexically_normal()).second)
+    {
+      std::cerr << "Error: " << filename << " has the same output file as another input, convert them separately" << std::endl;
+      return 1;
+    }
+  }
+
+  if(!settings.outputDirectory.empty())
+  {
+    std::error_code ec;
+    std::filesystem::create_directories(settings.outputDirectory, ec);
+  }
+
+  // each job converts whole files, the parallel loops of a file share the thread pool
+  const size_t                 fileCount = settings.inputFilenames.size();
+  std::vector<ConverterResult> results(fileCount);
+  std::atomic<size_t>          nextFile{0};
+  std::vector<std::thread>     jobs;
+  for(uint32_t job = 0; job < std::min<size_t>(settings.jobs, fileCount); ++job)
+  {
+    jobs.emplace_back([&]() {
+      for(size_t fileIdx = nextFile++; fileIdx < fileCount; fileIdx = nextFile++)
+        results[fileIdx] = convertFile(settings, settings.inputFilenames[fileIdx]);
+    });
+  }
+  for(auto& job : jobs)
+    job.join();
+
+  size_t   failed = 0;
+  uint64_t inputBytes = 0, outputBytes = 0, inputSplats = 0, outputSplats = 0;
+  for(const auto& r : results)
+  {
+    failed += r.success ? 0 : 1;
+    inputBytes += r.inputBytes;
+    outputBytes += r.outputBytes;
+    inputSplats += r.pruneStats.inputCount;
+    outputSplats += r.outputSplatCount;
+  }
+  const uint64_t MB = 1024 * 1024;
+  std::cout << "Converted " << fileCount - failed << "/" << fileCount << " files, " << inputSplats << " -> "
+            << outputSplats << " splats, " << inputBytes / MB << "MB -> " << outputBytes / MB << "MB" << std::endl;
+
+  if(!writeReport(settings, results))
+    return 1;
+  std::cout << "Report written to " << settings.reportFilename << std::endl;
+  return failed ? 1 : 0;
+}